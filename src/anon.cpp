@@ -10,6 +10,7 @@
 #include <secp256k1_mlsag.h>
 
 #include <blind.h>
+#include <crypto/sha256.h>
 #include <rctindex.h>
 #include <txdb.h>
 #include <util/system.h>
@@ -20,7 +21,13 @@
 #include <txmempool.h>
 
 
-bool VerifyMLSAG(const CTransaction &tx, TxValidationState &state)
+/**
+ * Verify the MLSAG signatures and commitment sums of tx.
+ * With fContextual unset the checks against the chain tip and spent key images are
+ * skipped and verified signatures are added to the proof cache, otherwise cached
+ * signatures are not verified again.
+ */
+static bool CheckMLSAG(const CTransaction &tx, TxValidationState &state, bool fContextual)
 {
     const Consensus::Params &consensus = Params().GetConsensus();
 
@@ -134,7 +141,7 @@ bool VerifyMLSAG(const CTransaction &tx, TxValidationState &state)
             }
 
             CAnonOutput ao;
-            if (!pblocktree->ReadRCTOutput(nIndex, ao)) {
+            if (!prctdb->ReadRCTOutput(nIndex, ao)) {
                 LogPrintf("%s: ReadRCTOutput failed: %ld\n", __func__, nIndex);
                 return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-anonin-unknown-i");
             }
@@ -142,7 +149,8 @@ bool VerifyMLSAG(const CTransaction &tx, TxValidationState &state)
             vCommitments.push_back(ao.commitment);
             vpInCommits[i+k*nCols] = vCommitments.back().data;
 
-            if (state.m_spend_height - ao.nBlockHeight + 1 < consensus.nMinRCTOutputDepth) {
+            if (fContextual
+                && state.m_spend_height - ao.nBlockHeight + 1 < consensus.nMinRCTOutputDepth) {
                 LogPrint(BCLog::RINGCT, "%s: Low input depth %s\n", __func__, state.m_spend_height - ao.nBlockHeight);
                 return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-anonin-depth");
             }
@@ -160,6 +168,10 @@ bool VerifyMLSAG(const CTransaction &tx, TxValidationState &state)
                 return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-anonin-dup-ki");
             }
 
+            if (!fContextual) {
+                continue;
+            }
+
             if (mempool.HaveKeyImage(ki, txhashKI)
                 && txhashKI != txhash) {
                 if (LogAcceptCategory(BCLog::RINGCT)) {
@@ -169,7 +181,7 @@ bool VerifyMLSAG(const CTransaction &tx, TxValidationState &state)
                 return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-anonin-dup-ki");
             }
 
-            if (pblocktree->ReadRCTKeyImage(ki, txhashKI)
+            if (prctdb->ReadRCTKeyImage(ki, txhashKI)
                 && txhashKI != txhash) {
                 if (LogAcceptCategory(BCLog::RINGCT)) {
                     LogPrintf("%s: Duplicate keyimage detected %s, used in %s.\n", __func__,
@@ -178,6 +190,24 @@ bool VerifyMLSAG(const CTransaction &tx, TxValidationState &state)
                 return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-anonin-dup-ki");
             }
         }
+
+        // Entries commit to everything the signature is verified against, ring
+        // members rewritten by a reorg produce a different entry.
+        uint256 cache_entry;
+        CSHA256 hasher = GetProofCacheHasher();
+        hasher.Write((const uint8_t*)"M", 1).Write(txhash.begin(), 32)
+            .Write(vM.data(), vM.size()).Write(vKeyImages.data(), vKeyImages.size()).Write(vDL.data(), vDL.size());
+        for (const auto *pc : vpInCommits) {
+            hasher.Write(pc, 33);
+        }
+        for (const auto *pc : vpOutCommits) {
+            hasher.Write(pc, 33);
+        }
+        hasher.Finalize(cache_entry.begin());
+        if (fContextual && ProofCacheContains(cache_entry)) {
+            continue;
+        }
+
         if (0 != (rv = secp256k1_prepare_mlsag(&vM[0], nullptr,
             vpOutCommits.size(), 0, nCols, nRows,
             &vpInCommits[0], &vpOutCommits[0], nullptr))) {
@@ -190,6 +220,9 @@ bool VerifyMLSAG(const CTransaction &tx, TxValidationState &state)
             LogPrintf("ERROR: %s: verify-mlsag-failed %d\n", __func__, rv);
             return state.Invalid(TxValidationResult::TX_CONSENSUS, "verify-mlsag-failed");
         }
+        if (!fContextual) {
+            ProofCacheInsert(cache_entry);
+        }
     }
 
     // Verify commitment sums match
@@ -215,6 +248,16 @@ bool VerifyMLSAG(const CTransaction &tx, TxValidationState &state)
     return true;
 };
 
+bool VerifyMLSAG(const CTransaction &tx, TxValidationState &state)
+{
+    return CheckMLSAG(tx, state, true);
+};
+
+bool PreVerifyMLSAG(const CTransaction &tx, TxValidationState &state)
+{
+    return CheckMLSAG(tx, state, false);
+};
+
 bool AddKeyImagesToMempool(const CTransaction &tx, CTxMemPool &pool)
 {
     for (const CTxIn &txin : tx.vin) {
@@ -277,10 +320,10 @@ bool AllAnonOutputsUnknown(const CTransaction &tx, TxValidationState &state)
         CTxOutRingCT *txout = (CTxOutRingCT*)tx.vpout[k].get();
 
         int64_t nTestExists;
-        if (pblocktree->ReadRCTOutputLink(txout->pk, nTestExists)) {
+        if (prctdb->ReadRCTOutputLink(txout->pk, nTestExists)) {
             COutPoint op(tx.GetHash(), k);
             CAnonOutput ao;
-            if (!pblocktree->ReadRCTOutput(nTestExists, ao) || ao.outpoint != op) {
+            if (!prctdb->ReadRCTOutput(nTestExists, ao) || ao.outpoint != op) {
                 LogPrintf("ERROR: %s: Duplicate anon-output %s, index %d - existing: %s,%d.\n",
                           __func__, HexStr(txout->pk.begin(), txout->pk.end()), nTestExists, ao.outpoint.hash.ToString(), ao.outpoint.n);
                 return state.Invalid(TxValidationResult::TX_CONSENSUS, "duplicate-anon-output");
@@ -312,29 +355,29 @@ bool RollBackRCTIndex(int64_t nLastValidRCTOutput, int64_t nExpectErase, std::se
     CAnonOutput ao;
     while (true) {
         nRemRCTOutput++;
-        if (!pblocktree->ReadRCTOutput(nRemRCTOutput, ao)) {
+        if (!prctdb->ReadRCTOutput(nRemRCTOutput, ao)) {
             break;
         }
-        pblocktree->EraseRCTOutput(nRemRCTOutput);
-        pblocktree->EraseRCTOutputLink(ao.pubkey);
+        prctdb->EraseRCTOutput(nRemRCTOutput);
+        prctdb->EraseRCTOutputLink(ao.pubkey);
     }
 
     LogPrintf("%s: Removed up to %d\n", __func__, nRemRCTOutput);
     if (nExpectErase > nRemRCTOutput) {
         nRemRCTOutput = nExpectErase;
         while (nRemRCTOutput > nLastValidRCTOutput) {
-            if (!pblocktree->ReadRCTOutput(nRemRCTOutput, ao)) {
+            if (!prctdb->ReadRCTOutput(nRemRCTOutput, ao)) {
                 break;
             }
-            pblocktree->EraseRCTOutput(nRemRCTOutput);
-            pblocktree->EraseRCTOutputLink(ao.pubkey);
+            prctdb->EraseRCTOutput(nRemRCTOutput);
+            prctdb->EraseRCTOutputLink(ao.pubkey);
             nRemRCTOutput--;
         }
         LogPrintf("%s: Removed down to %d\n", __func__, nRemRCTOutput);
     }
 
     for (const auto &ki : setKi) {
-        pblocktree->EraseRCTKeyImage(ki);
+        prctdb->EraseRCTKeyImage(ki);
     }
 
     return true;
@@ -382,9 +425,9 @@ bool RewindToCheckpoint(int nCheckPointHeight, int &nBlocks, std::string &sError
 
     int nRemoveOutput = nLastRCTOutput + 1;
     CAnonOutput ao;
-    while (pblocktree->ReadRCTOutput(nRemoveOutput, ao)) {
-        pblocktree->EraseRCTOutput(nRemoveOutput);
-        pblocktree->EraseRCTOutputLink(ao.pubkey);
+    while (prctdb->ReadRCTOutput(nRemoveOutput, ao)) {
+        prctdb->EraseRCTOutput(nRemoveOutput);
+        prctdb->EraseRCTOutputLink(ao.pubkey);
         nRemoveOutput++;
     }
 
@@ -27,6 +27,9 @@ const size_t DEFAULT_INPUTS_PER_SIG = 1;
 
 
 bool VerifyMLSAG(const CTransaction &tx, TxValidationState &state) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+//! Verify the MLSAG signatures of tx without cs_main, adding them to the proof cache for VerifyMLSAG.
+//! Checks against the chain tip and spent key images are left to VerifyMLSAG.
+bool PreVerifyMLSAG(const CTransaction &tx, TxValidationState &state);
 
 bool AddKeyImagesToMempool(const CTransaction &tx, CTxMemPool &pool);
 bool RemoveKeyImagesFromMempool(const uint256 &hash, const CTxIn &txin, CTxMemPool &pool);
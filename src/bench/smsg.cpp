@@ -0,0 +1,200 @@
+// Copyright (c) 2020 The Graviocoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include <smsg/smessage.h>
+#include <key.h>
+#include <random.h>
+#include <sync.h>
+#include <util/time.h>
+
+#include <vector>
+
+/** Run secure messaging on the benchmark's temporary datadir, without wallets or peers. */
+class SmsgBenchSetup
+{
+public:
+    explicit SmsgBenchSetup(size_t nKeys = 2)
+    {
+        std::vector<std::shared_ptr<CWallet>> vpwallets;
+        bool started = smsgModule.Start(nullptr, vpwallets, false);
+        assert(started);
+
+        vKeys.resize(nKeys);
+        for (auto &key : vKeys) {
+            smsg::SecMsgKey smsg_key;
+            smsg_key.key.MakeNewKey(true);
+            smsg_key.nFlags = smsg::SMK_RECEIVE_ON | smsg::SMK_RECEIVE_ANON;
+            CKeyID idk = smsg_key.key.GetPubKey().GetID();
+            smsgModule.keyStore.AddKey(idk, smsg_key);
+            key = smsg_key.key;
+        }
+    }
+    ~SmsgBenchSetup()
+    {
+        smsgModule.Disable();
+    }
+
+    CKeyID GetID(size_t n) const { return vKeys[n].GetPubKey().GetID(); }
+
+    std::vector<CKey> vKeys;
+};
+
+static std::string RandomText(size_t nBytes)
+{
+    // Printable text compresses similarly to real messages
+    std::string text(nBytes, ' ');
+    for (auto &c : text) {
+        c = 'a' + GetRand(26);
+    }
+    return text;
+}
+
+static void MakeMessage(SmsgBenchSetup &setup, smsg::SecureMessage &smsg, size_t nBytes, bool fSetHash = true)
+{
+    smsg.m_ttl = smsg::SMSG_SECONDS_IN_DAY;
+    int rv = smsgModule.Encrypt(smsg, setup.GetID(0), setup.GetID(1), RandomText(nBytes));
+    assert(rv == smsg::SMSG_NO_ERROR);
+    if (fSetHash) {
+        rv = smsgModule.SetHash(smsg.data(), smsg.pPayload, smsg.nPayload);
+        assert(rv == smsg::SMSG_NO_ERROR);
+    }
+}
+
+static void SmsgEncrypt(benchmark::State& state, size_t nBytes)
+{
+    SmsgBenchSetup setup;
+    std::string text = RandomText(nBytes);
+
+    while (state.KeepRunning()) {
+        smsg::SecureMessage smsg(false, smsg::SMSG_SECONDS_IN_DAY);
+        int rv = smsgModule.Encrypt(smsg, setup.GetID(0), setup.GetID(1), text);
+        assert(rv == smsg::SMSG_NO_ERROR);
+    }
+}
+
+static void SmsgDecrypt(benchmark::State& state, size_t nBytes)
+{
+    SmsgBenchSetup setup;
+    smsg::SecureMessage smsg;
+    MakeMessage(setup, smsg, nBytes, false);
+
+    smsg::MessageData msg;
+    while (state.KeepRunning()) {
+        int rv = smsgModule.Decrypt(false, setup.vKeys[1], setup.GetID(1), smsg, msg);
+        assert(rv == smsg::SMSG_NO_ERROR);
+    }
+}
+
+static void SmsgSetHash(benchmark::State& state, size_t nBytes, uint32_t target_compact)
+{
+    SmsgBenchSetup setup;
+    smsg::SecureMessage smsg;
+    MakeMessage(setup, smsg, nBytes, false);
+
+    uint32_t nonce = 0;
+    while (state.KeepRunning()) {
+        // Start each search from a fresh nonce
+        memcpy(smsg.nonce, &nonce, 4);
+        nonce += 0x10000;
+        int rv = smsgModule.SetHash(smsg.data(), smsg.pPayload, smsg.nPayload, target_compact);
+        assert(rv == smsg::SMSG_NO_ERROR);
+    }
+}
+
+static void SmsgValidate(benchmark::State& state)
+{
+    SmsgBenchSetup setup;
+    smsg::SecureMessage smsg;
+    MakeMessage(setup, smsg, 1024);
+
+    while (state.KeepRunning()) {
+        int rv = smsgModule.Validate(smsg.data(), smsg.pPayload, smsg.nPayload);
+        assert(rv == smsg::SMSG_NO_ERROR);
+    }
+}
+
+static void SmsgScanMessage(benchmark::State& state, size_t nKeys)
+{
+    // Scan a message addressed to none of the local keys, the usual case for relayed messages
+    SmsgBenchSetup setup(nKeys + 2);
+    smsg::SecureMessage smsg;
+    MakeMessage(setup, smsg, 256);
+    for (size_t i = 0; i < 2; ++i) {
+        smsgModule.keyStore.EraseKey(setup.GetID(i));
+    }
+
+    bool fOwnMessage;
+    while (state.KeepRunning()) {
+        smsgModule.ScanMessage(smsg.data(), smsg.pPayload, smsg.nPayload, false, fOwnMessage);
+        assert(!fOwnMessage);
+    }
+}
+
+static void SmsgHashBucket(benchmark::State& state, size_t nTokens)
+{
+    smsg::SecMsgBucket bucket;
+    int64_t now = GetTime();
+    uint8_t sample[8];
+    for (size_t i = 0; i < nTokens; ++i) {
+        GetRandBytes(sample, 8);
+        bucket.setTokens.insert(smsg::SecMsgToken(now, sample, 8, 0, smsg::SMSG_SECONDS_IN_DAY));
+    }
+
+    while (state.KeepRunning()) {
+        bucket.hashBucket(now - (now % smsg::SMSG_BUCKET_LEN));
+    }
+}
+
+static void SmsgStoreRetrieve(benchmark::State& state)
+{
+    SmsgBenchSetup setup;
+    smsg::SecureMessage smsg;
+    MakeMessage(setup, smsg, 1024);
+
+    int64_t bucket_time = smsg.timestamp - (smsg.timestamp % smsg::SMSG_BUCKET_LEN);
+    std::vector<uint8_t> vchData;
+    uint64_t n = 0;
+    while (state.KeepRunning()) {
+        // Vary the token sample so each message is stored
+        memcpy(smsg.pPayload, &n, 8);
+        n++;
+
+        LOCK(smsgModule.cs_smsg);
+        int rv = smsgModule.Store(smsg, false);
+        assert(rv == smsg::SMSG_NO_ERROR);
+        smsg::SecMsgToken token(smsg.timestamp, smsg.pPayload, smsg.nPayload, 0, smsg.m_ttl);
+        auto it = smsgModule.buckets[bucket_time].setTokens.find(token);
+        assert(it != smsgModule.buckets[bucket_time].setTokens.end());
+        rv = smsgModule.Retrieve(*it, vchData);
+        assert(rv == smsg::SMSG_NO_ERROR);
+    }
+}
+
+static void SmsgEncrypt256(benchmark::State& state) { SmsgEncrypt(state, 256); }
+static void SmsgEncrypt24000(benchmark::State& state) { SmsgEncrypt(state, 24000); }
+static void SmsgDecrypt256(benchmark::State& state) { SmsgDecrypt(state, 256); }
+static void SmsgDecrypt24000(benchmark::State& state) { SmsgDecrypt(state, 24000); }
+static void SmsgSetHashEasy256(benchmark::State& state) { SmsgSetHash(state, 256, 0x2000ffff); }
+static void SmsgSetHashEasy24000(benchmark::State& state) { SmsgSetHash(state, 24000, 0x2000ffff); }
+static void SmsgSetHashRegtest256(benchmark::State& state) { SmsgSetHash(state, 256, 0x1f0fffff); }
+static void SmsgScanMessage1(benchmark::State& state) { SmsgScanMessage(state, 1); }
+static void SmsgScanMessage100(benchmark::State& state) { SmsgScanMessage(state, 100); }
+static void SmsgHashBucket1000(benchmark::State& state) { SmsgHashBucket(state, 1000); }
+static void SmsgHashBucket100000(benchmark::State& state) { SmsgHashBucket(state, 100000); }
+
+BENCHMARK(SmsgEncrypt256, 200);
+BENCHMARK(SmsgEncrypt24000, 50);
+BENCHMARK(SmsgDecrypt256, 200);
+BENCHMARK(SmsgDecrypt24000, 50);
+BENCHMARK(SmsgSetHashEasy256, 50);
+BENCHMARK(SmsgSetHashEasy24000, 5);
+BENCHMARK(SmsgSetHashRegtest256, 5);
+BENCHMARK(SmsgValidate, 1000);
+BENCHMARK(SmsgScanMessage1, 200);
+BENCHMARK(SmsgScanMessage100, 10);
+BENCHMARK(SmsgHashBucket1000, 1000);
+BENCHMARK(SmsgHashBucket100000, 10);
+BENCHMARK(SmsgStoreRetrieve, 200);
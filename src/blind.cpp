@@ -13,7 +13,6 @@
 
 
 secp256k1_context *secp256k1_ctx_blind = nullptr;
-secp256k1_scratch_space *blind_scratch = nullptr;
 secp256k1_bulletproof_generators *blind_gens = nullptr;
 
 static int CountLeadingZeros(uint64_t nValueIn)
@@ -123,6 +122,20 @@ int GetRangeProofInfo(const std::vector<uint8_t> &vRangeproof, int &rexp, int &r
         &vRangeproof[0], vRangeproof.size()) == 1));
 };
 
+int VerifyBulletproof(const secp256k1_pedersen_commitment *commitment, const std::vector<uint8_t> &vRangeproof)
+{
+    // Verification writes to the scratch space, each call takes its own so
+    // proofs can be verified on several threads at once.
+    // The scratch space allocates its frames while verifying, creating it is cheap.
+    secp256k1_scratch_space *scratch = secp256k1_scratch_space_create(secp256k1_ctx_blind, 1024 * 1024);
+    assert(scratch);
+    int rv = secp256k1_bulletproof_rangeproof_verify(secp256k1_ctx_blind,
+        scratch, blind_gens, vRangeproof.data(), vRangeproof.size(),
+        nullptr, commitment, 1, 64, &secp256k1_generator_const_h, nullptr, 0);
+    secp256k1_scratch_space_destroy(scratch);
+    return rv;
+};
+
 void ECC_Start_Blinding()
 {
     assert(secp256k1_ctx_blind == nullptr);
@@ -140,8 +153,6 @@ void ECC_Start_Blinding()
 
     secp256k1_ctx_blind = ctx;
 
-    blind_scratch = secp256k1_scratch_space_create(secp256k1_ctx_blind, 1024 * 1024);
-    assert(blind_scratch);
     blind_gens = secp256k1_bulletproof_generators_create(secp256k1_ctx_blind, &secp256k1_generator_const_g, 128);
     assert(blind_gens);
 };
@@ -149,7 +160,6 @@ void ECC_Start_Blinding()
 void ECC_Stop_Blinding()
 {
     secp256k1_bulletproof_generators_destroy(secp256k1_ctx_blind, blind_gens);
-    secp256k1_scratch_space_destroy(blind_scratch);
 
     secp256k1_context *ctx = secp256k1_ctx_blind;
     secp256k1_ctx_blind = nullptr;
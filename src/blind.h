@@ -13,13 +13,15 @@
 #include <amount.h>
 
 extern secp256k1_context *secp256k1_ctx_blind;
-extern secp256k1_scratch_space *blind_scratch;
 extern secp256k1_bulletproof_generators *blind_gens;
 
 int SelectRangeProofParameters(uint64_t nValueIn, uint64_t &minValue, int &exponent, int &nBits);
 
 int GetRangeProofInfo(const std::vector<uint8_t> &vRangeproof, int &rexp, int &rmantissa, CAmount &min_value, CAmount &max_value);
 
+/** Verify a bulletproof rangeproof for commitment, safe to call from several threads at once */
+int VerifyBulletproof(const secp256k1_pedersen_commitment *commitment, const std::vector<uint8_t> &vRangeproof);
+
 void ECC_Start_Blinding();
 void ECC_Stop_Blinding();
 
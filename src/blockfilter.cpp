@@ -266,6 +266,12 @@ static GCSFilter::ElementSet BasicFilterElements(const CBlock& block,
             if (script.empty() || script[0] == OP_RETURN) continue;
             elements.emplace(script.begin(), script.end());
         }
+        // Standard and CT outputs carry a scriptPubKey, data and anon outputs have none
+        for (const auto& txout : tx->vpout) {
+            const CScript *pscript = txout->GetPScriptPubKey();
+            if (!pscript || pscript->empty() || (*pscript)[0] == OP_RETURN) continue;
+            elements.emplace(pscript->begin(), pscript->end());
+        }
     }
 
     for (const CTxUndo& tx_undo : block_undo.vtxundo) {
@@ -22,6 +22,7 @@ enum eBlockFlags
     BLOCK_DELAYED                   = (1 << 4),
     BLOCK_ACCEPTED                  = (1 << 5),
     BLOCK_STAKE_KERNEL_SPENT        = (1 << 6),
+    BLOCK_SNAPSHOT                  = (1 << 7), // connected by loading a utxo snapshot, block data is not stored
 };
 
 /**
@@ -1137,6 +1137,17 @@ void CRegTestParams::UpdateActivationParametersFromArgs(const ArgsManager& args)
         consensus.SegwitHeight = static_cast<int>(height);
     }
 
+    for (const std::string& strSnapshot : args.GetArgs("-assumeutxo")) {
+        std::vector<std::string> vSnapshotParams;
+        boost::split(vSnapshotParams, strSnapshot, boost::is_any_of(":"));
+        int32_t nHeight;
+        if (vSnapshotParams.size() != 2 || !ParseInt32(vSnapshotParams[0], &nHeight) || nHeight < 1 || !IsHex(vSnapshotParams[1]) || vSnapshotParams[1].size() != 64) {
+            throw std::runtime_error("Snapshot parameters malformed, expecting height:hash");
+        }
+        m_assumeutxo_data[nHeight] = uint256S(vSnapshotParams[1]);
+        LogPrintf("Accepting utxo snapshot %s at height %d\n", vSnapshotParams[1], nHeight);
+    }
+
     if (!args.IsArgSet("-vbparams")) return;
 
     for (const std::string& strDeployment : args.GetArgs("-vbparams")) {
@@ -29,6 +29,12 @@ struct CCheckpointData {
     MapCheckpoints mapCheckpoints;
 };
 
+/**
+ * Snapshot hashes (as reported by dumptxoutset) by base block height.
+ * loadtxoutset only accepts snapshots listed here.
+ */
+typedef std::map<int, uint256> MapAssumeutxo;
+
 /**
  * Holds various statistics on transactions within a chain. Used to estimate
  * verification progress during chain sync.
@@ -134,6 +140,7 @@ public:
     const std::string& Bech32HRP() const { return bech32_hrp; }
     const std::vector<SeedSpec6>& FixedSeeds() const { return vFixedSeeds; }
     const CCheckpointData& Checkpoints() const { return checkpointData; }
+    const MapAssumeutxo& Assumeutxo() const { return m_assumeutxo_data; }
     const ChainTxData& TxData() const { return chainTxData; }
 
     bool IsBech32Prefix(const std::vector<unsigned char> &vchPrefixIn) const;
@@ -195,6 +202,7 @@ protected:
     bool fRequireStandard;
     bool m_is_test_chain;
     CCheckpointData checkpointData;
+    MapAssumeutxo m_assumeutxo_data;
     ChainTxData chainTxData;
 };
 
@@ -13,7 +13,7 @@ bool CCoinsView::GetCoin(const COutPoint &outpoint, Coin &coin) const { return f
 
 uint256 CCoinsView::GetBestBlock() const { return uint256(); }
 std::vector<uint256> CCoinsView::GetHeadBlocks() const { return std::vector<uint256>(); }
-bool CCoinsView::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) { return false; }
+bool CCoinsView::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, const CUTXOStats &statsDelta) { return false; }
 CCoinsViewCursor *CCoinsView::Cursor() const { return nullptr; }
 
 bool CCoinsView::HaveCoin(const COutPoint &outpoint) const
@@ -28,16 +28,196 @@ bool CCoinsViewBacked::HaveCoin(const COutPoint &outpoint) const { return base->
 uint256 CCoinsViewBacked::GetBestBlock() const { return base->GetBestBlock(); }
 std::vector<uint256> CCoinsViewBacked::GetHeadBlocks() const { return base->GetHeadBlocks(); }
 void CCoinsViewBacked::SetBackend(CCoinsView &viewIn) { base = &viewIn; }
-bool CCoinsViewBacked::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) { return base->BatchWrite(mapCoins, hashBlock); }
+bool CCoinsViewBacked::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, const CUTXOStats &statsDelta) { return base->BatchWrite(mapCoins, hashBlock, statsDelta); }
 CCoinsViewCursor *CCoinsViewBacked::Cursor() const { return base->Cursor(); }
 size_t CCoinsViewBacked::EstimateSize() const { return base->EstimateSize(); }
 
+UTXOStatsScriptType CUTXOStats::GetScriptType(const CScript &script)
+{
+    if (script.IsPayToPublicKeyHash()) {
+        return UTXO_STATS_PAYTOPUBKEYHASH;
+    }
+    if (script.IsPayToScriptHash()) {
+        return UTXO_STATS_PAYTOSCRIPTHASH;
+    }
+    if (script.IsPayToPublicKeyHash256_CS()) {
+        return UTXO_STATS_COLDSTAKE_PAYTOPUBKEYHASH;
+    }
+    if (script.IsPayToScriptHash256_CS() || script.IsPayToScriptHash_CS()) {
+        return UTXO_STATS_COLDSTAKE_PAYTOSCRIPTHASH;
+    }
+    return UTXO_STATS_OTHER;
+}
+
+void CUTXOStats::ApplyCoin(const Coin &coin, bool spend)
+{
+    int64_t sign = spend ? -1 : 1;
+    CUTXOScriptTypeStats &st = m_script_types[GetScriptType(coin.out.scriptPubKey)];
+    if (coin.nType == OUTPUT_STANDARD) {
+        st.nPlain += sign;
+        st.nPlainValue += sign * coin.out.nValue;
+    } else
+    if (coin.nType == OUTPUT_CT) {
+        st.nBlinded += sign;
+    }
+    // Matches the bogosize of GetUTXOStats
+    nBogoSize += sign * (int64_t)(32 /* txid */ + 4 /* vout index */ + 4 /* height + coinbase */ + 8 /* amount */ +
+                                  2 /* scriptPubKey len */ + coin.out.scriptPubKey.size() /* scriptPubKey */ +
+                                  (fGraviocoinMode ? 1 /* nType */ + 33 /* commitment */ : 0));
+}
+
+CUTXOStats& CUTXOStats::operator+=(const CUTXOStats &b)
+{
+    for (size_t i = 0; i < UTXO_STATS_SCRIPT_TYPES; ++i) {
+        m_script_types[i].nPlain += b.m_script_types[i].nPlain;
+        m_script_types[i].nBlinded += b.m_script_types[i].nBlinded;
+        m_script_types[i].nPlainValue += b.m_script_types[i].nPlainValue;
+    }
+    nBogoSize += b.nBogoSize;
+    return *this;
+}
+
+bool CUTXOStats::IsNull() const
+{
+    for (const auto &st : m_script_types) {
+        if (st.nPlain != 0 || st.nBlinded != 0 || st.nPlainValue != 0) {
+            return false;
+        }
+    }
+    return nBogoSize == 0;
+}
+
 SaltedOutpointHasher::SaltedOutpointHasher() : k0(GetRand(std::numeric_limits<uint64_t>::max())), k1(GetRand(std::numeric_limits<uint64_t>::max())) {}
 
+constexpr uint8_t CCoinsMap::CTRL_EMPTY;
+constexpr uint8_t CCoinsMap::CTRL_DELETED;
+constexpr uint8_t CCoinsMap::CTRL_FULL;
+constexpr size_t CCoinsMap::MIN_CAPACITY;
+constexpr size_t CCoinsMap::NPOS;
+
+size_t CCoinsMap::FindPos(const COutPoint &key) const
+{
+    if (m_size == 0) {
+        return NPOS;
+    }
+    size_t hash = m_hasher(key);
+    uint8_t tag = Tag(hash);
+    size_t mask = m_ctrl.size() - 1;
+    for (size_t pos = hash & mask;; pos = (pos + 1) & mask) {
+        uint8_t ctrl = m_ctrl[pos];
+        if (ctrl == CTRL_EMPTY) {
+            return NPOS;
+        }
+        if (ctrl == tag && m_slots[pos]->first == key) {
+            return pos;
+        }
+    }
+}
+
+size_t CCoinsMap::FindInsertPos(const COutPoint &key, uint8_t &tag, bool &found)
+{
+    // Keep at least 1/8 of the slots empty so probes end
+    size_t capacity = m_ctrl.size();
+    if ((m_size + m_deleted + 1) * 8 > capacity * 7) {
+        // Grow if more than half the load is live entries, else only drop the tombstones
+        Rehash((m_size + 1) * 16 > capacity * 7 ? std::max(MIN_CAPACITY, capacity * 2) : capacity);
+    }
+
+    size_t hash = m_hasher(key);
+    tag = Tag(hash);
+    size_t mask = m_ctrl.size() - 1;
+    size_t insert_pos = NPOS;
+    for (size_t pos = hash & mask;; pos = (pos + 1) & mask) {
+        uint8_t ctrl = m_ctrl[pos];
+        if (ctrl == CTRL_EMPTY) {
+            found = false;
+            return insert_pos == NPOS ? pos : insert_pos;
+        }
+        if (ctrl == CTRL_DELETED) {
+            if (insert_pos == NPOS) {
+                insert_pos = pos;
+            }
+        } else
+        if (ctrl == tag && m_slots[pos]->first == key) {
+            found = true;
+            return pos;
+        }
+    }
+}
+
+void CCoinsMap::Rehash(size_t capacity)
+{
+    std::vector<uint8_t> ctrl(capacity, CTRL_EMPTY);
+    std::vector<value_type*> slots(capacity, nullptr);
+    size_t mask = capacity - 1;
+    for (size_t i = 0; i < m_ctrl.size(); ++i) {
+        if (!(m_ctrl[i] & CTRL_FULL)) {
+            continue;
+        }
+        size_t pos = m_hasher(m_slots[i]->first) & mask;
+        while (ctrl[pos] != CTRL_EMPTY) {
+            pos = (pos + 1) & mask;
+        }
+        ctrl[pos] = m_ctrl[i];
+        slots[pos] = m_slots[i];
+    }
+    m_ctrl.swap(ctrl);
+    m_slots.swap(slots);
+    m_deleted = 0;
+}
+
+void CCoinsMap::ErasePos(size_t pos)
+{
+    value_type *entry = m_slots[pos];
+    entry->~value_type();
+    m_pool.Free(entry);
+    m_slots[pos] = nullptr;
+    m_size--;
+
+    if (m_size == 0) {
+        std::fill(m_ctrl.begin(), m_ctrl.end(), CTRL_EMPTY);
+        m_deleted = 0;
+        return;
+    }
+
+    // A slot followed by an empty slot ends no probe sequence another key needs,
+    // it and the tombstones before it can be emptied.
+    size_t mask = m_ctrl.size() - 1;
+    if (m_ctrl[(pos + 1) & mask] != CTRL_EMPTY) {
+        m_ctrl[pos] = CTRL_DELETED;
+        m_deleted++;
+        return;
+    }
+    m_ctrl[pos] = CTRL_EMPTY;
+    for (pos = (pos - 1) & mask; m_ctrl[pos] == CTRL_DELETED; pos = (pos - 1) & mask) {
+        m_ctrl[pos] = CTRL_EMPTY;
+        m_deleted--;
+    }
+}
+
+void CCoinsMap::clear()
+{
+    for (size_t i = 0; i < m_ctrl.size(); ++i) {
+        if (m_ctrl[i] & CTRL_FULL) {
+            m_slots[i]->~value_type();
+        }
+    }
+    std::vector<uint8_t>().swap(m_ctrl);
+    std::vector<value_type*>().swap(m_slots);
+    m_size = 0;
+    m_deleted = 0;
+    m_pool.Clear();
+}
+
+size_t CCoinsMap::DynamicMemoryUsage() const
+{
+    return memusage::DynamicUsage(m_ctrl) + memusage::DynamicUsage(m_slots) + m_pool.DynamicMemoryUsage();
+}
+
 CCoinsViewCache::CCoinsViewCache(CCoinsView *baseIn) : CCoinsViewBacked(baseIn), cachedCoinsUsage(0) { }
 
 size_t CCoinsViewCache::DynamicMemoryUsage() const {
-    return memusage::DynamicUsage(cacheCoins) + cachedCoinsUsage;
+    return cacheCoins.DynamicMemoryUsage() + cachedCoinsUsage;
 }
 
 CCoinsMap::iterator CCoinsViewCache::FetchCoin(const COutPoint &outpoint) const {
@@ -47,7 +227,7 @@ CCoinsMap::iterator CCoinsViewCache::FetchCoin(const COutPoint &outpoint) const
     Coin tmp;
     if (!base->GetCoin(outpoint, tmp))
         return cacheCoins.end();
-    CCoinsMap::iterator ret = cacheCoins.emplace(std::piecewise_construct, std::forward_as_tuple(outpoint), std::forward_as_tuple(std::move(tmp))).first;
+    CCoinsMap::iterator ret = cacheCoins.try_emplace(outpoint, std::move(tmp)).first;
     if (ret->second.coin.IsSpent()) {
         // The parent only has an empty entry for this outpoint; we can consider our
         // version as fresh.
@@ -71,7 +251,7 @@ void CCoinsViewCache::AddCoin(const COutPoint &outpoint, Coin&& coin, bool possi
     if (coin.out.scriptPubKey.IsUnspendable()) return;
     CCoinsMap::iterator it;
     bool inserted;
-    std::tie(it, inserted) = cacheCoins.emplace(std::piecewise_construct, std::forward_as_tuple(outpoint), std::tuple<>());
+    std::tie(it, inserted) = cacheCoins.try_emplace(outpoint);
     bool fresh = false;
     if (!inserted) {
         cachedCoinsUsage -= it->second.coin.DynamicMemoryUsage();
@@ -82,6 +262,12 @@ void CCoinsViewCache::AddCoin(const COutPoint &outpoint, Coin&& coin, bool possi
         }
         fresh = !(it->second.flags & CCoinsCacheEntry::DIRTY);
     }
+    // An overwritten coin not loaded into the cache is not removed from the totals,
+    // only possible for the duplicate coinbases BIP30 allowed.
+    if (!it->second.coin.IsSpent()) {
+        cacheStatsDelta.ApplyCoin(it->second.coin, true);
+    }
+    cacheStatsDelta.ApplyCoin(coin, false);
     it->second.coin = std::move(coin);
     it->second.flags |= CCoinsCacheEntry::DIRTY | (fresh ? CCoinsCacheEntry::FRESH : 0);
     cachedCoinsUsage += it->second.coin.DynamicMemoryUsage();
@@ -106,7 +292,7 @@ void AddCoins(CCoinsViewCache& cache, const CTransaction &tx, int nHeight, bool
                 CTxOut txout(nV, *out->GetPScriptPubKey());
                 coin = Coin(txout, nHeight, fCoinbase);
                 coin.nType = OUTPUT_CT;
-                coin.commitment = ((CTxOutCT*)out)->commitment;
+                coin.SetCommitment(((CTxOutCT*)out)->commitment);
             } else {
                 continue; // Data or anon
             }
@@ -128,6 +314,9 @@ bool CCoinsViewCache::SpendCoin(const COutPoint &outpoint, Coin* moveout) {
     CCoinsMap::iterator it = FetchCoin(outpoint);
     if (it == cacheCoins.end()) return false;
     cachedCoinsUsage -= it->second.coin.DynamicMemoryUsage();
+    if (!it->second.coin.IsSpent()) {
+        cacheStatsDelta.ApplyCoin(it->second.coin, true);
+    }
     if (moveout) {
         *moveout = std::move(it->second.coin);
     }
@@ -172,7 +361,7 @@ void CCoinsViewCache::SetBestBlock(const uint256 &hashBlockIn, int height) {
     nBlockHeight = height;
 }
 
-bool CCoinsViewCache::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlockIn) {
+bool CCoinsViewCache::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlockIn, const CUTXOStats &statsDelta) {
     for (CCoinsMap::iterator it = mapCoins.begin(); it != mapCoins.end(); it = mapCoins.erase(it)) {
         // Ignore non-dirty entries (optimization).
         if (!(it->second.flags & CCoinsCacheEntry::DIRTY)) {
@@ -227,13 +416,15 @@ bool CCoinsViewCache::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlockIn
         }
     }
     hashBlock = hashBlockIn;
+    cacheStatsDelta += statsDelta;
     return true;
 }
 
 bool CCoinsViewCache::Flush() {
-    bool fOk = base->BatchWrite(cacheCoins, hashBlock);
+    bool fOk = base->BatchWrite(cacheCoins, hashBlock, cacheStatsDelta);
     cacheCoins.clear();
     cachedCoinsUsage = 0;
+    cacheStatsDelta.SetNull();
     return fOk;
 }
 
@@ -12,13 +12,19 @@
 #include <crypto/siphash.h>
 #include <memusage.h>
 #include <serialize.h>
+#include <support/allocators/pool.h>
 #include <uint256.h>
+#include <util/memory.h>
 
 #include <assert.h>
 #include <stdint.h>
 
 #include <functional>
-#include <unordered_map>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 #include <insight/addressindex.h>
 #include <insight/spentindex.h>
 #include <rctindex.h>
@@ -31,6 +37,10 @@ extern bool fGraviocoinMode;
  * Serialized format:
  * - VARINT((coinbase ? 1 : 0) | (height << 1))
  * - the non-spent CTxOut (via CTxOutCompressor)
+ * - in graviocoin mode the output type, followed by the 33 byte commitment for OUTPUT_CT
+ *
+ * The commitment is only allocated for OUTPUT_CT coins, scripts up to 28 bytes
+ * are held inline by CScript, a standard P2PKH or P2SH coin needs no heap memory.
  */
 class Coin
 {
@@ -38,6 +48,11 @@ public:
     //! unspent transaction output
     CTxOut out;
 
+private:
+    //! value commitment of an OUTPUT_CT coin
+    std::unique_ptr<secp256k1_pedersen_commitment> m_commitment;
+
+public:
     //! whether containing transaction was a coinbase
     uint32_t fCoinBase : 1;
 
@@ -45,12 +60,52 @@ public:
     uint32_t nHeight : 31;
 
     uint8_t nType = OUTPUT_STANDARD;
-    secp256k1_pedersen_commitment commitment;
 
     //! construct a Coin from a CTxOut and height/coinbase information.
     Coin(CTxOut&& outIn, int nHeightIn, bool fCoinBaseIn) : out(std::move(outIn)), fCoinBase(fCoinBaseIn), nHeight(nHeightIn) {}
     Coin(const CTxOut& outIn, int nHeightIn, bool fCoinBaseIn) : out(outIn), fCoinBase(fCoinBaseIn),nHeight(nHeightIn) {}
 
+    Coin(const Coin& other) : out(other.out), fCoinBase(other.fCoinBase), nHeight(other.nHeight), nType(other.nType)
+    {
+        if (other.m_commitment) {
+            m_commitment = MakeUnique<secp256k1_pedersen_commitment>(*other.m_commitment);
+        }
+    }
+    Coin(Coin&& other) = default;
+
+    Coin& operator=(const Coin& other)
+    {
+        if (this != &other) {
+            out = other.out;
+            fCoinBase = other.fCoinBase;
+            nHeight = other.nHeight;
+            nType = other.nType;
+            if (other.m_commitment) {
+                SetCommitment(*other.m_commitment);
+            } else {
+                m_commitment.reset();
+            }
+        }
+        return *this;
+    }
+    Coin& operator=(Coin&& other) = default;
+
+    //! The value commitment, all zero if none was set
+    const secp256k1_pedersen_commitment& GetCommitment() const
+    {
+        static const secp256k1_pedersen_commitment null_commitment = {};
+        return m_commitment ? *m_commitment : null_commitment;
+    }
+
+    void SetCommitment(const secp256k1_pedersen_commitment& commitment)
+    {
+        if (m_commitment) {
+            *m_commitment = commitment;
+        } else {
+            m_commitment = MakeUnique<secp256k1_pedersen_commitment>(commitment);
+        }
+    }
+
     bool Matches(CTxOutBase *txo) const
     {
         if (!txo->IsType(nType)) {
@@ -64,7 +119,7 @@ public:
             return false;
         }
         if (nType == OUTPUT_CT
-            && memcmp(commitment.data, ((CTxOutCT*)txo)->commitment.data, 33) != 0) {
+            && memcmp(GetCommitment().data, ((CTxOutCT*)txo)->commitment.data, 33) != 0) {
             return false;
         }
         return true;
@@ -74,6 +129,8 @@ public:
         out.SetNull();
         fCoinBase = false;
         nHeight = 0;
+        nType = OUTPUT_STANDARD;
+        m_commitment.reset();
     }
 
     //! empty constructor
@@ -93,7 +150,7 @@ public:
         if (!fGraviocoinMode) return;
         ::Serialize(s, nType);
         if (nType == OUTPUT_CT)
-            s.write((char*)&commitment.data[0], 33);
+            s.write((char*)&GetCommitment().data[0], 33);
     }
 
     template<typename Stream>
@@ -105,8 +162,13 @@ public:
         ::Unserialize(s, CTxOutCompressor(out));
         if (!fGraviocoinMode) return;
         ::Unserialize(s, nType);
-        if (nType == OUTPUT_CT)
+        if (nType == OUTPUT_CT) {
+            secp256k1_pedersen_commitment commitment = {};
             s.read((char*)&commitment.data[0], 33);
+            SetCommitment(commitment);
+        } else {
+            m_commitment.reset();
+        }
     }
 
     bool IsSpent() const {
@@ -114,7 +176,7 @@ public:
     }
 
     size_t DynamicMemoryUsage() const {
-        return memusage::DynamicUsage(out.scriptPubKey);
+        return memusage::DynamicUsage(out.scriptPubKey) + memusage::DynamicUsage(m_commitment);
     }
 };
 
@@ -164,7 +226,218 @@ struct CCoinsCacheEntry
     explicit CCoinsCacheEntry(Coin&& coin_) : coin(std::move(coin_)), flags(0) {}
 };
 
-typedef std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> CCoinsMap;
+/**
+ * Open addressing hash map of cache entries.
+ *
+ * Slots hold a pointer to the entry and a control byte with 7 bits of the hash,
+ * entries are allocated from a NodePool. Entries don't move when the table
+ * grows, references to them stay valid until they are erased.
+ * Iterators are invalidated by insertions, erase leaves a tombstone so the
+ * other iterators stay valid while the map is drained.
+ */
+class CCoinsMap
+{
+public:
+    typedef COutPoint key_type;
+    typedef CCoinsCacheEntry mapped_type;
+    typedef std::pair<const COutPoint, CCoinsCacheEntry> value_type;
+
+private:
+    static constexpr uint8_t CTRL_EMPTY = 0;
+    static constexpr uint8_t CTRL_DELETED = 1;
+    static constexpr uint8_t CTRL_FULL = 0x80;
+    static constexpr size_t MIN_CAPACITY = 16;
+    static constexpr size_t NPOS = (size_t)-1;
+
+    std::vector<uint8_t> m_ctrl;
+    std::vector<value_type*> m_slots;
+    size_t m_size = 0;
+    size_t m_deleted = 0;
+    SaltedOutpointHasher m_hasher;
+    NodePool<value_type> m_pool;
+
+    static uint8_t Tag(size_t hash) { return CTRL_FULL | (uint8_t)(hash >> (sizeof(size_t) * 8 - 7)); }
+    size_t FindPos(const COutPoint& key) const;
+    //! Return the slot holding key, or the slot to insert key at and whether key was found
+    size_t FindInsertPos(const COutPoint& key, uint8_t& tag, bool& found);
+    void Rehash(size_t capacity);
+    void ErasePos(size_t pos);
+
+    template <bool CONST>
+    class Iterator
+    {
+        friend class CCoinsMap;
+        template <bool> friend class Iterator;
+        typedef typename std::conditional<CONST, const CCoinsMap, CCoinsMap>::type Map;
+
+        Map* m_map = nullptr;
+        size_t m_pos = 0;
+
+        Iterator(Map* map, size_t pos) : m_map(map), m_pos(pos) {}
+        Iterator& SkipEmpty()
+        {
+            while (m_pos < m_map->m_ctrl.size() && !(m_map->m_ctrl[m_pos] & CTRL_FULL)) {
+                ++m_pos;
+            }
+            return *this;
+        }
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef CCoinsMap::value_type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef typename std::conditional<CONST, const value_type*, value_type*>::type pointer;
+        typedef typename std::conditional<CONST, const value_type&, value_type&>::type reference;
+
+        Iterator() {}
+        template <bool C = CONST, typename = typename std::enable_if<C>::type>
+        Iterator(const Iterator<false>& it) : m_map(it.m_map), m_pos(it.m_pos) {}
+
+        reference operator*() const { return *m_map->m_slots[m_pos]; }
+        pointer operator->() const { return m_map->m_slots[m_pos]; }
+        Iterator& operator++() { ++m_pos; return SkipEmpty(); }
+        Iterator operator++(int) { Iterator ret = *this; ++*this; return ret; }
+        bool operator==(const Iterator& b) const { return m_pos == b.m_pos; }
+        bool operator!=(const Iterator& b) const { return m_pos != b.m_pos; }
+    };
+
+public:
+    typedef Iterator<false> iterator;
+    typedef Iterator<true> const_iterator;
+
+    CCoinsMap() {}
+    CCoinsMap(const CCoinsMap&) = delete;
+    CCoinsMap& operator=(const CCoinsMap&) = delete;
+    ~CCoinsMap() { clear(); }
+
+    iterator begin() { return iterator(this, 0).SkipEmpty(); }
+    iterator end() { return iterator(this, m_ctrl.size()); }
+    const_iterator begin() const { return const_iterator(this, 0).SkipEmpty(); }
+    const_iterator end() const { return const_iterator(this, m_ctrl.size()); }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    iterator find(const COutPoint& key)
+    {
+        size_t pos = FindPos(key);
+        return pos == NPOS ? end() : iterator(this, pos);
+    }
+    const_iterator find(const COutPoint& key) const
+    {
+        size_t pos = FindPos(key);
+        return pos == NPOS ? end() : const_iterator(this, pos);
+    }
+
+    //! Insert an entry constructed from args if key is not present
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const COutPoint& key, Args&&... args)
+    {
+        uint8_t tag;
+        bool found;
+        size_t pos = FindInsertPos(key, tag, found);
+        if (found) {
+            return std::make_pair(iterator(this, pos), false);
+        }
+        void* node = m_pool.Allocate();
+        try {
+            m_slots[pos] = new (node) value_type(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+        } catch (...) {
+            m_pool.Free(node);
+            throw;
+        }
+        if (m_ctrl[pos] == CTRL_DELETED) {
+            m_deleted--;
+        }
+        m_ctrl[pos] = tag;
+        m_size++;
+        return std::make_pair(iterator(this, pos), true);
+    }
+
+    CCoinsCacheEntry& operator[](const COutPoint& key) { return try_emplace(key).first->second; }
+
+    //! Erase the entry at it, returns the iterator following it
+    iterator erase(const_iterator it)
+    {
+        ErasePos(it.m_pos);
+        return iterator(this, it.m_pos + 1).SkipEmpty();
+    }
+    size_t erase(const COutPoint& key)
+    {
+        size_t pos = FindPos(key);
+        if (pos == NPOS) {
+            return 0;
+        }
+        ErasePos(pos);
+        return 1;
+    }
+
+    //! Erase all entries and release all memory
+    void clear();
+
+    //! Memory held by the table and the entry pool, excluding the entries' own dynamic memory
+    size_t DynamicMemoryUsage() const;
+};
+
+/** Script types the unspent output totals are kept for */
+enum UTXOStatsScriptType
+{
+    UTXO_STATS_PAYTOPUBKEYHASH              = 0,
+    UTXO_STATS_PAYTOSCRIPTHASH              = 1,
+    UTXO_STATS_COLDSTAKE_PAYTOPUBKEYHASH    = 2,
+    UTXO_STATS_COLDSTAKE_PAYTOSCRIPTHASH    = 3,
+    UTXO_STATS_OTHER                        = 4,
+    UTXO_STATS_SCRIPT_TYPES,
+};
+
+struct CUTXOScriptTypeStats
+{
+    int64_t nPlain = 0;
+    int64_t nBlinded = 0;
+    CAmount nPlainValue = 0;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(nPlain);
+        READWRITE(nBlinded);
+        READWRITE(nPlainValue);
+    }
+};
+
+/**
+ * Running totals of the unspent outputs per script and output type.
+ * Caches accumulate the change made by their AddCoin and SpendCoin calls and
+ * pass it down with their coins when flushed, the coins database applies it
+ * to the totals stored with the best block.
+ */
+class CUTXOStats
+{
+public:
+    CUTXOScriptTypeStats m_script_types[UTXO_STATS_SCRIPT_TYPES];
+    int64_t nBogoSize = 0;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        for (auto &st : m_script_types) {
+            READWRITE(st);
+        }
+        READWRITE(nBogoSize);
+    }
+
+    static UTXOStatsScriptType GetScriptType(const CScript &script);
+
+    //! Add or remove (spend) a coin from the totals
+    void ApplyCoin(const Coin &coin, bool spend);
+
+    CUTXOStats& operator+=(const CUTXOStats &b);
+
+    void SetNull() { *this = CUTXOStats(); }
+    bool IsNull() const;
+};
 
 /** Cursor for iterating over CoinsView state */
 class CCoinsViewCursor
@@ -210,7 +483,8 @@ public:
 
     //! Do a bulk modification (multiple Coin changes + BestBlock change).
     //! The passed mapCoins can be modified.
-    virtual bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock);
+    //! statsDelta is the change to the unspent output totals made by the modification.
+    virtual bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, const CUTXOStats &statsDelta);
 
     //! Get a cursor to iterate over the whole state
     virtual CCoinsViewCursor *Cursor() const;
@@ -236,7 +510,7 @@ public:
     uint256 GetBestBlock() const override;
     std::vector<uint256> GetHeadBlocks() const override;
     void SetBackend(CCoinsView &viewIn);
-    bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) override;
+    bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, const CUTXOStats &statsDelta) override;
     CCoinsViewCursor *Cursor() const override;
     size_t EstimateSize() const override;
 };
@@ -259,9 +533,8 @@ public:
     /* Cached dynamic memory usage for the inner Coin objects. */
     mutable size_t cachedCoinsUsage;
 
-    mutable std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
-    mutable std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > addressUnspentIndex;
-    mutable std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> > spentIndex;
+    /* Change to the unspent output totals not yet flushed to the base view. */
+    CUTXOStats cacheStatsDelta;
 
     mutable bool fForceDisconnect = false; // disconnect even if rct mismatch
     mutable int64_t nLastRCTOutput = 0;
@@ -292,7 +565,7 @@ public:
     bool HaveCoin(const COutPoint &outpoint) const override;
     uint256 GetBestBlock() const override;
     void SetBestBlock(const uint256 &hashBlock, int height);
-    bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) override;
+    bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, const CUTXOStats &statsDelta) override;
     CCoinsViewCursor* Cursor() const override {
         throw std::logic_error("CCoinsViewCache cursor iteration not supported.");
     }
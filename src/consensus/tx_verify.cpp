@@ -252,7 +252,7 @@ bool Consensus::CheckTxInputs(const CTransaction& tx, TxValidationState& state,
                 nStandard++;
             } else
             if (coin.nType == OUTPUT_CT) {
-                vpCommitsIn.push_back(&coin.commitment);
+                vpCommitsIn.push_back(&coin.GetCommitment());
                 nCt++;
             } else {
                 return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-txns-input-type");
@@ -440,9 +440,7 @@ static bool CheckBlindOutput(TxValidationState &state, const CTxOutCT *p)
     int rv = 0;
 
     if (state.fBulletproofsActive) {
-        rv = secp256k1_bulletproof_rangeproof_verify(secp256k1_ctx_blind,
-            blind_scratch, blind_gens, p->vRangeproof.data(), p->vRangeproof.size(),
-            nullptr, &p->commitment, 1, 64, &secp256k1_generator_const_h, nullptr, 0);
+        rv = VerifyBulletproof(&p->commitment, p->vRangeproof);
     } else {
         rv = secp256k1_rangeproof_verify(secp256k1_ctx_blind, &min_value, &max_value,
             &p->commitment, p->vRangeproof.data(), p->vRangeproof.size(),
@@ -484,9 +482,7 @@ bool CheckAnonOutput(TxValidationState &state, const CTxOutRingCT *p)
     int rv = 0;
 
     if (state.fBulletproofsActive) {
-        rv = secp256k1_bulletproof_rangeproof_verify(secp256k1_ctx_blind,
-            blind_scratch, blind_gens, p->vRangeproof.data(), p->vRangeproof.size(),
-            nullptr, &p->commitment, 1, 64, &secp256k1_generator_const_h, nullptr, 0);
+        rv = VerifyBulletproof(&p->commitment, p->vRangeproof);
     } else {
         rv = secp256k1_rangeproof_verify(secp256k1_ctx_blind, &min_value, &max_value,
             &p->commitment, p->vRangeproof.data(), p->vRangeproof.size(),
@@ -72,6 +72,8 @@ static std::unique_ptr<HTTPRPCTimerInterface> httpRPCTimerInterface;
 /* RPC Auth Whitelist */
 static std::map<std::string, std::set<std::string>> g_rpc_whitelist;
 static bool g_rpc_whitelist_default = false;
+/* Number of HTTP worker threads a batch request is executed on */
+static int g_rpc_batch_threads = DEFAULT_HTTP_BATCH_THREADS;
 
 static void JSONErrorReply(HTTPRequest* req, const UniValue& objError, const UniValue& id)
 {
@@ -237,7 +239,7 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
                     }
                 }
             }
-            strReply = JSONRPCExecBatch(jreq, valRequest.get_array());
+            strReply = JSONRPCExecBatch(jreq, valRequest.get_array(), g_rpc_batch_threads, QueueHTTPWork);
         }
         else
             throw JSONRPCError(RPC_PARSE_ERROR, "Top-level object parse error");
@@ -303,6 +305,8 @@ bool StartHTTPRPC()
     if (!InitRPCAuthentication())
         return false;
 
+    g_rpc_batch_threads = std::max((int)std::min(gArgs.GetArg("-rpcbatchthreads", DEFAULT_HTTP_BATCH_THREADS), gArgs.GetArg("-rpcthreads", DEFAULT_HTTP_THREADS)), 1);
+
     RegisterHTTPHandler("/", true, HTTPReq_JSONRPC);
     if (g_wallet_init_interface.HasWalletSupport()) {
         RegisterHTTPHandler("/wallet/", false, HTTPReq_JSONRPC);
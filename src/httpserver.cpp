@@ -62,6 +62,22 @@ private:
     HTTPRequestHandler func;
 };
 
+/** Work item running a function, see QueueHTTPWork */
+class HTTPFunctionItem final : public HTTPClosure
+{
+public:
+    explicit HTTPFunctionItem(const std::function<void()>& _func): func(_func)
+    {
+    }
+    void operator()() override
+    {
+        func();
+    }
+
+private:
+    std::function<void()> func;
+};
+
 /** Simple work queue for distributing work over multiple threads.
  * Work items are simply callable objects.
  */
@@ -664,3 +680,16 @@ void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch)
         pathHandlers.erase(i);
     }
 }
+
+bool QueueHTTPWork(const std::function<void()>& func)
+{
+    if (!workQueue) {
+        return false;
+    }
+    std::unique_ptr<HTTPFunctionItem> item(new HTTPFunctionItem(func));
+    if (!workQueue->Enqueue(item.get())) {
+        return false;
+    }
+    item.release(); /* if true, queue took ownership */
+    return true;
+}
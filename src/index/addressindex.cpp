@@ -0,0 +1,326 @@
+// Copyright (c) 2020 The Graviocoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/addressindex.h>
+
+#include <chain.h>
+#include <insight/insight.h>
+#include <undo.h>
+#include <util/system.h>
+
+#include <limits>
+#include <map>
+#include <set>
+
+#include <boost/thread.hpp>
+
+constexpr char DB_ADDRESSINDEX = 'a';
+constexpr char DB_ADDRESSUNSPENTINDEX = 'u';
+constexpr char DB_ADDRESSBALANCEINDEX = 'w';
+
+std::unique_ptr<AddressIndex> g_address_index;
+
+/**
+ * Access to the address index database (indexes/address/)
+ *
+ * Deltas are keyed by address, height, position in block, txid, input or
+ * output index and a spending flag, so an address's history is one range.
+ * Unspent outputs are keyed by address and outpoint, balances by address.
+ */
+class AddressIndex::DB : public BaseIndex::DB
+{
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    bool ReadAddressIndex(uint256 addressHash, int type,
+                          std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
+                          int start, int end, const CAddressIndexCursor &after, size_t max_txns);
+    bool ReadAddressUnspentIndex(uint256 addressHash, int type,
+                                 std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs,
+                                 const CAddressUnspentKey &after, size_t max_count);
+    bool ReadAddressBalance(uint256 addressHash, int type, CAddressBalanceValue &value) const;
+
+    /// Add the balance changes from a block's address deltas to batch, reversed if fErase.
+    bool BatchAddressBalance(CDBBatch &batch, const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect, bool fErase) const;
+};
+
+AddressIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    BaseIndex::DB(GetDataDir() / "indexes" / "address", n_cache_size, f_memory, f_wipe)
+{}
+
+bool AddressIndex::DB::ReadAddressIndex(uint256 addressHash, int type,
+                                        std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
+                                        int start, int end, const CAddressIndexCursor &after, size_t max_txns)
+{
+    const std::unique_ptr<CDBIterator> pcursor(NewIterator());
+
+    if (!after.IsNull() && after.blockHeight >= start) {
+        // Skip the remaining entries of the cursor transaction
+        if (after.txindex == std::numeric_limits<unsigned int>::max()) {
+            pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorHeightKey(type, addressHash, after.blockHeight + 1)));
+        } else {
+            pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorPositionKey(type, addressHash, after.blockHeight, after.txindex + 1)));
+        }
+    } else
+    if (start > 0 && end > 0) {
+        pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorHeightKey(type, addressHash, start)));
+    } else {
+        pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorKey(type, addressHash)));
+    }
+
+    size_t nTxns = 0;
+    CAddressIndexCursor last;
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char,CAddressIndexKey> key;
+        if (pcursor->GetKey(key) && key.first == DB_ADDRESSINDEX && key.second.type == (unsigned int)type && key.second.hashBytes == addressHash) {
+            if (end > 0 && key.second.blockHeight > end) {
+                break;
+            }
+            // Pages end on a transaction boundary
+            CAddressIndexCursor position(key.second);
+            if (position != last) {
+                if (max_txns > 0 && nTxns >= max_txns) {
+                    break;
+                }
+                nTxns++;
+                last = position;
+            }
+            CAmount nValue;
+            if (pcursor->GetValue(nValue)) {
+                addressIndex.push_back(std::make_pair(key.second, nValue));
+                pcursor->Next();
+            } else {
+                return error("failed to get address index value");
+            }
+        } else {
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool AddressIndex::DB::ReadAddressUnspentIndex(uint256 addressHash, int type,
+                                               std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs,
+                                               const CAddressUnspentKey &after, size_t max_count)
+{
+    const std::unique_ptr<CDBIterator> pcursor(NewIterator());
+
+    if (!after.txhash.IsNull()) {
+        pcursor->Seek(std::make_pair(DB_ADDRESSUNSPENTINDEX, CAddressUnspentKey(type, addressHash, after.txhash, after.index)));
+    } else {
+        pcursor->Seek(std::make_pair(DB_ADDRESSUNSPENTINDEX, CAddressIndexIteratorKey(type, addressHash)));
+    }
+
+    size_t nCount = 0;
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char,CAddressUnspentKey> key;
+        if (pcursor->GetKey(key) && key.first == DB_ADDRESSUNSPENTINDEX && key.second.type == (unsigned int)type && key.second.hashBytes == addressHash) {
+            // Skip the output the cursor points at, if it is still unspent
+            if (!after.txhash.IsNull() && key.second.txhash == after.txhash && key.second.index == after.index) {
+                pcursor->Next();
+                continue;
+            }
+            if (max_count > 0 && nCount >= max_count) {
+                break;
+            }
+            nCount++;
+            CAddressUnspentValue nValue;
+            if (pcursor->GetValue(nValue)) {
+                unspentOutputs.push_back(std::make_pair(key.second, nValue));
+                pcursor->Next();
+            } else {
+                return error("failed to get address unspent value");
+            }
+        } else {
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool AddressIndex::DB::ReadAddressBalance(uint256 addressHash, int type, CAddressBalanceValue &value) const
+{
+    if (!Read(std::make_pair(DB_ADDRESSBALANCEINDEX, CAddressIndexIteratorKey(type, addressHash)), value)) {
+        value.SetNull();
+    }
+    return true;
+}
+
+bool AddressIndex::DB::BatchAddressBalance(CDBBatch &batch, const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect, bool fErase) const
+{
+    // vect holds the entries of a single block, so a txid counted here is not counted in any other call
+    std::map<std::pair<unsigned int, uint256>, CAddressBalanceValue> deltas;
+    std::set<std::pair<std::pair<unsigned int, uint256>, uint256> > seen_txids;
+    for (const auto &entry : vect) {
+        const CAddressIndexKey &key = entry.first;
+        std::pair<unsigned int, uint256> address(key.type, key.hashBytes);
+        CAddressBalanceValue &delta = deltas[address];
+        if (entry.second > 0) {
+            delta.received += entry.second;
+        } else {
+            delta.sent -= entry.second;
+        }
+        if (seen_txids.insert(std::make_pair(address, key.txhash)).second) {
+            delta.txCount++;
+        }
+    }
+
+    for (const auto &it : deltas) {
+        CAddressIndexIteratorKey key(it.first.first, it.first.second);
+        CAddressBalanceValue value;
+        if (!Read(std::make_pair(DB_ADDRESSBALANCEINDEX, key), value)) {
+            value.SetNull();
+        }
+        if (fErase) {
+            if (value.received < it.second.received || value.sent < it.second.sent || value.txCount < it.second.txCount) {
+                return error("%s: Address balance index underflow", __func__);
+            }
+            value.received -= it.second.received;
+            value.sent -= it.second.sent;
+            value.txCount -= it.second.txCount;
+        } else {
+            value.received += it.second.received;
+            value.sent += it.second.sent;
+            value.txCount += it.second.txCount;
+        }
+        if (value.IsNull()) {
+            batch.Erase(std::make_pair(DB_ADDRESSBALANCEINDEX, key));
+        } else {
+            batch.Write(std::make_pair(DB_ADDRESSBALANCEINDEX, key), value);
+        }
+    }
+
+    return true;
+}
+
+AddressIndex::AddressIndex(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : m_db(MakeUnique<AddressIndex::DB>(n_cache_size, f_memory, f_wipe))
+{}
+
+AddressIndex::~AddressIndex() {}
+
+bool AddressIndex::IndexBlock(CDBBatch& batch, const CBlock& block, const CBlockUndo& blockundo,
+                              const CBlockIndex* pindex, bool fErase)
+{
+    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
+    // Unspent index changes in block order, spends are null on connect and restore the output on erase
+    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > addressUnspentIndex;
+    std::vector<bool> vUnspentIsSpend;
+
+    size_t nVtxundo = 0;
+    for (size_t i = 0; i < block.vtx.size(); i++) {
+        const CTransaction &tx = *block.vtx[i];
+        const uint256 &txhash = tx.GetHash();
+
+        if (!tx.IsCoinBase() && pindex->pprev) {
+            if (nVtxundo >= blockundo.vtxundo.size()) {
+                return error("%s: Missing undo data for transaction %s", __func__, txhash.ToString());
+            }
+            const CTxUndo &txundo = blockundo.vtxundo[nVtxundo++];
+
+            size_t nPrevout = 0;
+            for (size_t j = 0; j < tx.vin.size() && tx.IsGraviocoinVersion(); j++) {
+                const CTxIn &input = tx.vin[j];
+                if (input.IsAnonInput()) {
+                    continue;
+                }
+                if (nPrevout >= txundo.vprevout.size()) {
+                    return error("%s: Undo data inconsistent for transaction %s", __func__, txhash.ToString());
+                }
+                const Coin &coin = txundo.vprevout[nPrevout++];
+                const CScript *pScript = &coin.out.scriptPubKey;
+
+                CAmount nValue = coin.nType == OUTPUT_CT ? 0 : coin.out.nValue;
+                std::vector<uint8_t> hashBytes;
+                int scriptType = 0;
+                if (!ExtractIndexInfo(pScript, scriptType, hashBytes)
+                    || scriptType <= 0) {
+                    continue;
+                }
+                uint256 hashAddress(hashBytes.data(), hashBytes.size());
+
+                // Record spending activity
+                addressIndex.push_back(std::make_pair(CAddressIndexKey(scriptType, hashAddress, pindex->nHeight, i, txhash, j, true), nValue * -1));
+                // Remove address from unspent index
+                addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(scriptType, hashAddress, input.prevout.hash, input.prevout.n), CAddressUnspentValue(nValue, *pScript, coin.nHeight)));
+                vUnspentIsSpend.push_back(true);
+            }
+        }
+
+        for (unsigned int k = 0; k < tx.vpout.size(); k++) {
+            const CTxOutBase *out = tx.vpout[k].get();
+
+            if (!out->IsType(OUTPUT_STANDARD)
+                && !out->IsType(OUTPUT_CT)) {
+                continue;
+            }
+
+            const CScript *pScript;
+            std::vector<unsigned char> hashBytes;
+            int scriptType = 0;
+            CAmount nValue;
+            if (!ExtractIndexInfo(out, scriptType, hashBytes, nValue, pScript)
+                || scriptType == 0) {
+                continue;
+            }
+            uint256 hashAddress(hashBytes.data(), hashBytes.size());
+
+            // Record receiving activity
+            addressIndex.push_back(std::make_pair(CAddressIndexKey(scriptType, hashAddress, pindex->nHeight, i, txhash, k, false), nValue));
+            // Record unspent output
+            addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(scriptType, hashAddress, txhash, k), CAddressUnspentValue(nValue, *pScript, pindex->nHeight)));
+            vUnspentIsSpend.push_back(false);
+        }
+    }
+
+    for (const auto &entry : addressIndex) {
+        if (fErase) {
+            batch.Erase(std::make_pair(DB_ADDRESSINDEX, entry.first));
+        } else {
+            batch.Write(std::make_pair(DB_ADDRESSINDEX, entry.first), entry.second);
+        }
+    }
+    if (!m_db->BatchAddressBalance(batch, addressIndex, fErase)) {
+        return false;
+    }
+
+    // Later writes to a key in a batch replace earlier ones, so erasing a block walks it backwards
+    // to leave outputs created and spent within the block erased.
+    for (size_t n = 0; n < addressUnspentIndex.size(); n++) {
+        size_t k = fErase ? addressUnspentIndex.size() - 1 - n : n;
+        const auto &entry = addressUnspentIndex[k];
+        if (vUnspentIsSpend[k] != fErase) {
+            batch.Erase(std::make_pair(DB_ADDRESSUNSPENTINDEX, entry.first));
+        } else {
+            batch.Write(std::make_pair(DB_ADDRESSUNSPENTINDEX, entry.first), entry.second);
+        }
+    }
+
+    return true;
+}
+
+BaseIndex::DB& AddressIndex::GetDB() const { return *m_db; }
+
+bool AddressIndex::ReadAddressIndex(uint256 addressHash, int type,
+                                    std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
+                                    int start, int end, const CAddressIndexCursor &after, size_t max_txns) const
+{
+    return m_db->ReadAddressIndex(addressHash, type, addressIndex, start, end, after, max_txns);
+}
+
+bool AddressIndex::ReadAddressUnspentIndex(uint256 addressHash, int type,
+                                           std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs,
+                                           const CAddressUnspentKey &after, size_t max_count) const
+{
+    return m_db->ReadAddressUnspentIndex(addressHash, type, unspentOutputs, after, max_count);
+}
+
+bool AddressIndex::ReadAddressBalance(uint256 addressHash, int type, CAddressBalanceValue &value) const
+{
+    return m_db->ReadAddressBalance(addressHash, type, value);
+}
@@ -0,0 +1,59 @@
+// Copyright (c) 2020 The Graviocoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GIO_INDEX_ADDRESSINDEX_H
+#define GIO_INDEX_ADDRESSINDEX_H
+
+#include <index/insightindex.h>
+#include <insight/addressindex.h>
+
+#include <vector>
+
+/**
+ * AddressIndex records the history, unspent outputs and running balance of
+ * every address (indexes/address/). Enabled by -addressindex.
+ */
+class AddressIndex final : public InsightIndex
+{
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+protected:
+    bool IndexBlock(CDBBatch& batch, const CBlock& block, const CBlockUndo& blockundo,
+                    const CBlockIndex* pindex, bool fErase) override;
+
+    BaseIndex::DB& GetDB() const override;
+
+    const char* GetName() const override { return "addressindex"; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit AddressIndex(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~AddressIndex() override;
+
+    /// Append the address deltas between heights start and end, or all if not set.
+    /// Reading begins after the transaction at cursor after, and stops before the entries of
+    /// transaction max_txns + 1 if max_txns is set.
+    bool ReadAddressIndex(uint256 addressHash, int type,
+                          std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
+                          int start = 0, int end = 0,
+                          const CAddressIndexCursor &after = CAddressIndexCursor(), size_t max_txns = 0) const;
+    /// Append the unspent outputs of an address in index order, beginning after the output
+    /// after if its txhash is set, and stopping at max_count outputs if set.
+    bool ReadAddressUnspentIndex(uint256 addressHash, int type,
+                                 std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs,
+                                 const CAddressUnspentKey &after = CAddressUnspentKey(), size_t max_count = 0) const;
+    /// Read the running totals for an address, value is null if the address is unknown.
+    bool ReadAddressBalance(uint256 addressHash, int type, CAddressBalanceValue &value) const;
+};
+
+/// The global address index. May be null.
+extern std::unique_ptr<AddressIndex> g_address_index;
+
+#endif // GIO_INDEX_ADDRESSINDEX_H
@@ -306,6 +306,13 @@ bool BaseIndex::BlockUntilSyncedToCurrentChain()
     return true;
 }
 
+bool BaseIndex::IsBlockIndexed(const CBlockIndex* block_index) const
+{
+    const CBlockIndex* best_block_index = m_best_block_index.load();
+    return block_index && best_block_index &&
+        best_block_index->GetAncestor(block_index->nHeight) == block_index;
+}
+
 void BaseIndex::Interrupt()
 {
     m_interrupt();
@@ -104,6 +104,11 @@ public:
     /// not block and immediately returns false.
     bool BlockUntilSyncedToCurrentChain();
 
+    /// Return whether the index has processed block_index, a block on the
+    /// active chain. Entries for blocks after the best block of the index may
+    /// be missing or stale.
+    bool IsBlockIndexed(const CBlockIndex* block_index) const;
+
     void Interrupt();
 
     /// Start initializes the sync state and registers the instance as a
@@ -23,14 +23,23 @@
  * Keys for the height index have the type [DB_BLOCK_HEIGHT, uint32 (BE)]. The height is represented
  * as big-endian so that sequential reads of filters by height are fast.
  * Keys for the hash index have the type [DB_BLOCK_HASH, uint256].
+ *
+ * DB_VERSION holds the version of the filter contents, the entries and filter files of an index
+ * written by an older version are removed and it is rebuilt from the genesis block.
  */
 constexpr char DB_BLOCK_HASH = 's';
 constexpr char DB_BLOCK_HEIGHT = 't';
 constexpr char DB_FILTER_POS = 'P';
+constexpr char DB_VERSION = 'V';
+
+//! Version 1 adds the scripts of vpout outputs to basic filters
+constexpr int32_t BLOCKFILTER_INDEX_VERSION = 1;
 
 constexpr unsigned int MAX_FLTR_FILE_SIZE = 0x1000000; // 16 MiB
 /** The pre-allocation chunk size for fltr?????.dat files */
 constexpr unsigned int FLTR_FILE_CHUNK_SIZE = 0x100000; // 1 MiB
+/** Size of the batches erasing the entries of an outdated index */
+constexpr size_t ERASE_BATCH_SIZE = 0x1000000; // 16 MiB
 
 namespace {
 
@@ -96,6 +105,23 @@ struct DBHashKey {
 
 static std::map<BlockFilterType, BlockFilterIndex> g_filter_indexes;
 
+template <typename K>
+static bool EraseEntries(CDBWrapper& db, K key)
+{
+    CDBBatch batch(db);
+    std::unique_ptr<CDBIterator> db_it(db.NewIterator());
+    for (db_it->Seek(key); db_it->Valid() && db_it->GetKey(key); db_it->Next()) {
+        batch.Erase(key);
+        if (batch.SizeEstimate() > ERASE_BATCH_SIZE) {
+            if (!db.WriteBatch(batch)) {
+                return false;
+            }
+            batch.Clear();
+        }
+    }
+    return db.WriteBatch(batch);
+}
+
 BlockFilterIndex::BlockFilterIndex(BlockFilterType filter_type,
                                    size_t n_cache_size, bool f_memory, bool f_wipe)
     : m_filter_type(filter_type)
@@ -126,6 +152,30 @@ bool BlockFilterIndex::Init()
         m_next_filter_pos.nFile = 0;
         m_next_filter_pos.nPos = 0;
     }
+
+    int32_t version = 0;
+    if (!m_db->Read(DB_VERSION, version) || version != BLOCKFILTER_INDEX_VERSION) {
+        if (m_db->Exists(DB_FILTER_POS)) {
+            LogPrintf("%s: %s version %d is outdated, rebuilding\n", __func__, GetName(), version);
+        }
+        // Restart from the genesis block. Lookups must not find the old entries, their filters are
+        // overwritten as blocks are indexed again.
+        if (!EraseEntries(*m_db, DBHeightKey(0)) || !EraseEntries(*m_db, DBHashKey(uint256()))) {
+            return error("%s: Failed to erase %s entries", __func__, GetName());
+        }
+        for (int file = m_next_filter_pos.nFile; file >= 0; --file) {
+            fs::remove(m_filter_fileseq->FileName(FlatFilePos(file, 0)));
+        }
+        m_next_filter_pos.nFile = 0;
+        m_next_filter_pos.nPos = 0;
+        CDBBatch batch(*m_db);
+        batch.Write(DB_VERSION, BLOCKFILTER_INDEX_VERSION);
+        batch.Write(DB_FILTER_POS, m_next_filter_pos);
+        GetDB().WriteBestBlock(batch, CBlockLocator());
+        if (!m_db->WriteBatch(batch)) {
+            return error("%s: Failed to write %s version", __func__, GetName());
+        }
+    }
     return BaseIndex::Init();
 }
 
@@ -146,17 +196,22 @@ bool BlockFilterIndex::CommitInternal(CDBBatch& batch)
     return BaseIndex::CommitInternal(batch);
 }
 
-bool BlockFilterIndex::ReadFilterFromDisk(const FlatFilePos& pos, BlockFilter& filter) const
+bool BlockFilterIndex::ReadFilterFromDisk(const FlatFilePos& pos, const uint256& block_hash, BlockFilter& filter) const
 {
     CAutoFile filein(m_filter_fileseq->Open(pos, true), SER_DISK, CLIENT_VERSION);
     if (filein.IsNull()) {
         return false;
     }
 
-    uint256 block_hash;
+    uint256 read_hash;
     std::vector<unsigned char> encoded_filter;
     try {
-        filein >> block_hash >> encoded_filter;
+        filein >> read_hash;
+        if (read_hash != block_hash) {
+            return error("%s: Filter at %s belongs to block %s, expected %s",
+                         __func__, pos.ToString(), read_hash.ToString(), block_hash.ToString());
+        }
+        filein >> encoded_filter;
         filter = BlockFilter(GetFilterType(), block_hash, std::move(encoded_filter));
     }
     catch (const std::exception& e) {
@@ -384,7 +439,7 @@ bool BlockFilterIndex::LookupFilter(const CBlockIndex* block_index, BlockFilter&
         return false;
     }
 
-    return ReadFilterFromDisk(entry.pos, filter_out);
+    return ReadFilterFromDisk(entry.pos, block_index->GetBlockHash(), filter_out);
 }
 
 bool BlockFilterIndex::LookupFilterHeader(const CBlockIndex* block_index, uint256& header_out) const
@@ -407,12 +462,11 @@ bool BlockFilterIndex::LookupFilterRange(int start_height, const CBlockIndex* st
     }
 
     filters_out.resize(entries.size());
-    auto filter_pos_it = filters_out.begin();
-    for (const auto& entry : entries) {
-        if (!ReadFilterFromDisk(entry.pos, *filter_pos_it)) {
+    const CBlockIndex* block_index = stop_index;
+    for (size_t i = entries.size(); i-- > 0; block_index = block_index->pprev) {
+        if (!ReadFilterFromDisk(entries[i].pos, block_index->GetBlockHash(), filters_out[i])) {
             return false;
         }
-        ++filter_pos_it;
     }
 
     return true;
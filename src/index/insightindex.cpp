@@ -0,0 +1,108 @@
+// Copyright (c) 2020 The Graviocoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/insightindex.h>
+
+#include <chainparams.h>
+#include <undo.h>
+#include <util/system.h>
+#include <validation.h>
+
+bool InsightIndex::Init()
+{
+    LOCK(cs_main);
+
+    CBlockLocator locator;
+    GetDB().ReadBestBlock(locator);
+
+    if (!BaseIndex::Init()) {
+        return false;
+    }
+
+    // A shutdown after blocks were disconnected, but before the index received the notifications,
+    // leaves the locator on a stale branch. Undo those blocks before syncing the active chain.
+    const CBlockIndex *pindex_stale = locator.IsNull() ? nullptr : LookupBlockIndex(locator.vHave.front());
+    const CBlockIndex *pindex_fork = m_best_block_index.load();
+    if (pindex_stale && pindex_fork && !::ChainActive().Contains(pindex_stale)
+        && pindex_stale->GetAncestor(pindex_fork->nHeight) == pindex_fork) {
+        LogPrintf("%s: Rewinding %s from stale block %s to height %d\n", __func__, GetName(),
+                  pindex_stale->GetBlockHash().ToString(), pindex_fork->nHeight);
+        m_best_block_index = pindex_stale;
+        if (!Rewind(pindex_stale, pindex_fork)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool InsightIndex::ApplyBlock(const CBlock& block, const CBlockIndex* pindex, bool fErase)
+{
+    CBlockUndo blockundo;
+    if (UsesUndoData() && pindex->pprev && !UndoReadFromDisk(blockundo, pindex)) {
+        return error("%s: Failed to read undo data for block %s", __func__, pindex->GetBlockHash().ToString());
+    }
+
+    CDBBatch batch(GetDB());
+    if (!IndexBlock(batch, block, blockundo, pindex, fErase)) {
+        return false;
+    }
+    {
+        LOCK(cs_main);
+        GetDB().WriteBestBlock(batch, ::ChainActive().GetLocator(fErase ? pindex->pprev : pindex));
+    }
+    return GetDB().WriteBatch(batch);
+}
+
+bool InsightIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    return ApplyBlock(block, pindex, false);
+}
+
+bool InsightIndex::DisconnectBlock(const CBlock& block)
+{
+    const CBlockIndex *pindex;
+    {
+        LOCK(cs_main);
+        pindex = LookupBlockIndex(block.GetHash());
+    }
+
+    // Blocks the index never reached are left for Rewind to resolve on the next connect
+    if (!pindex || pindex != m_best_block_index.load()) {
+        LogPrint(BCLog::COINDB, "%s: %s is not at block %s, not disconnecting\n", __func__, GetName(), block.GetHash().ToString());
+        return true;
+    }
+
+    if (!ApplyBlock(block, pindex, true)) {
+        return false;
+    }
+    m_best_block_index = pindex->pprev;
+    return true;
+}
+
+bool InsightIndex::Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip)
+{
+    // The sync thread only updates m_best_block_index periodically, current_tip is the last block written
+    assert(current_tip->GetAncestor(new_tip->nHeight) == new_tip);
+
+    const auto& consensus_params = Params().GetConsensus();
+    for (const CBlockIndex *pindex = current_tip; pindex != new_tip; pindex = pindex->pprev) {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, pindex, consensus_params)) {
+            return error("%s: Failed to read block %s from disk", __func__, pindex->GetBlockHash().ToString());
+        }
+        if (!ApplyBlock(block, pindex, true)) {
+            return false;
+        }
+        m_best_block_index = pindex->pprev;
+    }
+
+    return true;
+}
+
+bool InsightIndex::IsSyncedTo(const CBlockIndex* pindex) const
+{
+    const CBlockIndex *best_block_index = m_best_block_index.load();
+    return m_synced && best_block_index && best_block_index->GetAncestor(pindex->nHeight) == pindex;
+}
@@ -0,0 +1,54 @@
+// Copyright (c) 2020 The Graviocoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GIO_INDEX_INSIGHTINDEX_H
+#define GIO_INDEX_INSIGHTINDEX_H
+
+#include <index/base.h>
+
+class CBlockUndo;
+
+/**
+ * Base class for the insight indices (address, spent and timestamp).
+ *
+ * Unlike the txindex, insight entries are not idempotent: the address balance
+ * totals are running sums and the unspent index removes entries as outputs are
+ * spent. Each block's entries are therefore written in the same batch as the
+ * block locator, and blocks leaving the active chain are undone entry by entry
+ * before the locator is moved back.
+ */
+class InsightIndex : public BaseIndex
+{
+protected:
+    /// Add the index entries for a block to batch, or the entries removing them if fErase is set.
+    /// blockundo is empty if UsesUndoData returns false.
+    virtual bool IndexBlock(CDBBatch& batch, const CBlock& block, const CBlockUndo& blockundo,
+                            const CBlockIndex* pindex, bool fErase) = 0;
+
+    /// Whether IndexBlock needs the spent outputs from the block's undo data.
+    virtual bool UsesUndoData() const { return true; }
+
+    /// Undo blocks above the last locator if the index was left on a stale chain.
+    bool Init() override;
+
+    bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) override;
+
+    bool DisconnectBlock(const CBlock& block) override;
+
+    bool Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip) override;
+
+    /// The locator is written with every block, so there is nothing left to commit.
+    bool CommitInternal(CDBBatch& batch) override { return true; }
+
+private:
+    /// Write or erase the entries for pindex and move the locator in one batch.
+    bool ApplyBlock(const CBlock& block, const CBlockIndex* pindex, bool fErase);
+
+public:
+    /// Whether the index has processed every block up to and including pindex, which must be on
+    /// the active chain. Does not wait on queued validation notifications.
+    bool IsSyncedTo(const CBlockIndex* pindex) const;
+};
+
+#endif // GIO_INDEX_INSIGHTINDEX_H
@@ -0,0 +1,109 @@
+// Copyright (c) 2020 The Graviocoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/spentindex.h>
+
+#include <chain.h>
+#include <insight/insight.h>
+#include <undo.h>
+#include <util/system.h>
+
+constexpr char DB_SPENTINDEX = 'p';
+
+std::unique_ptr<SpentIndex> g_spent_index;
+
+/**
+ * Access to the spent index database (indexes/spent/)
+ *
+ * Values are keyed by the outpoint spent.
+ */
+class SpentIndex::DB : public BaseIndex::DB
+{
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    bool ReadSpentIndex(const CSpentIndexKey &key, CSpentIndexValue &value) const;
+};
+
+SpentIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    BaseIndex::DB(GetDataDir() / "indexes" / "spent", n_cache_size, f_memory, f_wipe)
+{}
+
+bool SpentIndex::DB::ReadSpentIndex(const CSpentIndexKey &key, CSpentIndexValue &value) const
+{
+    return Read(std::make_pair(DB_SPENTINDEX, key), value);
+}
+
+SpentIndex::SpentIndex(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : m_db(MakeUnique<SpentIndex::DB>(n_cache_size, f_memory, f_wipe))
+{}
+
+SpentIndex::~SpentIndex() {}
+
+bool SpentIndex::IndexBlock(CDBBatch& batch, const CBlock& block, const CBlockUndo& blockundo,
+                            const CBlockIndex* pindex, bool fErase)
+{
+    if (!pindex->pprev) {
+        return true;
+    }
+
+    size_t nVtxundo = 0;
+    for (size_t i = 0; i < block.vtx.size(); i++) {
+        const CTransaction &tx = *block.vtx[i];
+        const uint256 &txhash = tx.GetHash();
+        if (tx.IsCoinBase()) {
+            continue;
+        }
+        if (nVtxundo >= blockundo.vtxundo.size()) {
+            return error("%s: Missing undo data for transaction %s", __func__, txhash.ToString());
+        }
+        const CTxUndo &txundo = blockundo.vtxundo[nVtxundo++];
+        if (!tx.IsGraviocoinVersion()) {
+            continue;
+        }
+
+        size_t nPrevout = 0;
+        for (size_t j = 0; j < tx.vin.size(); j++) {
+            const CTxIn &input = tx.vin[j];
+            if (input.IsAnonInput()) {
+                continue;
+            }
+            if (nPrevout >= txundo.vprevout.size()) {
+                return error("%s: Undo data inconsistent for transaction %s", __func__, txhash.ToString());
+            }
+            const Coin &coin = txundo.vprevout[nPrevout++];
+
+            std::vector<uint8_t> hashBytes;
+            int scriptType = 0;
+            if (!ExtractIndexInfo(&coin.out.scriptPubKey, scriptType, hashBytes)
+                || scriptType == 0) {
+                continue;
+            }
+
+            CSpentIndexKey key(input.prevout.hash, input.prevout.n);
+            if (fErase) {
+                batch.Erase(std::make_pair(DB_SPENTINDEX, key));
+                continue;
+            }
+
+            uint256 hashAddress;
+            if (scriptType > 0) {
+                hashAddress = uint256(hashBytes.data(), hashBytes.size());
+            }
+            CAmount nValue = coin.nType == OUTPUT_CT ? -1 : coin.out.nValue;
+            // Add the spent index to determine the txid and input that spent an output
+            // and to find the amount and address from an input
+            batch.Write(std::make_pair(DB_SPENTINDEX, key), CSpentIndexValue(txhash, j, pindex->nHeight, nValue, scriptType, hashAddress));
+        }
+    }
+
+    return true;
+}
+
+BaseIndex::DB& SpentIndex::GetDB() const { return *m_db; }
+
+bool SpentIndex::ReadSpentIndex(const CSpentIndexKey &key, CSpentIndexValue &value) const
+{
+    return m_db->ReadSpentIndex(key, value);
+}
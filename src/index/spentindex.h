@@ -0,0 +1,45 @@
+// Copyright (c) 2020 The Graviocoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GIO_INDEX_SPENTINDEX_H
+#define GIO_INDEX_SPENTINDEX_H
+
+#include <index/insightindex.h>
+#include <insight/spentindex.h>
+
+/**
+ * SpentIndex records the input spending each output, with the value and
+ * address of the output spent (indexes/spent/). Enabled by -spentindex.
+ */
+class SpentIndex final : public InsightIndex
+{
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+protected:
+    bool IndexBlock(CDBBatch& batch, const CBlock& block, const CBlockUndo& blockundo,
+                    const CBlockIndex* pindex, bool fErase) override;
+
+    BaseIndex::DB& GetDB() const override;
+
+    const char* GetName() const override { return "spentindex"; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit SpentIndex(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~SpentIndex() override;
+
+    /// Look up the input spending an output. Returns false if the output is not spent.
+    bool ReadSpentIndex(const CSpentIndexKey &key, CSpentIndexValue &value) const;
+};
+
+/// The global spent index. May be null.
+extern std::unique_ptr<SpentIndex> g_spent_index;
+
+#endif // GIO_INDEX_SPENTINDEX_H
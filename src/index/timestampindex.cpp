@@ -0,0 +1,133 @@
+// Copyright (c) 2020 The Graviocoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/timestampindex.h>
+
+#include <chain.h>
+#include <insight/insight.h>
+#include <util/system.h>
+#include <validation.h>
+
+#include <boost/thread.hpp>
+
+constexpr char DB_TIMESTAMPINDEX = 's';
+constexpr char DB_BLOCKHASHINDEX = 'z';
+
+std::unique_ptr<TimestampIndex> g_timestamp_index;
+
+/**
+ * Access to the timestamp index database (indexes/timestamp/)
+ *
+ * Keys are the logical timestamp and block hash, so a time range is one range
+ * of keys. The logical timestamp of each block is also stored by hash.
+ */
+class TimestampIndex::DB : public BaseIndex::DB
+{
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    bool ReadTimestampIndex(const unsigned int &high, const unsigned int &low, const bool fActiveOnly,
+                            std::vector<std::pair<uint256, unsigned int> > &hashes);
+    bool ReadTimestampBlockIndex(const uint256 &hash, unsigned int &logicalTS) const;
+};
+
+TimestampIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    BaseIndex::DB(GetDataDir() / "indexes" / "timestamp", n_cache_size, f_memory, f_wipe)
+{}
+
+bool TimestampIndex::DB::ReadTimestampIndex(const unsigned int &high, const unsigned int &low, const bool fActiveOnly,
+                                            std::vector<std::pair<uint256, unsigned int> > &hashes)
+{
+    const std::unique_ptr<CDBIterator> pcursor(NewIterator());
+
+    pcursor->Seek(std::make_pair(DB_TIMESTAMPINDEX, CTimestampIndexIteratorKey(low)));
+
+    if (fActiveOnly) {
+        LockAssertion lock(::cs_main); // cs_main is locked before GetTimestampIndex if fActiveOnly
+        while (pcursor->Valid()) {
+            boost::this_thread::interruption_point();
+            std::pair<char, CTimestampIndexKey> key;
+            if (pcursor->GetKey(key) && key.first == DB_TIMESTAMPINDEX && key.second.timestamp < high) {
+                if (HashOnchainActive(key.second.blockHash)) {
+                    hashes.push_back(std::make_pair(key.second.blockHash, key.second.timestamp));
+                }
+                pcursor->Next();
+            } else {
+                break;
+            }
+        }
+    } else {
+        while (pcursor->Valid()) {
+            boost::this_thread::interruption_point();
+            std::pair<char, CTimestampIndexKey> key;
+            if (pcursor->GetKey(key) && key.first == DB_TIMESTAMPINDEX && key.second.timestamp < high) {
+                hashes.push_back(std::make_pair(key.second.blockHash, key.second.timestamp));
+                pcursor->Next();
+            } else {
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool TimestampIndex::DB::ReadTimestampBlockIndex(const uint256 &hash, unsigned int &logicalTS) const
+{
+    CTimestampBlockIndexValue lts;
+    if (!Read(std::make_pair(DB_BLOCKHASHINDEX, hash), lts)) {
+        return false;
+    }
+
+    logicalTS = lts.ltimestamp;
+    return true;
+}
+
+TimestampIndex::TimestampIndex(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : m_db(MakeUnique<TimestampIndex::DB>(n_cache_size, f_memory, f_wipe))
+{}
+
+TimestampIndex::~TimestampIndex() {}
+
+bool TimestampIndex::IndexBlock(CDBBatch& batch, const CBlock& block, const CBlockUndo& blockundo,
+                                const CBlockIndex* pindex, bool fErase)
+{
+    // Entries for blocks leaving the chain are kept, getblockhashes can include orphans
+    if (fErase) {
+        return true;
+    }
+
+    unsigned int logicalTS = pindex->nTime;
+    unsigned int prevLogicalTS = 0;
+
+    // Retrieve logical timestamp of the previous block
+    if (pindex->pprev) {
+        if (!m_db->ReadTimestampBlockIndex(pindex->pprev->GetBlockHash(), prevLogicalTS)) {
+            LogPrintf("%s: Failed to read previous block's logical timestamp\n", __func__);
+        }
+    }
+
+    if (logicalTS <= prevLogicalTS) {
+        logicalTS = prevLogicalTS + 1;
+        LogPrintf("%s: Previous logical timestamp is newer Actual[%d] prevLogical[%d] Logical[%d]\n", __func__, pindex->nTime, prevLogicalTS, logicalTS);
+    }
+
+    batch.Write(std::make_pair(DB_TIMESTAMPINDEX, CTimestampIndexKey(logicalTS, pindex->GetBlockHash())), 0);
+    batch.Write(std::make_pair(DB_BLOCKHASHINDEX, CTimestampBlockIndexKey(pindex->GetBlockHash())), CTimestampBlockIndexValue(logicalTS));
+
+    return true;
+}
+
+BaseIndex::DB& TimestampIndex::GetDB() const { return *m_db; }
+
+bool TimestampIndex::ReadTimestampIndex(const unsigned int &high, const unsigned int &low, const bool fActiveOnly,
+                                        std::vector<std::pair<uint256, unsigned int> > &hashes) const
+{
+    return m_db->ReadTimestampIndex(high, low, fActiveOnly, hashes);
+}
+
+bool TimestampIndex::ReadTimestampBlockIndex(const uint256 &hash, unsigned int &logicalTS) const
+{
+    return m_db->ReadTimestampBlockIndex(hash, logicalTS);
+}
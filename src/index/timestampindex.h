@@ -0,0 +1,51 @@
+// Copyright (c) 2020 The Graviocoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GIO_INDEX_TIMESTAMPINDEX_H
+#define GIO_INDEX_TIMESTAMPINDEX_H
+
+#include <index/insightindex.h>
+#include <insight/timestampindex.h>
+
+#include <vector>
+
+/**
+ * TimestampIndex maps logical block timestamps, which increase strictly along
+ * the chain, to block hashes (indexes/timestamp/). Enabled by -timestampindex.
+ */
+class TimestampIndex final : public InsightIndex
+{
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+protected:
+    bool IndexBlock(CDBBatch& batch, const CBlock& block, const CBlockUndo& blockundo,
+                    const CBlockIndex* pindex, bool fErase) override;
+
+    bool UsesUndoData() const override { return false; }
+
+    BaseIndex::DB& GetDB() const override;
+
+    const char* GetName() const override { return "timestampindex"; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit TimestampIndex(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~TimestampIndex() override;
+
+    /// Append the blocks with logical timestamps in [low, high), cs_main must be held if fActiveOnly is set.
+    bool ReadTimestampIndex(const unsigned int &high, const unsigned int &low, const bool fActiveOnly,
+                            std::vector<std::pair<uint256, unsigned int> > &hashes) const;
+    bool ReadTimestampBlockIndex(const uint256 &hash, unsigned int &logicalTS) const;
+};
+
+/// The global timestamp index. May be null.
+extern std::unique_ptr<TimestampIndex> g_timestamp_index;
+
+#endif // GIO_INDEX_TIMESTAMPINDEX_H
@@ -256,12 +256,32 @@ bool TxIndex::Init()
 
     // Set m_best_block_index to the last cs_indexed block if lower
     if (m_cs_index) {
+        int cs_version = 0;
+        if (!GetDB().Read(DB_TXINDEX_CSVERSION, cs_version) || cs_version < CSINDEX_VERSION) {
+            LogPrintf("Resyncing csindex to build the cold stake aggregates.\n");
+            CDBBatch batch(GetDB());
+            batch.Erase(DB_TXINDEX_CSBESTBLOCK);
+            batch.Write(DB_TXINDEX_CSVERSION, CSINDEX_VERSION);
+            if (!GetDB().WriteBatch(batch)) {
+                return error("%s: Failed to write csindex version", __func__);
+            }
+        }
+
         CBlockLocator locator;
         if (!GetDB().Read(DB_TXINDEX_CSBESTBLOCK, locator)) {
             locator.SetNull();
         }
         CBlockIndex *best_cs_block_index = FindForkInGlobalIndex(::ChainActive(), locator);
 
+        // Undo blocks indexed on a chain reorganised away while the node was down
+        m_cs_best_block_index = locator.IsNull() ? nullptr : LookupBlockIndex(locator.vHave[0]);
+        if (!m_cs_best_block_index.load()) {
+            m_cs_best_block_index = best_cs_block_index;
+        }
+        if (!RewindCSOutputs(best_cs_block_index)) {
+            return false;
+        }
+
         if (best_cs_block_index != ::ChainActive().Tip()) {
             m_synced = false;
             if (m_best_block_index.load()->nHeight > best_cs_block_index->nHeight) {
@@ -277,7 +297,13 @@ bool TxIndex::Init()
 bool TxIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
 {
     if (m_cs_index) {
-        IndexCSOutputs(block, pindex);
+        // Blocks at or below the csindex best block are already counted in the aggregates
+        const CBlockIndex *cs_best_block_index = m_cs_best_block_index.load();
+        if (!cs_best_block_index || cs_best_block_index->GetAncestor(pindex->nHeight) != pindex) {
+            if (!IndexCSOutputs(block, pindex)) {
+                return false;
+            }
+        }
     }
     // Exclude genesis block transaction because outputs are not spendable.
     if (!block.IsGraviocoinVersion() && pindex->nHeight == 0) return true;
@@ -298,9 +324,85 @@ bool TxIndex::DisconnectBlock(const CBlock& block)
         return true;
     }
 
+    const CBlockIndex *cs_best_block_index = m_cs_best_block_index.load();
+    if (!cs_best_block_index || cs_best_block_index->GetBlockHash() != block.GetHash()) {
+        return true;
+    }
+
+    return DisconnectCSOutputs(block, cs_best_block_index->pprev);
+}
+
+bool TxIndex::Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip)
+{
+    if (m_cs_index && !RewindCSOutputs(new_tip)) {
+        return false;
+    }
+
+    return BaseIndex::Rewind(current_tip, new_tip);
+}
+
+bool TxIndex::RewindCSOutputs(const CBlockIndex* new_tip)
+{
+    const Consensus::Params& consensus_params = Params().GetConsensus();
+
+    const CBlockIndex *pindex;
+    while ((pindex = m_cs_best_block_index.load()) && pindex->pprev
+           && new_tip->GetAncestor(pindex->nHeight) != pindex) {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, pindex, consensus_params)) {
+            return error("%s: Failed to read block %s from disk", __func__, pindex->GetBlockHash().ToString());
+        }
+        if (!DisconnectCSOutputs(block, pindex->pprev)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/** Accumulate the aggregate changes of one transaction, rewards are the net value a coinstake adds to each pair */
+static void AddCSTxDeltas(const std::map<ColdStakeIndexAggregateKey, CAmount>& staked,
+    std::map<ColdStakeIndexAggregateKey, ColdStakeIndexAggregateValue>& deltas)
+{
+    for (const auto &it : staked) {
+        if (it.second > 0) {
+            deltas[it.first].m_staked += it.second;
+        }
+    }
+}
+
+/** Apply aggregate changes to the stored totals */
+static bool WriteCSAggregates(CDBWrapper& db, CDBBatch& batch,
+    const std::map<ColdStakeIndexAggregateKey, ColdStakeIndexAggregateValue>& deltas, bool subtract)
+{
+    for (const auto &it : deltas) {
+        ColdStakeIndexAggregateValue av;
+        if (db.Exists(std::make_pair(DB_TXINDEX_CSAGGREGATE, it.first))
+            && !db.Read(std::make_pair(DB_TXINDEX_CSAGGREGATE, it.first), av)) {
+            return error("%s: Failed to read cold stake aggregate", __func__);
+        }
+        if (subtract) {
+            av -= it.second;
+        } else {
+            av += it.second;
+        }
+        if (av.IsNull()) {
+            batch.Erase(std::make_pair(DB_TXINDEX_CSAGGREGATE, it.first));
+        } else {
+            batch.Write(std::make_pair(DB_TXINDEX_CSAGGREGATE, it.first), av);
+        }
+    }
+    return true;
+}
+
+bool TxIndex::DisconnectCSOutputs(const CBlock& block, const CBlockIndex* pindex_prev)
+{
+    const int height = pindex_prev->nHeight + 1;
     std::set<COutPoint> erasedCSOuts;
+    std::map<ColdStakeIndexAggregateKey, ColdStakeIndexAggregateValue> deltas;
     CDBBatch batch(*m_db);
     for (const auto& tx : block.vtx) {
+        std::map<ColdStakeIndexAggregateKey, CAmount> staked;
         int n = -1;
         for (const auto &o : tx->vpout) {
             n++;
@@ -313,10 +415,26 @@ bool TxIndex::DisconnectBlock(const CBlock& block)
             }
 
             ColdStakeIndexOutputKey ok(tx->GetHash(), n);
+            ColdStakeIndexOutputValue ov;
+            if (m_db->Read(std::make_pair(DB_TXINDEX_CSOUTPUT, ok), ov) && !ov.m_pair.IsNull()) {
+                // Outputs spent in this block were netted out when connecting
+                if (ov.m_spend_height == -1) {
+                    ColdStakeIndexAggregateValue &delta = deltas[ov.m_pair];
+                    delta.m_value += ov.m_value;
+                    delta.m_num_unspent++;
+                }
+                if (tx->IsCoinStake()) {
+                    staked[ov.m_pair] += ov.m_value;
+                }
+                batch.Erase(std::make_pair(DB_TXINDEX_CSLINK, ColdStakeIndexLinkKey(ov.m_pair, height)));
+            }
             batch.Erase(std::make_pair(DB_TXINDEX_CSOUTPUT, ok));
             erasedCSOuts.insert(COutPoint(ok.m_txnid, ok.m_n));
         }
         for (const auto &in : tx->vin) {
+            if (in.IsAnonInput()) {
+                continue;
+            }
             ColdStakeIndexOutputKey ok(in.prevout.hash, in.prevout.n);
             ColdStakeIndexOutputValue ov;
 
@@ -327,13 +445,32 @@ bool TxIndex::DisconnectBlock(const CBlock& block)
                 ov.m_spend_height = -1;
                 ov.m_spend_txid.SetNull();
                 batch.Write(std::make_pair(DB_TXINDEX_CSOUTPUT, ok), ov);
+
+                if (!ov.m_pair.IsNull()) {
+                    ColdStakeIndexAggregateValue &delta = deltas[ov.m_pair];
+                    delta.m_value -= ov.m_value;
+                    delta.m_num_unspent--;
+                    if (tx->IsCoinStake()) {
+                        staked[ov.m_pair] -= ov.m_value;
+                    }
+                }
             }
         }
+        AddCSTxDeltas(staked, deltas);
+    }
+
+    if (!WriteCSAggregates(*m_db, batch, deltas, true)) {
+        return false;
+    }
+    {
+        LOCK(cs_main);
+        batch.Write(DB_TXINDEX_CSBESTBLOCK, ::ChainActive().GetLocator(pindex_prev));
     }
 
     if (!m_db->WriteBatch(batch)) {
         return error("%s: WriteBatch failed.", __func__);
     }
+    m_cs_best_block_index = pindex_prev;
 
     return true;
 }
@@ -343,8 +480,10 @@ bool TxIndex::IndexCSOutputs(const CBlock& block, const CBlockIndex* pindex)
     CDBBatch batch(*m_db);
     std::map<ColdStakeIndexOutputKey, ColdStakeIndexOutputValue> newCSOuts;
     std::map<ColdStakeIndexLinkKey, std::vector<ColdStakeIndexOutputKey> > newCSLinks;
+    std::map<ColdStakeIndexAggregateKey, ColdStakeIndexAggregateValue> deltas;
 
     for (const auto& tx : block.vtx) {
+        std::map<ColdStakeIndexAggregateKey, CAmount> staked;
         int n = -1;
         for (const auto &o : tx->vpout) {
             n++;
@@ -400,11 +539,17 @@ bool TxIndex::IndexCSOutputs(const CBlock& block, const CBlockIndex* pindex)
             ok.m_txnid = tx->GetHash();
             ok.m_n = n;
             ov.m_value = o->GetValue();
+            ov.m_pair = lk.GetPair();
 
             if (tx->IsCoinStake()) {
                 ov.m_flags |= CSI_FROM_STAKE;
+                staked[ov.m_pair] += ov.m_value;
             }
 
+            ColdStakeIndexAggregateValue &delta = deltas[ov.m_pair];
+            delta.m_value += ov.m_value;
+            delta.m_num_unspent++;
+
             newCSOuts[ok] = ov;
             newCSLinks[lk].push_back(ok);
         }
@@ -420,13 +565,26 @@ bool TxIndex::IndexCSOutputs(const CBlock& block, const CBlockIndex* pindex)
             if (it != newCSOuts.end()) {
                 it->second.m_spend_height = pindex->nHeight;
                 it->second.m_spend_txid = tx->GetHash();
+                ov = it->second;
             } else
             if (m_db->Read(std::make_pair(DB_TXINDEX_CSOUTPUT, ok), ov)) {
                 ov.m_spend_height = pindex->nHeight;
                 ov.m_spend_txid = tx->GetHash();
                 batch.Write(std::make_pair(DB_TXINDEX_CSOUTPUT, ok), ov);
+            } else {
+                continue;
+            }
+
+            if (!ov.m_pair.IsNull()) {
+                ColdStakeIndexAggregateValue &delta = deltas[ov.m_pair];
+                delta.m_value -= ov.m_value;
+                delta.m_num_unspent--;
+                if (tx->IsCoinStake()) {
+                    staked[ov.m_pair] -= ov.m_value;
+                }
             }
         }
+        AddCSTxDeltas(staked, deltas);
     }
 
     for (const auto &it : newCSOuts) {
@@ -435,12 +593,19 @@ bool TxIndex::IndexCSOutputs(const CBlock& block, const CBlockIndex* pindex)
     for (const auto &it : newCSLinks) {
         batch.Write(std::make_pair(DB_TXINDEX_CSLINK, it.first), it.second);
     }
+    if (!WriteCSAggregates(*m_db, batch, deltas, false)) {
+        return false;
+    }
 
-    batch.Write(DB_TXINDEX_CSBESTBLOCK, ::ChainActive().GetLocator(pindex));
+    {
+        LOCK(cs_main);
+        batch.Write(DB_TXINDEX_CSBESTBLOCK, ::ChainActive().GetLocator(pindex));
+    }
 
     if (!m_db->WriteBatch(batch)) {
         return error("%s: WriteBatch failed.", __func__);
     }
+    m_cs_best_block_index = pindex;
 
     return true;
 }
@@ -454,19 +619,9 @@ bool TxIndex::FindTx(const uint256& tx_hash, uint256& block_hash, CTransactionRe
         return false;
     }
 
-    CAutoFile file(OpenBlockFile(postx, true), SER_DISK, CLIENT_VERSION);
-    if (file.IsNull()) {
-        return error("%s: OpenBlockFile failed", __func__);
-    }
     CBlockHeader header;
-    try {
-        file >> header;
-        if (fseek(file.Get(), postx.nTxOffset, SEEK_CUR)) {
-            return error("%s: fseek(...) failed", __func__);
-        }
-        file >> tx;
-    } catch (const std::exception& e) {
-        return error("%s: Deserialize or I/O error - %s", __func__, e.what());
+    if (!ReadTransactionFromDiskBlock(postx, postx.nTxOffset, header, tx)) {
+        return false;
     }
     if (tx->GetHash() != tx_hash) {
         return error("%s: txid mismatch", __func__);
@@ -482,18 +637,8 @@ bool TxIndex::FindTx(const uint256& tx_hash, CBlockHeader& header, CTransactionR
         return false;
     }
 
-    CAutoFile file(OpenBlockFile(postx, true), SER_DISK, CLIENT_VERSION);
-    if (file.IsNull()) {
-        return error("%s: OpenBlockFile failed", __func__);
-    }
-    try {
-        file >> header;
-        if (fseek(file.Get(), postx.nTxOffset, SEEK_CUR)) {
-            return error("%s: fseek(...) failed", __func__);
-        }
-        file >> tx;
-    } catch (const std::exception& e) {
-        return error("%s: Deserialize or I/O error - %s", __func__, e.what());
+    if (!ReadTransactionFromDiskBlock(postx, postx.nTxOffset, header, tx)) {
+        return false;
     }
     if (tx->GetHash() != tx_hash) {
         return error("%s: txid mismatch", __func__);
@@ -501,6 +646,49 @@ bool TxIndex::FindTx(const uint256& tx_hash, CBlockHeader& header, CTransactionR
     return true;
 }
 
+bool TxIndex::MoveBlock(const CBlock& block, const FlatFilePos& old_pos, const FlatFilePos& new_pos)
+{
+    CDiskTxPos pos(old_pos, GetSizeOfCompactSize(block.vtx.size()));
+    std::vector<std::pair<uint256, CDiskTxPos>> vPos;
+    for (const auto& tx : block.vtx) {
+        CDiskTxPos postx;
+        if (m_db->ReadTxPos(tx->GetHash(), postx)
+            && postx.nFile == pos.nFile && postx.nPos == pos.nPos && postx.nTxOffset == pos.nTxOffset) {
+            vPos.emplace_back(tx->GetHash(), CDiskTxPos(new_pos, pos.nTxOffset));
+        }
+        pos.nTxOffset += ::GetSerializeSize(*tx, CLIENT_VERSION);
+    }
+    return vPos.empty() || m_db->WriteTxs(vPos);
+}
+
+bool TxIndex::ReadCSAggregates(txnouttype stake_type, const CKeyID256& stake_id,
+    std::vector<std::pair<ColdStakeIndexAggregateKey, ColdStakeIndexAggregateValue> >& aggregates) const
+{
+    ColdStakeIndexAggregateKey seek_key;
+    seek_key.m_stake_type = stake_type;
+    seek_key.m_stake_id = stake_id;
+
+    std::unique_ptr<CDBIterator> it(m_db->NewIterator());
+    it->Seek(std::make_pair(DB_TXINDEX_CSAGGREGATE, seek_key));
+
+    std::pair<char, ColdStakeIndexAggregateKey> key;
+    while (it->Valid() && it->StartsWith(DB_TXINDEX_CSAGGREGATE) && it->GetKey(key)) {
+        if (key.first != DB_TXINDEX_CSAGGREGATE
+            || key.second.m_stake_type != stake_type
+            || key.second.m_stake_id != stake_id) {
+            break;
+        }
+        ColdStakeIndexAggregateValue av;
+        if (!it->GetValue(av)) {
+            return error("%s: Failed to read cold stake aggregate", __func__);
+        }
+        aggregates.emplace_back(key.second, av);
+        it->Next();
+    }
+
+    return true;
+}
+
 bool TxIndex::AppendCSAddress(std::string addr)
 {
     CTxDestination dest = DecodeDestination(addr);
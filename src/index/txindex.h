@@ -7,6 +7,7 @@
 
 #include <chain.h>
 #include <index/base.h>
+#include <insight/csindex.h>
 #include <txdb.h>
 
 class CBlockHeader;
@@ -31,12 +32,20 @@ protected:
     bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) override;
     bool DisconnectBlock(const CBlock& block) override;
 
+    /// Remove the cold stake data of blocks not on the new chain before moving the locator.
+    bool Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip) override;
+
     //BaseIndex::DB& GetDB() const override;
 
     const char* GetName() const override { return "txindex"; }
 
 
     bool IndexCSOutputs(const CBlock& block, const CBlockIndex* pindex);
+    bool DisconnectCSOutputs(const CBlock& block, const CBlockIndex* pindex_prev);
+    bool RewindCSOutputs(const CBlockIndex* new_tip);
+
+    /// Last block applied to the cold stake data, may run ahead of m_best_block_index.
+    std::atomic<const CBlockIndex*> m_cs_best_block_index{nullptr};
 
 public:
     BaseIndex::DB& GetDB() const override;
@@ -56,8 +65,16 @@ public:
     bool FindTx(const uint256& tx_hash, uint256& block_hash, CTransactionRef& tx) const;
     bool FindTx(const uint256& tx_hash, CBlockHeader& header, CTransactionRef& tx) const;
 
+    /// Point the entries of a block rewritten to another position in the block files to the new position.
+    /// Entries of transactions indexed in another block are left alone.
+    bool MoveBlock(const CBlock& block, const FlatFilePos& old_pos, const FlatFilePos& new_pos);
+
     bool AppendCSAddress(std::string addr);
 
+    /// Read the running totals of every spend key paired with a stake key.
+    bool ReadCSAggregates(txnouttype stake_type, const CKeyID256& stake_id,
+        std::vector<std::pair<ColdStakeIndexAggregateKey, ColdStakeIndexAggregateValue> >& aggregates) const;
+
     bool m_cs_index = false;
     std::set<std::vector<uint8_t> > m_cs_index_whitelist;
 };
@@ -0,0 +1,150 @@
+// Copyright (c) 2020 The Graviocoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/voteindex.h>
+
+#include <chain.h>
+#include <util/system.h>
+#include <validation.h>
+
+#include <boost/thread.hpp>
+
+constexpr char DB_VOTEINDEX = 'v';
+
+std::unique_ptr<VoteIndex> g_vote_index;
+
+namespace {
+
+/** Heights are stored big-endian so entries sort by height */
+struct VoteHeightKey {
+    int nHeight;
+
+    explicit VoteHeightKey(int height = 0) : nHeight(height) {}
+
+    template<typename Stream>
+    void Serialize(Stream& s) const {
+        ser_writedata32be(s, nHeight);
+    }
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        nHeight = ser_readdata32be(s);
+    }
+};
+
+} // namespace
+
+/**
+ * Access to the vote index database (indexes/vote/)
+ *
+ * The 4 byte vote token of each coinstake is keyed by block height, blocks
+ * without a coinstake have no entry.
+ */
+class VoteIndex::DB : public BaseIndex::DB
+{
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    bool TallyVotes(int proposal, int nStartHeight, int nEndHeight, std::map<int, int>& mapVotes, int& nBlocks);
+};
+
+VoteIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    BaseIndex::DB(GetDataDir() / "indexes" / "vote", n_cache_size, f_memory, f_wipe)
+{}
+
+bool VoteIndex::DB::TallyVotes(int proposal, int nStartHeight, int nEndHeight, std::map<int, int>& mapVotes, int& nBlocks)
+{
+    const std::unique_ptr<CDBIterator> pcursor(NewIterator());
+
+    pcursor->Seek(std::make_pair(DB_VOTEINDEX, VoteHeightKey(std::max(nStartHeight, 0))));
+
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char, VoteHeightKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_VOTEINDEX || key.second.nHeight > nEndHeight) {
+            break;
+        }
+        uint32_t vote_token;
+        if (!pcursor->GetValue(vote_token)) {
+            return error("%s: Failed to read vote at height %d", __func__, key.second.nHeight);
+        }
+
+        int option = 0; // default to abstain
+        // count only if related to the proposal
+        if ((int) (vote_token & 0xFFFF) == proposal) {
+            option = (vote_token >> 16) & 0xFFFF;
+        }
+        mapVotes[option]++;
+        nBlocks++;
+        pcursor->Next();
+    }
+
+    return true;
+}
+
+VoteIndex::VoteIndex(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : m_db(MakeUnique<VoteIndex::DB>(n_cache_size, f_memory, f_wipe))
+{}
+
+VoteIndex::~VoteIndex() {}
+
+bool VoteIndex::GetVoteToken(const CBlock& block, uint32_t& vote_token)
+{
+    vote_token = 0;
+    if (block.vtx.size() < 1
+        || !block.vtx[0]->IsCoinStake()) {
+        return false;
+    }
+
+    const auto &vpout = block.vtx[0]->vpout;
+    if (vpout.empty() || !vpout[0]->IsType(OUTPUT_DATA)) {
+        return true;
+    }
+    const std::vector<uint8_t> &vData = ((CTxOutData*)vpout[0].get())->vData;
+    if (vData.size() >= 9 && vData[4] == DO_VOTE) {
+        memcpy(&vote_token, &vData[5], 4);
+    }
+    return true;
+}
+
+bool VoteIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    uint32_t vote_token;
+    if (!GetVoteToken(block, vote_token)) {
+        return true;
+    }
+    return m_db->Write(std::make_pair(DB_VOTEINDEX, VoteHeightKey(pindex->nHeight)), vote_token);
+}
+
+bool VoteIndex::Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip)
+{
+    assert(current_tip->GetAncestor(new_tip->nHeight) == new_tip);
+
+    // Erase the entries of the disconnected blocks with the locator change, a new chain may be shorter
+    CDBBatch batch(*m_db);
+    for (int height = new_tip->nHeight + 1; height <= current_tip->nHeight; height++) {
+        batch.Erase(std::make_pair(DB_VOTEINDEX, VoteHeightKey(height)));
+    }
+    {
+        LOCK(cs_main);
+        m_db->WriteBestBlock(batch, ::ChainActive().GetLocator(new_tip));
+    }
+    if (!m_db->WriteBatch(batch)) {
+        return error("%s: Failed to rewind %s to height %d", __func__, GetName(), new_tip->nHeight);
+    }
+    m_best_block_index = new_tip;
+
+    return true;
+}
+
+BaseIndex::DB& VoteIndex::GetDB() const { return *m_db; }
+
+bool VoteIndex::TallyVotes(int proposal, int nStartHeight, int nEndHeight, std::map<int, int>& mapVotes, int& nBlocks) const
+{
+    const CBlockIndex *best_block_index = m_best_block_index.load();
+    if (!best_block_index) {
+        return false;
+    }
+    // Entries above the best block may be left from a longer chain
+    return m_db->TallyVotes(proposal, nStartHeight, std::min(nEndHeight, best_block_index->nHeight), mapVotes, nBlocks);
+}
@@ -0,0 +1,56 @@
+// Copyright (c) 2020 The Graviocoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GIO_INDEX_VOTEINDEX_H
+#define GIO_INDEX_VOTEINDEX_H
+
+#include <index/base.h>
+
+#include <map>
+
+static const bool DEFAULT_VOTEINDEX = false;
+
+/**
+ * VoteIndex records the vote token of each block's coinstake by height
+ * (indexes/vote/), so votes can be tallied without reading blocks.
+ * Enabled by -voteindex.
+ */
+class VoteIndex final : public BaseIndex
+{
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+protected:
+    bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) override;
+
+    /// Entries are keyed by height, erase those above the new tip.
+    bool Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip) override;
+
+    BaseIndex::DB& GetDB() const override;
+
+    const char* GetName() const override { return "voteindex"; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit VoteIndex(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~VoteIndex() override;
+
+    /// Get the vote token of a block, 0 if the coinstake carries no vote.
+    /// Returns false if the block has no coinstake.
+    static bool GetVoteToken(const CBlock& block, uint32_t& vote_token);
+
+    /// Count the options voted for proposal by the coinstakes of blocks nStartHeight to nEndHeight,
+    /// votes for other proposals and blocks without a vote count as option 0 (abstain).
+    bool TallyVotes(int proposal, int nStartHeight, int nEndHeight, std::map<int, int>& mapVotes, int& nBlocks) const;
+};
+
+/// The global vote index. May be null.
+extern std::unique_ptr<VoteIndex> g_vote_index;
+
+#endif // GIO_INDEX_VOTEINDEX_H
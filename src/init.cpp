@@ -20,8 +20,12 @@
 #include <fs.h>
 #include <httprpc.h>
 #include <httpserver.h>
+#include <index/addressindex.h>
 #include <index/blockfilterindex.h>
+#include <index/spentindex.h>
+#include <index/timestampindex.h>
 #include <index/txindex.h>
+#include <index/voteindex.h>
 #include <interfaces/chain.h>
 #include <key.h>
 #include <miner.h>
@@ -29,6 +33,7 @@
 #include <net_permissions.h>
 #include <net_processing.h>
 #include <netbase.h>
+#include <node/blockindexsnapshot.h>
 #include <node/context.h>
 #include <policy/feerate.h>
 #include <policy/fees.h>
@@ -256,6 +261,18 @@ void Interrupt(NodeContext& node)
     if (g_txindex) {
         g_txindex->Interrupt();
     }
+    if (g_address_index) {
+        g_address_index->Interrupt();
+    }
+    if (g_spent_index) {
+        g_spent_index->Interrupt();
+    }
+    if (g_timestamp_index) {
+        g_timestamp_index->Interrupt();
+    }
+    if (g_vote_index) {
+        g_vote_index->Interrupt();
+    }
     ForEachBlockFilterIndex([](BlockFilterIndex& index) { index.Interrupt(); });
 }
 
@@ -292,6 +309,10 @@ void Shutdown(NodeContext& node)
     if (node.peer_logic) UnregisterValidationInterface(node.peer_logic.get());
     if (node.connman) node.connman->Stop();
     if (g_txindex) g_txindex->Stop();
+    if (g_address_index) g_address_index->Stop();
+    if (g_spent_index) g_spent_index->Stop();
+    if (g_timestamp_index) g_timestamp_index->Stop();
+    if (g_vote_index) g_vote_index->Stop();
     ForEachBlockFilterIndex([](BlockFilterIndex& index) { index.Stop(); });
 
     StopTorControl();
@@ -307,6 +328,10 @@ void Shutdown(NodeContext& node)
     node.connman.reset();
     node.banman.reset();
     g_txindex.reset();
+    g_address_index.reset();
+    g_spent_index.reset();
+    g_timestamp_index.reset();
+    g_vote_index.reset();
     DestroyAllBlockFilterIndexes();
 
     if (::mempool.IsLoaded() && gArgs.GetArg("-persistmempool", DEFAULT_PERSIST_MEMPOOL)) {
@@ -349,10 +374,18 @@ void Shutdown(NodeContext& node)
     {
         LOCK(cs_main);
         if (g_chainstate && g_chainstate->CanFlushToDisk()) {
-            g_chainstate->ForceFlushStateToDisk();
+            BlockValidationState state;
+            if (!g_chainstate->FlushStateToDisk(Params(), state, FlushStateMode::ALWAYS)) {
+                LogPrintf("%s: failed to flush state (%s)\n", __func__, FormatStateMessage(state));
+            } else if (pblocktree && !fReindex && !::BlockIndex().empty()
+                && gArgs.GetBoolArg("-blockindexsnapshot", DEFAULT_BLOCK_INDEX_SNAPSHOT)) {
+                // The block index was flushed, the snapshot matches the block tree db
+                WriteBlockIndexSnapshot(*pblocktree, ::BlockIndex());
+            }
             g_chainstate->ResetCoinsViews();
         }
         pblocktree.reset();
+        prctdb.reset();
     }
     for (const auto& client : node.chain_clients) {
         client->stop();
@@ -465,6 +498,8 @@ void SetupServerArgs()
     gArgs.AddArg("-alertnotify=<cmd>", "Execute command when a relevant alert is received or we see a really long fork (%s in cmd is replaced by message)", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
 #endif
     gArgs.AddArg("-assumevalid=<hex>", strprintf("If this block is in the chain assume that it and its ancestors are valid and potentially skip their script verification (0 to verify all, default: %s, testnet: %s)", defaultChainParams->GetConsensus().defaultAssumeValid.GetHex(), testnetChainParams->GetConsensus().defaultAssumeValid.GetHex()), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-blockcompression", strprintf("Store blocks and undo data LZ4 compressed, existing block files are converted in the background, not done when pruning (default: %u)", DEFAULT_BLOCK_COMPRESSION), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-blockindexsnapshot", strprintf("Write a snapshot of the block index at shutdown to speed up the next start (default: %u)", DEFAULT_BLOCK_INDEX_SNAPSHOT), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::OPTIONS);
     gArgs.AddArg("-blocksdir=<dir>", "Specify directory to hold blocks subdirectory for *.dat files (default: <datadir>)", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
 #if HAVE_SYSTEM
     gArgs.AddArg("-blocknotify=<cmd>", "Execute command when the best block changes (%s in cmd is replaced by block hash)", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
@@ -498,6 +533,7 @@ void SetupServerArgs()
 #else
     hidden_args.emplace_back("-sysperms");
 #endif
+    gArgs.AddArg("-txprevalidationthreads=<n>", strprintf("Number of threads verifying the range proofs and MLSAG signatures of transactions received from peers before they are accepted to the mempool, 0 verifies them on the message handler thread (0 to %d, default: %d)", MAX_TX_PREVALIDATION_THREADS, DEFAULT_TX_PREVALIDATION_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     gArgs.AddArg("-txindex", strprintf("Maintain a full transaction index, used by the getrawtransaction rpc call (default: %u)", DEFAULT_TXINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     gArgs.AddArg("-blockfilterindex=<type>",
                  strprintf("Maintain an index of compact filters by block (default: %s, values: %s).", DEFAULT_BLOCKFILTERINDEX, ListBlockFilterTypes()) +
@@ -507,6 +543,7 @@ void SetupServerArgs()
     gArgs.AddArg("-addressindex", strprintf("Maintain a full address index, used to query for the balance, txids and unspent outputs for addresses (default: %u)", DEFAULT_ADDRESSINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     gArgs.AddArg("-timestampindex", strprintf("Maintain a timestamp index for block hashes, used to query blocks hashes by a range of timestamps (default: %u)", DEFAULT_TIMESTAMPINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     gArgs.AddArg("-spentindex", strprintf("Maintain a full spent index, used to query the spending txid and input index for an outpoint (default: %u)", DEFAULT_SPENTINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-voteindex", strprintf("Maintain an index of the votes in coinstakes, used by the tallyvotes rpc call (default: %u)", DEFAULT_VOTEINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     gArgs.AddArg("-csindex", strprintf("Maintain an index of outputs by coldstaking address (default: %u)", DEFAULT_CSINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     gArgs.AddArg("-cswhitelist", strprintf("Only index coldstaked outputs with matching stake address. Can be specified multiple times."), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
 
@@ -588,6 +625,8 @@ void SetupServerArgs()
 
     gArgs.AddArg("-zmqpubhashwtx=<address>", "Enable publish hash transaction received by wallets in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     gArgs.AddArg("-zmqpubsmsg=<address>", "Enable publish secure message in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqpubsequence=<address>", "Enable publish block connect and disconnect, mempool acceptance and removal, wallet transaction and secure message events in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqpubsequencehwm=<n>", strprintf("Set publish sequence outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     gArgs.AddArg("-serverkeyzmq=<secret_key>", "Base64 encoded string of the z85 encoded secret key for CurveZMQ.", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     gArgs.AddArg("-newserverkeypairzmq", "Generate new key pair for CurveZMQ, print and exit.", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     gArgs.AddArg("-whitelistzmq=<IP address or network>", "Whitelist peers connecting from the given IP address (e.g. 1.2.3.4) or CIDR notated network (e.g. 1.2.3.0/24). Can be specified multiple times.", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
@@ -604,6 +643,8 @@ void SetupServerArgs()
 
     hidden_args.emplace_back("-zmqpubhashwtx=<address>");
     hidden_args.emplace_back("-zmqpubsmsg=<address>");
+    hidden_args.emplace_back("-zmqpubsequence=<address>");
+    hidden_args.emplace_back("-zmqpubsequencehwm=<n>");
     hidden_args.emplace_back("-serverkeyzmq=<secret_key>");
     hidden_args.emplace_back("-newserverkeypairzmq");
     hidden_args.emplace_back("-whitelistzmq=<IP address or network>");
@@ -623,6 +664,7 @@ void SetupServerArgs()
     gArgs.AddArg("-checkpoints", strprintf("Enable rejection of any forks from the known historical chain until block 295000 (default: %u)", DEFAULT_CHECKPOINTS_ENABLED), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-deprecatedrpc=<method>", "Allows deprecated RPC method(s) to be used", ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-dropmessagestest=<n>", "Randomly drop 1 of every <n> network messages", ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
+    gArgs.AddArg("-fastprune", "Use smaller block files for testing purposes", ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-stopafterblockimport", strprintf("Stop running after importing blocks from disk (default: %u)", DEFAULT_STOPAFTERBLOCKIMPORT), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-stopatheight", strprintf("Stop running after reaching the given height in the main chain (default: %u)", DEFAULT_STOPATHEIGHT), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-limitancestorcount=<n>", strprintf("Do not accept transactions if number of in-mempool ancestors is <n> or more (default: %u)", DEFAULT_ANCESTOR_LIMIT), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
@@ -666,6 +708,7 @@ void SetupServerArgs()
     gArgs.AddArg("-rest", strprintf("Accept public REST requests (default: %u)", DEFAULT_REST_ENABLE), ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
     gArgs.AddArg("-rpcallowip=<ip>", "Allow JSON-RPC connections from specified source. Valid for <ip> are a single IP (e.g. 1.2.3.4), a network/netmask (e.g. 1.2.3.4/255.255.255.0) or a network/CIDR (e.g. 1.2.3.4/24). This option can be specified multiple times", ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
     gArgs.AddArg("-rpcauth=<userpw>", "Username and HMAC-SHA-256 hashed password for JSON-RPC connections. The field <userpw> comes in the format: <USERNAME>:<SALT>$<HASH>. A canonical python script is included in share/rpcauth. The client then connects normally using the rpcuser=<USERNAME>/rpcpassword=<PASSWORD> pair of arguments. This option can be specified multiple times", ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
+    gArgs.AddArg("-rpcbatchthreads=<n>", strprintf("Set the number of -rpcthreads threads the calls of one JSON-RPC batch request are executed on at once, calls of a batch then complete in any order (default: %d)", DEFAULT_HTTP_BATCH_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
     gArgs.AddArg("-rpcbind=<addr>[:port]", "Bind to given address to listen for JSON-RPC connections. Do not expose the RPC server to untrusted networks such as the public internet! This option is ignored unless -rpcallowip is also passed. Port is optional and overrides -rpcport. Use [host]:port notation for IPv6. This option can be specified multiple times (default: 127.0.0.1 and ::1 i.e., localhost)", ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
     gArgs.AddArg("-rpccookiefile=<loc>", "Location of the auth cookie. Relative paths will be prefixed by a net-specific datadir location. (default: data dir)", ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
     gArgs.AddArg("-rpcpassword=<pw>", "Password for JSON-RPC connections", ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
@@ -800,6 +843,20 @@ static void CleanupBlockRevFiles()
     }
 }
 
+/** Return the highest numbered blk?????.dat file in the blocks directory, or -1 if there are none */
+static int GetLastBlockFileOnDisk()
+{
+    int nLastFile = -1;
+    for (fs::directory_iterator it(GetBlocksDir()); it != fs::directory_iterator(); it++) {
+        const std::string filename = it->path().filename().string();
+        if (fs::is_regular_file(*it) && filename.length() == 12 &&
+            filename.substr(0, 3) == "blk" && filename.substr(8, 4) == ".dat") {
+            nLastFile = std::max(nLastFile, atoi(filename.substr(3, 5)));
+        }
+    }
+    return nLastFile;
+}
+
 static void ThreadImport(std::vector<fs::path> vImportFiles)
 {
     const CChainParams& chainparams = Params();
@@ -812,11 +869,18 @@ static void ThreadImport(std::vector<fs::path> vImportFiles)
 
     // -reindex
     if (fReindex) {
+        // Block files compressed in the background leave gaps, -prune removed any files after a gap
+        int nLastFile = fPruneMode ? -1 : GetLastBlockFileOnDisk();
         int nFile = 0;
         while (true) {
             FlatFilePos pos(nFile, 0);
-            if (!fs::exists(GetBlockPosFilename(pos)))
+            if (!fs::exists(GetBlockPosFilename(pos))) {
+                if (nFile < nLastFile) {
+                    nFile++;
+                    continue;
+                }
                 break; // No block files left to reindex
+            }
             FILE *file = OpenBlockFile(pos, true);
             if (!file)
                 break; // This error is logged in OpenBlockFile
@@ -866,6 +930,10 @@ static void ThreadImport(std::vector<fs::path> vImportFiles)
     }
     fBusyImporting = false;
     ::mempool.SetIsLoaded(!ShutdownRequested());
+
+    if (g_block_compression && !fPruneMode) {
+        CompressBlockFiles(chainparams);
+    }
 }
 
 /** Sanity checks
@@ -1121,6 +1189,7 @@ bool AppInitParameterInteraction()
         CHECK_ARG_FOR_PRUNE_MODE("-timestampindex", DEFAULT_TIMESTAMPINDEX)
         CHECK_ARG_FOR_PRUNE_MODE("-spentindex", DEFAULT_SPENTINDEX)
         CHECK_ARG_FOR_PRUNE_MODE("-csindex", DEFAULT_CSINDEX)
+        CHECK_ARG_FOR_PRUNE_MODE("-voteindex", DEFAULT_VOTEINDEX)
         #undef CHECK_ARG_FOR_PRUNE_MODE
     }
 
@@ -1241,6 +1310,8 @@ bool AppInitParameterInteraction()
         fPruneMode = false;
     }
 
+    g_block_compression = gArgs.GetBoolArg("-blockcompression", DEFAULT_BLOCK_COMPRESSION);
+
     nConnectTimeout = gArgs.GetArg("-timeout", DEFAULT_CONNECT_TIMEOUT);
     if (nConnectTimeout <= 0) {
         nConnectTimeout = DEFAULT_CONNECT_TIMEOUT;
@@ -1428,6 +1499,8 @@ bool AppInitMain(NodeContext& node)
     script_threads = std::min(script_threads, MAX_SCRIPTCHECK_THREADS);
 
     LogPrintf("Script verification uses %d additional threads\n", script_threads);
+    // Blocks read by -reindex and -loadblock, and the proofs of transactions in mempool.dat, are checked on as many threads as scripts
+    g_import_check_threads = script_threads + 1;
     if (script_threads >= 1) {
         g_parallel_script_checks = true;
         for (int i = 0; i < script_threads; ++i) {
@@ -1626,20 +1699,26 @@ bool AppInitMain(NodeContext& node)
     nTotalCache = std::max(nTotalCache, nMinDbCache << 20); // total cache cannot be less than nMinDbCache
     nTotalCache = std::min(nTotalCache, nMaxDbCache << 20); // total cache cannot be greater than nMaxDbcache
     int64_t nBlockTreeDBCache = nTotalCache / 8;
-
-    if (gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX) || gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX))
-    {
-        // enable 3/4 of the cache if addressindex and/or spentindex is enabled
-        nBlockTreeDBCache = nTotalCache * 3 / 4;
-    } else
-    {
-        nBlockTreeDBCache = std::min(nBlockTreeDBCache, (gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX) ? nMaxTxIndexCache : nMaxBlockDBCache) << 20);
-    };
-
-    //int64_t nBlockTreeDBCache = std::min(nTotalCache / 8, nMaxBlockDBCache << 20);
+    nBlockTreeDBCache = std::min(nBlockTreeDBCache, (gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX) ? nMaxTxIndexCache : nMaxBlockDBCache) << 20);
     nTotalCache -= nBlockTreeDBCache;
+    // Every anon output and spent key image is looked up while connecting blocks
+    int64_t nRCTDBCache = std::min(nTotalCache / 8, nMaxRCTDBCache << 20);
+    nTotalCache -= nRCTDBCache;
     int64_t nTxIndexCache = std::min(nTotalCache / 8, gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX) ? nMaxTxIndexCache << 20 : 0);
     nTotalCache -= nTxIndexCache;
+    fAddressIndex = gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX);
+    fSpentIndex = gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX);
+    fTimestampIndex = gArgs.GetBoolArg("-timestampindex", DEFAULT_TIMESTAMPINDEX);
+    int64_t insight_index_cache = 0;
+    size_t n_insight_indexes = (fAddressIndex ? 1 : 0) + (fSpentIndex ? 1 : 0) + (fTimestampIndex ? 1 : 0);
+    if (n_insight_indexes > 0) {
+        // The address and spent indexes are read per request, give them a larger share than the txindex
+        insight_index_cache = nTotalCache / 4 / n_insight_indexes;
+        nTotalCache -= insight_index_cache * n_insight_indexes;
+    }
+    // One small record per block
+    int64_t vote_index_cache = std::min(nTotalCache / 16, gArgs.GetBoolArg("-voteindex", DEFAULT_VOTEINDEX) ? (int64_t)8 << 20 : 0);
+    nTotalCache -= vote_index_cache;
     int64_t filter_index_cache = 0;
     if (!g_enabled_filter_types.empty()) {
         size_t n_indexes = g_enabled_filter_types.size();
@@ -1655,9 +1734,16 @@ bool AppInitMain(NodeContext& node)
     LogPrintf("Cache configuration:\n");
     LogPrintf("* Max cache setting possible %.1fMiB\n", nMaxDbCache);
     LogPrintf("* Using %.1f MiB for block index database\n", nBlockTreeDBCache * (1.0 / 1024 / 1024));
+    LogPrintf("* Using %.1f MiB for RingCT database\n", nRCTDBCache * (1.0 / 1024 / 1024));
     if (gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX)) {
         LogPrintf("* Using %.1f MiB for transaction index database\n", nTxIndexCache * (1.0 / 1024 / 1024));
     }
+    if (n_insight_indexes > 0) {
+        LogPrintf("* Using %.1f MiB for each insight index database\n", insight_index_cache * (1.0 / 1024 / 1024));
+    }
+    if (gArgs.GetBoolArg("-voteindex", DEFAULT_VOTEINDEX)) {
+        LogPrintf("* Using %.1f MiB for vote index database\n", vote_index_cache * (1.0 / 1024 / 1024));
+    }
     for (BlockFilterType filter_type : g_enabled_filter_types) {
         LogPrintf("* Using %.1f MiB for %s block filter index database\n",
                   filter_index_cache * (1.0 / 1024 / 1024), BlockFilterTypeName(filter_type));
@@ -1669,6 +1755,7 @@ bool AppInitMain(NodeContext& node)
     bool fLoaded = false;
     while (!fLoaded && !ShutdownRequestedMainThread()) {
         bool fReset = fReindex;
+        bool fRetryLoad = false;
         std::string strLoadError;
 
         uiInterface.InitMessage(_("Loading block index...").translated);
@@ -1695,6 +1782,10 @@ bool AppInitMain(NodeContext& node)
                     pblocktree.reset(new CBlockTreeDB(nBlockTreeDBCache, false, fReset));
                 }
 
+                // The RingCT data is rebuilt with the chainstate
+                prctdb.reset();
+                prctdb.reset(new CRCTDB(nRCTDBCache, false, fReset || fReindexChainState));
+
                 if (fReset) {
                     pblocktree->WriteReindexing(true);
                     //If we're reindexing in prune mode, wipe away unusable block files and all undo data files
@@ -1721,24 +1812,6 @@ bool AppInitMain(NodeContext& node)
                     return InitError(_("Incorrect or no genesis block found. Wrong datadir for network?").translated);
                 }
 
-                // Check for changed -addressindex state
-                if (fAddressIndex != gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX)) {
-                    strLoadError = _("You need to rebuild the database using -reindex to change -addressindex").translated;
-                    break;
-                }
-
-                // Check for changed -spentindex state
-                if (fSpentIndex != gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX)) {
-                    strLoadError = _("You need to rebuild the database using -reindex to change -spentindex").translated;
-                    break;
-                }
-
-                // Check for changed -timestampindex state
-                if (fTimestampIndex != gArgs.GetBoolArg("-timestampindex", DEFAULT_TIMESTAMPINDEX)) {
-                    strLoadError = _("You need to rebuild the database using -reindex to change -timestampindex").translated;
-                    break;
-                }
-
                 // Check for changed -prune state.  What we are concerned about is a user who has pruned blocks
                 // in the past, but is now trying to run unpruned.
                 if (fHavePruned && !fPruneMode) {
@@ -1776,6 +1849,16 @@ bool AppInitMain(NodeContext& node)
                     break;
                 }
 
+                // A block index snapshot must have been written with the chainstate now on disk,
+                // else load again, the snapshot marker is gone so the block tree db is read.
+                const uint256 snapshot_best_block = GetBlockIndexSnapshotBestBlock();
+                if (!snapshot_best_block.IsNull() && !fReset && !fReindexChainState
+                    && snapshot_best_block != ::ChainstateActive().CoinsDB().GetBestBlock()) {
+                    LogPrintf("Block index snapshot best block %s does not match the coin database, reading the block tree db\n", snapshot_best_block.ToString());
+                    fRetryLoad = true;
+                    break;
+                }
+
                 // ReplayBlocks is a no-op if we cleared the coinsviewdb with -reindex or -reindex-chainstate
                 if (!::ChainstateActive().ReplayBlocks(chainparams)) {
                     strLoadError = _("Unable to replay blocks. You will need to rebuild the database using -reindex-chainstate.").translated;
@@ -1850,6 +1933,9 @@ bool AppInitMain(NodeContext& node)
             LogPrintf(" block index %15dms\n", GetTimeMillis() - load_block_index_start_time);
         } while(false);
 
+        if (fRetryLoad) {
+            continue;
+        }
         if (!fLoaded && !ShutdownRequestedMainThread()) {
             // first suggest a reindex
             if (!fReset) {
@@ -1893,6 +1979,16 @@ bool AppInitMain(NodeContext& node)
     // ********************************************************* Step 8: start indexers
     SetCoreWriteGetSpentIndex(&GetSpentIndex);
 
+    if (gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX) || !g_enabled_filter_types.empty()
+        || fAddressIndex || fSpentIndex || fTimestampIndex || gArgs.GetBoolArg("-voteindex", DEFAULT_VOTEINDEX)) {
+        LOCK(cs_main);
+        // Blocks below the base of a loaded utxo snapshot are not stored, indexes can't read them
+        const CBlockIndex *pindex = ::ChainActive()[1];
+        if (pindex && (pindex->nFlags & BLOCK_SNAPSHOT)) {
+            return InitError(_("The chain was loaded from a UTXO snapshot, restart with -txindex=0 and the address, spent, timestamp, vote and block filter indexes disabled.").translated);
+        }
+    }
+
     if (gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX)) {
         g_txindex = MakeUnique<TxIndex>(nTxIndexCache, false, fReindex);
 
@@ -1910,6 +2006,23 @@ bool AppInitMain(NodeContext& node)
         GetBlockFilterIndex(filter_type)->Start();
     }
 
+    if (fAddressIndex) {
+        g_address_index = MakeUnique<AddressIndex>(insight_index_cache, false, fReindex);
+        g_address_index->Start();
+    }
+    if (fSpentIndex) {
+        g_spent_index = MakeUnique<SpentIndex>(insight_index_cache, false, fReindex);
+        g_spent_index->Start();
+    }
+    if (fTimestampIndex) {
+        g_timestamp_index = MakeUnique<TimestampIndex>(insight_index_cache, false, fReindex);
+        g_timestamp_index->Start();
+    }
+    if (gArgs.GetBoolArg("-voteindex", DEFAULT_VOTEINDEX)) {
+        g_vote_index = MakeUnique<VoteIndex>(vote_index_cache, false, fReindex);
+        g_vote_index->Start();
+    }
+
     // ********************************************************* Step 9: load wallet
     for (const auto& client : node.chain_clients) {
         if (!client->load()) {
@@ -193,6 +193,40 @@ struct CAddressIndexIteratorKey {
     }
 };
 
+/** Running totals for an address, keyed by CAddressIndexIteratorKey */
+struct CAddressBalanceValue {
+    CAmount received;
+    CAmount sent;
+    uint32_t txCount;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(received);
+        READWRITE(sent);
+        READWRITE(txCount);
+    }
+
+    CAddressBalanceValue() {
+        SetNull();
+    }
+
+    void SetNull() {
+        received = 0;
+        sent = 0;
+        txCount = 0;
+    }
+
+    bool IsNull() const {
+        return received == 0 && sent == 0 && txCount == 0;
+    }
+
+    CAmount GetBalance() const {
+        return received - sent;
+    }
+};
+
 struct CAddressIndexIteratorHeightKey {
     unsigned int type;
     uint256 hashBytes;
@@ -231,6 +265,98 @@ struct CAddressIndexIteratorHeightKey {
     }
 };
 
+/** Position of a transaction in the chain, paged address index reads continue after it */
+struct CAddressIndexCursor {
+    int blockHeight;
+    unsigned int txindex;
+
+    CAddressIndexCursor() {
+        SetNull();
+    }
+
+    CAddressIndexCursor(int height, unsigned int blockindex) {
+        blockHeight = height;
+        txindex = blockindex;
+    }
+
+    explicit CAddressIndexCursor(const CAddressIndexKey &key) {
+        blockHeight = key.blockHeight;
+        txindex = key.txindex;
+    }
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(blockHeight);
+        READWRITE(txindex);
+    }
+
+    void SetNull() {
+        blockHeight = -1;
+        txindex = 0;
+    }
+
+    bool IsNull() const {
+        return blockHeight < 0;
+    }
+
+    friend bool operator==(const CAddressIndexCursor &a, const CAddressIndexCursor &b) {
+        return a.blockHeight == b.blockHeight && a.txindex == b.txindex;
+    }
+
+    friend bool operator!=(const CAddressIndexCursor &a, const CAddressIndexCursor &b) {
+        return !(a == b);
+    }
+
+    friend bool operator<(const CAddressIndexCursor &a, const CAddressIndexCursor &b) {
+        return a.blockHeight < b.blockHeight || (a.blockHeight == b.blockHeight && a.txindex < b.txindex);
+    }
+};
+
+struct CAddressIndexIteratorPositionKey {
+    unsigned int type;
+    uint256 hashBytes;
+    int blockHeight;
+    unsigned int txindex;
+
+    size_t GetSerializeSize() const {
+        return 41;
+    }
+    template<typename Stream>
+    void Serialize(Stream& s) const {
+        ser_writedata8(s, type);
+        hashBytes.Serialize(s);
+        ser_writedata32be(s, blockHeight);
+        ser_writedata32be(s, txindex);
+    }
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        type = ser_readdata8(s);
+        hashBytes.Unserialize(s);
+        blockHeight = ser_readdata32be(s);
+        txindex = ser_readdata32be(s);
+    }
+
+    CAddressIndexIteratorPositionKey(unsigned int addressType, uint256 addressHash, int height, unsigned int blockindex) {
+        type = addressType;
+        hashBytes = addressHash;
+        blockHeight = height;
+        txindex = blockindex;
+    }
+
+    CAddressIndexIteratorPositionKey() {
+        SetNull();
+    }
+
+    void SetNull() {
+        type = ADDR_INDT_UNKNOWN;
+        hashBytes.SetNull();
+        blockHeight = 0;
+        txindex = 0;
+    }
+};
+
 struct CMempoolAddressDelta
 {
     int64_t time;
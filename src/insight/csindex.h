@@ -10,6 +10,11 @@
 constexpr char DB_TXINDEX_CSOUTPUT = 'O';
 constexpr char DB_TXINDEX_CSLINK = 'L';
 constexpr char DB_TXINDEX_CSBESTBLOCK = 'C';
+constexpr char DB_TXINDEX_CSAGGREGATE = 'G';
+constexpr char DB_TXINDEX_CSVERSION = 'V';
+
+/** Outputs indexed by older versions carry no aggregate key, a lower stored version triggers a resync */
+static const int CSINDEX_VERSION = 1;
 
 enum CSIndexFlags
 {
@@ -42,22 +47,104 @@ public:
     }
 };
 
-class ColdStakeIndexOutputValue
+/** Stake and spend key pair an output pays to, aggregates are kept per pair */
+class ColdStakeIndexAggregateKey
 {
 public:
-    CAmount m_value = 0;
-    uint8_t m_flags = 0; // Mark outputs resulting from coldstaking
-    int m_spend_height = -1;
-    uint256 m_spend_txid;
+    txnouttype m_stake_type = TX_NONSTANDARD, m_spend_type = TX_NONSTANDARD;
+    CKeyID256 m_stake_id, m_spend_id;
+
+    bool IsNull() const { return m_stake_type == TX_NONSTANDARD; }
+
+    template<typename Stream>
+    void Serialize(Stream& s) const {
+        ser_writedata8(s, m_stake_type);
+        s.write((char*)m_stake_id.begin(), (m_stake_type == TX_PUBKEYHASH256) ? 32 : 20);
+        ser_writedata8(s, m_spend_type);
+        s.write((char*)m_spend_id.begin(), (m_spend_type == TX_PUBKEYHASH256 || m_spend_type == TX_SCRIPTHASH256) ? 32 : 20);
+    }
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        m_stake_type = (txnouttype) ser_readdata8(s);
+        m_stake_id.SetNull();
+        s.read((char*)m_stake_id.begin(), (m_stake_type == TX_PUBKEYHASH256) ? 32 : 20);
+        m_spend_type = (txnouttype) ser_readdata8(s);
+        m_spend_id.SetNull();
+        s.read((char*)m_spend_id.begin(), (m_spend_type == TX_PUBKEYHASH256 || m_spend_type == TX_SCRIPTHASH256) ? 32 : 20);
+    }
+
+    friend bool operator<(const ColdStakeIndexAggregateKey& a, const ColdStakeIndexAggregateKey& b) {
+        if (a.m_stake_type != b.m_stake_type) return a.m_stake_type < b.m_stake_type;
+        int cmp = a.m_stake_id.Compare(b.m_stake_id);
+        if (cmp < 0) return true;
+        if (cmp > 0) return false;
+        if (a.m_spend_type != b.m_spend_type) return a.m_spend_type < b.m_spend_type;
+        return a.m_spend_id.Compare(b.m_spend_id) < 0;
+    }
+};
+
+/** Running totals of a stake and spend key pair */
+class ColdStakeIndexAggregateValue
+{
+public:
+    CAmount m_value = 0;            // Value of the unspent outputs
+    int64_t m_num_unspent = 0;
+    CAmount m_staked = 0;           // Rewards staked by the pair's outputs
 
     ADD_SERIALIZE_METHODS;
 
     template <typename Stream, typename Operation>
     inline void SerializationOp(Stream& s, Operation ser_action) {
         READWRITE(m_value);
-        READWRITE(m_flags);
-        READWRITE(m_spend_height);
-        READWRITE(m_spend_txid);
+        READWRITE(m_num_unspent);
+        READWRITE(m_staked);
+    }
+
+    bool IsNull() const {
+        return m_value == 0 && m_num_unspent == 0 && m_staked == 0;
+    }
+
+    ColdStakeIndexAggregateValue& operator+=(const ColdStakeIndexAggregateValue& b) {
+        m_value += b.m_value;
+        m_num_unspent += b.m_num_unspent;
+        m_staked += b.m_staked;
+        return *this;
+    }
+    ColdStakeIndexAggregateValue& operator-=(const ColdStakeIndexAggregateValue& b) {
+        m_value -= b.m_value;
+        m_num_unspent -= b.m_num_unspent;
+        m_staked -= b.m_staked;
+        return *this;
+    }
+};
+
+class ColdStakeIndexOutputValue
+{
+public:
+    CAmount m_value = 0;
+    uint8_t m_flags = 0; // Mark outputs resulting from coldstaking
+    int m_spend_height = -1;
+    uint256 m_spend_txid;
+    ColdStakeIndexAggregateKey m_pair; // Null for outputs indexed before CSINDEX_VERSION 1
+
+    template<typename Stream>
+    void Serialize(Stream& s) const {
+        ::Serialize(s, m_value);
+        ::Serialize(s, m_flags);
+        ::Serialize(s, m_spend_height);
+        ::Serialize(s, m_spend_txid);
+        ::Serialize(s, m_pair);
+    }
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        ::Unserialize(s, m_value);
+        ::Unserialize(s, m_flags);
+        ::Unserialize(s, m_spend_height);
+        ::Unserialize(s, m_spend_txid);
+        m_pair = ColdStakeIndexAggregateKey();
+        if (!s.empty()) {
+            ::Unserialize(s, m_pair);
+        }
     }
 };
 
@@ -68,6 +155,20 @@ public:
     CKeyID256 m_stake_id, m_spend_id;
     unsigned int m_height = 0;
 
+    ColdStakeIndexLinkKey() {};
+    ColdStakeIndexLinkKey(const ColdStakeIndexAggregateKey& pair, unsigned int height)
+        : m_stake_type(pair.m_stake_type), m_spend_type(pair.m_spend_type),
+          m_stake_id(pair.m_stake_id), m_spend_id(pair.m_spend_id), m_height(height) {};
+
+    ColdStakeIndexAggregateKey GetPair() const {
+        ColdStakeIndexAggregateKey pair;
+        pair.m_stake_type = m_stake_type;
+        pair.m_spend_type = m_spend_type;
+        pair.m_stake_id = m_stake_id;
+        pair.m_spend_id = m_spend_id;
+        return pair;
+    }
+
     template<typename Stream>
     void Serialize(Stream& s) const {
         ser_writedata8(s, m_stake_type);
@@ -6,8 +6,10 @@
 #include <insight/addressindex.h>
 #include <insight/spentindex.h>
 #include <insight/timestampindex.h>
+#include <index/addressindex.h>
+#include <index/spentindex.h>
+#include <index/timestampindex.h>
 #include <validation.h>
-#include <txdb.h>
 #include <txmempool.h>
 #include <uint256.h>
 #include <script/script.h>
@@ -76,10 +78,10 @@ bool ExtractIndexInfo(const CTxOutBase *out, int &scriptType, std::vector<uint8_
 
 bool GetTimestampIndex(const unsigned int &high, const unsigned int &low, const bool fActiveOnly, std::vector<std::pair<uint256, unsigned int> > &hashes)
 {
-    if (!fTimestampIndex) {
+    if (!g_timestamp_index) {
         return error("Timestamp index not enabled");
     }
-    if (!pblocktree->ReadTimestampIndex(high, low, fActiveOnly, hashes)) {
+    if (!g_timestamp_index->ReadTimestampIndex(high, low, fActiveOnly, hashes)) {
         return error("Unable to get hashes for timestamps");
     }
 
@@ -94,7 +96,7 @@ bool GetSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value)
     if (mempool.getSpentIndex(key, value)) {
         return true;
     }
-    if (!pblocktree->ReadSpentIndex(key, value)) {
+    if (!g_spent_index || !g_spent_index->ReadSpentIndex(key, value)) {
         return false;
     }
 
@@ -113,31 +115,113 @@ bool HashOnchainActive(const uint256 &hash)
 };
 
 bool GetAddressIndex(uint256 addressHash, int type,
-                     std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex, int start, int end)
+                     std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex, int start, int end,
+                     const CAddressIndexCursor &after, size_t max_txns)
 {
-    if (!fAddressIndex) {
+    if (!g_address_index) {
         return error("Address index not enabled");
     }
-    if (!pblocktree->ReadAddressIndex(addressHash, type, addressIndex, start, end)) {
+    if (!g_address_index->ReadAddressIndex(addressHash, type, addressIndex, start, end, after, max_txns)) {
         return error("Unable to get txids for address");
     }
 
     return true;
 };
 
+bool GetAddressBalance(uint256 addressHash, int type, CAddressBalanceValue &value)
+{
+    if (!g_address_index) {
+        return error("Address index not enabled");
+    }
+    if (!g_address_index->ReadAddressBalance(addressHash, type, value)) {
+        return error("Unable to get balance for address");
+    }
+
+    return true;
+};
+
 bool GetAddressUnspent(uint256 addressHash, int type,
-                       std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs)
+                       std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs,
+                       const CAddressUnspentKey &after, size_t max_count)
 {
-    if (!fAddressIndex) {
+    if (!g_address_index) {
         return error("Address index not enabled");
     }
-    if (!pblocktree->ReadAddressUnspentIndex(addressHash, type, unspentOutputs)) {
+    if (!g_address_index->ReadAddressUnspentIndex(addressHash, type, unspentOutputs, after, max_count)) {
         return error("Unable to get txids for address");
     }
 
     return true;
 };
 
+static bool GetIndexKey(const CTxDestination &dest, uint256 &hashBytes, int &type) {
+    if (dest.type() == typeid(PKHash)) {
+        const PKHash &id = boost::get<PKHash>(dest);
+        memcpy(hashBytes.begin(), id.begin(), 20);
+        type = ADDR_INDT_PUBKEY_ADDRESS;
+        return true;
+    }
+    if (dest.type() == typeid(ScriptHash)) {
+        const ScriptHash& id = boost::get<ScriptHash>(dest);
+        memcpy(hashBytes.begin(), id.begin(), 20);
+        type = ADDR_INDT_SCRIPT_ADDRESS;
+        return true;
+    }
+    if (dest.type() == typeid(CKeyID256)) {
+        const CKeyID256& id = boost::get<CKeyID256>(dest);
+        memcpy(hashBytes.begin(), id.begin(), 32);
+        type = ADDR_INDT_PUBKEY_ADDRESS_256;
+        return true;
+    }
+    if (dest.type() == typeid(CScriptID256)) {
+        const CScriptID256& id = boost::get<CScriptID256>(dest);
+        memcpy(hashBytes.begin(), id.begin(), 32);
+        type = ADDR_INDT_SCRIPT_ADDRESS_256;
+        return true;
+    }
+    if (dest.type() == typeid(WitnessV0KeyHash)) {
+        const WitnessV0KeyHash& id = boost::get<WitnessV0KeyHash>(dest);
+        memcpy(hashBytes.begin(), id.begin(), 20);
+        type = ADDR_INDT_WITNESS_V0_KEYHASH;
+        return true;
+    }
+    if (dest.type() == typeid(WitnessV0ScriptHash)) {
+        const WitnessV0ScriptHash& id = boost::get<WitnessV0ScriptHash>(dest);
+        memcpy(hashBytes.begin(), id.begin(), 32);
+        type = ADDR_INDT_WITNESS_V0_SCRIPTHASH;
+        return true;
+    }
+    type = ADDR_INDT_UNKNOWN;
+    return false;
+}
+
+bool getIndexKeyFromAddress(const std::string &address, uint256 &hashBytes, int &type)
+{
+    return GetIndexKey(DecodeDestination(address), hashBytes, type);
+}
+
+bool TrimAddressIndexPage(std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex, size_t limit, CAddressIndexCursor &last)
+{
+    last.SetNull();
+    if (limit == 0) {
+        return false;
+    }
+    size_t nTxns = 0;
+    for (size_t i = 0; i < addressIndex.size(); i++) {
+        CAddressIndexCursor position(addressIndex[i].first);
+        if (position == last) {
+            continue;
+        }
+        if (nTxns >= limit) {
+            addressIndex.resize(i);
+            return true;
+        }
+        nTxns++;
+        last = position;
+    }
+    return false;
+}
+
 bool getAddressFromIndex(const int &type, const uint256 &hash, std::string &address)
 {
     if (type == ADDR_INDT_SCRIPT_ADDRESS) {
@@ -9,6 +9,7 @@
 #include <threadsafety.h>
 
 #include <amount.h>
+#include <insight/addressindex.h>
 #include <sync.h>
 #include <stdint.h>
 #include <vector>
@@ -25,6 +26,7 @@ class CTxOutBase;
 class CScript;
 class uint256;
 struct CAddressIndexKey;
+struct CAddressBalanceValue;
 struct CAddressUnspentKey;
 struct CAddressUnspentValue;
 struct CSpentIndexKey;
@@ -39,10 +41,18 @@ bool GetSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value);
 bool HashOnchainActive(const uint256 &hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 bool GetAddressIndex(uint256 addressHash, int type,
                      std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
-                     int start = 0, int end = 0);
+                     int start = 0, int end = 0,
+                     const CAddressIndexCursor &after = CAddressIndexCursor(), size_t max_txns = 0);
+bool GetAddressBalance(uint256 addressHash, int type, CAddressBalanceValue &value);
 bool GetAddressUnspent(uint256 addressHash, int type,
-                       std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs);
+                       std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs,
+                       const CAddressUnspentKey &after = CAddressUnspentKey(), size_t max_count = 0);
+
+/** Truncate address index entries in chain order to limit transactions.
+ *  Returns true if entries were dropped, last is set to the position of the last transaction kept. */
+bool TrimAddressIndexPage(std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex, size_t limit, CAddressIndexCursor &last);
 
 bool getAddressFromIndex(const int &type, const uint256 &hash, std::string &address);
+bool getIndexKeyFromAddress(const std::string &address, uint256 &hashBytes, int &type);
 
 #endif // BITCOIN_INSIGHT_INSIGHT_H
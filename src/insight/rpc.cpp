@@ -2,6 +2,8 @@
 // Distributed under the MIT/X11 software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <insight/rpc.h>
+
 #include <rpc/server.h>
 #include <rpc/util.h>
 #include <rpc/blockchain.h>
@@ -9,7 +11,12 @@
 #include <util/strencodings.h>
 #include <insight/insight.h>
 #include <insight/csindex.h>
+#include <index/addressindex.h>
+#include <index/spentindex.h>
+#include <index/timestampindex.h>
 #include <index/txindex.h>
+#include <index/voteindex.h>
+#include <node/coinstats.h>
 #include <validation.h>
 #include <txmempool.h>
 #include <key_io.h>
@@ -20,54 +27,12 @@
 
 #include <boost/thread/thread.hpp> // boost::thread::interrupt
 
-static bool GetIndexKey(const CTxDestination &dest, uint256 &hashBytes, int &type) {
-    if (dest.type() == typeid(PKHash)) {
-        const PKHash &id = boost::get<PKHash>(dest);
-        memcpy(hashBytes.begin(), id.begin(), 20);
-        type = ADDR_INDT_PUBKEY_ADDRESS;
-        return true;
-    }
-    if (dest.type() == typeid(ScriptHash)) {
-        const ScriptHash& id = boost::get<ScriptHash>(dest);
-        memcpy(hashBytes.begin(), id.begin(), 20);
-        type = ADDR_INDT_SCRIPT_ADDRESS;
-        return true;
-    }
-    if (dest.type() == typeid(CKeyID256)) {
-        const CKeyID256& id = boost::get<CKeyID256>(dest);
-        memcpy(hashBytes.begin(), id.begin(), 32);
-        type = ADDR_INDT_PUBKEY_ADDRESS_256;
-        return true;
-    }
-    if (dest.type() == typeid(CScriptID256)) {
-        const CScriptID256& id = boost::get<CScriptID256>(dest);
-        memcpy(hashBytes.begin(), id.begin(), 32);
-        type = ADDR_INDT_SCRIPT_ADDRESS_256;
-        return true;
-    }
-    if (dest.type() == typeid(WitnessV0KeyHash)) {
-        const WitnessV0KeyHash& id = boost::get<WitnessV0KeyHash>(dest);
-        memcpy(hashBytes.begin(), id.begin(), 20);
-        type = ADDR_INDT_WITNESS_V0_KEYHASH;
-        return true;
-    }
-    if (dest.type() == typeid(WitnessV0ScriptHash)) {
-        const WitnessV0ScriptHash& id = boost::get<WitnessV0ScriptHash>(dest);
-        memcpy(hashBytes.begin(), id.begin(), 32);
-        type = ADDR_INDT_WITNESS_V0_SCRIPTHASH;
-        return true;
-    }
-    type = ADDR_INDT_UNKNOWN;
-    return false;
-}
-
 bool getAddressesFromParams(const UniValue& params, std::vector<std::pair<uint256, int> > &addresses)
 {
     if (params[0].isStr()) {
-        auto dest = DecodeDestination(params[0].get_str());
         uint256 hashBytes;
         int type = 0;
-        if (!GetIndexKey(dest, hashBytes, type)) {
+        if (!getIndexKeyFromAddress(params[0].get_str(), hashBytes, type)) {
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
         }
         addresses.push_back(std::make_pair(hashBytes, type));
@@ -80,10 +45,9 @@ bool getAddressesFromParams(const UniValue& params, std::vector<std::pair<uint25
 
         std::vector<UniValue> values = addressValues.getValues();
         for (std::vector<UniValue>::iterator it = values.begin(); it != values.end(); ++it) {
-            auto dest = DecodeDestination(it->get_str());
             uint256 hashBytes;
             int type = 0;
-            if (!GetIndexKey(dest, hashBytes, type)) {
+            if (!getIndexKeyFromAddress(it->get_str(), hashBytes, type)) {
                 throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
             }
             addresses.push_back(std::make_pair(hashBytes, type));
@@ -95,6 +59,68 @@ bool getAddressesFromParams(const UniValue& params, std::vector<std::pair<uint25
     return true;
 }
 
+/** Read the "limit" and "cursor" paging options of getaddressdeltas and getaddresstxids */
+static bool GetPagingOptions(const UniValue &options, size_t &limit, CAddressIndexCursor &after)
+{
+    limit = 0;
+    after.SetNull();
+    if (!options.isObject()) {
+        return false;
+    }
+
+    const UniValue &limitValue = find_value(options, "limit");
+    const UniValue &cursorValue = find_value(options, "cursor");
+    if (!limitValue.isNull()) {
+        int nLimit = limitValue.get_int();
+        if (nLimit < 0) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "limit must be zero or positive");
+        }
+        limit = nLimit; // 0 for all
+    }
+    if (!cursorValue.isNull()) {
+        const std::string &sCursor = cursorValue.get_str();
+        size_t nSep = sCursor.find(':');
+        int32_t nHeight;
+        uint32_t nTxIndex;
+        if (nSep == std::string::npos
+            || !ParseInt32(sCursor.substr(0, nSep), &nHeight) || nHeight < 0
+            || !ParseUInt32(sCursor.substr(nSep + 1), &nTxIndex)) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "cursor must be \"height:blockindex\"");
+        }
+        after = CAddressIndexCursor(nHeight, nTxIndex);
+    }
+
+    return !limitValue.isNull() || !after.IsNull();
+}
+
+/**
+ * Read a page of address index entries for the addresses in chain order.
+ * At most limit transactions are returned, if more remain cursor is set to the last returned.
+ */
+static void GetAddressIndexPage(const std::vector<std::pair<uint256, int> > &addresses, int start, int end,
+                                size_t limit, const CAddressIndexCursor &after,
+                                std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex, std::string &cursor)
+{
+    // One more transaction than the limit is read per address to tell if the page is the last
+    for (const auto &address : addresses) {
+        if (!GetAddressIndex(address.first, address.second, addressIndex, start, end, after, limit > 0 ? limit + 1 : 0)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+        }
+    }
+
+    if (addresses.size() > 1) {
+        std::stable_sort(addressIndex.begin(), addressIndex.end(),
+            [](const std::pair<CAddressIndexKey, CAmount> &a, const std::pair<CAddressIndexKey, CAmount> &b) {
+                return CAddressIndexCursor(a.first) < CAddressIndexCursor(b.first);
+            });
+    }
+
+    CAddressIndexCursor last;
+    if (TrimAddressIndexPage(addressIndex, limit, last)) {
+        cursor = strprintf("%d:%u", last.blockHeight, last.txindex);
+    }
+}
+
 bool heightSort(std::pair<CAddressUnspentKey, CAddressUnspentValue> a,
                 std::pair<CAddressUnspentKey, CAddressUnspentValue> b)
 {
@@ -211,10 +237,14 @@ UniValue getaddressutxos(const JSONRPCRequest& request)
                 },
         }.Check(request);
 
-    if (!fAddressIndex) {
+    if (!fAddressIndex || !g_address_index) {
         throw JSONRPCError(RPC_MISC_ERROR, "Address index is not enabled.");
     }
 
+    if (!g_address_index->BlockUntilSyncedToCurrentChain()) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Address index is still syncing. Try again later.");
+    }
+
     bool includeChainInfo = false;
     if (request.params[0].isObject()) {
         UniValue chainInfo = find_value(request.params[0].get_obj(), "chainInfo");
@@ -281,6 +311,8 @@ UniValue getaddressdeltas(const JSONRPCRequest& request)
                     {"start", RPCArg::Type::NUM, /* default */ "0", "The start block height."},
                     {"end", RPCArg::Type::NUM, /* default */ "0", "The end block height."},
                     {"chainInfo", RPCArg::Type::BOOL, /* default */ "false", "Include chain info in results, only applies if start and end specified."},
+                    {"limit", RPCArg::Type::NUM, /* default */ "0", "Return the deltas of at most this many transactions, 0 for all."},
+                    {"cursor", RPCArg::Type::STR, /* default */ "", "Continue after this \"height:blockindex\" position, from the \"cursor\" field of a previous result."},
                 },
                 RPCResult{
             "[\n"
@@ -292,6 +324,13 @@ UniValue getaddressdeltas(const JSONRPCRequest& request)
             "    \"address\"  (string) The base58check encoded address\n"
             "  }\n"
             "]\n"
+            "\nIf limit or cursor is set, or chainInfo with start and end, the result is an object:\n"
+            "{\n"
+            "  \"deltas\": [...],     (array) As above, in chain order\n"
+            "  \"cursor\": \"str\"     (string) Set if limit was reached, pass in options to list the following deltas\n"
+            "  \"start\": {...},      (object) chainInfo only\n"
+            "  \"end\": {...}         (object) chainInfo only\n"
+            "}\n"
                 },
                 RPCExamples{
             HelpExampleCli("getaddressdeltas", "'{\"addresses\": [\"Pb7FLL3DyaAVP2eGfRiEkj4U8ZJ3RHLY9g\"]}'") +
@@ -300,10 +339,14 @@ UniValue getaddressdeltas(const JSONRPCRequest& request)
                 },
         }.Check(request);
 
-    if (!fAddressIndex) {
+    if (!fAddressIndex || !g_address_index) {
         throw JSONRPCError(RPC_MISC_ERROR, "Address index is not enabled.");
     }
 
+    if (!g_address_index->BlockUntilSyncedToCurrentChain()) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Address index is still syncing. Try again later.");
+    }
+
     UniValue startValue = find_value(request.params[0].get_obj(), "start");
     UniValue endValue = find_value(request.params[0].get_obj(), "end");
 
@@ -333,16 +376,25 @@ UniValue getaddressdeltas(const JSONRPCRequest& request)
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
     }
 
+    size_t limit;
+    CAddressIndexCursor after;
+    bool fPaged = GetPagingOptions(request.params[0], limit, after);
+
     std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
+    std::string cursor;
 
-    for (std::vector<std::pair<uint256, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        if (start > 0 && end > 0) {
-            if (!GetAddressIndex(it->first, it->second, addressIndex, start, end)) {
-                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
-            }
-        } else {
-            if (!GetAddressIndex(it->first, it->second, addressIndex)) {
-                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+    if (fPaged) {
+        GetAddressIndexPage(addresses, start, end, limit, after, addressIndex, cursor);
+    } else {
+        for (std::vector<std::pair<uint256, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
+            if (start > 0 && end > 0) {
+                if (!GetAddressIndex(it->first, it->second, addressIndex, start, end)) {
+                    throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+                }
+            } else {
+                if (!GetAddressIndex(it->first, it->second, addressIndex)) {
+                    throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+                }
             }
         }
     }
@@ -387,9 +439,19 @@ UniValue getaddressdeltas(const JSONRPCRequest& request)
         endInfo.pushKV("height", end);
 
         result.pushKV("deltas", deltas);
+        if (!cursor.empty()) {
+            result.pushKV("cursor", cursor);
+        }
         result.pushKV("start", startInfo);
         result.pushKV("end", endInfo);
 
+        return result;
+    } else
+    if (fPaged) {
+        result.pushKV("deltas", deltas);
+        if (!cursor.empty()) {
+            result.pushKV("cursor", cursor);
+        }
         return result;
     } else {
         return deltas;
@@ -401,9 +463,14 @@ UniValue getaddressbalance(const JSONRPCRequest& request)
             RPCHelpMan{"getaddressbalance",
                 "\nReturns the balance for an address(es) (requires addressindex to be enabled).\n",
                 {
-                    {"addresses", RPCArg::Type::ARR, RPCArg::Optional::NO, "A json array with addresses.\n",
+                    {"addresses", RPCArg::Type::OBJ, RPCArg::Optional::NO, "A json object with the addresses and options, or a single address string.",
                         {
-                            {"address", RPCArg::Type::STR, RPCArg::Optional::NO, "The base58check encoded address."},
+                            {"addresses", RPCArg::Type::ARR, RPCArg::Optional::NO, "A json array with addresses.\n",
+                                {
+                                    {"address", RPCArg::Type::STR, RPCArg::Optional::NO, "The base58check encoded address."},
+                                },
+                            },
+                            {"mempool", RPCArg::Type::BOOL, /* default */ "false", "Include unconfirmed mempool transactions."},
                         },
                     },
                 },
@@ -411,6 +478,8 @@ UniValue getaddressbalance(const JSONRPCRequest& request)
             "{\n"
             "  \"balance\"  (string) The current balance in satoshis\n"
             "  \"received\"  (string) The total number of satoshis received (including change)\n"
+            "  \"sent\"  (string) The total number of satoshis sent (including change)\n"
+            "  \"txcount\"  (number) The number of transactions involving the addresses, counted once per address\n"
             "}\n"
                 },
                 RPCExamples{
@@ -420,37 +489,67 @@ UniValue getaddressbalance(const JSONRPCRequest& request)
                 },
         }.Check(request);
 
-    if (!fAddressIndex) {
+    if (!fAddressIndex || !g_address_index) {
         throw JSONRPCError(RPC_MISC_ERROR, "Address index is not enabled.");
     }
 
+    if (!g_address_index->BlockUntilSyncedToCurrentChain()) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Address index is still syncing. Try again later.");
+    }
+
+    bool includeMempool = false;
+    if (request.params[0].isObject()) {
+        UniValue mempoolValue = find_value(request.params[0].get_obj(), "mempool");
+        if (mempoolValue.isBool()) {
+            includeMempool = mempoolValue.get_bool();
+        }
+    }
+
     std::vector<std::pair<uint256, int> > addresses;
 
     if (!getAddressesFromParams(request.params, addresses)) {
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
     }
 
-    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
+    // Running totals are kept per address, so each lookup is a single read
+    CAmount received = 0;
+    CAmount sent = 0;
+    uint64_t txCount = 0;
 
     for (std::vector<std::pair<uint256, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        if (!GetAddressIndex(it->first, it->second, addressIndex)) {
+        CAddressBalanceValue value;
+        if (!GetAddressBalance(it->first, it->second, value)) {
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
         }
+        received += value.received;
+        sent += value.sent;
+        txCount += value.txCount;
     }
 
-    CAmount balance = 0;
-    CAmount received = 0;
+    if (includeMempool) {
+        std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta> > indexes;
+        if (!mempool.getAddressIndex(addresses, indexes)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+        }
 
-    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=addressIndex.begin(); it!=addressIndex.end(); it++) {
-        if (it->second > 0) {
-            received += it->second;
+        std::set<std::pair<std::pair<int, uint256>, uint256> > mempoolTxids;
+        for (std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta> >::const_iterator it = indexes.begin(); it != indexes.end(); it++) {
+            if (it->second.amount > 0) {
+                received += it->second.amount;
+            } else {
+                sent -= it->second.amount;
+            }
+            if (mempoolTxids.insert(std::make_pair(std::make_pair(it->first.type, it->first.addressBytes), it->first.txhash)).second) {
+                txCount++;
+            }
         }
-        balance += it->second;
     }
 
     UniValue result(UniValue::VOBJ);
-    result.pushKV("balance", balance);
+    result.pushKV("balance", received - sent);
     result.pushKV("received", received);
+    result.pushKV("sent", sent);
+    result.pushKV("txcount", txCount);
 
     return result;
 }
@@ -467,12 +566,19 @@ UniValue getaddresstxids(const JSONRPCRequest& request)
                     },
                     {"start", RPCArg::Type::NUM, /* default */ "0", "The start block height."},
                     {"end", RPCArg::Type::NUM, /* default */ "0", "The end block height."},
+                    {"limit", RPCArg::Type::NUM, /* default */ "0", "Return at most this many txids, 0 for all."},
+                    {"cursor", RPCArg::Type::STR, /* default */ "", "Continue after this \"height:blockindex\" position, from the \"cursor\" field of a previous result."},
                 },
                 RPCResult{
             "[\n"
             "  \"transactionid\"  (string) The transaction id\n"
             "  ,...\n"
             "]\n"
+            "\nIf limit or cursor is set the result is an object:\n"
+            "{\n"
+            "  \"txids\": [...],      (array) As above, in chain order\n"
+            "  \"cursor\": \"str\"     (string) Set if limit was reached, pass in options to list the following txids\n"
+            "}\n"
                 },
                 RPCExamples{
             HelpExampleCli("getaddresstxids", "'{\"addresses\": [\"Pb7FLL3DyaAVP2eGfRiEkj4U8ZJ3RHLY9g\"]}'") +
@@ -481,10 +587,14 @@ UniValue getaddresstxids(const JSONRPCRequest& request)
                 },
         }.Check(request);
 
-    if (!fAddressIndex) {
+    if (!fAddressIndex || !g_address_index) {
         throw JSONRPCError(RPC_MISC_ERROR, "Address index is not enabled.");
     }
 
+    if (!g_address_index->BlockUntilSyncedToCurrentChain()) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Address index is still syncing. Try again later.");
+    }
+
     std::vector<std::pair<uint256, int> > addresses;
 
     if (!getAddressesFromParams(request.params, addresses)) {
@@ -502,6 +612,31 @@ UniValue getaddresstxids(const JSONRPCRequest& request)
         }
     }
 
+    size_t limit;
+    CAddressIndexCursor after;
+    if (GetPagingOptions(request.params[0], limit, after)) {
+        std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
+        std::string cursor;
+        GetAddressIndexPage(addresses, start, end, limit, after, addressIndex, cursor);
+
+        // Entries are in chain order, the entries of a transaction are adjacent
+        UniValue txids(UniValue::VARR);
+        const CAddressIndexKey *prev = nullptr;
+        for (const auto &entry : addressIndex) {
+            if (!prev || prev->txhash != entry.first.txhash) {
+                txids.push_back(entry.first.txhash.GetHex());
+            }
+            prev = &entry.first;
+        }
+
+        UniValue result(UniValue::VOBJ);
+        result.pushKV("txids", txids);
+        if (!cursor.empty()) {
+            result.pushKV("cursor", cursor);
+        }
+        return result;
+    }
+
     std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
 
     for (std::vector<std::pair<uint256, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
@@ -567,6 +702,10 @@ UniValue getspentinfo(const JSONRPCRequest& request)
                 },
         }.Check(request);
 
+    if (g_spent_index && !g_spent_index->BlockUntilSyncedToCurrentChain()) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Spent index is still syncing. Try again later.");
+    }
+
     UniValue txidValue = find_value(request.params[0].get_obj(), "txid");
     UniValue indexValue = find_value(request.params[0].get_obj(), "index");
 
@@ -612,7 +751,7 @@ static void AddAddress(CScript *script, UniValue &uv)
     }
 }
 
-static UniValue blockToDeltasJSON(const CBlock& block, const CBlockIndex* blockindex)
+UniValue blockToDeltasJSON(const CBlock& block, const CBlockIndex* blockindex)
 {
     UniValue result(UniValue::VOBJ);
     result.pushKV("hash", block.GetHash().GetHex());
@@ -750,6 +889,10 @@ static UniValue getblockdeltas(const JSONRPCRequest& request)
         },
     }.Check(request);
 
+    if (g_spent_index && !g_spent_index->BlockUntilSyncedToCurrentChain()) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Spent index is still syncing. Try again later.");
+    }
+
     LOCK(cs_main);
 
     std::string strHash = request.params[0].get_str();
@@ -827,6 +970,10 @@ static UniValue getblockhashes(const JSONRPCRequest& request)
 
     std::vector<std::pair<uint256, unsigned int> > blockHashes;
 
+    if (g_timestamp_index && !g_timestamp_index->BlockUntilSyncedToCurrentChain()) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Timestamp index is still syncing. Try again later.");
+    }
+
     if (fActiveOnly) {
         LOCK(cs_main);
     }
@@ -855,7 +1002,7 @@ UniValue gettxoutsetinfobyscript(const JSONRPCRequest& request)
 {
             RPCHelpMan{"gettxoutsetinfobyscript",
                 "\nReturns statistics about the unspent transaction output set per script type.\n"
-                "This call may take some time.\n",
+                "The first call may take some time, the totals are kept up to date from then on.\n",
                 {
                 },
                 RPCResult{
@@ -875,75 +1022,26 @@ UniValue gettxoutsetinfobyscript(const JSONRPCRequest& request)
 
     int nHeight;
     uint256 hashBlock;
-
-    std::unique_ptr<CCoinsViewCursor> pcursor;
-    {
-        LOCK(cs_main);
-        ::ChainstateActive().ForceFlushStateToDisk();
-        pcursor = std::unique_ptr<CCoinsViewCursor>(::ChainstateActive().CoinsDB().Cursor());
-        assert(pcursor);
-        hashBlock = pcursor->GetBestBlock();
-        nHeight = ::BlockIndex().find(hashBlock)->second->nHeight;
+    CUTXOStats stats;
+    if (!GetUTXOTypeStats(stats, hashBlock, nHeight)) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read UTXO set");
     }
 
-    class PerScriptTypeStats {
-    public:
-        int64_t nPlain = 0;
-        int64_t nBlinded = 0;
-        int64_t nPlainValue = 0;
-
-        UniValue ToUV()
-        {
-            UniValue ret(UniValue::VOBJ);
-            ret.pushKV("num_plain", nPlain);
-            ret.pushKV("num_blinded", nBlinded);
-            ret.pushKV("total_amount", ValueFromAmount(nPlainValue));
-            return ret;
-        }
+    auto ToUV = [](const CUTXOScriptTypeStats &st) {
+        UniValue ret(UniValue::VOBJ);
+        ret.pushKV("num_plain", st.nPlain);
+        ret.pushKV("num_blinded", st.nBlinded);
+        ret.pushKV("total_amount", ValueFromAmount(st.nPlainValue));
+        return ret;
     };
 
-    PerScriptTypeStats statsPKH;
-    PerScriptTypeStats statsSH;
-    PerScriptTypeStats statsCSPKH;
-    PerScriptTypeStats statsCSSH;
-    PerScriptTypeStats statsOther;
-
-    uint256 prevkey;
-    while (pcursor->Valid()) {
-        boost::this_thread::interruption_point();
-        COutPoint key;
-        Coin coin;
-        if (pcursor->GetKey(key) && pcursor->GetValue(coin)) {
-            PerScriptTypeStats *ps = &statsOther;
-            if (coin.out.scriptPubKey.IsPayToPublicKeyHash())
-                ps = &statsPKH;
-            else if (coin.out.scriptPubKey.IsPayToScriptHash())
-                ps = &statsSH;
-            else if (coin.out.scriptPubKey.IsPayToPublicKeyHash256_CS())
-                ps = &statsCSPKH;
-            else if (coin.out.scriptPubKey.IsPayToScriptHash256_CS() || coin.out.scriptPubKey.IsPayToScriptHash_CS() )
-                ps = &statsCSSH;
-
-            if (coin.nType == OUTPUT_STANDARD) {
-                ps->nPlain++;
-                ps->nPlainValue += coin.out.nValue;
-            } else
-            if (coin.nType == OUTPUT_CT) {
-                ps->nBlinded++;
-            }
-        } else {
-            throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read UTXO set");
-        }
-        pcursor->Next();
-    }
-
     ret.pushKV("height", (int64_t)nHeight);
     ret.pushKV("bestblock", hashBlock.GetHex());
-    ret.pushKV("paytopubkeyhash", statsPKH.ToUV());
-    ret.pushKV("paytoscripthash", statsSH.ToUV());
-    ret.pushKV("coldstake_paytopubkeyhash", statsCSPKH.ToUV());
-    ret.pushKV("coldstake_paytoscripthash", statsCSSH.ToUV());
-    ret.pushKV("other", statsOther.ToUV());
+    ret.pushKV("paytopubkeyhash", ToUV(stats.m_script_types[UTXO_STATS_PAYTOPUBKEYHASH]));
+    ret.pushKV("paytoscripthash", ToUV(stats.m_script_types[UTXO_STATS_PAYTOSCRIPTHASH]));
+    ret.pushKV("coldstake_paytopubkeyhash", ToUV(stats.m_script_types[UTXO_STATS_COLDSTAKE_PAYTOPUBKEYHASH]));
+    ret.pushKV("coldstake_paytoscripthash", ToUV(stats.m_script_types[UTXO_STATS_COLDSTAKE_PAYTOSCRIPTHASH]));
+    ret.pushKV("other", ToUV(stats.m_script_types[UTXO_STATS_OTHER]));
 
     return ret;
 }
@@ -1116,6 +1214,48 @@ UniValue getblockreward(const JSONRPCRequest& request)
     return rv;
 }
 
+static void DecodeStakeAddress(const std::string &address, txnouttype &stake_type, CKeyID256 &stake_id)
+{
+    CTxDestination stake_dest = DecodeDestination(address, true);
+    if (stake_dest.type() == typeid(PKHash)) {
+        stake_type = TX_PUBKEYHASH;
+        PKHash id = boost::get<PKHash>(stake_dest);
+        memcpy(stake_id.begin(), id.begin(), 20);
+    } else
+    if (stake_dest.type() == typeid(CKeyID256)) {
+        stake_type = TX_PUBKEYHASH256;
+        stake_id = boost::get<CKeyID256>(stake_dest);
+    } else {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unrecognised stake address type.");
+    }
+}
+
+static std::string EncodeSpendAddress(txnouttype spend_type, const CKeyID256 &spend_id)
+{
+    switch (spend_type) {
+        case TX_PUBKEYHASH: {
+            PKHash idk;
+            memcpy(idk.begin(), spend_id.begin(), 20);
+            return EncodeDestination(idk);
+            }
+        case TX_PUBKEYHASH256:
+            return EncodeDestination(spend_id);
+        case TX_SCRIPTHASH: {
+            ScriptHash ids;
+            memcpy(ids.begin(), spend_id.begin(), 20);
+            return EncodeDestination(ids);
+            }
+        case TX_SCRIPTHASH256: {
+            CScriptID256 ids;
+            memcpy(ids.begin(), spend_id.begin(), 32);
+            return EncodeDestination(ids);
+            }
+        default:
+            break;
+    }
+    return "unknown_type";
+}
+
 UniValue listcoldstakeunspent(const JSONRPCRequest& request)
 {
             RPCHelpMan{"listcoldstakeunspent",
@@ -1157,18 +1297,7 @@ UniValue listcoldstakeunspent(const JSONRPCRequest& request)
     }
 
     ColdStakeIndexLinkKey seek_key;
-    CTxDestination stake_dest = DecodeDestination(request.params[0].get_str(), true);
-    if (stake_dest.type() == typeid(PKHash)) {
-        seek_key.m_stake_type = TX_PUBKEYHASH;
-        PKHash id = boost::get<PKHash>(stake_dest);
-        memcpy(seek_key.m_stake_id.begin(), id.begin(), 20);
-    } else
-    if (stake_dest.type() == typeid(CKeyID256)) {
-        seek_key.m_stake_type = TX_PUBKEYHASH256;
-        seek_key.m_stake_id = boost::get<CKeyID256>(stake_dest);
-    } else {
-        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unrecognised stake address type.");
-    }
+    DecodeStakeAddress(request.params[0].get_str(), seek_key.m_stake_type, seek_key.m_stake_id);
 
     CDBWrapper &db = g_txindex->GetDB();
 
@@ -1238,32 +1367,7 @@ UniValue listcoldstakeunspent(const JSONRPCRequest& request)
                         output.pushKV("n", ok.m_n);
                     }
 
-                    switch (lk.m_spend_type) {
-                        case TX_PUBKEYHASH: {
-                            PKHash idk;
-                            memcpy(idk.begin(), lk.m_spend_id.begin(), 20);
-                            output.pushKV("addrspend", EncodeDestination(idk));
-                            }
-                            break;
-                        case TX_PUBKEYHASH256:
-                            output.pushKV("addrspend", EncodeDestination(lk.m_spend_id));
-                            break;
-                        case TX_SCRIPTHASH: {
-                            ScriptHash ids;
-                            memcpy(ids.begin(), lk.m_spend_id.begin(), 20);
-                            output.pushKV("addrspend", EncodeDestination(ids));
-                            }
-                            break;
-                        case TX_SCRIPTHASH256: {
-                            CScriptID256 ids;
-                            memcpy(ids.begin(), lk.m_spend_id.begin(), 32);
-                            output.pushKV("addrspend", EncodeDestination(ids));
-                            }
-                            break;
-                        default:
-                            output.pushKV("addrspend", "unknown_type");
-                            break;
-                    }
+                    output.pushKV("addrspend", EncodeSpendAddress(lk.m_spend_type, lk.m_spend_id));
 
                     rv.push_back(output);
                 }
@@ -1275,6 +1379,65 @@ UniValue listcoldstakeunspent(const JSONRPCRequest& request)
     return rv;
 }
 
+UniValue getcoldstakesummary(const JSONRPCRequest& request)
+{
+            RPCHelpMan{"getcoldstakesummary",
+                "\nReturns the running totals of the outputs of \"stakeaddress\" for each spend address.\n",
+                {
+                    {"stakeaddress", RPCArg::Type::STR, RPCArg::Optional::NO, "The stakeaddress to summarise outputs of."},
+                },
+                RPCResult{
+            "[\n"
+            " {\n"
+            "  \"addrspend\" : \"addr\",   (string) The spending address of the outputs\n"
+            "  \"value\" : n,            (numeric) The value of the unspent outputs.\n"
+            "  \"num_unspent\" : n,      (numeric) The number of unspent outputs.\n"
+            "  \"staked\" : n,           (numeric) The rewards staked by the outputs.\n"
+            " } ...\n"
+            "]\n"
+                },
+                RPCExamples{
+            HelpExampleCli("getcoldstakesummary", "\"Pb7FLL3DyaAVP2eGfRiEkj4U8ZJ3RHLY9g\"") +
+            "\nAs a JSON-RPC call\n"
+            + HelpExampleRpc("getcoldstakesummary", "\"Pb7FLL3DyaAVP2eGfRiEkj4U8ZJ3RHLY9g\"")
+                },
+            }.Check(request);
+
+    RPCTypeCheck(request.params, {UniValue::VSTR}, true);
+
+    if (!g_txindex) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Requires -txindex enabled");
+    }
+    if (!g_txindex->m_cs_index) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Requires -csindex enabled");
+    }
+
+    txnouttype stake_type;
+    CKeyID256 stake_id;
+    DecodeStakeAddress(request.params[0].get_str(), stake_type, stake_id);
+
+    if (!g_txindex->BlockUntilSyncedToCurrentChain()) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Transaction index is still syncing. Try again later.");
+    }
+
+    std::vector<std::pair<ColdStakeIndexAggregateKey, ColdStakeIndexAggregateValue> > aggregates;
+    if (!g_txindex->ReadCSAggregates(stake_type, stake_id, aggregates)) {
+        throw JSONRPCError(RPC_DATABASE_ERROR, "Failed to read cold stake aggregates");
+    }
+
+    UniValue rv(UniValue::VARR);
+    for (const auto &it : aggregates) {
+        UniValue entry(UniValue::VOBJ);
+        entry.pushKV("addrspend", EncodeSpendAddress(it.first.m_spend_type, it.first.m_spend_id));
+        entry.pushKV("value", it.second.m_value);
+        entry.pushKV("num_unspent", it.second.m_num_unspent);
+        entry.pushKV("staked", it.second.m_staked);
+        rv.push_back(entry);
+    }
+
+    return rv;
+}
+
 UniValue getindexinfo(const JSONRPCRequest& request)
 {
             RPCHelpMan{"getindexinfo",
@@ -1288,6 +1451,7 @@ UniValue getindexinfo(const JSONRPCRequest& request)
             "  \"spentindex\":  xxx         (bool) Is the spentindex enabled.\n"
             "  \"timestampindex\":  xxx     (bool) Is the timestampindex enabled.\n"
             "  \"coldstakeindex\":  xxx     (bool) Is the coldstakeindex enabled.\n"
+            "  \"voteindex\":  xxx          (bool) Is the voteindex enabled.\n"
             "}\n"
                 },
                 RPCExamples{
@@ -1304,6 +1468,7 @@ UniValue getindexinfo(const JSONRPCRequest& request)
     ret.pushKV("spentindex", fSpentIndex);
     ret.pushKV("timestampindex", fTimestampIndex);
     ret.pushKV("coldstakeindex", (bool) (g_txindex && g_txindex->m_cs_index));
+    ret.pushKV("voteindex", (bool) g_vote_index);
 
     return ret;
 }
@@ -1326,6 +1491,7 @@ static const CRPCCommand commands[] =
     { "blockchain",         "getblockreward",         &getblockreward,         {"height"} },
 
     { "csindex",            "listcoldstakeunspent",   &listcoldstakeunspent,   {"stakeaddress","height","options"} },
+    { "csindex",            "getcoldstakesummary",    &getcoldstakesummary,    {"stakeaddress"} },
 
     { "blockchain",         "getindexinfo",           &getindexinfo,           {} },
 };
@@ -5,8 +5,15 @@
 #ifndef GIO_INSIGHT_RPC_H
 #define GIO_INSIGHT_RPC_H
 
+#include <univalue.h>
+
+class CBlock;
+class CBlockIndex;
 class CRPCTable;
 
+/** Block with the address deltas of its transactions, needs the spent index. Throws like an RPC. */
+UniValue blockToDeltasJSON(const CBlock& block, const CBlockIndex* blockindex);
+
 void RegisterInsightRPCCommands(CRPCTable &t);
 
 #endif // GIO_INSIGHT_RPC_H
@@ -6,6 +6,7 @@
 
 #include <chain.h>
 #include <chainparams.h>
+#include <index/blockfilterindex.h>
 #include <interfaces/handler.h>
 #include <interfaces/wallet.h>
 #include <net.h>
@@ -278,6 +279,21 @@ public:
         }
         return true;
     }
+    bool hasBlockFilterIndex(BlockFilterType filter_type) override
+    {
+        return GetBlockFilterIndex(filter_type) != nullptr;
+    }
+    Optional<bool> blockFilterMatchesAny(BlockFilterType filter_type, const uint256& block_hash, const GCSFilter::ElementSet& elements) override
+    {
+        const BlockFilterIndex* filter_index = GetBlockFilterIndex(filter_type);
+        if (!filter_index) return nullopt;
+        const CBlockIndex* index = WITH_LOCK(cs_main, return LookupBlockIndex(block_hash));
+        BlockFilter filter;
+        if (!filter_index->IsBlockIndexed(index) || !filter_index->LookupFilter(index, filter)) {
+            return nullopt;
+        }
+        return filter.GetFilter().MatchAny(elements);
+    }
     void findCoins(std::map<COutPoint, Coin>& coins) override { return FindCoins(m_node, coins); }
     double guessVerificationProgress(const uint256& block_hash) override
     {
@@ -23,6 +23,8 @@
 #include <wallet/rpcwallet.h>
 #include <wallet/wallet.h>
 
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
@@ -426,6 +428,61 @@ public:
 
         return result;
     }
+    std::vector<WalletTx> getWalletTxsPage(WalletTxCursor& cursor, size_t max_count) override
+    {
+        std::vector<WalletTx> result;
+        if (max_count == 0) {
+            return result;
+        }
+        typedef std::pair<int64_t, uint256> TxKey;
+        auto locked_chain = m_wallet->chain().lock();
+        LOCK(m_wallet->cs_wallet);
+
+        // Keep the newest max_count keys older than the cursor in a heap with
+        // the oldest on top, only the selected transactions are converted.
+        const TxKey cursor_key(cursor.time, cursor.hash);
+        std::vector<TxKey> keys;
+        auto select = [&](int64_t time, const uint256& hash) {
+            TxKey key(time, hash);
+            if (cursor.is_set && !(key < cursor_key)) {
+                return;
+            }
+            if (keys.size() < max_count) {
+                keys.push_back(key);
+                std::push_heap(keys.begin(), keys.end(), std::greater<TxKey>());
+            } else
+            if (keys.front() < key) {
+                std::pop_heap(keys.begin(), keys.end(), std::greater<TxKey>());
+                keys.back() = key;
+                std::push_heap(keys.begin(), keys.end(), std::greater<TxKey>());
+            }
+        };
+        for (const auto& entry : m_wallet->mapWallet) {
+            select(entry.second.GetTxTime(), entry.first);
+        }
+        if (m_wallet_part) {
+            for (const auto& entry : m_wallet_part->mapRecords) {
+                select(entry.second.GetTxTime(), entry.first);
+            }
+        }
+        std::sort(keys.begin(), keys.end(), std::greater<TxKey>());
+
+        result.reserve(keys.size());
+        for (const auto& key : keys) {
+            auto mi = m_wallet->mapWallet.find(key.second);
+            if (mi != m_wallet->mapWallet.end()) {
+                result.emplace_back(MakeWalletTx(*m_wallet, mi->second));
+                continue;
+            }
+            result.emplace_back(MakeWalletTx(*m_wallet_part, m_wallet_part->mapRecords.find(key.second)));
+        }
+        if (!keys.empty()) {
+            cursor.time = keys.back().first;
+            cursor.hash = keys.back().second;
+            cursor.is_set = true;
+        }
+        return result;
+    }
     bool tryGetTxStatus(const uint256& txid,
         interfaces::WalletTxStatus& tx_status,
         int& num_blocks,
@@ -44,6 +44,7 @@ class Handler;
 struct WalletAddress;
 struct WalletBalances;
 struct WalletTx;
+struct WalletTxCursor;
 struct WalletTxOut;
 struct WalletTxStatus;
 
@@ -188,6 +189,11 @@ public:
     //! Get list of all wallet transactions.
     virtual std::vector<WalletTx> getWalletTxs() = 0;
 
+    //! Get up to max_count wallet transactions after the cursor, ordered by
+    //! time and hash with the newest first. The cursor is moved past the
+    //! returned transactions, an empty result marks the end of the list.
+    virtual std::vector<WalletTx> getWalletTxsPage(WalletTxCursor& cursor, size_t max_count) = 0;
+
     //! Try to get updated status for a particular transaction, if possible without blocking.
     virtual bool tryGetTxStatus(const uint256& txid,
         WalletTxStatus& tx_status,
@@ -393,6 +399,15 @@ struct WalletTx
     CHDWallet *partWallet;
 };
 
+//! Position in the list of wallet transactions ordered by time.
+struct WalletTxCursor
+{
+    int64_t time = 0;
+    uint256 hash;
+    //! An unset cursor starts at the newest transaction
+    bool is_set = false;
+};
+
 //! Updated transaction status.
 struct WalletTxStatus
 {
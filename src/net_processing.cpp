@@ -26,11 +26,16 @@
 #include <txmempool.h>
 #include <util/system.h>
 #include <util/strencodings.h>
+#include <util/threadnames.h>
 #include <util/validation.h>
 
 #include <smsg/smessage.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <thread>
 
 #if defined(NDEBUG)
 # error "Bitcoin cannot be compiled without assertions."
@@ -82,6 +87,12 @@ static_assert(INBOUND_PEER_TX_DELAY >= MAX_GETDATA_RANDOM_DELAY,
 "To preserve security, MAX_GETDATA_RANDOM_DELAY should not exceed INBOUND_PEER_DELAY");
 /** Limit to avoid sending big packets. Not used in processing incoming GETDATA for compatibility */
 static const unsigned int MAX_GETDATA_SZ = 1000;
+/** Maximum number of inbound transactions queued for verification, beyond this transactions are verified on the message handler thread */
+static const size_t MAX_TX_PREVALIDATION_QUEUE = 1000;
+/** Maximum number of transactions queued for verification per peer, further messages from the peer are held until they were accepted */
+static const size_t MAX_PEER_TX_PREVALIDATION_QUEUE = 100;
+/** Number of transactions remembered as failing verification, they are not verified ahead of acceptance again */
+static const unsigned int MAX_TX_PREVALIDATION_FAILED = 10000;
 
 
 struct COrphanTx {
@@ -775,6 +786,190 @@ void RequestTx(CNodeState* state, const uint256& txid, std::chrono::microseconds
 
 } // namespace
 
+/**
+ * Inbound transactions with range proofs or MLSAG signatures are verified by a
+ * pool of threads, outside cs_main, before the message handler accepts them.
+ * Transactions from each peer are accepted in the order they were received.
+ */
+class TxPreValidator
+{
+public:
+    TxPreValidator(CConnman* connman, int n_threads) : m_connman(connman)
+    {
+        for (int i = 0; i < n_threads; ++i) {
+            m_threads.emplace_back([this, i]() {
+                util::ThreadRename(strprintf("txverify.%i", i));
+                ThreadVerify();
+            });
+        }
+    }
+
+    ~TxPreValidator()
+    {
+        {
+            LOCK(m_mutex);
+            m_stop = true;
+        }
+        m_cond.notify_all();
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    //! Queue tx received from peer, returns false if tx should be processed now
+    bool Push(NodeId peer, const CTransactionRef& tx)
+    {
+        bool has_proofs = TransactionHasProofs(*tx);
+        {
+            LOCK(m_mutex);
+            if (has_proofs && m_failed.contains(tx->GetWitnessHash())) {
+                // Failed before, acceptance rejects it again
+                has_proofs = false;
+                m_stats.skipped++;
+            }
+            auto& items = m_peer_items[peer];
+            if (items.empty() && (!has_proofs || m_queued >= MAX_TX_PREVALIDATION_QUEUE)) {
+                // Nothing to keep in order, verify now, or later when the queue drained
+                m_peer_items.erase(peer);
+                return false;
+            }
+            auto item = std::make_shared<Item>();
+            item->peer = peer;
+            item->tx = tx;
+            item->ready = !has_proofs;
+            items.push_back(item);
+            m_queued++;
+            if (has_proofs) {
+                m_work.push_back(std::move(item));
+            }
+        }
+        if (has_proofs) {
+            m_cond.notify_one();
+        }
+        return true;
+    }
+
+    //! Take the next transaction from peer once it was verified, more is set if another one is ready
+    CTransactionRef PopReady(NodeId peer, bool& more)
+    {
+        LOCK(m_mutex);
+        auto it = m_peer_items.find(peer);
+        if (it == m_peer_items.end() || !it->second.front()->ready) {
+            return nullptr;
+        }
+        CTransactionRef tx = std::move(it->second.front()->tx);
+        it->second.pop_front();
+        m_queued--;
+        if (it->second.empty()) {
+            m_peer_items.erase(it);
+        } else if (it->second.front()->ready) {
+            more = true;
+        }
+        return tx;
+    }
+
+    //! Whether peer has too many transactions queued, no more messages from peer are processed until they were accepted
+    bool IsFull(NodeId peer)
+    {
+        LOCK(m_mutex);
+        auto it = m_peer_items.find(peer);
+        return it != m_peer_items.end() && it->second.size() >= MAX_PEER_TX_PREVALIDATION_QUEUE;
+    }
+
+    void RemovePeer(NodeId peer)
+    {
+        LOCK(m_mutex);
+        auto it = m_peer_items.find(peer);
+        if (it == m_peer_items.end()) {
+            return;
+        }
+        m_queued -= it->second.size();
+        m_peer_items.erase(it);
+        m_work.erase(std::remove_if(m_work.begin(), m_work.end(),
+            [peer](const std::shared_ptr<Item>& item) { return item->peer == peer; }), m_work.end());
+    }
+
+    void GetStats(TxPreValidationStats& stats)
+    {
+        LOCK(m_mutex);
+        stats = m_stats;
+        stats.threads = m_threads.size();
+        stats.queued = m_queued;
+    }
+
+private:
+    struct Item {
+        NodeId peer;
+        CTransactionRef tx;
+        bool ready{false};
+    };
+
+    void ThreadVerify()
+    {
+        while (true) {
+            std::shared_ptr<Item> item;
+            bool skip = false;
+            {
+                WAIT_LOCK(m_mutex, lock);
+                m_cond.wait(lock, [this]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || !m_work.empty(); });
+                if (m_stop) {
+                    return;
+                }
+                item = std::move(m_work.front());
+                m_work.pop_front();
+                if (m_failed.contains(item->tx->GetWitnessHash())) {
+                    // Another copy queued from a different peer failed meanwhile
+                    item->ready = true;
+                    m_stats.skipped++;
+                    skip = true;
+                }
+            }
+            if (skip) {
+                m_connman->WakeMessageHandler();
+                continue;
+            }
+
+            int64_t start = GetTimeMicros();
+            bool verified = false;
+            try {
+                verified = PreVerifyTransactionProofs(*item->tx, GetTime());
+            } catch (const std::exception& e) {
+                // The transaction is verified again when it is accepted
+                LogPrintf("%s: %s\n", __func__, e.what());
+            }
+
+            {
+                LOCK(m_mutex);
+                item->ready = true;
+                if (verified) {
+                    m_stats.verified++;
+                } else {
+                    m_stats.failed++;
+                    m_failed.insert(item->tx->GetWitnessHash());
+                }
+                m_stats.verify_time += GetTimeMicros() - start;
+            }
+            m_connman->WakeMessageHandler();
+        }
+    }
+
+    CConnman* const m_connman;
+
+    Mutex m_mutex;
+    std::condition_variable m_cond;
+    //! Transactions of each peer in the order they were received, until they are accepted
+    std::map<NodeId, std::deque<std::shared_ptr<Item>>> m_peer_items GUARDED_BY(m_mutex);
+    //! Transactions waiting for a thread to verify them
+    std::deque<std::shared_ptr<Item>> m_work GUARDED_BY(m_mutex);
+    size_t m_queued GUARDED_BY(m_mutex){0};
+    bool m_stop GUARDED_BY(m_mutex){false};
+    TxPreValidationStats m_stats GUARDED_BY(m_mutex);
+    //! Witness hashes of transactions that failed verification
+    CRollingBloomFilter m_failed GUARDED_BY(m_mutex){MAX_TX_PREVALIDATION_FAILED, 0.000001};
+
+    std::vector<std::thread> m_threads;
+};
+
 // This function is used for testing the stale tip eviction logic, see
 // denialofservice_tests.cpp
 void UpdateLastBlockAnnounceTime(NodeId node, int64_t time_in_seconds)
@@ -820,6 +1015,9 @@ void PeerLogicValidation::FinalizeNode(NodeId nodeid, bool& fUpdateConnectionTim
         mapBlocksInFlight.erase(entry.hash);
     }
     EraseOrphansFor(nodeid);
+    if (m_tx_prevalidator) {
+        m_tx_prevalidator->RemovePeer(nodeid);
+    }
     nPreferredDownload -= state->fPreferredDownload;
     nPeersWithValidatedDownloads -= (state->nBlocksInFlightValidHeaders != 0);
     assert(nPeersWithValidatedDownloads >= 0);
@@ -1399,6 +1597,11 @@ PeerLogicValidation::PeerLogicValidation(CConnman* connmanIn, BanMan* banman, CS
     // Initialize global variables that cannot be constructed at startup.
     recentRejects.reset(new CRollingBloomFilter(120000, 0.000001));
 
+    int prevalidation_threads = gArgs.GetArg("-txprevalidationthreads", DEFAULT_TX_PREVALIDATION_THREADS);
+    if (prevalidation_threads > 0) {
+        m_tx_prevalidator.reset(new TxPreValidator(connman, std::min(prevalidation_threads, MAX_TX_PREVALIDATION_THREADS)));
+    }
+
     const Consensus::Params& consensusParams = Params().GetConsensus();
     // Stale tip checking and peer eviction are on two different timers, but we
     // don't want them to get out of sync due to drift in the scheduler, so we
@@ -1408,6 +1611,17 @@ PeerLogicValidation::PeerLogicValidation(CConnman* connmanIn, BanMan* banman, CS
     scheduler.scheduleEvery(std::bind(&PeerLogicValidation::CheckForStaleTipAndEvictPeers, this, consensusParams), EXTRA_PEER_CHECK_INTERVAL * 1000);
 }
 
+PeerLogicValidation::~PeerLogicValidation() {}
+
+bool PeerLogicValidation::GetTxPreValidationStats(TxPreValidationStats& stats)
+{
+    if (!m_tx_prevalidator) {
+        return false;
+    }
+    m_tx_prevalidator->GetStats(stats);
+    return true;
+}
+
 /**
  * Evict orphan txn pool entries (EraseOrphanTx) based on a newly connected
  * block. Also save the time of the last tip update.
@@ -2174,7 +2388,146 @@ void static ProcessOrphanTx(CConnman* connman, std::set<uint256>& orphan_work_se
     }
 }
 
-bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStream& vRecv, int64_t nTimeReceived, const CChainParams& chainparams, CConnman* connman, BanMan* banman, const std::atomic<bool>& interruptMsgProc)
+/**
+ * Accept a transaction received from pfrom to the mempool, relay it and
+ * process the orphans depending on it, or keep it as an orphan itself.
+ */
+void static ProcessTransaction(CNode* pfrom, const CTransactionRef& ptx, CConnman* connman) LOCKS_EXCLUDED(cs_main)
+{
+    const CTransaction& tx = *ptx;
+    CInv inv(MSG_TX, tx.GetHash());
+
+    LOCK2(cs_main, g_cs_orphans);
+
+    TxValidationState state;
+
+    CNodeState* nodestate = State(pfrom->GetId());
+    nodestate->m_tx_download.m_tx_announced.erase(inv.hash);
+    nodestate->m_tx_download.m_tx_in_flight.erase(inv.hash);
+    EraseTxRequest(inv.hash);
+
+    std::list<CTransactionRef> lRemovedTxn;
+
+    if (!AlreadyHave(inv) &&
+        AcceptToMemoryPool(mempool, state, ptx, &lRemovedTxn, false /* bypass_limits */, 0 /* nAbsurdFee */)) {
+        mempool.check(&::ChainstateActive().CoinsTip());
+        RelayTransaction(tx.GetHash(), *connman);
+        for (unsigned int i = 0; i < tx.GetNumVOuts(); i++) {
+            auto it_by_prev = mapOrphanTransactionsByPrev.find(COutPoint(inv.hash, i));
+            if (it_by_prev != mapOrphanTransactionsByPrev.end()) {
+                for (const auto& elem : it_by_prev->second) {
+                    pfrom->orphan_work_set.insert(elem->first);
+                }
+            }
+        }
+
+        pfrom->nLastTXTime = GetTime();
+
+        LogPrint(BCLog::MEMPOOL, "AcceptToMemoryPool: peer=%d: accepted %s (poolsz %u txn, %u kB)\n",
+            pfrom->GetId(),
+            tx.GetHash().ToString(),
+            mempool.size(), mempool.DynamicMemoryUsage() / 1000);
+
+        // Recursively process any orphan transactions that depended on this one
+        ProcessOrphanTx(connman, pfrom->orphan_work_set, lRemovedTxn);
+    }
+    else if (state.GetResult() == TxValidationResult::TX_MISSING_INPUTS)
+    {
+        bool fRejectedParents = false; // It may be the case that the orphans parents have all been rejected
+        for (const CTxIn& txin : tx.vin) {
+            if (txin.IsAnonInput())
+                continue;
+            if (recentRejects->contains(txin.prevout.hash)) {
+                fRejectedParents = true;
+                break;
+            }
+        }
+        if (!fRejectedParents) {
+            uint32_t nFetchFlags = GetFetchFlags(pfrom);
+            const auto current_time = GetTime<std::chrono::microseconds>();
+
+            for (const CTxIn& txin : tx.vin) {
+                if (txin.IsAnonInput())
+                    continue;
+                CInv _inv(MSG_TX | nFetchFlags, txin.prevout.hash);
+                pfrom->AddInventoryKnown(_inv);
+                if (!AlreadyHave(_inv)) RequestTx(State(pfrom->GetId()), _inv.hash, current_time);
+            }
+            AddOrphanTx(ptx, pfrom->GetId());
+
+            // DoS prevention: do not allow mapOrphanTransactions to grow unbounded (see CVE-2012-3789)
+            unsigned int nMaxOrphanTx = (unsigned int)std::max((int64_t)0, gArgs.GetArg("-maxorphantx", DEFAULT_MAX_ORPHAN_TRANSACTIONS));
+            unsigned int nEvicted = LimitOrphanTxSize(nMaxOrphanTx);
+            if (nEvicted > 0) {
+                LogPrint(BCLog::MEMPOOL, "mapOrphan overflow, removed %u tx\n", nEvicted);
+            }
+        } else {
+            LogPrint(BCLog::MEMPOOL, "not keeping orphan with rejected parents %s\n",tx.GetHash().ToString());
+            // We will continue to reject this tx since it has rejected
+            // parents so avoid re-requesting it from other peers.
+            recentRejects->insert(tx.GetHash());
+        }
+    } else {
+        if (!tx.HasWitness() && state.GetResult() != TxValidationResult::TX_WITNESS_MUTATED) {
+            // Do not use rejection cache for witness transactions or
+            // witness-stripped transactions, as they can have been malleated.
+            // See https://github.com/bitcoin/bitcoin/issues/8279 for details.
+            assert(recentRejects);
+            recentRejects->insert(tx.GetHash());
+            if (RecursiveDynamicUsage(*ptx) < 100000) {
+                AddToCompactExtraTransactions(ptx);
+            }
+        } else if (tx.HasWitness() && RecursiveDynamicUsage(*ptx) < 100000) {
+            AddToCompactExtraTransactions(ptx);
+        }
+
+        if (pfrom->HasPermission(PF_FORCERELAY)) {
+            // Always relay transactions received from whitelisted peers, even
+            // if they were already in the mempool or rejected from it due
+            // to policy, allowing the node to function as a gateway for
+            // nodes hidden behind it.
+            //
+            // Never relay transactions that might result in being
+            // disconnected (or banned).
+            if (state.IsInvalid() && TxRelayMayResultInDisconnect(state)) {
+                LogPrintf("Not relaying invalid transaction %s from whitelisted peer=%d (%s)\n", tx.GetHash().ToString(), pfrom->GetId(), FormatStateMessage(state));
+            } else {
+                LogPrintf("Force relaying tx %s from whitelisted peer=%d\n", tx.GetHash().ToString(), pfrom->GetId());
+                RelayTransaction(tx.GetHash(), *connman);
+            }
+        }
+    }
+
+    for (const CTransactionRef& removedTx : lRemovedTxn)
+        AddToCompactExtraTransactions(removedTx);
+
+    // If a tx has been detected by recentRejects, we will have reached
+    // this point and the tx will have been ignored. Because we haven't run
+    // the tx through AcceptToMemoryPool, we won't have computed a DoS
+    // score for it or determined exactly why we consider it invalid.
+    //
+    // This means we won't penalize any peer subsequently relaying a DoSy
+    // tx (even if we penalized the first peer who gave it to us) because
+    // we have to account for recentRejects showing false positives. In
+    // other words, we shouldn't penalize a peer if we aren't *sure* they
+    // submitted a DoSy tx.
+    //
+    // Note that recentRejects doesn't just record DoSy or invalid
+    // transactions, but any tx not accepted by the mempool, which may be
+    // due to node policy (vs. consensus). So we can't blanket penalize a
+    // peer simply for relaying a tx that our recentRejects has caught,
+    // regardless of false positives.
+
+    if (state.IsInvalid())
+    {
+        LogPrint(BCLog::MEMPOOLREJ, "%s from peer=%d was not accepted: %s\n", tx.GetHash().ToString(),
+            pfrom->GetId(),
+            FormatStateMessage(state));
+        MaybePunishNodeForTx(pfrom->GetId(), state);
+    }
+}
+
+bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStream& vRecv, int64_t nTimeReceived, const CChainParams& chainparams, CConnman* connman, BanMan* banman, TxPreValidator* tx_prevalidator, const std::atomic<bool>& interruptMsgProc)
 {
     LogPrint(BCLog::NET, "received: %s (%u bytes) peer=%d\n", SanitizeString(strCommand), vRecv.size(), pfrom->GetId());
     if (gArgs.IsArgSet("-dropmessagestest") && GetRand(gArgs.GetArg("-dropmessagestest", 0)) == 0)
@@ -2802,134 +3155,18 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
         CInv inv(MSG_TX, tx.GetHash());
         pfrom->AddInventoryKnown(inv);
 
-        LOCK2(cs_main, g_cs_orphans);
-
-        TxValidationState state;
-
-        CNodeState* nodestate = State(pfrom->GetId());
-        nodestate->m_tx_download.m_tx_announced.erase(inv.hash);
-        nodestate->m_tx_download.m_tx_in_flight.erase(inv.hash);
-        EraseTxRequest(inv.hash);
-
-        std::list<CTransactionRef> lRemovedTxn;
-
-        if (!AlreadyHave(inv) &&
-            AcceptToMemoryPool(mempool, state, ptx, &lRemovedTxn, false /* bypass_limits */, 0 /* nAbsurdFee */)) {
-            mempool.check(&::ChainstateActive().CoinsTip());
-            RelayTransaction(tx.GetHash(), *connman);
-            for (unsigned int i = 0; i < tx.GetNumVOuts(); i++) {
-                auto it_by_prev = mapOrphanTransactionsByPrev.find(COutPoint(inv.hash, i));
-                if (it_by_prev != mapOrphanTransactionsByPrev.end()) {
-                    for (const auto& elem : it_by_prev->second) {
-                        pfrom->orphan_work_set.insert(elem->first);
-                    }
-                }
-            }
-
-            pfrom->nLastTXTime = GetTime();
-
-            LogPrint(BCLog::MEMPOOL, "AcceptToMemoryPool: peer=%d: accepted %s (poolsz %u txn, %u kB)\n",
-                pfrom->GetId(),
-                tx.GetHash().ToString(),
-                mempool.size(), mempool.DynamicMemoryUsage() / 1000);
-
-            // Recursively process any orphan transactions that depended on this one
-            ProcessOrphanTx(connman, pfrom->orphan_work_set, lRemovedTxn);
-        }
-        else if (state.GetResult() == TxValidationResult::TX_MISSING_INPUTS)
-        {
-            bool fRejectedParents = false; // It may be the case that the orphans parents have all been rejected
-            for (const CTxIn& txin : tx.vin) {
-                if (txin.IsAnonInput())
-                    continue;
-                if (recentRejects->contains(txin.prevout.hash)) {
-                    fRejectedParents = true;
-                    break;
-                }
-            }
-            if (!fRejectedParents) {
-                uint32_t nFetchFlags = GetFetchFlags(pfrom);
-                const auto current_time = GetTime<std::chrono::microseconds>();
-
-                for (const CTxIn& txin : tx.vin) {
-                    if (txin.IsAnonInput())
-                        continue;
-                    CInv _inv(MSG_TX | nFetchFlags, txin.prevout.hash);
-                    pfrom->AddInventoryKnown(_inv);
-                    if (!AlreadyHave(_inv)) RequestTx(State(pfrom->GetId()), _inv.hash, current_time);
-                }
-                AddOrphanTx(ptx, pfrom->GetId());
-
-                // DoS prevention: do not allow mapOrphanTransactions to grow unbounded (see CVE-2012-3789)
-                unsigned int nMaxOrphanTx = (unsigned int)std::max((int64_t)0, gArgs.GetArg("-maxorphantx", DEFAULT_MAX_ORPHAN_TRANSACTIONS));
-                unsigned int nEvicted = LimitOrphanTxSize(nMaxOrphanTx);
-                if (nEvicted > 0) {
-                    LogPrint(BCLog::MEMPOOL, "mapOrphan overflow, removed %u tx\n", nEvicted);
-                }
-            } else {
-                LogPrint(BCLog::MEMPOOL, "not keeping orphan with rejected parents %s\n",tx.GetHash().ToString());
-                // We will continue to reject this tx since it has rejected
-                // parents so avoid re-requesting it from other peers.
-                recentRejects->insert(tx.GetHash());
-            }
-        } else {
-            if (!tx.HasWitness() && state.GetResult() != TxValidationResult::TX_WITNESS_MUTATED) {
-                // Do not use rejection cache for witness transactions or
-                // witness-stripped transactions, as they can have been malleated.
-                // See https://github.com/bitcoin/bitcoin/issues/8279 for details.
-                assert(recentRejects);
-                recentRejects->insert(tx.GetHash());
-                if (RecursiveDynamicUsage(*ptx) < 100000) {
-                    AddToCompactExtraTransactions(ptx);
-                }
-            } else if (tx.HasWitness() && RecursiveDynamicUsage(*ptx) < 100000) {
-                AddToCompactExtraTransactions(ptx);
+        if (tx_prevalidator) {
+            bool already_have;
+            {
+                LOCK(cs_main);
+                already_have = AlreadyHave(inv);
             }
-
-            if (pfrom->HasPermission(PF_FORCERELAY)) {
-                // Always relay transactions received from whitelisted peers, even
-                // if they were already in the mempool or rejected from it due
-                // to policy, allowing the node to function as a gateway for
-                // nodes hidden behind it.
-                //
-                // Never relay transactions that might result in being
-                // disconnected (or banned).
-                if (state.IsInvalid() && TxRelayMayResultInDisconnect(state)) {
-                    LogPrintf("Not relaying invalid transaction %s from whitelisted peer=%d (%s)\n", tx.GetHash().ToString(), pfrom->GetId(), FormatStateMessage(state));
-                } else {
-                    LogPrintf("Force relaying tx %s from whitelisted peer=%d\n", tx.GetHash().ToString(), pfrom->GetId());
-                    RelayTransaction(tx.GetHash(), *connman);
-                }
+            // Known and recently rejected transactions are not verified again
+            if (!already_have && tx_prevalidator->Push(pfrom->GetId(), ptx)) {
+                return true;
             }
         }
-
-        for (const CTransactionRef& removedTx : lRemovedTxn)
-            AddToCompactExtraTransactions(removedTx);
-
-        // If a tx has been detected by recentRejects, we will have reached
-        // this point and the tx will have been ignored. Because we haven't run
-        // the tx through AcceptToMemoryPool, we won't have computed a DoS
-        // score for it or determined exactly why we consider it invalid.
-        //
-        // This means we won't penalize any peer subsequently relaying a DoSy
-        // tx (even if we penalized the first peer who gave it to us) because
-        // we have to account for recentRejects showing false positives. In
-        // other words, we shouldn't penalize a peer if we aren't *sure* they
-        // submitted a DoSy tx.
-        //
-        // Note that recentRejects doesn't just record DoSy or invalid
-        // transactions, but any tx not accepted by the mempool, which may be
-        // due to node policy (vs. consensus). So we can't blanket penalize a
-        // peer simply for relaying a tx that our recentRejects has caught,
-        // regardless of false positives.
-
-        if (state.IsInvalid())
-        {
-            LogPrint(BCLog::MEMPOOLREJ, "%s from peer=%d was not accepted: %s\n", tx.GetHash().ToString(),
-                pfrom->GetId(),
-                FormatStateMessage(state));
-            MaybePunishNodeForTx(pfrom->GetId(), state);
-        }
+        ProcessTransaction(pfrom, ptx, connman);
         return true;
     }
 
@@ -3108,7 +3345,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
         } // cs_main
 
         if (fProcessBLOCKTXN)
-            return ProcessMessage(pfrom, NetMsgType::BLOCKTXN, blockTxnMsg, nTimeReceived, chainparams, connman, banman, interruptMsgProc);
+            return ProcessMessage(pfrom, NetMsgType::BLOCKTXN, blockTxnMsg, nTimeReceived, chainparams, connman, banman, tx_prevalidator, interruptMsgProc);
 
         if (fRevertToHeaderProcessing) {
             // Headers received from HB compact block peers are permitted to be
@@ -3543,7 +3780,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
         return true;
     }
 
-    if (smsg::SMSG_UNKNOWN_MESSAGE != smsgModule.ReceiveData(pfrom, strCommand, vRecv)) {
+    if (smsg::SMSG_UNKNOWN_MESSAGE != smsgModule.QueueData(pfrom, strCommand, vRecv)) {
         return true;
     }
 
@@ -3605,6 +3842,14 @@ bool PeerLogicValidation::ProcessMessages(CNode* pfrom, std::atomic<bool>& inter
         }
     }
 
+    bool more_prevalidated = false;
+    if (m_tx_prevalidator) {
+        CTransactionRef ptx = m_tx_prevalidator->PopReady(pfrom->GetId(), more_prevalidated);
+        if (ptx) {
+            ProcessTransaction(pfrom, ptx, connman);
+        }
+    }
+
     if (pfrom->fDisconnect)
         return false;
 
@@ -3612,6 +3857,16 @@ bool PeerLogicValidation::ProcessMessages(CNode* pfrom, std::atomic<bool>& inter
     // and prevents vRecvGetData to grow unbounded
     if (!pfrom->vRecvGetData.empty()) return true;
     if (!pfrom->orphan_work_set.empty()) return true;
+    if (more_prevalidated) return true;
+
+    // Leave further messages in the receive queue, which pauses receiving,
+    // until the transactions being verified were accepted
+    if (m_tx_prevalidator && m_tx_prevalidator->IsFull(pfrom->GetId()))
+        return false;
+
+    // Likewise until the smsg-net thread caught up with the peer's secure messages
+    if (smsgModule.IsQueueFull(pfrom->GetId()))
+        return false;
 
     // Don't bother if send buffer is too full to respond anyway
     if (pfrom->fPauseSend)
@@ -3662,7 +3917,7 @@ bool PeerLogicValidation::ProcessMessages(CNode* pfrom, std::atomic<bool>& inter
     bool fRet = false;
     try
     {
-        fRet = ProcessMessage(pfrom, strCommand, vRecv, msg.m_time, chainparams, connman, m_banman, interruptMsgProc);
+        fRet = ProcessMessage(pfrom, strCommand, vRecv, msg.m_time, chainparams, connman, m_banman, m_tx_prevalidator.get(), interruptMsgProc);
         if (interruptMsgProc)
             return false;
         if (!pfrom->vRecvGetData.empty())
@@ -18,16 +18,32 @@ static const unsigned int DEFAULT_MAX_ORPHAN_TRANSACTIONS = 100;
 /** Default number of orphan+recently-replaced txn to keep around for block reconstruction */
 static const unsigned int DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN = 100;
 static const bool DEFAULT_PEERBLOOMFILTERS = false;
+/** Default for -txprevalidationthreads, threads verifying the proofs of inbound transactions outside cs_main */
+static const int DEFAULT_TX_PREVALIDATION_THREADS = 2;
+static const int MAX_TX_PREVALIDATION_THREADS = 16;
+
+class TxPreValidator;
+
+struct TxPreValidationStats {
+    int threads = 0;
+    uint64_t queued = 0;      //!< Waiting to be verified or accepted
+    uint64_t verified = 0;    //!< Proofs verified ahead of acceptance
+    uint64_t failed = 0;      //!< Proofs that failed, the transaction is rejected when accepted
+    uint64_t skipped = 0;     //!< Not verified again after the proofs failed before
+    int64_t verify_time = 0;  //!< Microseconds spent verifying
+};
 
 class PeerLogicValidation final : public CValidationInterface, public NetEventsInterface {
 private:
     CConnman* const connman;
     BanMan* const m_banman;
+    std::unique_ptr<TxPreValidator> m_tx_prevalidator;
 
     bool CheckIfBanned(CNode* pnode) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
 public:
     PeerLogicValidation(CConnman* connman, BanMan* banman, CScheduler& scheduler);
+    ~PeerLogicValidation();
 
     /**
      * Overridden from CValidationInterface.
@@ -72,6 +88,9 @@ public:
     /** If we have extra outbound peers, try to disconnect the one with the oldest block announcement */
     void EvictExtraOutboundPeers(int64_t time_in_seconds) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+    /** Get the counts of inbound transactions verified ahead of acceptance, returns false if disabled */
+    bool GetTxPreValidationStats(TxPreValidationStats& stats);
+
 private:
     int64_t m_stale_tip_check_time; //!< Next time to check for stale tip
 };
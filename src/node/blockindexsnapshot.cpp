@@ -0,0 +1,399 @@
+// Copyright (c) 2020 The Graviocoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/blockindexsnapshot.h>
+
+#include <chain.h>
+#include <consensus/params.h>
+#include <crypto/common.h>
+#include <crypto/sha256.h>
+#include <fs.h>
+#include <txdb.h>
+#include <util/system.h>
+#include <util/time.h>
+#include <validation.h>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <string.h>
+#include <thread>
+
+#ifdef WIN32
+#include <stdio.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const unsigned char SNAPSHOT_MAGIC[4] = {'g', 'b', 'i', 'x'};
+const uint32_t SNAPSHOT_VERSION = 1;
+
+const size_t HEADER_SIZE = 96;
+const size_t RECORD_SIZE = 228;
+//! Records per checksummed chunk, a chunk is the unit of work when reading in parallel
+const size_t CHUNK_RECORDS = 4096;
+const int MAX_READ_THREADS = 16;
+
+fs::path GetSnapshotPath()
+{
+    return GetDataDir() / "blocks" / "index.snapshot";
+}
+
+/** Header fields, the checksum covers the header up to the checksum and the hash of each chunk of records. */
+struct SnapshotHeader
+{
+    uint64_t count = 0;
+    uint256 best_block;
+    int last_file = 0;
+    uint32_t last_file_size = 0;
+    uint32_t last_file_undo_size = 0;
+    uint256 checksum;
+
+    void Write(unsigned char *p) const
+    {
+        memset(p, 0, HEADER_SIZE);
+        memcpy(p, SNAPSHOT_MAGIC, 4);
+        WriteLE32(p + 4, SNAPSHOT_VERSION);
+        WriteLE64(p + 8, count);
+        memcpy(p + 16, best_block.begin(), 32);
+        WriteLE32(p + 48, (uint32_t)last_file);
+        WriteLE32(p + 52, last_file_size);
+        WriteLE32(p + 56, last_file_undo_size);
+        memcpy(p + 64, checksum.begin(), 32);
+    }
+
+    bool Read(const unsigned char *p)
+    {
+        if (memcmp(p, SNAPSHOT_MAGIC, 4) != 0 || ReadLE32(p + 4) != SNAPSHOT_VERSION) {
+            return false;
+        }
+        count = ReadLE64(p + 8);
+        memcpy(best_block.begin(), p + 16, 32);
+        last_file = (int)ReadLE32(p + 48);
+        last_file_size = ReadLE32(p + 52);
+        last_file_undo_size = ReadLE32(p + 56);
+        memcpy(checksum.begin(), p + 64, 32);
+        return true;
+    }
+};
+
+void WriteRecord(unsigned char *p, const CBlockIndex *pindex, int32_t prev_pos)
+{
+    memcpy(p, pindex->GetBlockHash().begin(), 32);
+    WriteLE32(p + 32, (uint32_t)prev_pos);
+    WriteLE32(p + 36, (uint32_t)pindex->nHeight);
+    WriteLE32(p + 40, pindex->nStatus);
+    WriteLE32(p + 44, pindex->nTx);
+    WriteLE32(p + 48, (uint32_t)pindex->nFile);
+    WriteLE32(p + 52, pindex->nDataPos);
+    WriteLE32(p + 56, pindex->nUndoPos);
+    WriteLE32(p + 60, pindex->nFlags);
+    memcpy(p + 64, pindex->bnStakeModifier.begin(), 32);
+    memcpy(p + 96, pindex->prevoutStake.hash.begin(), 32);
+    WriteLE32(p + 128, pindex->prevoutStake.n);
+    WriteLE32(p + 132, (uint32_t)pindex->nVersion);
+    WriteLE64(p + 136, (uint64_t)pindex->nMoneySupply);
+    WriteLE64(p + 144, (uint64_t)pindex->nAnonOutputs);
+    memcpy(p + 152, pindex->hashMerkleRoot.begin(), 32);
+    memcpy(p + 184, pindex->hashWitnessMerkleRoot.begin(), 32);
+    WriteLE32(p + 216, pindex->nTime);
+    WriteLE32(p + 220, pindex->nBits);
+    WriteLE32(p + 224, pindex->nNonce);
+}
+
+void ReadRecord(const unsigned char *p, uint256 &hash, int32_t &prev_pos, CBlockIndex *pindex)
+{
+    memcpy(hash.begin(), p, 32);
+    prev_pos = (int32_t)ReadLE32(p + 32);
+    pindex->nHeight = (int)ReadLE32(p + 36);
+    pindex->nStatus = ReadLE32(p + 40);
+    pindex->nTx = ReadLE32(p + 44);
+    pindex->nFile = (int)ReadLE32(p + 48);
+    pindex->nDataPos = ReadLE32(p + 52);
+    pindex->nUndoPos = ReadLE32(p + 56);
+    pindex->nFlags = ReadLE32(p + 60) & ~BLOCK_DELAYED;
+    memcpy(pindex->bnStakeModifier.begin(), p + 64, 32);
+    memcpy(pindex->prevoutStake.hash.begin(), p + 96, 32);
+    pindex->prevoutStake.n = ReadLE32(p + 128);
+    pindex->nVersion = (int32_t)ReadLE32(p + 132);
+    pindex->nMoneySupply = (CAmount)ReadLE64(p + 136);
+    pindex->nAnonOutputs = (int64_t)ReadLE64(p + 144);
+    memcpy(pindex->hashMerkleRoot.begin(), p + 152, 32);
+    memcpy(pindex->hashWitnessMerkleRoot.begin(), p + 184, 32);
+    pindex->nTime = ReadLE32(p + 216);
+    pindex->nBits = ReadLE32(p + 220);
+    pindex->nNonce = ReadLE32(p + 224);
+}
+
+uint256 GetChecksum(const unsigned char *header, const std::vector<uint256> &chunk_hashes)
+{
+    uint256 checksum;
+    CSHA256 hasher;
+    hasher.Write(header, 64);
+    for (const auto &h : chunk_hashes) {
+        hasher.Write(h.begin(), 32);
+    }
+    hasher.Finalize(checksum.begin());
+    return checksum;
+}
+
+/** Read only view of a file, mapped into memory where supported. */
+class MappedFile
+{
+public:
+    explicit MappedFile(const fs::path &path)
+    {
+#ifdef WIN32
+        FILE *file = fsbridge::fopen(path, "rb");
+        if (!file) {
+            return;
+        }
+        if (fseek(file, 0, SEEK_END) == 0) {
+            long size = ftell(file);
+            if (size > 0 && fseek(file, 0, SEEK_SET) == 0) {
+                m_buffer.resize(size);
+                if (fread(m_buffer.data(), 1, size, file) == (size_t)size) {
+                    m_data = m_buffer.data();
+                    m_size = size;
+                }
+            }
+        }
+        fclose(file);
+#else
+        int fd = open(path.string().c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED) {
+                madvise(addr, st.st_size, MADV_WILLNEED);
+                m_data = (const unsigned char*)addr;
+                m_size = st.st_size;
+            }
+        }
+        close(fd);
+#endif
+    }
+
+    ~MappedFile()
+    {
+#ifndef WIN32
+        if (m_data) {
+            munmap((void*)m_data, m_size);
+        }
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char *data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    const unsigned char *m_data = nullptr;
+    size_t m_size = 0;
+#ifdef WIN32
+    std::vector<unsigned char> m_buffer;
+#endif
+};
+
+} // namespace
+
+bool WriteBlockIndexSnapshot(CBlockTreeDB &blocktree, const BlockMap &block_index)
+{
+    int64_t nStart = GetTimeMillis();
+
+    std::vector<const CBlockIndex*> sorted;
+    sorted.reserve(block_index.size());
+    for (const auto &item : block_index) {
+        sorted.push_back(item.second);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const CBlockIndex *a, const CBlockIndex *b) {
+        return a->nHeight < b->nHeight;
+    });
+    std::unordered_map<const CBlockIndex*, int32_t> positions;
+    positions.reserve(sorted.size());
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        positions.emplace(sorted[i], (int32_t)i);
+    }
+
+    SnapshotHeader header;
+    header.count = sorted.size();
+    const CBlockIndex *pindexBest = ::ChainActive().Tip();
+    if (pindexBest) {
+        header.best_block = pindexBest->GetBlockHash();
+    }
+    CBlockFileInfo info;
+    if (!blocktree.ReadLastBlockFile(header.last_file)) {
+        header.last_file = 0;
+    }
+    if (blocktree.ReadBlockFileInfo(header.last_file, info)) {
+        header.last_file_size = info.nSize;
+        header.last_file_undo_size = info.nUndoSize;
+    }
+
+    fs::path path = GetSnapshotPath();
+    fs::path temppath = path.string() + ".new";
+    FILE *file = fsbridge::fopen(temppath, "wb");
+    if (!file) {
+        return error("%s: Failed to open %s", __func__, temppath.string());
+    }
+
+    unsigned char header_data[HEADER_SIZE];
+    header.Write(header_data);
+    bool fOk = fwrite(header_data, 1, HEADER_SIZE, file) == HEADER_SIZE;
+
+    std::vector<uint256> chunk_hashes;
+    std::vector<unsigned char> chunk(CHUNK_RECORDS * RECORD_SIZE);
+    for (size_t i = 0; fOk && i < sorted.size(); i += CHUNK_RECORDS) {
+        size_t n = std::min(CHUNK_RECORDS, sorted.size() - i);
+        for (size_t k = 0; k < n; ++k) {
+            const CBlockIndex *pindex = sorted[i + k];
+            int32_t prev_pos = -1;
+            if (pindex->pprev) {
+                auto it = positions.find(pindex->pprev);
+                if (it == positions.end()) {
+                    fOk = false;
+                    break;
+                }
+                prev_pos = it->second;
+            }
+            WriteRecord(&chunk[k * RECORD_SIZE], pindex, prev_pos);
+        }
+        chunk_hashes.emplace_back();
+        CSHA256().Write(chunk.data(), n * RECORD_SIZE).Finalize(chunk_hashes.back().begin());
+        fOk = fOk && fwrite(chunk.data(), 1, n * RECORD_SIZE, file) == n * RECORD_SIZE;
+    }
+
+    header.checksum = GetChecksum(header_data, chunk_hashes);
+    header.Write(header_data);
+    fOk = fOk && fseek(file, 0, SEEK_SET) == 0
+        && fwrite(header_data, 1, HEADER_SIZE, file) == HEADER_SIZE
+        && FileCommit(file);
+    fclose(file);
+
+    if (!fOk || !RenameOver(temppath, path)) {
+        fs::remove(temppath);
+        return error("%s: Failed to write %s", __func__, path.string());
+    }
+    if (!blocktree.WriteBlockIndexSnapshotMarker(header.checksum)) {
+        return error("%s: Failed to write marker", __func__);
+    }
+
+    LogPrintf("Wrote %u block index entries to snapshot in %dms\n", sorted.size(), GetTimeMillis() - nStart);
+    return true;
+}
+
+bool ReadBlockIndexSnapshot(CBlockTreeDB &blocktree, const Consensus::Params &consensus,
+                            std::vector<std::pair<uint256, CBlockIndex*> > &entries, uint256 &best_block)
+{
+    uint256 marker;
+    if (!blocktree.ReadBlockIndexSnapshotMarker(marker)) {
+        return false;
+    }
+    // Single use, the block index changes from here on
+    if (!blocktree.EraseBlockIndexSnapshotMarker()) {
+        return error("%s: Failed to erase marker", __func__);
+    }
+
+    int64_t nStart = GetTimeMillis();
+    fs::path path = GetSnapshotPath();
+    MappedFile file(path);
+    SnapshotHeader header;
+    if (!file.data() || file.size() < HEADER_SIZE || !header.Read(file.data())) {
+        LogPrintf("%s: Failed to open %s\n", __func__, path.string());
+        return false;
+    }
+    if (header.checksum != marker
+        || header.count > (uint64_t)std::numeric_limits<int32_t>::max()
+        || file.size() != HEADER_SIZE + header.count * RECORD_SIZE) {
+        LogPrintf("%s: Stale block index snapshot\n", __func__);
+        return false;
+    }
+    int last_file = 0;
+    CBlockFileInfo info;
+    if (!blocktree.ReadLastBlockFile(last_file)) {
+        last_file = 0;
+    }
+    if (blocktree.ReadBlockFileInfo(last_file, info)
+        ? (info.nSize != header.last_file_size || info.nUndoSize != header.last_file_undo_size)
+        : (header.last_file_size != 0 || header.last_file_undo_size != 0)) {
+        LogPrintf("%s: Stale block index snapshot, block files changed\n", __func__);
+        return false;
+    }
+    if (last_file != header.last_file) {
+        LogPrintf("%s: Stale block index snapshot, block files changed\n", __func__);
+        return false;
+    }
+
+    const size_t count = header.count;
+    const unsigned char *records = file.data() + HEADER_SIZE;
+    const size_t n_chunks = (count + CHUNK_RECORDS - 1) / CHUNK_RECORDS;
+    std::vector<uint256> chunk_hashes(n_chunks);
+    std::vector<int32_t> prev_positions(count);
+    entries.assign(count, std::make_pair(uint256(), nullptr));
+
+    // Hash and decode chunks of records in parallel
+    std::atomic<size_t> next_chunk{0};
+    auto worker = [&]() {
+        size_t c;
+        while ((c = next_chunk++) < n_chunks) {
+            size_t begin = c * CHUNK_RECORDS;
+            size_t end = std::min(begin + CHUNK_RECORDS, count);
+            const unsigned char *p = records + begin * RECORD_SIZE;
+            CSHA256().Write(p, (end - begin) * RECORD_SIZE).Finalize(chunk_hashes[c].begin());
+            for (size_t i = begin; i < end; ++i, p += RECORD_SIZE) {
+                entries[i].second = new CBlockIndex();
+                ReadRecord(p, entries[i].first, prev_positions[i], entries[i].second);
+            }
+        }
+    };
+    int n_threads = std::max(1, std::min({GetNumCores(), MAX_READ_THREADS, (int)n_chunks}));
+    std::vector<std::thread> threads;
+    for (int i = 1; i < n_threads; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    bool fValid = GetChecksum(file.data(), chunk_hashes) == header.checksum;
+    bool fFoundBest = header.best_block.IsNull();
+    for (size_t i = 0; fValid && i < count; ++i) {
+        CBlockIndex *pindex = entries[i].second;
+        int32_t prev_pos = prev_positions[i];
+        if (prev_pos < 0) {
+            fValid = pindex->nHeight == 0 && entries[i].first == consensus.hashGenesisBlock;
+        } else {
+            fValid = (size_t)prev_pos < i && entries[prev_pos].second->nHeight + 1 == pindex->nHeight;
+            if (fValid) {
+                pindex->pprev = entries[prev_pos].second;
+            }
+        }
+        if (entries[i].first == header.best_block) {
+            fFoundBest = true;
+        }
+    }
+    if (!fValid || !fFoundBest) {
+        for (auto &entry : entries) {
+            delete entry.second;
+        }
+        entries.clear();
+        LogPrintf("%s: Invalid block index snapshot\n", __func__);
+        return false;
+    }
+
+    best_block = header.best_block;
+    LogPrintf("Loaded %u block index entries from snapshot in %dms\n", count, GetTimeMillis() - nStart);
+    return true;
+}
@@ -0,0 +1,46 @@
+// Copyright (c) 2020 The Graviocoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GIO_NODE_BLOCKINDEXSNAPSHOT_H
+#define GIO_NODE_BLOCKINDEXSNAPSHOT_H
+
+#include <uint256.h>
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class CBlockIndex;
+class CBlockTreeDB;
+struct BlockHasher;
+namespace Consensus { struct Params; }
+
+static const bool DEFAULT_BLOCK_INDEX_SNAPSHOT = true;
+
+/**
+ * The block index snapshot, blocks/index.snapshot, is a copy of the block
+ * index records in the block tree db, written at a clean shutdown so the next
+ * start can skip iterating and hashing every record.
+ *
+ * Fixed size records are ordered by height and link to the position of their
+ * parent, the file can be mapped and decoded in parallel.
+ * The snapshot is only used while the block tree db holds a marker with its
+ * checksum, the marker is erased as the snapshot is read, so any later change
+ * to the block index, or an unclean shutdown, leaves the snapshot stale.
+ */
+
+//! Write the snapshot of block_index, must be called after the block index was flushed to blocktree.
+bool WriteBlockIndexSnapshot(CBlockTreeDB &blocktree, const std::unordered_map<uint256, CBlockIndex*, BlockHasher> &block_index);
+
+/**
+ * Read and verify the snapshot.
+ * On success entries holds the hash and a new CBlockIndex for each record, in height order.
+ * pprev is linked, phashBlock is left for the caller to set when inserting the entries into the block index.
+ * best_block is the tip when the snapshot was written, the caller must check it against the coins db.
+ * Returns false if the snapshot is missing, stale or invalid, the block index must then be read from blocktree.
+ */
+bool ReadBlockIndexSnapshot(CBlockTreeDB &blocktree, const Consensus::Params &consensus,
+                            std::vector<std::pair<uint256, CBlockIndex*> > &entries, uint256 &best_block);
+
+#endif // GIO_NODE_BLOCKINDEXSNAPSHOT_H
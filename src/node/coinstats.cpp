@@ -8,6 +8,7 @@
 #include <coins.h>
 #include <hash.h>
 #include <serialize.h>
+#include <shutdown.h>
 #include <validation.h>
 #include <uint256.h>
 #include <util/system.h>
@@ -31,7 +32,7 @@ static void ApplyStats(CCoinsStats &stats, CHashWriter& ss, const uint256& hash,
                 stats.nTotalAmount += output.second.out.nValue;
                 break;
             case OUTPUT_CT:
-                ss.write((char*)&output.second.commitment.data[0], 33);
+                ss.write((char*)&output.second.GetCommitment().data[0], 33);
                 stats.nBlindTransactionOutputs++;
                 break;
             default:
@@ -56,7 +57,11 @@ bool GetUTXOStats(CCoinsView *view, CCoinsStats &stats)
     stats.hashBlock = pcursor->GetBestBlock();
     {
         LOCK(cs_main);
-        stats.nHeight = LookupBlockIndex(stats.hashBlock)->nHeight;
+        const CBlockIndex* pindex = LookupBlockIndex(stats.hashBlock);
+        if (!pindex) {
+            return error("%s: best block %s not found", __func__, stats.hashBlock.ToString());
+        }
+        stats.nHeight = pindex->nHeight;
     }
     ss << stats.hashBlock;
     uint256 prevkey;
@@ -84,3 +89,72 @@ bool GetUTXOStats(CCoinsView *view, CCoinsStats &stats)
     stats.nDiskSize = view->EstimateSize();
     return true;
 }
+
+bool GetUTXOTypeStats(CUTXOStats& stats, uint256& hashBlock, int& nHeight)
+{
+    // Only one caller initialises the totals
+    static Mutex cs_init_scan;
+    LOCK(cs_init_scan);
+
+    std::unique_ptr<CCoinsViewCursor> pcursor;
+    {
+        LOCK(cs_main);
+        CCoinsViewDB& db = ::ChainstateActive().CoinsDB();
+        if (!db.ReadUTXOStats(stats)) {
+            ::ChainstateActive().ForceFlushStateToDisk();
+            // The cursor reads the database as of now, later flushes are collected by the db
+            pcursor.reset(db.Cursor());
+            assert(pcursor);
+            db.BeginUTXOStatsScan();
+        }
+    }
+
+    if (pcursor) {
+        LogPrintf("Scanning the UTXO set to initialise the unspent output totals...\n");
+        CUTXOStats scanned;
+        bool fInterrupted = false, fReadError = false;
+        while (pcursor->Valid()) {
+            if (ShutdownRequested()) {
+                fInterrupted = true;
+                break;
+            }
+            COutPoint key;
+            Coin coin;
+            if (!pcursor->GetKey(key) || !pcursor->GetValue(coin)) {
+                fReadError = true;
+                break;
+            }
+            scanned.ApplyCoin(coin, false);
+            pcursor->Next();
+        }
+        pcursor.reset();
+
+        LOCK(cs_main);
+        CCoinsViewDB& db = ::ChainstateActive().CoinsDB();
+        if (fInterrupted || fReadError) {
+            db.AbortUTXOStatsScan();
+            return fReadError ? error("%s: unable to read value", __func__)
+                : error("%s: interrupted", __func__);
+        }
+        if (!db.FinishUTXOStatsScan(scanned)) {
+            return error("%s: unable to write unspent output totals", __func__);
+        }
+        LogPrintf("Unspent output totals initialised.\n");
+    }
+
+    LOCK(cs_main);
+    if (!::ChainstateActive().CoinsDB().ReadUTXOStats(stats)) {
+        return error("%s: unspent output totals not found", __func__);
+    }
+
+    // Add the changes not yet flushed to the database
+    const CCoinsViewCache& tip = ::ChainstateActive().CoinsTip();
+    stats += tip.cacheStatsDelta;
+    hashBlock = tip.GetBestBlock();
+    const CBlockIndex* pindex = LookupBlockIndex(hashBlock);
+    if (!pindex) {
+        return error("%s: best block %s not found", __func__, hashBlock.ToString());
+    }
+    nHeight = pindex->nHeight;
+    return true;
+}
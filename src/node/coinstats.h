@@ -12,6 +12,7 @@
 #include <cstdint>
 
 class CCoinsView;
+class CUTXOStats;
 
 struct CCoinsStats
 {
@@ -34,4 +35,8 @@ struct CCoinsStats
 //! Calculate statistics about the unspent transaction output set
 bool GetUTXOStats(CCoinsView* view, CCoinsStats& stats);
 
+//! Get the running totals of the unspent transaction outputs at the chain tip,
+//! the set is scanned once when the totals are not kept yet.
+bool GetUTXOTypeStats(CUTXOStats& stats, uint256& hashBlock, int& nHeight);
+
 #endif // BITCOIN_NODE_COINSTATS_H
@@ -6,11 +6,16 @@
 #ifndef BITCOIN_NODE_UTXO_SNAPSHOT_H
 #define BITCOIN_NODE_UTXO_SNAPSHOT_H
 
+#include <amount.h>
 #include <uint256.h>
 #include <serialize.h>
 
 //! Metadata describing a serialized version of a UTXO set from which an
 //! assumeutxo CChainState can be constructed.
+//!
+//! The metadata is followed by the coins, the anon outputs (DB_RCTOUTPUT),
+//! the spent key images (DB_RCTKEYIMAGE) and the stake modifier of every block
+//! from genesis to the base block, each in database key or height order.
 class SnapshotMetadata
 {
 public:
@@ -26,6 +31,18 @@ public:
     //! initial block download for the assumeutxo chainstate.
     unsigned int m_nchaintx = 0;
 
+    //! The number of anon outputs and spent key images in the snapshot.
+    uint64_t m_anon_outputs_count = 0;
+    uint64_t m_key_images_count = 0;
+
+    //! The money supply and last anon output index of the base block, which
+    //! the next block builds on (see CBlockIndex).
+    CAmount m_money_supply = 0;
+    int64_t m_last_anon_output = 0;
+
+    //! The number of stake modifiers, the base block height + 1.
+    uint32_t m_stake_modifiers_count = 0;
+
     SnapshotMetadata() { }
     SnapshotMetadata(
         const uint256& base_blockhash,
@@ -43,6 +60,11 @@ public:
         READWRITE(m_base_blockhash);
         READWRITE(m_coins_count);
         READWRITE(m_nchaintx);
+        READWRITE(m_anon_outputs_count);
+        READWRITE(m_key_images_count);
+        READWRITE(m_money_supply);
+        READWRITE(m_last_anon_output);
+        READWRITE(m_stake_modifiers_count);
     }
 
 };
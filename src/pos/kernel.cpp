@@ -16,6 +16,7 @@
 #include <policy/policy.h>
 #include <consensus/validation.h>
 #include <coins.h>
+#include <index/spentindex.h>
 #include <insight/insight.h>
 #include <txmempool.h>
 
@@ -190,7 +191,8 @@ static bool SpendTooDeep(const COutPoint &prevout) EXCLUSIVE_LOCKS_REQUIRED(cs_m
     LogPrint(BCLog::POS, "%s: SpendTooDeep %s.\n", __func__, prevout.ToString());
     CBlockIndex *pindexTip = ::ChainActive().Tip();
 
-    if (fSpentIndex) {
+    // The spent index is built asynchronously, scan the blocks instead while it is behind the tip
+    if (fSpentIndex && g_spent_index && g_spent_index->IsSyncedTo(pindexTip)) {
         CSpentIndexKey key(prevout.hash, prevout.n);
         CSpentIndexValue value;
         if (GetSpentIndex(key, value)) {
@@ -34,6 +34,9 @@ static const bool DEFAULT_SPLASHSCREEN = true;
 /* Transaction list -- TX status decoration - default color */
 #define COLOR_BLACK QColor(0, 0, 0)
 
+/* TransactionTableModel -- Number of wallet transactions loaded per page */
+static const int TRANSACTION_FETCH_PAGE_SIZE = 1000;
+
 /* Tooltips longer than this (in characters) are converted into rich text,
    so that they can be word-wrapped.
  */
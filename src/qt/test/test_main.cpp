@@ -16,6 +16,7 @@
 
 #ifdef ENABLE_WALLET
 #include <qt/test/addressbooktests.h>
+#include <qt/test/transactiontablemodeltests.h>
 #include <qt/test/wallettests.h>
 #endif // ENABLE_WALLET
 
@@ -93,6 +94,10 @@ int main(int argc, char *argv[])
     if (QTest::qExec(&test6) != 0) {
         fInvalid = true;
     }
+    TransactionTableModelTests test7(*node);
+    if (QTest::qExec(&test7) != 0) {
+        fInvalid = true;
+    }
 #endif
 
     return fInvalid;
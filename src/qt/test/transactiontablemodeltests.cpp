@@ -0,0 +1,279 @@
+#include <qt/test/transactiontablemodeltests.h>
+
+#include <interfaces/handler.h>
+#include <interfaces/node.h>
+#include <interfaces/wallet.h>
+#include <outputtype.h>
+#include <primitives/transaction.h>
+#include <qt/optionsmodel.h>
+#include <qt/platformstyle.h>
+#include <qt/transactiontablemodel.h>
+#include <qt/walletmodel.h>
+#include <script/ismine.h>
+#include <util/error.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+
+#include <boost/signals2/connection.hpp>
+
+namespace
+{
+
+/** Wallet serving transactions from a map, enough for the transaction table
+ * model to page through them.
+ */
+class PagedWallet : public interfaces::Wallet
+{
+public:
+    std::map<uint256, interfaces::WalletTx> m_txs;
+
+    void addTx(uint32_t n, int64_t time)
+    {
+        CMutableTransaction mtx;
+        mtx.nVersion = GIO_TXN_VERSION;
+        mtx.nLockTime = n;
+        mtx.vpout.push_back(MAKE_OUTPUT<CTxOutStandard>(COIN, CScript() << OP_TRUE));
+
+        interfaces::WalletTx wtx;
+        wtx.tx = MakeTransactionRef(mtx);
+        wtx.txout_is_mine.push_back(ISMINE_SPENDABLE);
+        wtx.txout_address.push_back(CNoDestination());
+        wtx.txout_address_is_mine.push_back(ISMINE_SPENDABLE);
+        wtx.credit = COIN;
+        wtx.debit = 0;
+        wtx.change = 0;
+        wtx.time = time;
+        wtx.is_coinbase = false;
+        wtx.is_coinstake = false;
+        wtx.partWallet = nullptr;
+        m_txs[wtx.tx->GetHash()] = wtx;
+    }
+
+    interfaces::WalletTx getWalletTx(const uint256& txid) override
+    {
+        auto mi = m_txs.find(txid);
+        return mi != m_txs.end() ? mi->second : interfaces::WalletTx();
+    }
+    std::vector<interfaces::WalletTx> getWalletTxs() override
+    {
+        std::vector<interfaces::WalletTx> result;
+        for (const auto& entry : m_txs) {
+            result.push_back(entry.second);
+        }
+        return result;
+    }
+    std::vector<interfaces::WalletTx> getWalletTxsPage(interfaces::WalletTxCursor& cursor, size_t max_count) override
+    {
+        typedef std::pair<int64_t, uint256> TxKey;
+        const TxKey cursor_key(cursor.time, cursor.hash);
+        std::vector<TxKey> keys;
+        for (const auto& entry : m_txs) {
+            TxKey key(entry.second.time, entry.first);
+            if (!cursor.is_set || key < cursor_key) {
+                keys.push_back(key);
+            }
+        }
+        std::sort(keys.begin(), keys.end(), std::greater<TxKey>());
+        keys.resize(std::min(keys.size(), max_count));
+
+        std::vector<interfaces::WalletTx> result;
+        for (const auto& key : keys) {
+            result.push_back(m_txs.at(key.second));
+        }
+        if (!keys.empty()) {
+            cursor.time = keys.back().first;
+            cursor.hash = keys.back().second;
+            cursor.is_set = true;
+        }
+        return result;
+    }
+    CTransactionRef getTx(const uint256& txid) override { return getWalletTx(txid).tx; }
+
+    bool encryptWallet(const SecureString& wallet_passphrase) override { return false; }
+    bool isCrypted() override { return false; }
+    bool lock() override { return false; }
+    bool unlock(const SecureString& wallet_passphrase, bool for_staking_only) override { return false; }
+    bool isLocked() override { return false; }
+    bool changeWalletPassphrase(const SecureString& old_wallet_passphrase,
+        const SecureString& new_wallet_passphrase) override { return false; }
+    void abortRescan() override {}
+    bool backupWallet(const std::string& filename) override { return false; }
+    std::string getWalletName() override { return "paged"; }
+    bool getNewDestination(const OutputType type, const std::string label, CTxDestination& dest) override { return false; }
+    bool getPubKey(const CScript& script, const CKeyID& address, CPubKey& pub_key) override { return false; }
+    bool getPrivKey(const CScript& script, const CKeyID& address, CKey& key) override { return false; }
+    bool isSpendable(const CTxDestination& dest) override { return false; }
+    bool haveWatchOnly() override { return false; }
+    bool setAddressBook(const CTxDestination& dest, const std::string& name, const std::string& purpose) override { return false; }
+    bool delAddressBook(const CTxDestination& dest) override { return false; }
+    bool getAddress(const CTxDestination& dest,
+        std::string* name,
+        isminetype* is_mine,
+        std::string* purpose) override { return false; }
+    std::vector<interfaces::WalletAddress> getAddresses() override { return {}; }
+    void learnRelatedScripts(const CPubKey& key, OutputType type) override {}
+    bool addDestData(const CTxDestination& dest, const std::string& key, const std::string& value) override { return false; }
+    bool eraseDestData(const CTxDestination& dest, const std::string& key) override { return false; }
+    std::vector<std::string> getDestValues(const std::string& prefix) override { return {}; }
+    void lockCoin(const COutPoint& output) override {}
+    void unlockCoin(const COutPoint& output) override {}
+    bool isLockedCoin(const COutPoint& output) override { return false; }
+    void listLockedCoins(std::vector<COutPoint>& outputs) override {}
+    CTransactionRef createTransaction(const std::vector<CRecipient>& recipients,
+        const CCoinControl& coin_control,
+        bool sign,
+        int& change_pos,
+        CAmount& fee,
+        std::string& fail_reason) override { return nullptr; }
+    void commitTransaction(CTransactionRef tx,
+        interfaces::WalletValueMap value_map,
+        interfaces::WalletOrderForm order_form) override {}
+    bool transactionCanBeAbandoned(const uint256& txid) override { return false; }
+    bool abandonTransaction(const uint256& txid) override { return false; }
+    bool transactionCanBeBumped(const uint256& txid) override { return false; }
+    bool createBumpTransaction(const uint256& txid,
+        const CCoinControl& coin_control,
+        CAmount total_fee,
+        std::vector<std::string>& errors,
+        CAmount& old_fee,
+        CAmount& new_fee,
+        CMutableTransaction& mtx) override { return false; }
+    bool signBumpTransaction(CMutableTransaction& mtx) override { return false; }
+    bool commitBumpTransaction(const uint256& txid,
+        CMutableTransaction&& mtx,
+        std::vector<std::string>& errors,
+        uint256& bumped_txid) override { return false; }
+    bool tryGetTxStatus(const uint256& txid,
+        interfaces::WalletTxStatus& tx_status,
+        int& num_blocks,
+        int64_t& block_time) override { return false; }
+    interfaces::WalletTx getWalletTxDetails(const uint256& txid,
+        interfaces::WalletTxStatus& tx_status,
+        interfaces::WalletOrderForm& order_form,
+        bool& in_mempool,
+        int& num_blocks) override { return getWalletTx(txid); }
+    TransactionError fillPSBT(PartiallySignedTransaction& psbtx,
+        bool& complete,
+        int sighash_type,
+        bool sign,
+        bool bip32derivs) override { return TransactionError::INVALID_PSBT; }
+    interfaces::WalletBalances getBalances() override { return {}; }
+    bool tryGetBalances(interfaces::WalletBalances& balances, bool skip_height_check, int cached_blocks, int& num_blocks) override { return false; }
+    CAmount getBalance() override { return 0; }
+    CAmount getAvailableBalance(const CCoinControl& coin_control) override { return 0; }
+    isminetype txinIsMine(const CTxIn& txin) override { return ISMINE_NO; }
+    isminetype txoutIsMine(const CTxOut& txout) override { return ISMINE_NO; }
+    CAmount getDebit(const CTxIn& txin, isminefilter filter) override { return 0; }
+    CAmount getCredit(const CTxOut& txout, isminefilter filter) override { return 0; }
+    CoinsList listCoins(OutputTypes nType) override { return {}; }
+    std::vector<interfaces::WalletTxOut> getCoins(const std::vector<COutPoint>& outputs) override { return {}; }
+    CAmount getRequiredFee(unsigned int tx_bytes) override { return 0; }
+    CAmount getMinimumFee(unsigned int tx_bytes,
+        const CCoinControl& coin_control,
+        int* returned_target,
+        FeeReason* reason) override { return 0; }
+    unsigned int getConfirmTarget() override { return 0; }
+    bool hdEnabled() override { return false; }
+    bool canGetAddresses() override { return false; }
+    bool IsWalletFlagSet(uint64_t flag) override { return false; }
+    OutputType getDefaultAddressType() override { return OutputType::LEGACY; }
+    OutputType getDefaultChangeType() override { return OutputType::LEGACY; }
+    CAmount getDefaultMaxTxFee() override { return 0; }
+    void remove() override {}
+    std::unique_ptr<interfaces::Handler> handleUnload(UnloadFn fn) override { return interfaces::MakeHandler({}); }
+    std::unique_ptr<interfaces::Handler> handleShowProgress(ShowProgressFn fn) override { return interfaces::MakeHandler({}); }
+    std::unique_ptr<interfaces::Handler> handleStatusChanged(StatusChangedFn fn) override { return interfaces::MakeHandler({}); }
+    std::unique_ptr<interfaces::Handler> handleAddressBookChanged(AddressBookChangedFn fn) override { return interfaces::MakeHandler({}); }
+    std::unique_ptr<interfaces::Handler> handleTransactionChanged(TransactionChangedFn fn) override { return interfaces::MakeHandler({}); }
+    std::unique_ptr<interfaces::Handler> handleWatchOnlyChanged(WatchOnlyChangedFn fn) override { return interfaces::MakeHandler({}); }
+    std::unique_ptr<interfaces::Handler> handleCanGetAddressesChanged(CanGetAddressesChangedFn fn) override { return interfaces::MakeHandler({}); }
+    std::unique_ptr<interfaces::Handler> handleReservedBalanceChanged(ReservedBalanceChangedFn fn) override { return interfaces::MakeHandler({}); }
+
+    bool IsGraviocoinWallet() override { return false; }
+    CAmount getReserveBalance() override { return 0; }
+    bool ownDestination(const CTxDestination &dest) override { return false; }
+    bool isUnlockForStakingOnlySet() override { return false; }
+    CAmount getAvailableAnonBalance(const CCoinControl& coin_control) override { return 0; }
+    CAmount getAvailableBlindBalance(const CCoinControl& coin_control) override { return 0; }
+    CHDWallet *getGraviocoinWallet() override { return nullptr; }
+    bool setReserveBalance(CAmount nValue) override { return false; }
+    void lockWallet() override {}
+    bool setUnlockedForStaking() override { return false; }
+    bool isDefaultAccountSet() override { return false; }
+    bool isHardwareLinkedWallet() override { return false; }
+    CAmount getCredit(const CTxOutBase *txout, isminefilter filter) override { return 0; }
+    isminetype txoutIsMine(const CTxOutBase *txout) override { return ISMINE_NO; }
+};
+
+QString RowHash(const TransactionTableModel& model, int row)
+{
+    return model.index(row, 0).data(TransactionTableModel::TxHashRole).toString();
+}
+
+QString TxHash(const PagedWallet& wallet, int64_t time)
+{
+    for (const auto& entry : wallet.m_txs) {
+        if (entry.second.time == time) {
+            return QString::fromStdString(entry.first.ToString());
+        }
+    }
+    return QString();
+}
+
+} // namespace
+
+void TransactionTableModelTests::transactionTableModelTests()
+{
+    std::unique_ptr<PagedWallet> paged_wallet(new PagedWallet);
+    for (int i = 1; i <= 5; ++i) {
+        paged_wallet->addTx(i, i * 100);
+    }
+    PagedWallet& wallet = *paged_wallet;
+
+    std::unique_ptr<const PlatformStyle> platformStyle(PlatformStyle::instantiate("other"));
+    OptionsModel optionsModel(m_node);
+    WalletModel walletModel(std::move(paged_wallet), m_node, platformStyle.get(), &optionsModel);
+    TransactionTableModel model(platformStyle.get(), &walletModel, 2);
+
+    // Only the first page is loaded, newest first
+    QCOMPARE(model.rowCount({}), 2);
+    QVERIFY(model.canFetchMore({}));
+    QCOMPARE(RowHash(model, 0), TxHash(wallet, 500));
+    QCOMPARE(RowHash(model, 1), TxHash(wallet, 400));
+
+    // An update to a transaction that is not loaded yet leaves the model alone
+    QString hash_200 = TxHash(wallet, 200);
+    model.updateTransaction(hash_200, CT_UPDATED, true);
+    QCOMPARE(model.rowCount({}), 2);
+
+    // A transaction that was not loaded yet but moved into the loaded range is shown
+    QString hash_100 = TxHash(wallet, 100);
+    uint256 moved;
+    moved.SetHex(hash_100.toStdString());
+    wallet.m_txs[moved].time = 450;
+    model.updateTransaction(hash_100, CT_UPDATED, true);
+    QCOMPARE(model.rowCount({}), 3);
+    QCOMPARE(RowHash(model, 0), TxHash(wallet, 500));
+    QCOMPARE(RowHash(model, 1), hash_100);
+    QCOMPARE(RowHash(model, 2), TxHash(wallet, 400));
+
+    // Fetching the remaining pages doesn't load the moved transaction again
+    while (model.canFetchMore({})) {
+        model.fetchMore({});
+    }
+    QCOMPARE(model.rowCount({}), 5);
+    QCOMPARE(RowHash(model, 3), TxHash(wallet, 300));
+    QCOMPARE(RowHash(model, 4), hash_200);
+
+    // New transactions are inserted at their position once all pages are loaded
+    wallet.addTx(6, 350);
+    QString hash_350 = TxHash(wallet, 350);
+    model.updateTransaction(hash_350, CT_NEW, true);
+    QCOMPARE(model.rowCount({}), 6);
+    QCOMPARE(RowHash(model, 3), hash_350);
+
+    model.updateTransaction(hash_350, CT_DELETED, true);
+    QCOMPARE(model.rowCount({}), 5);
+}
@@ -0,0 +1,23 @@
+#ifndef BITCOIN_QT_TEST_TRANSACTIONTABLEMODELTESTS_H
+#define BITCOIN_QT_TEST_TRANSACTIONTABLEMODELTESTS_H
+
+#include <QObject>
+#include <QTest>
+
+namespace interfaces {
+class Node;
+} // namespace interfaces
+
+class TransactionTableModelTests : public QObject
+{
+public:
+    TransactionTableModelTests(interfaces::Node& node) : m_node(node) {}
+    interfaces::Node& m_node;
+
+    Q_OBJECT
+
+private Q_SLOTS:
+    void transactionTableModelTests();
+};
+
+#endif // BITCOIN_QT_TEST_TRANSACTIONTABLEMODELTESTS_H
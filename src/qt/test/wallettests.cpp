@@ -28,6 +28,7 @@
 #include <QAction>
 #include <QApplication>
 #include <QCheckBox>
+#include <QDateTime>
 #include <QPushButton>
 #include <QTimer>
 #include <QVBoxLayout>
@@ -188,11 +189,30 @@ void TestGUI(interfaces::Node& node)
     // Send two transactions, and verify they are added to transaction list.
     TransactionTableModel* transactionTableModel = walletModel.getTransactionTableModel();
     QCOMPARE(transactionTableModel->rowCount({}), 105);
+    QVERIFY(!transactionTableModel->canFetchMore({}));
+
+    // Load the same list in pages of 20 transactions, newest first.
+    TransactionTableModel pagedTableModel(platformStyle.get(), &walletModel, 20);
+    QCOMPARE(pagedTableModel.rowCount({}), 20);
+    while (pagedTableModel.canFetchMore({})) {
+        int rows = pagedTableModel.rowCount({});
+        pagedTableModel.fetchMore({});
+        QVERIFY(pagedTableModel.rowCount({}) > rows);
+    }
+    QCOMPARE(pagedTableModel.rowCount({}), 105);
+    for (int row = 1; row < pagedTableModel.rowCount({}); ++row) {
+        QVERIFY(pagedTableModel.index(row - 1, 0).data(TransactionTableModel::DateRole).toDateTime() >=
+                pagedTableModel.index(row, 0).data(TransactionTableModel::DateRole).toDateTime());
+    }
+
     uint256 txid1 = SendCoins(*wallet.get(), sendCoinsDialog, PKHash(), 5 * COIN, false /* rbf */);
     uint256 txid2 = SendCoins(*wallet.get(), sendCoinsDialog, PKHash(), 10 * COIN, true /* rbf */);
     QCOMPARE(transactionTableModel->rowCount({}), 107);
     QVERIFY(FindTx(*transactionTableModel, txid1).isValid());
     QVERIFY(FindTx(*transactionTableModel, txid2).isValid());
+    QCOMPARE(pagedTableModel.rowCount({}), 107);
+    QVERIFY(FindTx(pagedTableModel, txid1).isValid());
+    QVERIFY(FindTx(pagedTableModel, txid2).isValid());
 
     // Call bumpfee. Test disabled, canceled, enabled, then failing cases.
     BumpFee(transactionView, txid1, true /* expect disabled */, "not BIP 125 replaceable" /* expected error */, false /* cancel */);
@@ -18,6 +18,7 @@
 #include <uint256.h>
 
 #include <algorithm>
+#include <map>
 
 #include <QColor>
 #include <QDateTime>
@@ -38,57 +39,167 @@ static int column_alignments[] = {
         Qt::AlignRight|Qt::AlignVCenter, /* amount */
     };
 
-// Comparison operator for sort/binary search of model tx list
-struct TxLessThan
-{
-    bool operator()(const TransactionRecord &a, const TransactionRecord &b) const
-    {
-        return a.hash < b.hash;
-    }
-    bool operator()(const TransactionRecord &a, const uint256 &b) const
-    {
-        return a.hash < b;
-    }
-    bool operator()(const uint256 &a, const TransactionRecord &b) const
-    {
-        return a < b.hash;
-    }
-};
-
 // Private implementation
 class TransactionTablePriv
 {
 public:
-    explicit TransactionTablePriv(TransactionTableModel *_parent) :
-        parent(_parent)
+    explicit TransactionTablePriv(TransactionTableModel *_parent, int _page_size) :
+        parent(_parent),
+        page_size(_page_size)
     {
     }
 
     TransactionTableModel *parent;
     bool show_zero_value_coinstakes;
+    int page_size;
 
-    /* Local cache of wallet.
-     * As it is in the same order as the CWallet, by definition
-     * this is sorted by sha256.
+    /* Ordering key of a transaction, the model is sorted by descending key */
+    typedef std::pair<int64_t, uint256> TxKey;
+
+    /* Local cache of the part of the wallet loaded so far, newest first.
+     * Records of one transaction are adjacent.
      */
     QList<TransactionRecord> cachedWallet;
 
-    /* Query entire wallet anew from core.
+    /* Time of each transaction in cachedWallet when it was loaded, a
+     * transaction keeps its position if its time changes later.
+     */
+    std::map<uint256, int64_t> loadedTxs;
+
+    /* Transactions ordered after the cursor are not loaded yet */
+    interfaces::WalletTxCursor cursor;
+    bool fetchedAll = false;
+    bool fetching = false;
+
+    TxKey key(const uint256 &hash) const
+    {
+        return TxKey(loadedTxs.at(hash), hash);
+    }
+
+    QList<TransactionRecord>::iterator lowerBound(const TxKey &k)
+    {
+        return std::lower_bound(cachedWallet.begin(), cachedWallet.end(), k,
+            [this](const TransactionRecord &rec, const TxKey &value) { return value < key(rec.hash); });
+    }
+
+    QList<TransactionRecord>::iterator upperBound(const TxKey &k)
+    {
+        return std::upper_bound(cachedWallet.begin(), cachedWallet.end(), k,
+            [this](const TxKey &value, const TransactionRecord &rec) { return key(rec.hash) < value; });
+    }
+
+    /* Whether a transaction ordered at k belongs to the loaded part of the list */
+    bool isLoadedRange(const TxKey &k) const
+    {
+        return fetchedAll || !cursor.is_set || TxKey(cursor.time, cursor.hash) < k;
+    }
+
+    bool showWalletTx(const interfaces::WalletTx &wtx) const
+    {
+        if (!TransactionRecord::showTransaction()) {
+            return false;
+        }
+        return show_zero_value_coinstakes || !wtx.is_coinstake || wtx.credit != wtx.debit;
+    }
+
+    static uint256 walletTxHash(const interfaces::WalletTx &wtx)
+    {
+        return wtx.is_record ? wtx.irtx->first : wtx.tx->GetHash();
+    }
+
+    /* Drop the cached wallet and load the first page anew from core.
      */
     void refreshWallet(interfaces::Wallet& wallet)
     {
         qDebug() << "TransactionTablePriv::refreshWallet";
         cachedWallet.clear();
-        {
-            for (const auto& wtx : wallet.getWalletTxs()) {
-                if (TransactionRecord::showTransaction()) {
-                    if (!show_zero_value_coinstakes && wtx.is_coinstake && wtx.credit == wtx.debit) {
-                        continue;
-                    }
-                    cachedWallet.append(TransactionRecord::decomposeTransaction(wtx));
+        loadedTxs.clear();
+        cursor = interfaces::WalletTxCursor();
+        fetchedAll = false;
+        fetchMore(wallet, false);
+    }
+
+    /* Append the next page of older transactions to the model.
+       Pages without shown transactions are skipped.
+     */
+    void fetchMore(interfaces::Wallet& wallet, bool notify)
+    {
+        QList<TransactionRecord> toAppend;
+        while (toAppend.isEmpty() && !fetchedAll) {
+            std::vector<interfaces::WalletTx> wtxs = wallet.getWalletTxsPage(cursor, page_size);
+            if (wtxs.size() < (size_t)page_size) {
+                fetchedAll = true;
+            }
+            for (const auto& wtx : wtxs) {
+                uint256 hash = walletTxHash(wtx);
+                if (loadedTxs.count(hash) || !showWalletTx(wtx)) {
+                    // Already loaded transactions may have moved back in time
+                    continue;
                 }
+                QList<TransactionRecord> recs = TransactionRecord::decomposeTransaction(wtx);
+                if (recs.isEmpty()) {
+                    continue;
+                }
+                loadedTxs[hash] = wtx.time;
+                toAppend.append(recs);
             }
         }
+        qDebug() << "TransactionTablePriv::fetchMore: " + QString::number(toAppend.size()) + " records";
+        if (toAppend.isEmpty()) {
+            return;
+        }
+
+        fetching = true;
+        if (notify) {
+            parent->beginInsertRows(QModelIndex(), cachedWallet.size(), cachedWallet.size()+toAppend.size()-1);
+        }
+        cachedWallet.append(toAppend);
+        if (notify) {
+            parent->endInsertRows();
+        }
+        fetching = false;
+    }
+
+    /* Insert a transaction that is not in the model at the position of its
+       current time. Transactions ordered after the cursor are skipped, they
+       are added when their page is fetched.
+     */
+    void insertTransaction(interfaces::Wallet& wallet, const uint256 &hash)
+    {
+        // Find transaction in wallet
+        interfaces::WalletTx wtx = wallet.getWalletTx(hash);
+        if(!wtx.tx && !wtx.is_record)
+        {
+            qWarning() << "TransactionTablePriv::insertTransaction: Warning: transaction is not in wallet";
+            return;
+        }
+
+        if (!showWalletTx(wtx)) {
+            return;
+        }
+
+        TxKey k(wtx.time, hash);
+        if (!isLoadedRange(k)) {
+            return;
+        }
+
+        // Added -- insert at the right position
+        QList<TransactionRecord> toInsert =
+                TransactionRecord::decomposeTransaction(wtx);
+        if(toInsert.isEmpty()) /* only if something to insert */
+        {
+            return;
+        }
+        int lowerIndex = (lowerBound(k) - cachedWallet.begin());
+        loadedTxs[hash] = wtx.time;
+        parent->beginInsertRows(QModelIndex(), lowerIndex, lowerIndex+toInsert.size()-1);
+        int insert_idx = lowerIndex;
+        for (const TransactionRecord &rec : toInsert)
+        {
+            cachedWallet.insert(insert_idx, rec);
+            insert_idx += 1;
+        }
+        parent->endInsertRows();
     }
 
     /* Update our model of the wallet incrementally, to synchronize our model of the wallet
@@ -101,18 +212,18 @@ public:
         qDebug() << "TransactionTablePriv::updateWallet: " + QString::fromStdString(hash.ToString()) + " " + QString::number(status);
 
         // Find bounds of this transaction in model
-        QList<TransactionRecord>::iterator lower = std::lower_bound(
-            cachedWallet.begin(), cachedWallet.end(), hash, TxLessThan());
-        QList<TransactionRecord>::iterator upper = std::upper_bound(
-            cachedWallet.begin(), cachedWallet.end(), hash, TxLessThan());
-        int lowerIndex = (lower - cachedWallet.begin());
-        int upperIndex = (upper - cachedWallet.begin());
-        bool inModel = (lower != upper);
+        bool inModel = loadedTxs.count(hash);
+        int lowerIndex = 0, upperIndex = 0;
+        QList<TransactionRecord>::iterator lower, upper;
+        if (inModel) {
+            lower = lowerBound(key(hash));
+            upper = upperBound(key(hash));
+            lowerIndex = (lower - cachedWallet.begin());
+            upperIndex = (upper - cachedWallet.begin());
+        }
 
         if(status == CT_UPDATED)
         {
-            if(showTransaction && !inModel)
-                status = CT_NEW; /* Not in model, but want to show, treat as new */
             if(!showTransaction && inModel)
                 status = CT_DELETED; /* In model, but want to hide, treat as deleted */
         }
@@ -129,15 +240,9 @@ public:
             // remove entire transaction from table
                 parent->beginRemoveRows(QModelIndex(), lowerIndex, upperIndex-1);
                 cachedWallet.erase(lower, upper);
+                loadedTxs.erase(hash);
                 parent->endRemoveRows();
-
-                lower = qLowerBound(
-                    cachedWallet.begin(), cachedWallet.end(), hash, TxLessThan());
-                upper = qUpperBound(
-                    cachedWallet.begin(), cachedWallet.end(), hash, TxLessThan());
-                lowerIndex = (lower - cachedWallet.begin());
-                upperIndex = (upper - cachedWallet.begin());
-                inModel = (lower != upper);
+                inModel = false;
             }
             // drop through
         case CT_NEW:
@@ -148,52 +253,37 @@ public:
             }
             if(showTransaction)
             {
-                // Find transaction in wallet
-                interfaces::WalletTx wtx = wallet.getWalletTx(hash);
-                if(!wtx.tx && !wtx.is_record)
-                {
-                    qWarning() << "TransactionTablePriv::updateWallet: Warning: Got CT_NEW, but transaction is not in wallet";
-                    break;
-                }
-
-                if (!show_zero_value_coinstakes && wtx.is_coinstake && wtx.credit == wtx.debit) {
-                    break;
-                }
-
-                // Added -- insert at the right position
-                QList<TransactionRecord> toInsert =
-                        TransactionRecord::decomposeTransaction(wtx);
-                if(!toInsert.isEmpty()) /* only if something to insert */
-                {
-                    parent->beginInsertRows(QModelIndex(), lowerIndex, lowerIndex+toInsert.size()-1);
-                    int insert_idx = lowerIndex;
-                    for (const TransactionRecord &rec : toInsert)
-                    {
-                        cachedWallet.insert(insert_idx, rec);
-                        insert_idx += 1;
-                    }
-                    parent->endInsertRows();
-                }
+                insertTransaction(wallet, hash);
             }
             break;
         case CT_DELETED:
             if(!inModel)
             {
-                qWarning() << "TransactionTablePriv::updateWallet: Warning: Got CT_DELETED, but transaction is not in model";
+                // Transactions that were not loaded yet are not in the model
                 break;
             }
             // Removed -- remove entire transaction from table
             parent->beginRemoveRows(QModelIndex(), lowerIndex, upperIndex-1);
             cachedWallet.erase(lower, upper);
+            loadedTxs.erase(hash);
             parent->endRemoveRows();
             break;
         case CT_UPDATED:
-            // Miscellaneous updates -- nothing to do, status update will take care of this, and is only computed for
-            // visible transactions.
+            if (!inModel) {
+                // Not loaded yet. Pages only return transactions older than the
+                // cursor, so if its time moved into the loaded range no later
+                // page returns it and it has to be inserted now.
+                if (showTransaction) {
+                    insertTransaction(wallet, hash);
+                }
+                break;
+            }
+            // Miscellaneous updates -- mark the rows, the status is only computed again when they are read
             for (int i = lowerIndex; i < upperIndex; i++) {
                 TransactionRecord *rec = &cachedWallet[i];
                 rec->status.needsUpdate = true;
             }
+            Q_EMIT parent->dataChanged(parent->index(lowerIndex, 0), parent->index(upperIndex-1, parent->columns.length()-1));
             break;
         }
     }
@@ -203,30 +293,32 @@ public:
         return cachedWallet.size();
     }
 
-    TransactionRecord *index(interfaces::Wallet& wallet, int idx)
+    TransactionRecord *index(int idx)
     {
         if(idx >= 0 && idx < cachedWallet.size())
         {
-            TransactionRecord *rec = &cachedWallet[idx];
-
-            // Get required locks upfront. This avoids the GUI from getting
-            // stuck if the core is holding the locks for a longer time - for
-            // example, during a wallet rescan.
-            //
-            // If a status update is needed (blocks came in since last check),
-            //  update the status of this transaction from the wallet. Otherwise,
-            // simply re-use the cached status.
-            interfaces::WalletTxStatus wtx;
-            int numBlocks;
-            int64_t block_time;
-            if (wallet.tryGetTxStatus(rec->hash, wtx, numBlocks, block_time) && rec->statusUpdateNeeded(numBlocks)) {
-                rec->updateStatus(wtx, numBlocks, block_time);
-            }
-            return rec;
+            return &cachedWallet[idx];
         }
         return nullptr;
     }
 
+    void updateStatus(interfaces::Wallet& wallet, TransactionRecord *rec)
+    {
+        // Get required locks upfront. This avoids the GUI from getting
+        // stuck if the core is holding the locks for a longer time - for
+        // example, during a wallet rescan.
+        //
+        // If a status update is needed (blocks came in since last check),
+        //  update the status of this transaction from the wallet. Otherwise,
+        // simply re-use the cached status.
+        interfaces::WalletTxStatus wtx;
+        int numBlocks;
+        int64_t block_time;
+        if (wallet.tryGetTxStatus(rec->hash, wtx, numBlocks, block_time) && rec->statusUpdateNeeded(numBlocks)) {
+            rec->updateStatus(wtx, numBlocks, block_time);
+        }
+    }
+
     QString describe(interfaces::Node& node, interfaces::Wallet& wallet, TransactionRecord *rec, int unit)
     {
         return TransactionDesc::toHTML(node, wallet, rec, unit);
@@ -243,10 +335,10 @@ public:
     }
 };
 
-TransactionTableModel::TransactionTableModel(const PlatformStyle *_platformStyle, WalletModel *parent):
+TransactionTableModel::TransactionTableModel(const PlatformStyle *_platformStyle, WalletModel *parent, int page_size):
         QAbstractTableModel(parent),
         walletModel(parent),
-        priv(new TransactionTablePriv(this)),
+        priv(new TransactionTablePriv(this, page_size)),
         fProcessingQueuedTransactions(false),
         platformStyle(_platformStyle)
 {
@@ -297,6 +389,27 @@ int TransactionTableModel::rowCount(const QModelIndex &parent) const
     return priv->size();
 }
 
+bool TransactionTableModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return false;
+    }
+    return !priv->fetchedAll;
+}
+
+void TransactionTableModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid()) {
+        return;
+    }
+    priv->fetchMore(walletModel->wallet(), true);
+}
+
+bool TransactionTableModel::fetchingMore() const
+{
+    return priv->fetching;
+}
+
 int TransactionTableModel::columnCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent);
@@ -529,6 +642,8 @@ QVariant TransactionTableModel::data(const QModelIndex &index, int role) const
     if(!index.isValid())
         return QVariant();
     TransactionRecord *rec = static_cast<TransactionRecord*>(index.internalPointer());
+    // Status is only refreshed for rows that are read
+    priv->updateStatus(walletModel->wallet(), rec);
 
     switch(role)
     {
@@ -710,10 +825,10 @@ QVariant TransactionTableModel::headerData(int section, Qt::Orientation orientat
 QModelIndex TransactionTableModel::index(int row, int column, const QModelIndex &parent) const
 {
     Q_UNUSED(parent);
-    TransactionRecord *data = priv->index(walletModel->wallet(), row);
+    TransactionRecord *data = priv->index(row);
     if(data)
     {
-        return createIndex(row, column, priv->index(walletModel->wallet(), row));
+        return createIndex(row, column, data);
     }
     return QModelIndex();
 }
@@ -6,6 +6,7 @@
 #define BITCOIN_QT_TRANSACTIONTABLEMODEL_H
 
 #include <qt/bitcoinunits.h>
+#include <qt/guiconstants.h>
 #include <primitives/transaction.h>
 
 #include <QAbstractTableModel>
@@ -29,7 +30,7 @@ class TransactionTableModel : public QAbstractTableModel
     Q_OBJECT
 
 public:
-    explicit TransactionTableModel(const PlatformStyle *platformStyle, WalletModel *parent = nullptr);
+    explicit TransactionTableModel(const PlatformStyle *platformStyle, WalletModel *parent = nullptr, int page_size = TRANSACTION_FETCH_PAGE_SIZE);
     ~TransactionTableModel();
 
     enum ColumnIndex {
@@ -84,11 +85,16 @@ public:
     };
 
     int rowCount(const QModelIndex &parent) const;
+    /** Wallet transactions are loaded in pages of page_size transactions, newest first */
+    bool canFetchMore(const QModelIndex &parent) const;
+    void fetchMore(const QModelIndex &parent);
     int columnCount(const QModelIndex &parent) const;
     QVariant data(const QModelIndex &index, int role) const;
     QVariant headerData(int section, Qt::Orientation orientation, int role) const;
     QModelIndex index(int row, int column, const QModelIndex & parent = QModelIndex()) const;
     bool processingQueuedTransactions() const { return fProcessingQueuedTransactions; }
+    /** Rows are being inserted by fetchMore, not for new transactions */
+    bool fetchingMore() const;
 
 private:
     WalletModel *walletModel;
@@ -362,6 +362,11 @@ void TransactionView::exportClicked()
     if (filename.isNull())
         return;
 
+    // Load the remaining history so all transactions are exported
+    while (transactionProxyModel->canFetchMore(QModelIndex())) {
+        transactionProxyModel->fetchMore(QModelIndex());
+    }
+
     CSVModelWriter writer(filename);
 
     // name, column, role
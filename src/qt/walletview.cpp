@@ -163,7 +163,7 @@ void WalletView::processNewTransaction(const QModelIndex& parent, int start, int
         return;
 
     TransactionTableModel *ttm = walletModel->getTransactionTableModel();
-    if (!ttm || ttm->processingQueuedTransactions())
+    if (!ttm || ttm->processingQueuedTransactions() || ttm->fetchingMore())
         return;
 
     QString date = ttm->index(start, TransactionTableModel::Date, parent).data().toString();
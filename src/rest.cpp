@@ -7,7 +7,12 @@
 #include <chainparams.h>
 #include <core_io.h>
 #include <httpserver.h>
+#include <index/addressindex.h>
+#include <index/spentindex.h>
 #include <index/txindex.h>
+#include <insight/insight.h>
+#include <insight/rpc.h>
+#include <insight/spentindex.h>
 #include <node/context.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
@@ -29,6 +34,9 @@
 extern bool fGraviocoinMode;
 
 static const size_t MAX_GETUTXOS_OUTPOINTS = 15; //allow a max of 15 outpoints to be queried at once
+static const size_t MAX_REST_ADDRESS_TXNS = 10000; //allow a max of 10000 transactions per address deltas page
+static const size_t MAX_REST_ADDRESS_UTXOS = 10000; //allow a max of 10000 outputs per address utxos page
+static const size_t MAX_REST_SPENT_OUTPOINTS = 100; //allow a max of 100 outpoints to be queried for spent info at once
 
 enum class RetFormat {
     UNDEF,
@@ -648,12 +656,345 @@ static bool rest_blockhash_by_height(HTTPRequest* req,
     }
 }
 
+static bool CheckAddressIndex(HTTPRequest* req)
+{
+    if (!fAddressIndex || !g_address_index) {
+        return RESTERR(req, HTTP_NOT_FOUND, "Address index not enabled");
+    }
+    if (!g_address_index->BlockUntilSyncedToCurrentChain()) {
+        return RESTERR(req, HTTP_SERVICE_UNAVAILABLE, "Address index is still syncing. Try again later.");
+    }
+    return true;
+}
+
+static bool CheckSpentIndex(HTTPRequest* req)
+{
+    if (!fSpentIndex || !g_spent_index) {
+        return RESTERR(req, HTTP_NOT_FOUND, "Spent index not enabled");
+    }
+    if (!g_spent_index->BlockUntilSyncedToCurrentChain()) {
+        return RESTERR(req, HTTP_SERVICE_UNAVAILABLE, "Spent index is still syncing. Try again later.");
+    }
+    return true;
+}
+
+static bool rest_address_utxos(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+    std::vector<std::string> path;
+    boost::split(path, param, boost::is_any_of("/"));
+
+    if (path.size() != 2 && path.size() != 3)
+        return RESTERR(req, HTTP_BAD_REQUEST, "No address specified. Use /rest/address/utxos/<count>/<address>[/<txid>-<n>].<ext>.");
+
+    long count = strtol(path[0].c_str(), nullptr, 10);
+    if (count < 1 || (size_t)count > MAX_REST_ADDRESS_UTXOS)
+        return RESTERR(req, HTTP_BAD_REQUEST, strprintf("Output count out of range: %s", SanitizeString(path[0])));
+
+    uint256 hashBytes;
+    int type = 0;
+    if (!getIndexKeyFromAddress(path[1], hashBytes, type)) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid address: " + SanitizeString(path[1]));
+    }
+
+    CAddressUnspentKey after;
+    if (path.size() == 3) {
+        size_t nSep = path[2].find('-');
+        uint256 txid;
+        int32_t nOutput;
+        if (nSep == std::string::npos
+            || !ParseHashStr(path[2].substr(0, nSep), txid)
+            || !ParseInt32(path[2].substr(nSep + 1), &nOutput) || nOutput < 0) {
+            return RESTERR(req, HTTP_BAD_REQUEST, "Invalid cursor: " + SanitizeString(path[2]));
+        }
+        after = CAddressUnspentKey(type, hashBytes, txid, nOutput);
+    }
+    if (!CheckAddressIndex(req)) {
+        return false;
+    }
+
+    // One more output than the count is read to tell if the page is the last
+    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > unspentOutputs;
+    if (!GetAddressUnspent(hashBytes, type, unspentOutputs, after, count + 1)) {
+        return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "Unable to read address index");
+    }
+    COutPoint next;
+    if (unspentOutputs.size() > (size_t)count) {
+        unspentOutputs.resize(count);
+        next = COutPoint(unspentOutputs.back().first.txhash, unspentOutputs.back().first.index);
+    }
+
+    switch (rf) {
+    case RetFormat::BINARY:
+    case RetFormat::HEX: {
+        // The cursor of the next page (null on the last page), then the records in their index serialization, in index order
+        CDataStream ssUnspent(SER_NETWORK, PROTOCOL_VERSION);
+        ssUnspent << next << unspentOutputs;
+
+        if (rf == RetFormat::BINARY) {
+            req->WriteHeader("Content-Type", "application/octet-stream");
+            req->WriteReply(HTTP_OK, ssUnspent.str());
+        } else {
+            req->WriteHeader("Content-Type", "text/plain");
+            req->WriteReply(HTTP_OK, HexStr(ssUnspent.begin(), ssUnspent.end()) + "\n");
+        }
+        return true;
+    }
+
+    case RetFormat::JSON: {
+        UniValue utxos(UniValue::VARR);
+        for (const auto &it : unspentOutputs) {
+            UniValue output(UniValue::VOBJ);
+            output.pushKV("address", path[1]);
+            output.pushKV("txid", it.first.txhash.GetHex());
+            output.pushKV("outputIndex", (int)it.first.index);
+            output.pushKV("script", HexStr(it.second.script.begin(), it.second.script.end()));
+            output.pushKV("satoshis", it.second.satoshis);
+            output.pushKV("height", it.second.blockHeight);
+            utxos.push_back(output);
+        }
+        UniValue result(UniValue::VOBJ);
+        result.pushKV("utxos", utxos);
+        if (!next.IsNull()) {
+            result.pushKV("cursor", strprintf("%s-%u", next.hash.GetHex(), next.n));
+        }
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, result.write() + "\n");
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
+static bool rest_address_deltas(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+    std::vector<std::string> path;
+    boost::split(path, param, boost::is_any_of("/"));
+
+    if (path.size() != 2 && path.size() != 3)
+        return RESTERR(req, HTTP_BAD_REQUEST, "No address specified. Use /rest/address/deltas/<count>/<address>[/<height>:<blockindex>].<ext>.");
+
+    long count = strtol(path[0].c_str(), nullptr, 10);
+    if (count < 1 || (size_t)count > MAX_REST_ADDRESS_TXNS)
+        return RESTERR(req, HTTP_BAD_REQUEST, strprintf("Transaction count out of range: %s", SanitizeString(path[0])));
+
+    uint256 hashBytes;
+    int type = 0;
+    if (!getIndexKeyFromAddress(path[1], hashBytes, type)) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid address: " + SanitizeString(path[1]));
+    }
+
+    CAddressIndexCursor after;
+    if (path.size() == 3) {
+        size_t nSep = path[2].find(':');
+        int32_t nHeight;
+        uint32_t nTxIndex;
+        if (nSep == std::string::npos
+            || !ParseInt32(path[2].substr(0, nSep), &nHeight) || nHeight < 0
+            || !ParseUInt32(path[2].substr(nSep + 1), &nTxIndex)) {
+            return RESTERR(req, HTTP_BAD_REQUEST, "Invalid cursor: " + SanitizeString(path[2]));
+        }
+        after = CAddressIndexCursor(nHeight, nTxIndex);
+    }
+    if (!CheckAddressIndex(req)) {
+        return false;
+    }
+
+    // One more transaction than the count is read to tell if the page is the last
+    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
+    if (!GetAddressIndex(hashBytes, type, addressIndex, 0, 0, after, count + 1)) {
+        return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "Unable to read address index");
+    }
+    CAddressIndexCursor next;
+    if (!TrimAddressIndexPage(addressIndex, count, next)) {
+        next.SetNull();
+    }
+
+    switch (rf) {
+    case RetFormat::BINARY:
+    case RetFormat::HEX: {
+        // The cursor of the next page (null on the last page), then the records in their index serialization
+        CDataStream ssDeltas(SER_NETWORK, PROTOCOL_VERSION);
+        ssDeltas << next << addressIndex;
+
+        if (rf == RetFormat::BINARY) {
+            req->WriteHeader("Content-Type", "application/octet-stream");
+            req->WriteReply(HTTP_OK, ssDeltas.str());
+        } else {
+            req->WriteHeader("Content-Type", "text/plain");
+            req->WriteReply(HTTP_OK, HexStr(ssDeltas.begin(), ssDeltas.end()) + "\n");
+        }
+        return true;
+    }
+
+    case RetFormat::JSON: {
+        UniValue deltas(UniValue::VARR);
+        for (const auto &it : addressIndex) {
+            UniValue delta(UniValue::VOBJ);
+            delta.pushKV("satoshis", it.second);
+            delta.pushKV("txid", it.first.txhash.GetHex());
+            delta.pushKV("index", (int)it.first.index);
+            delta.pushKV("blockindex", (int)it.first.txindex);
+            delta.pushKV("height", it.first.blockHeight);
+            delta.pushKV("address", path[1]);
+            deltas.push_back(delta);
+        }
+        UniValue result(UniValue::VOBJ);
+        result.pushKV("deltas", deltas);
+        if (!next.IsNull()) {
+            result.pushKV("cursor", strprintf("%d:%u", next.blockHeight, next.txindex));
+        }
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, result.write() + "\n");
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
+static bool rest_spent(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+    std::vector<std::string> path;
+    boost::split(path, param, boost::is_any_of("/"));
+
+    if (param.empty() || path.size() > MAX_REST_SPENT_OUTPOINTS)
+        return RESTERR(req, HTTP_BAD_REQUEST, strprintf("Specify 1 to %u outpoints. Use /rest/spent/<txid>-<n>[/<txid>-<n>...].<ext>.", MAX_REST_SPENT_OUTPOINTS));
+
+    std::vector<CSpentIndexKey> keys;
+    for (const auto &outpoint : path) {
+        size_t nSep = outpoint.find('-');
+        uint256 txid;
+        int32_t nOutput;
+        if (nSep == std::string::npos
+            || !ParseHashStr(outpoint.substr(0, nSep), txid)
+            || !ParseInt32(outpoint.substr(nSep + 1), &nOutput) || nOutput < 0) {
+            return RESTERR(req, HTTP_BAD_REQUEST, "Parse error: " + SanitizeString(outpoint));
+        }
+        keys.emplace_back(txid, nOutput);
+    }
+
+    if (!CheckSpentIndex(req)) {
+        return false;
+    }
+
+    // Outputs that are not spent are left out
+    std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> > spentInfo;
+    for (auto &key : keys) {
+        CSpentIndexValue value;
+        if (GetSpentIndex(key, value)) {
+            spentInfo.emplace_back(key, value);
+        }
+    }
+
+    switch (rf) {
+    case RetFormat::BINARY:
+    case RetFormat::HEX: {
+        CDataStream ssSpent(SER_NETWORK, PROTOCOL_VERSION);
+        ssSpent << spentInfo;
+
+        if (rf == RetFormat::BINARY) {
+            req->WriteHeader("Content-Type", "application/octet-stream");
+            req->WriteReply(HTTP_OK, ssSpent.str());
+        } else {
+            req->WriteHeader("Content-Type", "text/plain");
+            req->WriteReply(HTTP_OK, HexStr(ssSpent.begin(), ssSpent.end()) + "\n");
+        }
+        return true;
+    }
+
+    case RetFormat::JSON: {
+        UniValue spent(UniValue::VARR);
+        for (const auto &it : spentInfo) {
+            UniValue obj(UniValue::VOBJ);
+            obj.pushKV("txid", it.first.txid.GetHex());
+            obj.pushKV("n", (int)it.first.outputIndex);
+            obj.pushKV("spendtxid", it.second.txid.GetHex());
+            obj.pushKV("spendindex", (int)it.second.inputIndex);
+            obj.pushKV("height", it.second.blockHeight);
+            spent.push_back(obj);
+        }
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, spent.write() + "\n");
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
+static bool rest_block_deltas(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string hashStr;
+    const RetFormat rf = ParseDataFormat(hashStr, strURIPart);
+
+    uint256 hash;
+    if (!ParseHashStr(hashStr, hash))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + hashStr);
+
+    if (!CheckSpentIndex(req)) {
+        return false;
+    }
+
+    switch (rf) {
+    case RetFormat::JSON: {
+        UniValue deltas;
+        {
+            LOCK(cs_main);
+            CBlockIndex* pblockindex = LookupBlockIndex(hash);
+            if (!pblockindex) {
+                return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+            }
+            if (IsBlockPruned(pblockindex))
+                return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not available (pruned data)");
+
+            CBlock block;
+            if (!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus()))
+                return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+            try {
+                deltas = blockToDeltasJSON(block, pblockindex);
+            } catch (const UniValue& objError) {
+                return RESTERR(req, HTTP_NOT_FOUND, hashStr + ": " + find_value(objError, "message").get_str());
+            }
+        }
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, deltas.write() + "\n");
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: json)");
+    }
+    }
+}
+
 static const struct {
     const char* prefix;
     bool (*handler)(HTTPRequest* req, const std::string& strReq);
 } uri_prefixes[] = {
       {"/rest/tx/", rest_tx},
       {"/rest/block/notxdetails/", rest_block_notxdetails},
+      {"/rest/block/deltas/", rest_block_deltas},
       {"/rest/block/", rest_block_extended},
       {"/rest/chaininfo", rest_chaininfo},
       {"/rest/mempool/info", rest_mempool_info},
@@ -661,6 +1002,9 @@ static const struct {
       {"/rest/headers/", rest_headers},
       {"/rest/getutxos", rest_getutxos},
       {"/rest/blockhashbyheight/", rest_blockhash_by_height},
+      {"/rest/address/utxos/", rest_address_utxos},
+      {"/rest/address/deltas/", rest_address_deltas},
+      {"/rest/spent/", rest_spent},
 };
 
 void StartREST()
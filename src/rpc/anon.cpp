@@ -64,13 +64,13 @@ UniValue anonoutput(const JSONRPCRequest &request)
             throw JSONRPCError(RPC_INVALID_PARAMETER, sIn+" is not a valid compressed public key.");
         }
 
-        if (!pblocktree->ReadRCTOutputLink(pk, nIndex)) {
+        if (!prctdb->ReadRCTOutputLink(pk, nIndex)) {
             throw JSONRPCError(RPC_MISC_ERROR, "Output not indexed.");
         }
     };
 
     CAnonOutput ao;
-    if (!pblocktree->ReadRCTOutput(nIndex, ao)) {
+    if (!prctdb->ReadRCTOutput(nIndex, ao)) {
         throw JSONRPCError(RPC_MISC_ERROR, "Unknown index.");
     }
 
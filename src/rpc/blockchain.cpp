@@ -13,7 +13,12 @@
 #include <consensus/validation.h>
 #include <core_io.h>
 #include <hash.h>
+#include <index/addressindex.h>
 #include <index/blockfilterindex.h>
+#include <index/spentindex.h>
+#include <index/timestampindex.h>
+#include <index/txindex.h>
+#include <index/voteindex.h>
 #include <node/coinstats.h>
 #include <node/context.h>
 #include <node/utxo_snapshot.h>
@@ -1007,8 +1012,11 @@ static UniValue gettxoutsetinfo(const JSONRPCRequest& request)
 {
             RPCHelpMan{"gettxoutsetinfo",
                 "\nReturns statistics about the unspent transaction output set.\n"
-                "Note this call may take some time.\n",
-                {},
+                "Note this call may take some time unless hash_type is \"none\".\n",
+                {
+                    {"hash_type", RPCArg::Type::STR, /* default */ "hash_serialized_2", "Which UTXO set hash should be calculated. Options: 'hash_serialized_2', 'none'.\n"
+            "       With 'none' the running totals kept by the node are returned without a scan, transactions is omitted."},
+                },
                 RPCResult{
             "{\n"
             "  \"height\":n,     (numeric) The current block height (index)\n"
@@ -1016,19 +1024,49 @@ static UniValue gettxoutsetinfo(const JSONRPCRequest& request)
             "  \"transactions\": n,      (numeric) The number of transactions with unspent outputs\n"
             "  \"txouts\": n,            (numeric) The number of unspent transaction outputs\n"
             "  \"bogosize\": n,          (numeric) A meaningless metric for UTXO set size\n"
-            "  \"hash_serialized_2\": \"hash\", (string) The serialized hash\n"
+            "  \"hash_serialized_2\": \"hash\", (string) The serialized hash (only present if 'hash_serialized_2' hash_type is chosen)\n"
             "  \"disk_size\": n,         (numeric) The estimated size of the chainstate on disk\n"
             "  \"total_amount\": x.xxx          (numeric) The total amount\n"
             "}\n"
                 },
                 RPCExamples{
                     HelpExampleCli("gettxoutsetinfo", "")
+            + HelpExampleCli("gettxoutsetinfo", "\"none\"")
             + HelpExampleRpc("gettxoutsetinfo", "")
                 },
             }.Check(request);
 
     UniValue ret(UniValue::VOBJ);
 
+    std::string hash_type = request.params[0].isNull() ? "hash_serialized_2" : request.params[0].get_str();
+    if (hash_type == "none") {
+        CUTXOStats stats;
+        uint256 hashBlock;
+        int nHeight;
+        if (!GetUTXOTypeStats(stats, hashBlock, nHeight)) {
+            throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read UTXO set");
+        }
+        int64_t nTransactionOutputs = 0, nBlindTransactionOutputs = 0;
+        CAmount nTotalAmount = 0;
+        for (const auto &st : stats.m_script_types) {
+            nTransactionOutputs += st.nPlain;
+            nBlindTransactionOutputs += st.nBlinded;
+            nTotalAmount += st.nPlainValue;
+        }
+        ret.pushKV("height", (int64_t)nHeight);
+        ret.pushKV("bestblock", hashBlock.GetHex());
+        ret.pushKV("txouts", nTransactionOutputs);
+        if (fGraviocoinMode)
+            ret.pushKV("txouts_blinded", nBlindTransactionOutputs);
+        ret.pushKV("bogosize", stats.nBogoSize);
+        ret.pushKV("disk_size", (uint64_t)WITH_LOCK(cs_main, return ::ChainstateActive().CoinsDB().EstimateSize()));
+        ret.pushKV("total_amount", ValueFromAmount(nTotalAmount));
+        return ret;
+    }
+    if (hash_type != "hash_serialized_2") {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("%s is not a valid hash_type", hash_type));
+    }
+
     CCoinsStats stats;
     ::ChainstateActive().ForceFlushStateToDisk();
 
@@ -1458,6 +1496,14 @@ UniValue MempoolInfoToJSON(const CTxMemPool& pool)
     LOCK(pool.cs);
     UniValue ret(UniValue::VOBJ);
     ret.pushKV("loaded", pool.IsLoaded());
+    MempoolLoadProgress progress = pool.GetLoadProgress();
+    if (progress.total > 0) {
+        ret.pushKV("loadverified", (double)progress.verified / progress.total);
+        ret.pushKV("loadprogress", (double)progress.processed / progress.total);
+    } else {
+        ret.pushKV("loadverified", pool.IsLoaded() ? 1.0 : 0.0);
+        ret.pushKV("loadprogress", pool.IsLoaded() ? 1.0 : 0.0);
+    }
     ret.pushKV("size", (int64_t)pool.size());
     ret.pushKV("bytes", (int64_t)pool.GetTotalTxSize());
     ret.pushKV("usage", (int64_t)pool.DynamicMemoryUsage());
@@ -1477,6 +1523,8 @@ static UniValue getmempoolinfo(const JSONRPCRequest& request)
                 RPCResult{
             "{\n"
             "  \"loaded\": true|false         (boolean) True if the mempool is fully loaded\n"
+            "  \"loadverified\": x.xxx,        (numeric) Fraction of the transactions in mempool.dat with their proofs verified ahead of acceptance\n"
+            "  \"loadprogress\": x.xxx,        (numeric) Fraction of the transactions in mempool.dat accepted, rejected or expired\n"
             "  \"size\": xxxxx,               (numeric) Current tx count\n"
             "  \"bytes\": xxxxx,              (numeric) Sum of all virtual transaction sizes as defined in BIP 141. Differs from actual serialized size because witness data is discounted\n"
             "  \"usage\": xxxxx,              (numeric) Total memory usage for the mempool\n"
@@ -2336,8 +2384,11 @@ UniValue dumptxoutset(const JSONRPCRequest& request)
         RPCResult{
             "{\n"
             "  \"coins_written\": n,   (numeric) the number of coins written in the snapshot\n"
+            "  \"anon_outputs_written\": n, (numeric) the number of anon outputs written in the snapshot\n"
+            "  \"key_images_written\": n, (numeric) the number of spent key images written in the snapshot\n"
             "  \"base_hash\": \"...\",   (string) the hash of the base of the snapshot\n"
             "  \"base_height\": n,     (string) the height of the base of the snapshot\n"
+            "  \"snapshot_hash\": \"...\", (string) the hash of the snapshot contents, checked by loadtxoutset\n"
             "  \"path\": \"...\"         (string) the absolute path that the snapshot was written to\n"
             "]\n"
         },
@@ -2361,6 +2412,8 @@ UniValue dumptxoutset(const JSONRPCRequest& request)
     FILE* file{fsbridge::fopen(temppath, "wb")};
     CAutoFile afile{file, SER_DISK, CLIENT_VERSION};
     std::unique_ptr<CCoinsViewCursor> pcursor;
+    std::unique_ptr<CDBIterator> prct_cursor;
+    std::vector<uint256> stake_modifiers;
     CCoinsStats stats;
     CBlockIndex* tip;
 
@@ -2386,14 +2439,26 @@ UniValue dumptxoutset(const JSONRPCRequest& request)
         }
 
         pcursor = std::unique_ptr<CCoinsViewCursor>(::ChainstateActive().CoinsDB().Cursor());
+        // The anon outputs and key images are written to the RingCT db with each connected block
+        prct_cursor = std::unique_ptr<CDBIterator>(prctdb->NewIterator());
         tip = LookupBlockIndex(stats.hashBlock);
         CHECK_NONFATAL(tip);
+
+        stake_modifiers.reserve(tip->nHeight + 1);
+        for (int i = 0; i <= tip->nHeight; ++i) {
+            stake_modifiers.push_back(::ChainActive()[i]->bnStakeModifier);
+        }
     }
 
     SnapshotMetadata metadata{tip->GetBlockHash(), stats.coins_count, tip->nChainTx};
+    metadata.m_money_supply = tip->nMoneySupply;
+    metadata.m_last_anon_output = tip->nAnonOutputs;
+    metadata.m_stake_modifiers_count = stake_modifiers.size();
 
+    // Counts are filled in once the records are written
     afile << metadata;
 
+    CHashWriter records(SER_GETHASH, PROTOCOL_VERSION);
     COutPoint key;
     Coin coin;
     unsigned int iter{0};
@@ -2406,18 +2471,129 @@ UniValue dumptxoutset(const JSONRPCRequest& request)
         if (pcursor->GetKey(key) && pcursor->GetValue(coin)) {
             afile << key;
             afile << coin;
+            records << key << coin;
         }
 
         pcursor->Next();
     }
 
+    std::pair<char, int64_t> ao_key;
+    CAnonOutput ao;
+    prct_cursor->Seek(std::make_pair(DB_RCTOUTPUT, (int64_t)0));
+    while (prct_cursor->Valid()) {
+        if (!prct_cursor->GetKey(ao_key) || ao_key.first != DB_RCTOUTPUT) {
+            break;
+        }
+        if (!prct_cursor->GetValue(ao)) {
+            throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read anon output");
+        }
+        afile << ao_key.second << ao;
+        records << ao_key.second << ao;
+        metadata.m_anon_outputs_count++;
+        prct_cursor->Next();
+    }
+
+    std::pair<char, CCmpPubKey> ki_key;
+    uint256 txhash;
+    prct_cursor->Seek(DB_RCTKEYIMAGE);
+    while (prct_cursor->Valid()) {
+        if (!prct_cursor->GetKey(ki_key) || ki_key.first != DB_RCTKEYIMAGE) {
+            break;
+        }
+        if (!prct_cursor->GetValue(txhash)) {
+            throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read key image");
+        }
+        afile << ki_key.second << txhash;
+        records << ki_key.second << txhash;
+        metadata.m_key_images_count++;
+        prct_cursor->Next();
+    }
+
+    for (const auto& modifier : stake_modifiers) {
+        afile << modifier;
+        records << modifier;
+    }
+
+    // The metadata is fixed size
+    if (fseek(afile.Get(), 0, SEEK_SET) != 0) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Unable to write snapshot metadata");
+    }
+    afile << metadata;
+
+    CHashWriter ss(SER_GETHASH, PROTOCOL_VERSION);
+    ss << metadata << records.GetHash();
+
     afile.fclose();
     fs::rename(temppath, path);
 
     UniValue result(UniValue::VOBJ);
     result.pushKV("coins_written", stats.coins_count);
+    result.pushKV("anon_outputs_written", metadata.m_anon_outputs_count);
+    result.pushKV("key_images_written", metadata.m_key_images_count);
     result.pushKV("base_hash", tip->GetBlockHash().ToString());
     result.pushKV("base_height", tip->nHeight);
+    result.pushKV("snapshot_hash", ss.GetHash().ToString());
+    result.pushKV("path", path.string());
+    return result;
+}
+
+UniValue loadtxoutset(const JSONRPCRequest& request)
+{
+    RPCHelpMan{
+        "loadtxoutset",
+        "\nLoad a UTXO set snapshot written by dumptxoutset, including the anon outputs, spent key images and stake modifiers.\n"
+        "The node must be at the genesis block with the headers up to the snapshot's base block, and the snapshot hash\n"
+        "must be accepted by the chain parameters. The base block becomes the tip, blocks up to it are not downloaded or validated.\n"
+        "Indexes that read old blocks (-txindex, -addressindex, -spentindex, -timestampindex, -voteindex, -blockfilterindex)\n"
+        "can't be used on a node loaded from a snapshot.\n",
+        {
+            {"path",
+                RPCArg::Type::STR,
+                RPCArg::Optional::NO,
+                /* default_val */ "",
+                "path to the snapshot file. If relative, will be prefixed by datadir."},
+        },
+        RPCResult{
+            "{\n"
+            "  \"coins_loaded\": n,    (numeric) the number of coins loaded from the snapshot\n"
+            "  \"anon_outputs_loaded\": n, (numeric) the number of anon outputs loaded from the snapshot\n"
+            "  \"key_images_loaded\": n, (numeric) the number of spent key images loaded from the snapshot\n"
+            "  \"tip_hash\": \"...\",    (string) the hash of the base of the snapshot\n"
+            "  \"base_height\": n,     (numeric) the height of the base of the snapshot\n"
+            "  \"path\": \"...\"         (string) the absolute path that the snapshot was loaded from\n"
+            "}\n"
+        },
+        RPCExamples{
+            HelpExampleCli("loadtxoutset", "utxo.dat")
+        }
+    }.Check(request);
+
+    fs::path path = fs::absolute(request.params[0].get_str(), GetDataDir());
+    if (!fs::exists(path)) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, path.string() + " does not exist");
+    }
+
+    if (g_txindex || g_address_index || g_spent_index || g_timestamp_index || g_vote_index) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Indexes must be disabled to load a snapshot");
+    }
+    bool fFilterIndex = false;
+    ForEachBlockFilterIndex([&fFilterIndex](BlockFilterIndex& index) { fFilterIndex = true; });
+    if (fFilterIndex) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Indexes must be disabled to load a snapshot");
+    }
+
+    SnapshotMetadata metadata;
+    std::string sError;
+    if (!::ChainstateActive().ActivateSnapshot(path, Params(), metadata, sError)) {
+        throw JSONRPCError(RPC_MISC_ERROR, sError);
+    }
+
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("coins_loaded", metadata.m_coins_count);
+    result.pushKV("anon_outputs_loaded", metadata.m_anon_outputs_count);
+    result.pushKV("key_images_loaded", metadata.m_key_images_count);
+    result.pushKV("tip_hash", metadata.m_base_blockhash.ToString());
+    result.pushKV("base_height", (int)metadata.m_stake_modifiers_count - 1);
     result.pushKV("path", path.string());
     return result;
 }
@@ -2442,7 +2618,7 @@ static const CRPCCommand commands[] =
     { "blockchain",         "getmempoolinfo",         &getmempoolinfo,         {} },
     { "blockchain",         "getrawmempool",          &getrawmempool,          {"verbose"} },
     { "blockchain",         "gettxout",               &gettxout,               {"txid","n","include_mempool"} },
-    { "blockchain",         "gettxoutsetinfo",        &gettxoutsetinfo,        {} },
+    { "blockchain",         "gettxoutsetinfo",        &gettxoutsetinfo,        {"hash_type"} },
     { "blockchain",         "pruneblockchain",        &pruneblockchain,        {"height"} },
     { "blockchain",         "savemempool",            &savemempool,            {} },
     { "blockchain",         "verifychain",            &verifychain,            {"checklevel","nblocks"} },
@@ -2459,6 +2635,7 @@ static const CRPCCommand commands[] =
     { "hidden",             "waitforblockheight",     &waitforblockheight,     {"height","timeout"} },
     { "hidden",             "syncwithvalidationinterfacequeue", &syncwithvalidationinterfacequeue, {} },
     { "hidden",             "dumptxoutset",           &dumptxoutset,           {"path"} },
+    { "hidden",             "loadtxoutset",           &loadtxoutset,           {"path"} },
 };
 // clang-format on
 
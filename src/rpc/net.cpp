@@ -488,6 +488,15 @@ static UniValue getnetworkinfo(const JSONRPCRequest& request)
             "  }\n"
             "  ,...\n"
             "  ]\n"
+            "  \"txprevalidation\": {                  (json object) transactions received with range proofs or MLSAG signatures, verified before acceptance, if enabled\n"
+            "    \"threads\": xxx,                      (numeric) the number of threads verifying transactions\n"
+            "    \"queued\": xxx,                       (numeric) the number of transactions waiting to be verified or accepted\n"
+            "    \"verified\": xxx,                     (numeric) the number of transactions verified\n"
+            "    \"failed\": xxx,                       (numeric) the number of transactions failing verification\n"
+            "    \"skipped\": xxx,                      (numeric) the number of transactions not verified again after failing before\n"
+            "    \"verifytime\": x.xxx,                 (numeric) the seconds spent verifying, summed over the threads\n"
+            "    \"txpersec\": x.xxx,                   (numeric) the transactions verified per second with all threads busy\n"
+            "  },\n"
             "  \"warnings\": \"...\"                    (string) any network and blockchain warnings\n"
             "}\n"
                 },
@@ -530,6 +539,20 @@ static UniValue getnetworkinfo(const JSONRPCRequest& request)
         }
     }
     obj.pushKV("localaddresses", localAddresses);
+    TxPreValidationStats prevalidation_stats;
+    if (g_rpc_node->peer_logic && g_rpc_node->peer_logic->GetTxPreValidationStats(prevalidation_stats)) {
+        UniValue prevalidation(UniValue::VOBJ);
+        prevalidation.pushKV("threads", prevalidation_stats.threads);
+        prevalidation.pushKV("queued", prevalidation_stats.queued);
+        prevalidation.pushKV("verified", prevalidation_stats.verified);
+        prevalidation.pushKV("failed", prevalidation_stats.failed);
+        prevalidation.pushKV("skipped", prevalidation_stats.skipped);
+        double verify_time = prevalidation_stats.verify_time / 1000000.0;
+        prevalidation.pushKV("verifytime", verify_time);
+        uint64_t count = prevalidation_stats.verified + prevalidation_stats.failed;
+        prevalidation.pushKV("txpersec", verify_time > 0 ? count * prevalidation_stats.threads / verify_time : 0.0);
+        obj.pushKV("txprevalidation", prevalidation);
+    }
     obj.pushKV("warnings",       GetWarnings(false));
     return obj;
 }
@@ -7,6 +7,7 @@
 #include <coins.h>
 #include <consensus/validation.h>
 #include <core_io.h>
+#include <index/spentindex.h>
 #include <index/txindex.h>
 #include <key_io.h>
 #include <merkleblock.h>
@@ -304,6 +305,10 @@ static UniValue getrawtransaction(const JSONRPCRequest& request)
     if (g_txindex && !blockindex) {
         f_txindex_ready = g_txindex->BlockUntilSyncedToCurrentChain();
     }
+    // Spent info is only added to verbose output
+    if (g_spent_index && fVerbose && !g_spent_index->BlockUntilSyncedToCurrentChain()) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Spent index is still syncing. Try again later.");
+    }
 
     CTransactionRef tx;
 
@@ -15,6 +15,7 @@
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
 
+#include <condition_variable>
 #include <memory> // for unique_ptr
 #include <unordered_map>
 #include <time.h>
@@ -358,13 +359,77 @@ static UniValue JSONRPCExecOne(JSONRPCRequest jreq, const UniValue& req)
     return rpc_result;
 }
 
-std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq)
+namespace {
+/** Progress of a batch executed on several threads */
+struct BatchProgress
 {
-    UniValue ret(UniValue::VARR);
-    for (unsigned int reqIdx = 0; reqIdx < vReq.size(); reqIdx++)
-        ret.push_back(JSONRPCExecOne(jreq, vReq[reqIdx]));
+    explicit BatchProgress(size_t size) : m_size(size) {}
 
-    return ret.write() + "\n";
+    const size_t m_size;
+    std::atomic<size_t> m_next{0};
+    Mutex m_mutex;
+    std::condition_variable m_cond;
+    size_t m_completed GUARDED_BY(m_mutex) = 0;
+};
+} // namespace
+
+std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq, int max_threads, const std::function<bool(const std::function<void()>&)>& queue_work)
+{
+    std::vector<std::string> replies(vReq.size());
+
+    if (max_threads > 1 && replies.size() > 1 && queue_work) {
+        // JSON-RPC 2.0 allows the calls of a batch to be processed concurrently, in any order.
+        // Each thread takes the next call until none are left, a task that starts after
+        // all calls were taken returns without touching the batch.
+        auto progress = std::make_shared<BatchProgress>(replies.size());
+        auto exec_calls = [progress, &jreq, &vReq, &replies]() {
+            size_t i;
+            while ((i = progress->m_next++) < progress->m_size) {
+                try {
+                    replies[i] = JSONRPCExecOne(jreq, vReq[i]).write();
+                } catch (...) {
+                    // Always count the call as completed, the batch waits for all of them
+                    replies[i] = JSONRPCReplyObj(NullUniValue,
+                        JSONRPCError(RPC_MISC_ERROR, "Unexpected exception"), find_value(vReq[i], "id")).write();
+                }
+                LOCK(progress->m_mutex);
+                if (++progress->m_completed == progress->m_size) {
+                    progress->m_cond.notify_all();
+                }
+            }
+        };
+
+        size_t num_tasks = std::min((size_t)max_threads, replies.size()) - 1;
+        for (size_t i = 0; i < num_tasks; ++i) {
+            if (!queue_work(exec_calls)) {
+                break;
+            }
+        }
+        exec_calls();
+
+        WAIT_LOCK(progress->m_mutex, lock);
+        progress->m_cond.wait(lock, [&progress]() EXCLUSIVE_LOCKS_REQUIRED(progress->m_mutex) { return progress->m_completed == progress->m_size; });
+    } else {
+        for (unsigned int reqIdx = 0; reqIdx < vReq.size(); reqIdx++)
+            replies[reqIdx] = JSONRPCExecOne(jreq, vReq[reqIdx]).write();
+    }
+
+    // Join the replies directly, instead of copying them into one large UniValue array
+    size_t reply_size = 3;
+    for (const auto& reply : replies) {
+        reply_size += reply.size() + 1;
+    }
+    std::string ret;
+    ret.reserve(reply_size);
+    ret += '[';
+    for (size_t i = 0; i < replies.size(); ++i) {
+        if (i > 0) {
+            ret += ',';
+        }
+        ret += replies[i];
+    }
+    ret += "]\n";
+    return ret;
 }
 
 /**
@@ -163,7 +163,13 @@ extern CRPCTable tableRPC;
 void StartRPC();
 void InterruptRPC();
 void StopRPC();
-std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq);
+/**
+ * Execute the calls of a JSON-RPC batch and return the array of replies.
+ * With max_threads above 1, up to max_threads - 1 tasks passed to queue_work
+ * execute calls alongside the calling thread, calls may then complete in any order.
+ * queue_work returns false if the task could not be queued.
+ */
+std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq, int max_threads = 1, const std::function<bool(const std::function<void()>&)>& queue_work = nullptr);
 
 // Retrieves any serialization flags requested in command line argument
 int RPCSerializationFlags();
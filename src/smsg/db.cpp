@@ -19,6 +19,12 @@ const std::string DBK_INBOX         = "IM";
 const std::string DBK_OUTBOX        = "SM";
 const std::string DBK_QUEUED        = "QM";
 const std::string DBK_PURGED_TOKEN  = "pm";
+const std::string DBK_IDX_ADDRESS   = "ia";
+const std::string DBK_IDX_UNREAD    = "iu";
+const std::string DBK_META          = "me";
+const std::string DBK_IDX_VERSION   = "iv";
+
+static const int SMSG_DB_INDEX_VERSION = 1;
 
 CCriticalSection cs_smsgDB;
 leveldb::DB *smsgDB = nullptr;
@@ -52,6 +58,130 @@ bool SecMsgDB::Open(const char *pszMode)
 
     pdb = smsgDB;
 
+    if (!BuildIndexes()) {
+        LogPrintf("%s: Error building indexes.\n", __func__);
+        return false;
+    }
+
+    return true;
+};
+
+static bool IsMessageFolder(const uint8_t *chKey)
+{
+    return memcmp(chKey, DBK_INBOX.data(), 2) == 0
+        || memcmp(chKey, DBK_OUTBOX.data(), 2) == 0
+        || memcmp(chKey, DBK_QUEUED.data(), 2) == 0;
+};
+
+std::string SecMsgDB::AddressIndexPrefix(const std::string &folder, const CKeyID &addr)
+{
+    std::string prefix = DBK_IDX_ADDRESS + folder.substr(0, 2);
+    prefix.append((const char*)addr.begin(), 20);
+    return prefix;
+};
+
+std::string SecMsgDB::UnreadIndexPrefix(const std::string &folder)
+{
+    return DBK_IDX_UNREAD + folder.substr(0, 2);
+};
+
+static std::string MetaKey(const uint8_t *chKey)
+{
+    std::string key = DBK_META;
+    key.append((const char*)chKey, 30);
+    return key;
+};
+
+// Add the index entries for a stored message to batch, chKey is the 30 byte message key
+static void PutIndexEntries(leveldb::WriteBatch *batch, const uint8_t *chKey, const SecMsgStored &smsgStored)
+{
+    std::string folder((const char*)chKey, 2);
+    std::string msgId((const char*)chKey + 2, SMSG_MSGID_LEN);
+
+    batch->Put(SecMsgDB::AddressIndexPrefix(folder, smsgStored.addrTo) + msgId, "");
+    if (!smsgStored.addrOutbox.IsNull() && smsgStored.addrOutbox != smsgStored.addrTo) {
+        batch->Put(SecMsgDB::AddressIndexPrefix(folder, smsgStored.addrOutbox) + msgId, "");
+    }
+
+    if (smsgStored.status & SMSG_MASK_UNREAD) {
+        batch->Put(SecMsgDB::UnreadIndexPrefix(folder) + msgId, "");
+    } else {
+        batch->Delete(SecMsgDB::UnreadIndexPrefix(folder) + msgId);
+    }
+};
+
+static void DeleteIndexEntries(leveldb::WriteBatch *batch, const uint8_t *chKey, const SecMsgStored &smsgStored)
+{
+    std::string folder((const char*)chKey, 2);
+    std::string msgId((const char*)chKey + 2, SMSG_MSGID_LEN);
+
+    batch->Delete(SecMsgDB::AddressIndexPrefix(folder, smsgStored.addrTo) + msgId);
+    if (!smsgStored.addrOutbox.IsNull()) {
+        batch->Delete(SecMsgDB::AddressIndexPrefix(folder, smsgStored.addrOutbox) + msgId);
+    }
+    batch->Delete(SecMsgDB::UnreadIndexPrefix(folder) + msgId);
+    batch->Delete(MetaKey(chKey));
+};
+
+bool SecMsgDB::BuildIndexes()
+{
+    if (!pdb) {
+        return false;
+    }
+
+    std::string strValue;
+    leveldb::Status s = pdb->Get(leveldb::ReadOptions(), DBK_IDX_VERSION, &strValue);
+    if (s.ok()) {
+        int nVersion = 0;
+        try {
+            CDataStream ssValue(strValue.data(), strValue.data() + strValue.size(), SER_DISK, CLIENT_VERSION);
+            ssValue >> nVersion;
+        } catch (std::exception &e) {
+            LogPrintf("%s: Unreadable index version, rebuilding.\n", __func__);
+        }
+        if (nVersion == SMSG_DB_INDEX_VERSION) {
+            return true;
+        }
+    } else
+    if (!s.IsNotFound()) {
+        return error("LevelDB read failure: %s\n", s.ToString());
+    }
+
+    leveldb::WriteBatch batch;
+
+    // Drop entries written by another index version
+    for (const auto &prefix : {DBK_IDX_ADDRESS, DBK_IDX_UNREAD}) {
+        leveldb::Iterator *it = pdb->NewIterator(leveldb::ReadOptions());
+        for (it->Seek(prefix); it->Valid() && it->key().starts_with(prefix); it->Next()) {
+            batch.Delete(it->key());
+        }
+        delete it;
+    }
+
+    size_t nIndexed = 0;
+    uint8_t chKey[30];
+    SecMsgStored smsgStored;
+    for (const auto &folder : {DBK_INBOX, DBK_OUTBOX, DBK_QUEUED}) {
+        leveldb::Iterator *it = pdb->NewIterator(leveldb::ReadOptions());
+        while (NextSmesg(it, folder, chKey, smsgStored)) {
+            PutIndexEntries(&batch, chKey, smsgStored);
+            nIndexed++;
+        }
+        delete it;
+    }
+
+    CDataStream ssValue(SER_DISK, CLIENT_VERSION);
+    ssValue << SMSG_DB_INDEX_VERSION;
+    batch.Put(DBK_IDX_VERSION, ssValue.str());
+
+    leveldb::WriteOptions writeOptions;
+    writeOptions.sync = true;
+    s = pdb->Write(writeOptions, &batch);
+    if (!s.ok()) {
+        return error("SecMsgDB index write failure: %s\n", s.ToString());
+    }
+
+    LogPrintf("SecureMsg indexed %u stored messages.\n", nIndexed);
     return true;
 };
 
@@ -422,14 +552,21 @@ bool SecMsgDB::WriteSmesg(const uint8_t *chKey, SecMsgStored &smsgStored)
     CDataStream ssValue(SER_DISK, CLIENT_VERSION);
     ssValue << smsgStored;
 
+    // Message and index entries are written together
+    leveldb::WriteBatch batch;
+    leveldb::WriteBatch *pbatch = activeBatch ? activeBatch : &batch;
+    pbatch->Put(ssKey.str(), ssValue.str());
+    if (IsMessageFolder(chKey)) {
+        PutIndexEntries(pbatch, chKey, smsgStored);
+    }
+
     if (activeBatch) {
-        activeBatch->Put(ssKey.str(), ssValue.str());
         return true;
     }
 
     leveldb::WriteOptions writeOptions;
     writeOptions.sync = true;
-    leveldb::Status s = pdb->Put(writeOptions, ssKey.str(), ssValue.str());
+    leveldb::Status s = pdb->Write(writeOptions, &batch);
     if (!s.ok()) {
         return error("SecMsgDB write failed: %s\n", s.ToString());
     }
@@ -464,14 +601,24 @@ bool SecMsgDB::EraseSmesg(const uint8_t *chKey)
     CDataStream ssKey(SER_DISK, CLIENT_VERSION);
     ssKey.write((const char*)chKey, 30);
 
+    leveldb::WriteBatch batch;
+    leveldb::WriteBatch *pbatch = activeBatch ? activeBatch : &batch;
+    if (IsMessageFolder(chKey)) {
+        // Need the stored addresses to find the index entries
+        SecMsgStored smsgStored;
+        if (ReadSmesg(chKey, smsgStored)) {
+            DeleteIndexEntries(pbatch, chKey, smsgStored);
+        }
+    }
+    pbatch->Delete(ssKey.str());
+
     if (activeBatch) {
-        activeBatch->Delete(ssKey.str());
         return true;
     }
 
     leveldb::WriteOptions writeOptions;
     writeOptions.sync = true;
-    leveldb::Status s = pdb->Delete(writeOptions, ssKey.str());
+    leveldb::Status s = pdb->Write(writeOptions, &batch);
 
     if (s.ok() || s.IsNotFound()) {
         return true;
@@ -613,4 +760,120 @@ bool SecMsgDB::NextPrivKey(leveldb::Iterator *it, const std::string &prefix, CKe
     return true;
 };
 
+bool SecMsgDB::ReadMeta(const uint8_t *chKey, SecMsgMeta &meta)
+{
+    if (!pdb) {
+        return false;
+    }
+
+    CDataStream ssKey(SER_DISK, CLIENT_VERSION);
+    ssKey.write(MetaKey(chKey).data(), 32);
+    std::string strValue;
+
+    bool readFromDb = true;
+    if (activeBatch) {
+        // Check activeBatch first
+        bool deleted = false;
+        readFromDb = ScanBatch(ssKey, &strValue, &deleted) == false;
+        if (deleted) {
+            return false;
+        }
+    }
+
+    if (readFromDb) {
+        leveldb::Status s = pdb->Get(leveldb::ReadOptions(), ssKey.str(), &strValue);
+        if (!s.ok()) {
+            if (s.IsNotFound()) {
+                return false;
+            }
+            return error("LevelDB read failure: %s\n", s.ToString());
+        }
+    }
+
+    try {
+        CDataStream ssValue(strValue.data(), strValue.data() + strValue.size(), SER_DISK, CLIENT_VERSION);
+        ssValue >> meta;
+    } catch (std::exception &e) {
+        LogPrintf("%s unserialize threw: %s.\n", __func__, e.what());
+        return false;
+    }
+
+    return true;
+};
+
+bool SecMsgDB::WriteMeta(const uint8_t *chKey, const SecMsgMeta &meta)
+{
+    if (!pdb) {
+        return false;
+    }
+
+    CDataStream ssValue(SER_DISK, CLIENT_VERSION);
+    ssValue << meta;
+
+    if (activeBatch) {
+        activeBatch->Put(MetaKey(chKey), ssValue.str());
+        return true;
+    }
+
+    leveldb::WriteOptions writeOptions;
+    writeOptions.sync = true;
+    leveldb::Status s = pdb->Put(writeOptions, MetaKey(chKey), ssValue.str());
+    if (!s.ok()) {
+        return error("SecMsgDB write failed: %s\n", s.ToString());
+    }
+
+    return true;
+};
+
+bool SecMsgDB::NextIndexed(leveldb::Iterator *it, const std::string &prefix, const std::string &resume_after, bool reverse, uint8_t *msgId)
+{
+    if (!pdb) {
+        return false;
+    }
+
+    if (!it->Valid()) { // First run
+        std::string start = prefix + resume_after;
+        if (!reverse) {
+            it->Seek(start);
+            if (!resume_after.empty() && it->Valid() && it->key().ToString() == start) {
+                it->Next();
+            }
+        } else {
+            if (resume_after.empty()) {
+                // Seek past the last key with prefix
+                while (!start.empty() && (uint8_t)start.back() == 0xff) {
+                    start.pop_back();
+                }
+                if (!start.empty()) {
+                    start.back() = (char)((uint8_t)start.back() + 1);
+                }
+            }
+            if (!start.empty()) {
+                it->Seek(start);
+            }
+            if (it->Valid()) {
+                it->Prev();
+            } else {
+                it->SeekToLast();
+            }
+        }
+    } else {
+        if (reverse) {
+            it->Prev();
+        } else {
+            it->Next();
+        }
+    }
+
+    if (!(it->Valid()
+        && it->key().size() == prefix.size() + SMSG_MSGID_LEN
+        && memcmp(it->key().data(), prefix.data(), prefix.size()) == 0)) {
+        return false;
+    }
+
+    memcpy(msgId, it->key().data() + prefix.size(), SMSG_MSGID_LEN);
+
+    return true;
+};
+
 } // namespace smsg
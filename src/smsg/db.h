@@ -18,6 +18,7 @@ namespace smsg {
 class SecMsgKey;
 class SecMsgStored;
 class SecMsgPurged;
+class SecMsgMeta;
 
 extern CCriticalSection cs_smsgDB;
 extern leveldb::DB *smsgDB;
@@ -28,6 +29,13 @@ extern const std::string DBK_INBOX;
 extern const std::string DBK_OUTBOX;
 extern const std::string DBK_QUEUED;
 extern const std::string DBK_PURGED_TOKEN;
+extern const std::string DBK_IDX_ADDRESS;
+extern const std::string DBK_IDX_UNREAD;
+extern const std::string DBK_META;
+extern const std::string DBK_IDX_VERSION;
+
+// Length of a message id, timestamp + hash, following the 2 byte folder prefix
+static const size_t SMSG_MSGID_LEN = 28;
 
 class SecMsgDB
 {
@@ -75,6 +83,25 @@ public:
 
     bool NextPrivKey(leveldb::Iterator *it, const std::string &prefix, CKeyID &idk, SecMsgKey &key);
 
+    bool ReadMeta(const uint8_t *chKey, SecMsgMeta &meta);
+    bool WriteMeta(const uint8_t *chKey, const SecMsgMeta &meta);
+
+    /**
+     * Rebuild the address and unread indexes from the stored messages when the
+     * db has no index version key or one from another SMSG_DB_INDEX_VERSION.
+     * Message metadata is not built here, ListMessages caches it on first read.
+     */
+    bool BuildIndexes();
+
+    /**
+     * Step through the message ids stored under index prefix, newest first if reverse is set.
+     * If resume_after is not empty iteration begins after that message id.
+     */
+    bool NextIndexed(leveldb::Iterator *it, const std::string &prefix, const std::string &resume_after, bool reverse, uint8_t *msgId);
+
+    static std::string AddressIndexPrefix(const std::string &folder, const CKeyID &addr);
+    static std::string UnreadIndexPrefix(const std::string &folder);
+
     leveldb::DB *pdb; // points to the global instance
     leveldb::WriteBatch *activeBatch;
 };
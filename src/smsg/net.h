@@ -8,6 +8,7 @@
 #include <sync.h>
 
 const uint32_t SMSG_RCVCOUNT_REDUCE = 200;
+const uint16_t SMSG_MAX_SEND_DEFERRED = 10; // SendData waits for cs_smsg once a peer was skipped this many times in a row
 
 namespace SMSGMsgType {
 extern const char *PING;
@@ -40,8 +41,10 @@ public:
     uint16_t m_num_want_sent = 0;
     uint16_t m_receive_counter = 0;
     uint16_t m_ignored_counter = 0;
+    uint16_t m_send_deferred = 0;
     bool fEnabled = false;
     int m_version = 0;
+    int64_t m_processing_time = 0; // microseconds spent processing messages from the peer
     std::map<int64_t, PeerBucket> m_buckets;
     std::map<int64_t, int64_t> m_buckets_last_shown;
 
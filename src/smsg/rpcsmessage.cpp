@@ -984,6 +984,167 @@ static UniValue smsgsendanon(const JSONRPCRequest &request)
     return result;
 }
 
+struct MessageListParams
+{
+    std::string filter;
+    std::string encoding = "text";
+    std::string resume_after; // Raw msgid to continue listing after
+    bool newest_first = false;
+    size_t limit = 0;
+    CKeyID address;
+};
+
+static void ParseMessageListOptions(const UniValue &options, MessageListParams &params)
+{
+    if (options["encoding"].isStr()) {
+        params.encoding = options["encoding"].get_str();
+    }
+    if (!options["limit"].isNull()) {
+        int limit = options["limit"].get_int();
+        if (limit < 0) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "limit must be zero or positive.");
+        }
+        params.limit = limit;
+    }
+    if (options["cursor"].isStr()) {
+        std::string sCursor = options["cursor"].get_str();
+        if (!IsHex(sCursor) || sCursor.size() != 56) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "cursor must be a msgid, 28 bytes in hex string.");
+        }
+        std::vector<uint8_t> vCursor = ParseHex(sCursor);
+        params.resume_after.assign((const char*)vCursor.data(), vCursor.size());
+    }
+    if (options["newestfirst"].isBool()) {
+        params.newest_first = options["newestfirst"].get_bool();
+    }
+    if (options["address"].isStr()) {
+        CTxDestination dest = DecodeDestination(options["address"].get_str());
+        if (dest.type() != typeid(PKHash)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address.");
+        }
+        params.address = CKeyID(boost::get<PKHash>(dest));
+    }
+};
+
+/**
+ * List messages in folder through the message indexes.
+ * Messages are only decrypted when the text is required or no cached metadata exists.
+ * If the limit is reached, cursor is set to the last listed msgid.
+ */
+static UniValue ListMessages(smsg::SecMsgDB &db, const std::string &folder, bool unread_only, bool update_status,
+    const MessageListParams &params, std::string &cursor) EXCLUSIVE_LOCKS_REQUIRED(smsg::cs_smsgDB)
+{
+    bool fInbox = folder == smsg::DBK_INBOX;
+    bool need_text = params.filter.size() > 0 || params.encoding != "none";
+
+    std::string prefix = folder;
+    if (!params.address.IsNull()) {
+        prefix = smsg::SecMsgDB::AddressIndexPrefix(folder, params.address);
+    } else
+    if (unread_only) {
+        prefix = smsg::SecMsgDB::UnreadIndexPrefix(folder);
+    }
+
+    UniValue messageList(UniValue::VARR);
+
+    uint8_t chKey[30];
+    memcpy(&chKey[0], folder.data(), 2);
+    smsg::SecMsgStored smsgStored;
+
+    leveldb::Iterator *it = db.pdb->NewIterator(leveldb::ReadOptions());
+    while (db.NextIndexed(it, prefix, params.resume_after, params.newest_first, &chKey[2])) {
+        if (!db.ReadSmesg(chKey, smsgStored)) {
+            continue;
+        }
+        if (unread_only
+            && !(smsgStored.status & SMSG_MASK_UNREAD)) {
+            continue;
+        }
+        uint8_t *pHeader = &smsgStored.vchMessage[0];
+        const smsg::SecureMessage *psmsg = (smsg::SecureMessage*) pHeader;
+
+        UniValue objM(UniValue::VOBJ);
+        objM.pushKV("msgid", HexStr(&chKey[2], &chKey[2] + 28)); // timestamp+hash
+        objM.pushKV("version", strprintf("%02x%02x", psmsg->version[0], psmsg->version[1]));
+
+        uint32_t nPayload = smsgStored.vchMessage.size() - smsg::SMSG_HDR_LEN;
+        smsg::SecMsgMeta meta;
+        smsg::MessageData msg;
+        int rv = 0;
+        bool have_meta = db.ReadMeta(chKey, meta);
+        if (need_text || !have_meta) {
+            const CKeyID &addrDecrypt = fInbox ? smsgStored.addrTo : smsgStored.addrOutbox;
+            rv = smsgModule.Decrypt(false, addrDecrypt, pHeader, pHeader + smsg::SMSG_HDR_LEN, nPayload, msg);
+            if (rv == 0 && !have_meta) {
+                meta.timeSent = msg.timestamp;
+                meta.sFromAddress = msg.sFromAddress;
+                db.WriteMeta(chKey, meta);
+            }
+        }
+
+        if (rv == 0) {
+            std::string sAddrTo = EncodeDestination(PKHash(smsgStored.addrTo));
+            std::string sText = need_text ? std::string((char*)msg.vchMessage.data()) : "";
+            if (params.filter.size() > 0
+                && !(part::stringsMatchI(meta.sFromAddress, params.filter, 3) ||
+                    part::stringsMatchI(sAddrTo, params.filter, 3) ||
+                    part::stringsMatchI(sText, params.filter, 3))) {
+                continue;
+            }
+
+            if (fInbox) {
+                PushTime(objM, "received", smsgStored.timeReceived);
+            }
+            PushTime(objM, "sent", meta.timeSent);
+            objM.pushKV("paid", UniValue(psmsg->IsPaidVersion()));
+
+            int64_t ttl = psmsg->m_ttl;
+            objM.pushKV("ttl", ttl);
+            int nDaysRetention = ttl / smsg::SMSG_SECONDS_IN_DAY;
+            objM.pushKV("daysretention", nDaysRetention);
+            PushTime(objM, "expiration", psmsg->timestamp + ttl);
+
+            objM.pushKV("payloadsize", (int)nPayload);
+
+            objM.pushKV("from", meta.sFromAddress);
+            objM.pushKV("to", sAddrTo);
+            if (params.encoding == "none") {
+            } else
+            if (params.encoding == "text") {
+                objM.pushKV("text", sText);
+            } else
+            if (params.encoding == "hex") {
+                objM.pushKV("hex", HexStr(sText));
+            } else {
+                objM.pushKV("unknown_encoding", params.encoding);
+            }
+        } else {
+            if (params.filter.size() > 0) {
+                continue;
+            }
+
+            objM.pushKV("status", "Decrypt failed");
+            objM.pushKV("error", smsg::GetString(rv));
+        }
+
+        messageList.push_back(objM);
+
+        // Only set 'read' status if the message decrypted successfully and update_status is set
+        if (unread_only && rv == 0 && update_status) {
+            smsgStored.status &= ~SMSG_MASK_UNREAD;
+            db.WriteSmesg(chKey, smsgStored);
+        }
+
+        if (params.limit > 0 && messageList.size() >= params.limit) {
+            cursor = HexStr(&chKey[2], &chKey[2] + 28);
+            break;
+        }
+    }
+    delete it;
+
+    return messageList;
+};
+
 static UniValue smsginbox(const JSONRPCRequest &request)
 {
             RPCHelpMan{"smsginbox",
@@ -996,6 +1157,10 @@ static UniValue smsginbox(const JSONRPCRequest &request)
                         {
                             {"updatestatus", RPCArg::Type::BOOL, /* default */ "true", "Update read status if true."},
                             {"encoding", RPCArg::Type::STR, /* default */ "text", "Display message data in encoding, values: \"text\", \"hex\", \"none\"."},
+                            {"limit", RPCArg::Type::NUM, /* default */ "0", "Maximum number of messages to list, 0 for no limit."},
+                            {"cursor", RPCArg::Type::STR, /* default */ "", "Continue listing after this msgid, from the \"cursor\" field of a previous result."},
+                            {"newestfirst", RPCArg::Type::BOOL, /* default */ "false", "List messages in descending time order."},
+                            {"address", RPCArg::Type::STR, /* default */ "", "Only list messages received on address."},
                         },
                         "options"},
                 },
@@ -1011,8 +1176,13 @@ static UniValue smsginbox(const JSONRPCRequest &request)
             "  \"to\": \"str\"                       (string) Address the message was sent to\n"
             "  \"text\": \"str\"                     (string) Message text\n"
             "}\n"
+            "\"cursor\": \"str\"                     (string) Set if limit was reached, pass in options to list the following messages\n"
+                },
+                RPCExamples{
+            HelpExampleCli("smsginbox", "\"all\" \"\" \"{\\\"limit\\\":50,\\\"newestfirst\\\":true}\"") +
+            "\nAs a JSON-RPC call\n"
+            + HelpExampleRpc("smsginbox", "\"all\", \"\", {\"limit\":50,\"newestfirst\":true}")
                 },
-                RPCExamples{""},
             }.Check(request);
 
     EnsureSMSGIsEnabled();
@@ -1020,18 +1190,17 @@ static UniValue smsginbox(const JSONRPCRequest &request)
     RPCTypeCheck(request.params, {UniValue::VSTR, UniValue::VSTR, UniValue::VOBJ}, true);
 
     std::string mode = request.params[0].isStr() ? request.params[0].get_str() : "unread";
-    std::string filter = request.params[1].isStr() ? request.params[1].get_str() : "";
 
-    std::string sEnc = "text";
+    MessageListParams params;
+    params.filter = request.params[1].isStr() ? request.params[1].get_str() : "";
+
     bool update_status = true;
     if (request.params[2].isObject()) {
         UniValue options = request.params[2].get_obj();
         if (options["updatestatus"].isBool()) {
             update_status = options["updatestatus"].get_bool();
         }
-        if (options["encoding"].isStr()) {
-            sEnc = options["encoding"].get_str();
-        }
+        ParseMessageListOptions(options, params);
     }
 
     UniValue result(UniValue::VOBJ);
@@ -1062,88 +1231,18 @@ static UniValue smsginbox(const JSONRPCRequest &request)
         } else
         if (mode == "all"
             || mode == "unread") {
-            int fCheckReadStatus = mode == "unread" ? 1 : 0;
-
-            smsg::SecMsgStored smsgStored;
-            smsg::MessageData msg;
+            bool fCheckReadStatus = mode == "unread";
+            std::string cursor;
 
             dbInbox.TxnBegin();
-
-            leveldb::Iterator *it = dbInbox.pdb->NewIterator(leveldb::ReadOptions());
-            UniValue messageList(UniValue::VARR);
-
-            while (dbInbox.NextSmesg(it, smsg::DBK_INBOX, chKey, smsgStored)) {
-                if (fCheckReadStatus
-                    && !(smsgStored.status & SMSG_MASK_UNREAD)) {
-                    continue;
-                }
-                uint8_t *pHeader = &smsgStored.vchMessage[0];
-                const smsg::SecureMessage *psmsg = (smsg::SecureMessage*) pHeader;
-
-                UniValue objM(UniValue::VOBJ);
-                objM.pushKV("msgid", HexStr(&chKey[2], &chKey[2] + 28)); // timestamp+hash
-                objM.pushKV("version", strprintf("%02x%02x", psmsg->version[0], psmsg->version[1]));
-
-                uint32_t nPayload = smsgStored.vchMessage.size() - smsg::SMSG_HDR_LEN;
-                int rv = smsgModule.Decrypt(false, smsgStored.addrTo, pHeader, pHeader + smsg::SMSG_HDR_LEN, nPayload, msg);
-                if (rv == 0) {
-                    std::string sAddrTo = EncodeDestination(PKHash(smsgStored.addrTo));
-                    std::string sText = std::string((char*)msg.vchMessage.data());
-                    if (filter.size() > 0
-                        && !(part::stringsMatchI(msg.sFromAddress, filter, 3) ||
-                            part::stringsMatchI(sAddrTo, filter, 3) ||
-                            part::stringsMatchI(sText, filter, 3))) {
-                        continue;
-                    }
-
-                    PushTime(objM, "received", smsgStored.timeReceived);
-                    PushTime(objM, "sent", msg.timestamp);
-                    objM.pushKV("paid", UniValue(psmsg->IsPaidVersion()));
-
-                    int64_t ttl = psmsg->m_ttl;
-                    objM.pushKV("ttl", ttl);
-                    int nDaysRetention = ttl / smsg::SMSG_SECONDS_IN_DAY;
-                    objM.pushKV("daysretention", nDaysRetention);
-                    PushTime(objM, "expiration", psmsg->timestamp + ttl);
-
-                    uint32_t nPayload = smsgStored.vchMessage.size() - smsg::SMSG_HDR_LEN;
-                    objM.pushKV("payloadsize", (int)nPayload);
-
-                    objM.pushKV("from", msg.sFromAddress);
-                    objM.pushKV("to", sAddrTo);
-                    if (sEnc == "none") {
-                    } else
-                    if (sEnc == "text") {
-                        objM.pushKV("text", sText);
-                    } else
-                    if (sEnc == "hex") {
-                        objM.pushKV("hex", HexStr(sText));
-                    } else {
-                        objM.pushKV("unknown_encoding", sEnc);
-                    }
-                } else {
-                    if (filter.size() > 0) {
-                        continue;
-                    }
-
-                    objM.pushKV("status", "Decrypt failed");
-                    objM.pushKV("error", smsg::GetString(rv));
-                }
-
-                messageList.push_back(objM);
-
-                // Only set 'read' status if the message decrypted successfully and update_status is set
-                if (fCheckReadStatus && rv == 0 && update_status) {
-                    smsgStored.status &= ~SMSG_MASK_UNREAD;
-                    dbInbox.WriteSmesg(chKey, smsgStored);
-                }
-                nMessages++;
-            }
-            delete it;
+            UniValue messageList = ListMessages(dbInbox, smsg::DBK_INBOX, fCheckReadStatus, update_status, params, cursor);
             dbInbox.TxnCommit();
 
             result.pushKV("messages", messageList);
-            result.pushKV("result", strprintf("%u", nMessages));
+            result.pushKV("result", strprintf("%u", messageList.size()));
+            if (!cursor.empty()) {
+                result.pushKV("cursor", cursor);
+            }
         } else {
             result.pushKV("result", "Unknown Mode.");
             result.pushKV("expected", "all|unread|clear.");
@@ -1165,6 +1264,10 @@ static UniValue smsgoutbox(const JSONRPCRequest &request)
                         {
                             {"encoding", RPCArg::Type::STR, /* default */ "text", "Display message data in encoding, values: \"text\", \"hex\", \"none\"."},
                             {"sending", RPCArg::Type::BOOL, /* default */ "false", "Display messages in sending queue."},
+                            {"limit", RPCArg::Type::NUM, /* default */ "0", "Maximum number of messages to list, 0 for no limit."},
+                            {"cursor", RPCArg::Type::STR, /* default */ "", "Continue listing after this msgid, from the \"cursor\" field of a previous result."},
+                            {"newestfirst", RPCArg::Type::BOOL, /* default */ "false", "List messages in descending time order."},
+                            {"address", RPCArg::Type::STR, /* default */ "", "Only list messages sent to or from address."},
                         },
                         "options"},
                 },
@@ -1177,6 +1280,7 @@ static UniValue smsgoutbox(const JSONRPCRequest &request)
             "  \"to\": \"str\"                       (string) Address the message was sent to\n"
             "  \"text\": \"str\"                     (string) Message text\n"
             "}\n"
+            "\"cursor\": \"str\"                     (string) Set if limit was reached, pass in options to list the following messages\n"
                 },
                 RPCExamples{""},
             }.Check(request);
@@ -1186,18 +1290,17 @@ static UniValue smsgoutbox(const JSONRPCRequest &request)
     RPCTypeCheck(request.params, {UniValue::VSTR, UniValue::VSTR}, true);
 
     std::string mode = request.params[0].isStr() ? request.params[0].get_str() : "all";
-    std::string filter = request.params[1].isStr() ? request.params[1].get_str() : "";
+
+    MessageListParams params;
+    params.filter = request.params[1].isStr() ? request.params[1].get_str() : "";
 
     bool show_sending = false;
-    std::string sEnc = "text";
     if (request.params[2].isObject()) {
         UniValue options = request.params[2].get_obj();
-        if (options["encoding"].isStr()) {
-            sEnc = options["encoding"].get_str();
-        }
         if (options["sending"].isBool()) {
             show_sending = options["sending"].get_bool();
         }
+        ParseMessageListOptions(options, params);
     }
 
     UniValue result(UniValue::VOBJ);
@@ -1230,71 +1333,17 @@ static UniValue smsgoutbox(const JSONRPCRequest &request)
             result.pushKV("result", strprintf("Deleted %u messages.", nMessages));
         } else
         if (mode == "all") {
-            smsg::SecMsgStored smsgStored;
-            smsg::MessageData msg;
-            leveldb::Iterator *it = dbOutbox.pdb->NewIterator(leveldb::ReadOptions());
-
-            UniValue messageList(UniValue::VARR);
-
-            while (dbOutbox.NextSmesg(it, db_prefix, chKey, smsgStored)) {
-                uint8_t *pHeader = &smsgStored.vchMessage[0];
-                const smsg::SecureMessage *psmsg = (smsg::SecureMessage*) pHeader;
-
-                UniValue objM(UniValue::VOBJ);
-                objM.pushKV("msgid", HexStr(&chKey[2], &chKey[2] + 28)); // timestamp+hash
-                objM.pushKV("version", strprintf("%02x%02x", psmsg->version[0], psmsg->version[1]));
-
-                uint32_t nPayload = smsgStored.vchMessage.size() - smsg::SMSG_HDR_LEN;
-                int rv = smsgModule.Decrypt(false, smsgStored.addrOutbox, pHeader, pHeader + smsg::SMSG_HDR_LEN, nPayload, msg);
-                if (rv == 0) {
-                    std::string sAddrTo = EncodeDestination(PKHash(smsgStored.addrTo));
-                    std::string sText = std::string((char*)msg.vchMessage.data());
-                    if (filter.size() > 0
-                        && !(part::stringsMatchI(msg.sFromAddress, filter, 3) ||
-                            part::stringsMatchI(sAddrTo, filter, 3) ||
-                            part::stringsMatchI(sText, filter, 3))) {
-                        continue;
-                    }
+            std::string cursor;
 
-                    PushTime(objM, "sent", msg.timestamp);
-                    objM.pushKV("paid", UniValue(psmsg->IsPaidVersion()));
-
-                    int64_t ttl = psmsg->m_ttl;
-                    objM.pushKV("ttl", ttl);
-                    int nDaysRetention = ttl / smsg::SMSG_SECONDS_IN_DAY;
-                    objM.pushKV("daysretention", nDaysRetention);
-                    PushTime(objM, "expiration", psmsg->timestamp + ttl);
-
-                    uint32_t nPayload = smsgStored.vchMessage.size() - smsg::SMSG_HDR_LEN;
-                    objM.pushKV("payloadsize", (int)nPayload);
-
-                    objM.pushKV("from", msg.sFromAddress);
-                    objM.pushKV("to", sAddrTo);
-                    if (sEnc == "none") {
-                    } else
-                    if (sEnc == "text") {
-                        objM.pushKV("text", sText);
-                    } else
-                    if (sEnc == "hex") {
-                        objM.pushKV("hex", HexStr(sText));
-                    } else {
-                        objM.pushKV("unknown_encoding", sEnc);
-                    }
-                } else {
-                    if (filter.size() > 0) {
-                        continue;
-                    }
-
-                    objM.pushKV("status", "Decrypt failed");
-                    objM.pushKV("error", smsg::GetString(rv));
-                }
-                messageList.push_back(objM);
-                nMessages++;
-            }
-            delete it;
+            dbOutbox.TxnBegin();
+            UniValue messageList = ListMessages(dbOutbox, db_prefix, false, false, params, cursor);
+            dbOutbox.TxnCommit();
 
             result.pushKV("messages" ,messageList);
-            result.pushKV("result", strprintf("%u", nMessages));
+            result.pushKV("result", strprintf("%u", messageList.size()));
+            if (!cursor.empty()) {
+                result.pushKV("cursor", cursor);
+            }
         } else {
             result.pushKV("result", "Unknown Mode.");
             result.pushKV("expected", "all|clear.");
@@ -2116,6 +2165,8 @@ static UniValue smsgpeers(const JSONRPCRequest &request)
             "    \"numwantsent\": n,          (numeric) Number of smsges requested from peer\n"
             "    \"receivecounter\": n,       (numeric) Messages received from peer in window\n"
             "    \"ignoredcounter\": n,       (numeric) Number of times peer has been ignored\n"
+            "    \"queued\": n,               (numeric) Messages from peer waiting to be processed\n"
+            "    \"processingtime\": x.xxx,   (numeric) Seconds spent processing messages from peer\n"
             "  }\n"
             "  ,...\n"
             "]\n"
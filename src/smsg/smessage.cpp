@@ -68,7 +68,7 @@ Notes:
 
 extern NodeContext* g_rpc_node;
 
-extern void Misbehaving(NodeId nodeid, int howmuch, const std::string& message="");
+extern void Misbehaving(NodeId nodeid, int howmuch, const std::string& message="") EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 extern CCriticalSection cs_main;
 
 smsg::CSMSG smsgModule;
@@ -963,6 +963,12 @@ bool CSMSG::Start(std::shared_ptr<CWallet> pwalletIn, std::vector<std::shared_pt
     threadGroupSmsg.create_thread(boost::bind(&TraceThread<void (*)()>, "smsg", &ThreadSecureMsg));
     threadGroupSmsg.create_thread(boost::bind(&TraceThread<void (*)()>, "smsg-pow", &ThreadSecureMsgPow));
 
+    {
+        LOCK(m_queue_mutex);
+        m_queue_running = true;
+    }
+    m_queue_thread = std::thread(&TraceThread<std::function<void()> >, "smsg-net", std::function<void()>(std::bind(&CSMSG::ThreadProcessQueue, this)));
+
 #ifdef ENABLE_WALLET
     m_wallet_load_handler = interfaces::MakeHandler(NotifyWalletAdded.connect(boost::bind(&ListenWalletAdded, this, _1)));
 #endif
@@ -985,6 +991,7 @@ bool CSMSG::Shutdown()
     fSecMsgEnabled = false;
     g_rpc_node->connman->SetLocalServices(ServiceFlags(g_rpc_node->connman->GetLocalServices() & ~NODE_SMSG));
 
+    StopQueue();
     threadGroupSmsg.interrupt_all();
     threadGroupSmsg.join_all();
 
@@ -1054,6 +1061,9 @@ bool CSMSG::Disable()
         return error("%s: Secure messaging is already disabled.", __func__);
     }
 
+    // The smsg-net thread takes cs_smsg, stop it first
+    StopQueue();
+
     {
         LOCK(cs_smsg);
 
@@ -1184,6 +1194,7 @@ void CSMSG::GetNodesStats(int node_id, UniValue &result)
         if (node_id > -1 && node_id != pnode->GetId()) {
             continue;
         }
+        size_t queue_size = GetQueueSize(pnode->GetId());
         LOCK(pnode->smsgData.cs_smsg_net);
         if (!pnode->smsgData.fEnabled) {
             continue;
@@ -1199,6 +1210,8 @@ void CSMSG::GetNodesStats(int node_id, UniValue &result)
         obj.pushKV("ignoredcounter", (int) pnode->smsgData.m_ignored_counter);
         obj.pushKV("num_pending_inv", (int) pnode->smsgData.m_buckets.size());
         obj.pushKV("num_shown_buckets", (int) pnode->smsgData.m_buckets_last_shown.size());
+        obj.pushKV("queued", (int) queue_size);
+        obj.pushKV("processingtime", pnode->smsgData.m_processing_time / 1000000.0);
         if (node_id > -1) {
             UniValue pending_inv_buckets(UniValue::VARR);
             for (auto it = pnode->smsgData.m_buckets.begin(); it != pnode->smsgData.m_buckets.end(); ++it) {
@@ -1235,11 +1248,112 @@ void CSMSG::ClearBanned()
     }
 };
 
-int CSMSG::ReceiveData(CNode *pfrom, const std::string &strCommand, CDataStream &vRecv)
+int CSMSG::QueueData(CNode *pfrom, const std::string &strCommand, CDataStream &vRecv)
 {
     /*
         Called from ProcessMessage
         Runs in ThreadMessageHandler2
+
+        Passes smsg messages to the smsg-net thread, so matching, validating
+        and storing messages doesn't hold up processing blocks and transactions.
+    */
+
+    if (std::find(std::begin(SMSGMsgType::allTypes), std::end(SMSGMsgType::allTypes), strCommand) == std::end(SMSGMsgType::allTypes)) {
+        return SMSG_UNKNOWN_MESSAGE;
+    }
+
+    {
+        LOCK(m_queue_mutex);
+        if (m_queue_running) {
+            pfrom->AddRef();
+            m_queue.emplace_back(pfrom, strCommand, vRecv);
+            m_queue_peer_size[pfrom->GetId()]++;
+            m_queue_cond.notify_one();
+            return SMSG_NO_ERROR;
+        }
+    }
+
+    // Secure messaging is disabled or stopping
+    return ReceiveData(pfrom, strCommand, vRecv);
+};
+
+bool CSMSG::IsQueueFull(NodeId node_id)
+{
+    return GetQueueSize(node_id) >= SMSG_MAX_PEER_QUEUE;
+};
+
+size_t CSMSG::GetQueueSize(NodeId node_id)
+{
+    LOCK(m_queue_mutex);
+    const auto it = m_queue_peer_size.find(node_id);
+    return it == m_queue_peer_size.end() ? 0 : it->second;
+};
+
+void CSMSG::ThreadProcessQueue()
+{
+    while (true) {
+        std::unique_ptr<QueuedMessage> msg;
+        {
+            WAIT_LOCK(m_queue_mutex, lock);
+            m_queue_cond.wait(lock, [this]() EXCLUSIVE_LOCKS_REQUIRED(m_queue_mutex) { return !m_queue_running || !m_queue.empty(); });
+            if (!m_queue_running) {
+                return;
+            }
+            msg = MakeUnique<QueuedMessage>(std::move(m_queue.front()));
+            m_queue.pop_front();
+        }
+
+        CNode *pfrom = msg->m_node;
+        if (!pfrom->fDisconnect) {
+            int64_t start = GetTimeMicros();
+            ReceiveData(pfrom, msg->m_command, msg->m_data);
+            int64_t elapsed = GetTimeMicros() - start;
+
+            LOCK(pfrom->smsgData.cs_smsg_net);
+            pfrom->smsgData.m_processing_time += elapsed;
+        }
+
+        bool was_full;
+        {
+            LOCK(m_queue_mutex);
+            auto it = m_queue_peer_size.find(pfrom->GetId());
+            was_full = it->second >= SMSG_MAX_PEER_QUEUE;
+            if (--it->second == 0) {
+                m_queue_peer_size.erase(it);
+            }
+        }
+        pfrom->Release();
+
+        if (was_full) {
+            // Resume receiving from the peer
+            g_rpc_node->connman->WakeMessageHandler();
+        }
+    }
+};
+
+void CSMSG::StopQueue()
+{
+    {
+        LOCK(m_queue_mutex);
+        m_queue_running = false;
+    }
+    m_queue_cond.notify_all();
+    if (m_queue_thread.joinable()) {
+        m_queue_thread.join();
+    }
+
+    LOCK(m_queue_mutex);
+    for (auto &msg : m_queue) {
+        msg.m_node->Release();
+    }
+    m_queue.clear();
+    m_queue_peer_size.clear();
+};
+
+int CSMSG::ReceiveData(CNode *pfrom, const std::string &strCommand, CDataStream &vRecv)
+{
+    /*
+        Called from the smsg-net thread, or from ProcessMessage when secure messaging is disabled
     */
 
     /*
@@ -1326,7 +1440,7 @@ int CSMSG::ReceiveData(CNode *pfrom, const std::string &strCommand, CDataStream
         vRecv >> vchData;
 
         if (vchData.size() < 4) {
-            Misbehaving(pfrom->GetId(), 1);
+            WITH_LOCK(cs_main, Misbehaving(pfrom->GetId(), 1));
             return SMSG_GENERAL_ERROR; // Not enough data received to be a valid smsgInv
         }
 
@@ -1525,7 +1639,7 @@ int CSMSG::ReceiveData(CNode *pfrom, const std::string &strCommand, CDataStream
         }
         if (time > now + SMSG_TIME_LEEWAY) {
             LogPrint(BCLog::SMSG, "Not interested in peer %d bucket %d, in the future.\n", pfrom->GetId(), time);
-            Misbehaving(pfrom->GetId(), 1);
+            WITH_LOCK(cs_main, Misbehaving(pfrom->GetId(), 1));
             return SMSG_GENERAL_ERROR;
         }
 
@@ -1717,7 +1831,7 @@ int CSMSG::ReceiveData(CNode *pfrom, const std::string &strCommand, CDataStream
 
         if (vchData.size() < 8) {
             LogPrintf("smsgIgnore, not enough data %u.\n", vchData.size());
-            Misbehaving(pfrom->GetId(), 1);
+            WITH_LOCK(cs_main, Misbehaving(pfrom->GetId(), 1));
             return SMSG_GENERAL_ERROR;
         }
 
@@ -1774,6 +1888,20 @@ bool CSMSG::SendData(CNode *pto, bool fSendTrickle)
         return true;
     }
 
+    {
+        // Don't hold up the message handler while the smsg-net thread is busy, try again on the next call,
+        // wait for the lock once the peer was skipped too often
+        TRY_LOCK(cs_smsg, lock_smsg);
+        if (!lock_smsg) {
+            if (++pto->smsgData.m_send_deferred < SMSG_MAX_SEND_DEFERRED) {
+                LogPrint(BCLog::SMSG, "%s: cs_smsg busy, deferred peer %d.\n", __func__, pto->GetId());
+                return true;
+            }
+            LogPrint(BCLog::SMSG, "%s: cs_smsg busy, waiting for it after deferring peer %d %u times.\n", __func__, pto->GetId(), pto->smsgData.m_send_deferred);
+        }
+    }
+    pto->smsgData.m_send_deferred = 0;
+
     uint32_t nBucketsShown = 0;
     std::vector<uint8_t> vchData;
     {
@@ -3113,9 +3241,9 @@ int CSMSG::Receive(CNode *pfrom, std::vector<uint8_t> &vchData)
                 SmsgMisbehaving(pfrom, 10);
             } else
             if (rv == SMSG_FUND_FAILED) { // Bad funding tx
-                Misbehaving(pfrom->GetId(), 10);
+                WITH_LOCK(cs_main, Misbehaving(pfrom->GetId(), 10));
             } else {
-                Misbehaving(pfrom->GetId(), 1);
+                WITH_LOCK(cs_main, Misbehaving(pfrom->GetId(), 1));
             }
             continue;
         }
@@ -3610,6 +3738,19 @@ int CSMSG::SetHash(uint8_t *pHeader, uint8_t *pPayload, uint32_t nPayload)
 
     SecureMessage *psmsg = (SecureMessage*) pHeader;
 
+    uint32_t target_compact;
+    {
+    LOCK(cs_main);
+    target_compact = GetSmsgDifficulty(psmsg->timestamp);
+    }
+
+    return SetHash(pHeader, pPayload, nPayload, target_compact);
+};
+
+int CSMSG::SetHash(uint8_t *pHeader, uint8_t *pPayload, uint32_t nPayload, uint32_t target_compact)
+{
+    SecureMessage *psmsg = (SecureMessage*) pHeader;
+
     int64_t nStart = GetTimeMillis();
     uint8_t civ[32];
 
@@ -3620,10 +3761,7 @@ int CSMSG::SetHash(uint8_t *pHeader, uint8_t *pPayload, uint32_t nPayload)
 
     uint256 msg_hash;
     arith_uint256 target_difficulty;
-    {
-    LOCK(cs_main);
-    target_difficulty.SetCompact(GetSmsgDifficulty(psmsg->timestamp));
-    }
+    target_difficulty.SetCompact(target_compact);
 
     // Break for HMAC_CTX_cleanup
     for (;;) {
@@ -8,6 +8,8 @@
 
 #include <key_io.h>
 #include <serialize.h>
+#include <streams.h>
+#include <sync.h>
 #include <ui_interface.h>
 #include <lz4/lz4.h>
 #include <smsg/keystore.h>
@@ -15,8 +17,11 @@
 
 #include <boost/signals2/signal.hpp>
 
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
 class UniValue;
-class CDataStream;
 class CWallet;
 class CCoinControl;
 class CNode;
@@ -81,6 +86,7 @@ const uint32_t SMSG_TIME_LEEWAY    = 24;
 const uint32_t SMSG_TIME_IGNORE    = 90;                // seconds a peer is ignored for if they fail to deliver messages for a smsgWant
 const uint32_t SMSG_DEFAULT_BANTIME = 8 * 60 * 60;
 const uint32_t SMSG_DEFAULT_MAXRCV = 4000;
+const uint32_t SMSG_MAX_PEER_QUEUE = 32;                // messages from one peer waiting for the smsg-net thread before receiving from the peer pauses
 
 const uint32_t SMSG_MAX_MSG_BYTES  = 24000;             // the user input part
 const uint32_t SMSG_MAX_AMSG_BYTES = 512;               // the user input part (ANON)
@@ -378,6 +384,27 @@ public:
     };
 };
 
+class SecMsgMeta
+{
+// Fields recovered by decrypting a stored message, cached to avoid decrypting again when listing
+public:
+    int64_t              timeSent = 0;
+    std::string          sFromAddress;
+
+    template<typename Stream>
+    void Serialize(Stream &s) const
+    {
+        s << timeSent;
+        s << sFromAddress;
+    };
+    template <typename Stream>
+    void Unserialize(Stream &s)
+    {
+        s >> timeSent;
+        s >> sFromAddress;
+    };
+};
+
 void AddOptions();
 const char *GetString(size_t errorCode);
 
@@ -409,6 +436,12 @@ public:
     void GetNodesStats(int node_id, UniValue &result);
     void ClearBanned();
 
+    int QueueData(CNode *pfrom, const std::string &strCommand, CDataStream &vRecv);
+    bool IsQueueFull(NodeId node_id);
+    size_t GetQueueSize(NodeId node_id);
+    void ThreadProcessQueue();
+    void StopQueue();
+
     int ReceiveData(CNode *pfrom, const std::string &strCommand, CDataStream &vRecv);
     bool SendData(CNode *pto, bool fSendTrickle);
 
@@ -469,6 +502,7 @@ public:
 
     int Validate(const uint8_t *pHeader, const uint8_t *pPayload, uint32_t nPayload);
     int SetHash (uint8_t *pHeader, uint8_t *pPayload, uint32_t nPayload);
+    int SetHash (uint8_t *pHeader, uint8_t *pPayload, uint32_t nPayload, uint32_t target_compact);
 
     int Encrypt(SecureMessage &smsg, const CKeyID &addressFrom, const CKeyID &addressTo, const std::string &message);
 
@@ -498,6 +532,25 @@ public:
     uint16_t m_smsg_max_receive_count = SMSG_DEFAULT_MAXRCV;
 
     std::map<int64_t, int64_t> m_show_requests;
+
+private:
+    class QueuedMessage
+    {
+    public:
+        QueuedMessage(CNode *node, const std::string &command, CDataStream &data) : m_node(node), m_command(command), m_data(std::move(data)) {};
+        CNode *m_node;
+        std::string m_command;
+        CDataStream m_data;
+    };
+
+    // Messages received from peers, processed in order by the smsg-net thread.
+    // Each entry holds a reference on its node.
+    Mutex m_queue_mutex;
+    std::condition_variable m_queue_cond;
+    std::deque<QueuedMessage> m_queue GUARDED_BY(m_queue_mutex);
+    std::map<NodeId, size_t> m_queue_peer_size GUARDED_BY(m_queue_mutex);
+    bool m_queue_running GUARDED_BY(m_queue_mutex) = false;
+    std::thread m_queue_thread;
 };
 
 double GetDifficulty(uint32_t compact);
@@ -0,0 +1,110 @@
+// Copyright (c) 2020 The Graviocoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GIO_SUPPORT_ALLOCATORS_POOL_H
+#define GIO_SUPPORT_ALLOCATORS_POOL_H
+
+#include <memusage.h>
+
+#include <algorithm>
+#include <memory>
+#include <stddef.h>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Allocates storage for objects of type T from chunks of nodes.
+ * Freed nodes are kept on a free list and reused, chunk memory is only
+ * released by Clear() or the destructor.
+ * Chunks double in size from MIN_CHUNK_NODES up to MAX_CHUNK_NODES, so a
+ * pool holding few objects stays small.
+ * Nodes carry no per object allocation overhead, the objects must be
+ * destroyed by the caller before their node is freed.
+ */
+template <typename T>
+class NodePool
+{
+private:
+    union Node {
+        Node *next;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type data;
+    };
+
+    struct Chunk {
+        std::unique_ptr<Node[]> nodes;
+        size_t count;
+    };
+
+    std::vector<Chunk> m_chunks;
+    Node *m_free = nullptr;
+    Node *m_next = nullptr;
+    size_t m_left = 0;
+    size_t m_total_nodes = 0;
+    size_t m_usage = 0;
+
+    void NewChunk()
+    {
+        size_t count = std::min(MAX_CHUNK_NODES, std::max(MIN_CHUNK_NODES, m_total_nodes));
+        m_chunks.push_back(Chunk{std::unique_ptr<Node[]>(new Node[count]), count});
+        m_next = m_chunks.back().nodes.get();
+        m_left = count;
+        m_total_nodes += count;
+        m_usage += memusage::MallocUsage(sizeof(Node) * count);
+    }
+
+public:
+    static constexpr size_t MIN_CHUNK_NODES = 16;
+    static constexpr size_t MAX_CHUNK_NODES = 16384;
+
+    NodePool() = default;
+    NodePool(const NodePool &) = delete;
+    NodePool &operator=(const NodePool &) = delete;
+
+    //! Return uninitialised storage for one T
+    void *Allocate()
+    {
+        if (m_free) {
+            Node *node = m_free;
+            m_free = node->next;
+            return &node->data;
+        }
+        if (m_left == 0) {
+            NewChunk();
+        }
+        m_left--;
+        return &(m_next++)->data;
+    }
+
+    //! Return storage obtained from Allocate to the pool, the object must already be destroyed
+    void Free(void *p)
+    {
+        Node *node = reinterpret_cast<Node*>(p);
+        node->next = m_free;
+        m_free = node;
+    }
+
+    //! Release all chunks, every object allocated from the pool must already be destroyed
+    void Clear()
+    {
+        m_chunks.clear();
+        m_chunks.shrink_to_fit();
+        m_free = nullptr;
+        m_next = nullptr;
+        m_left = 0;
+        m_total_nodes = 0;
+        m_usage = 0;
+    }
+
+    size_t DynamicMemoryUsage() const
+    {
+        return m_usage + memusage::DynamicUsage(m_chunks);
+    }
+};
+
+template <typename T>
+constexpr size_t NodePool<T>::MIN_CHUNK_NODES;
+template <typename T>
+constexpr size_t NodePool<T>::MAX_CHUNK_NODES;
+
+#endif // GIO_SUPPORT_ALLOCATORS_POOL_H
@@ -5,6 +5,7 @@
 #include <blockfilter.h>
 #include <chainparams.h>
 #include <consensus/validation.h>
+#include <dbwrapper.h>
 #include <index/blockfilterindex.h>
 #include <miner.h>
 #include <pow.h>
@@ -258,6 +259,60 @@ BOOST_FIXTURE_TEST_CASE(blockfilter_index_initial_sync, TestChain100Setup)
     filter_index.Stop();
 }
 
+static void WaitForSync(BlockFilterIndex& filter_index)
+{
+    constexpr int64_t timeout_ms = 10 * 1000;
+    int64_t time_start = GetTimeMillis();
+    while (!filter_index.BlockUntilSyncedToCurrentChain()) {
+        BOOST_REQUIRE(time_start + timeout_ms > GetTimeMillis());
+        MilliSleep(100);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(blockfilter_index_outdated_version, TestChain100Setup)
+{
+    const fs::path db_path = GetDataDir() / "indexes" / "blockfilter" / "basic" / "db";
+    {
+        BlockFilterIndex filter_index(BlockFilterType::BASIC, 1 << 20, false, true);
+        filter_index.Start();
+        WaitForSync(filter_index);
+        filter_index.Interrupt();
+        filter_index.Stop();
+    }
+
+    // Mark the index as written by an older version, with an entry of a block no longer indexed
+    const uint256 stale_hash = InsecureRand256();
+    {
+        CDBWrapper db(db_path, 1 << 20);
+        db.Write('V', int32_t{0});
+        db.Write(std::make_pair('s', stale_hash), uint256());
+    }
+
+    {
+        BlockFilterIndex filter_index(BlockFilterType::BASIC, 1 << 20);
+        filter_index.Start();
+        WaitForSync(filter_index);
+
+        {
+            LOCK(cs_main);
+            uint256 last_header;
+            for (const CBlockIndex* block_index = ::ChainActive().Genesis();
+                 block_index != nullptr;
+                 block_index = ::ChainActive().Next(block_index)) {
+                CheckFilterLookups(filter_index, block_index, last_header);
+            }
+        }
+        filter_index.Interrupt();
+        filter_index.Stop();
+    }
+
+    CDBWrapper db(db_path, 1 << 20);
+    int32_t version = 0;
+    BOOST_CHECK(db.Read('V', version));
+    BOOST_CHECK(version > 0);
+    BOOST_CHECK(!db.Exists(std::make_pair('s', stale_hash)));
+}
+
 BOOST_FIXTURE_TEST_CASE(blockfilter_index_init_destroy, BasicTestingSetup)
 {
     BlockFilterIndex* filter_index;
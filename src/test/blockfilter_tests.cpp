@@ -125,6 +125,43 @@ BOOST_AUTO_TEST_CASE(blockfilter_basic_test)
     BOOST_CHECK(default_ctor_block_filter_1.GetEncodedFilter() == default_ctor_block_filter_2.GetEncodedFilter());
 }
 
+BOOST_AUTO_TEST_CASE(blockfilter_basic_vpout_test)
+{
+    CScript included_scripts[3], excluded_scripts[2];
+    included_scripts[0] << OP_DUP << OP_HASH160 << std::vector<unsigned char>(20, 1) << OP_EQUALVERIFY << OP_CHECKSIG;
+    included_scripts[1] << OP_HASH160 << std::vector<unsigned char>(20, 2) << OP_EQUAL;
+    included_scripts[2] << OP_DUP << OP_HASH160 << std::vector<unsigned char>(20, 3) << OP_EQUALVERIFY << OP_CHECKSIG;
+    excluded_scripts[0] << OP_RETURN << std::vector<unsigned char>(4, 40);
+    excluded_scripts[1] << OP_DUP << OP_HASH160 << std::vector<unsigned char>(20, 4) << OP_EQUALVERIFY << OP_CHECKSIG;
+
+    CMutableTransaction tx;
+    tx.nVersion = GIO_TXN_VERSION;
+    tx.vpout.push_back(MAKE_OUTPUT<CTxOutData>(std::vector<uint8_t>(excluded_scripts[1].begin(), excluded_scripts[1].end())));
+    tx.vpout.push_back(MAKE_OUTPUT<CTxOutStandard>(100, included_scripts[0]));
+    OUTPUT_PTR<CTxOutCT> out_ct = MAKE_OUTPUT<CTxOutCT>();
+    out_ct->scriptPubKey = included_scripts[1];
+    tx.vpout.push_back(out_ct);
+    tx.vpout.push_back(MAKE_OUTPUT<CTxOutStandard>(0, excluded_scripts[0]));
+
+    CBlock block;
+    block.vtx.push_back(MakeTransactionRef(tx));
+
+    // Spent CT and standard outputs are kept in the undo data as CTxOut
+    CBlockUndo block_undo;
+    block_undo.vtxundo.emplace_back();
+    block_undo.vtxundo.back().vprevout.emplace_back(CTxOut(500, included_scripts[2]), 1000, false);
+
+    BlockFilter block_filter(BlockFilterType::BASIC, block, block_undo);
+    const GCSFilter& filter = block_filter.GetFilter();
+
+    for (const CScript& script : included_scripts) {
+        BOOST_CHECK(filter.Match(GCSFilter::Element(script.begin(), script.end())));
+    }
+    for (const CScript& script : excluded_scripts) {
+        BOOST_CHECK(!filter.Match(GCSFilter::Element(script.begin(), script.end())));
+    }
+}
+
 BOOST_AUTO_TEST_CASE(blockfilters_json_test)
 {
     UniValue json;
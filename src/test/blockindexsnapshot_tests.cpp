@@ -0,0 +1,81 @@
+// Copyright (c) 2020 The Graviocoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chain.h>
+#include <chainparams.h>
+#include <fs.h>
+#include <node/blockindexsnapshot.h>
+#include <test/util/setup_common.h>
+#include <txdb.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(blockindexsnapshot_tests, TestChain100Setup)
+
+static void FreeEntries(std::vector<std::pair<uint256, CBlockIndex*> > &entries)
+{
+    for (auto &entry : entries) {
+        delete entry.second;
+    }
+    entries.clear();
+}
+
+static void FlipLastByte(const fs::path &path)
+{
+    FILE *file = fsbridge::fopen(path, "r+b");
+    BOOST_REQUIRE(file);
+    BOOST_REQUIRE(fseek(file, -1, SEEK_END) == 0);
+    int c = fgetc(file);
+    BOOST_REQUIRE(c != EOF);
+    BOOST_REQUIRE(fseek(file, -1, SEEK_END) == 0);
+    BOOST_REQUIRE(fputc(c ^ 1, file) != EOF);
+    fclose(file);
+}
+
+BOOST_AUTO_TEST_CASE(blockindexsnapshot_read)
+{
+    LOCK(cs_main);
+    const Consensus::Params &consensus = Params().GetConsensus();
+    const fs::path path = GetDataDir() / "blocks" / "index.snapshot";
+    std::vector<std::pair<uint256, CBlockIndex*> > entries;
+    uint256 best_block;
+
+    BOOST_REQUIRE(WriteBlockIndexSnapshot(*pblocktree, ::BlockIndex()));
+    BOOST_CHECK(ReadBlockIndexSnapshot(*pblocktree, consensus, entries, best_block));
+    BOOST_CHECK_EQUAL(entries.size(), ::BlockIndex().size());
+    BOOST_CHECK(best_block == ::ChainActive().Tip()->GetBlockHash());
+    for (const auto &entry : entries) {
+        const CBlockIndex *pindex = LookupBlockIndex(entry.first);
+        BOOST_REQUIRE(pindex);
+        BOOST_CHECK_EQUAL(entry.second->nHeight, pindex->nHeight);
+        BOOST_CHECK_EQUAL(entry.second->nTime, pindex->nTime);
+        BOOST_CHECK_EQUAL(entry.second->nStatus, pindex->nStatus);
+        BOOST_CHECK_EQUAL(entry.second->pprev != nullptr, pindex->pprev != nullptr);
+    }
+    FreeEntries(entries);
+
+    // The marker is erased by reading, a second read falls back to the block tree db
+    BOOST_CHECK(!ReadBlockIndexSnapshot(*pblocktree, consensus, entries, best_block));
+
+    // A corrupted record fails the checksum
+    BOOST_REQUIRE(WriteBlockIndexSnapshot(*pblocktree, ::BlockIndex()));
+    FlipLastByte(path);
+    BOOST_CHECK(!ReadBlockIndexSnapshot(*pblocktree, consensus, entries, best_block));
+    BOOST_CHECK(entries.empty());
+
+    // A truncated file
+    BOOST_REQUIRE(WriteBlockIndexSnapshot(*pblocktree, ::BlockIndex()));
+    fs::resize_file(path, fs::file_size(path) - 1);
+    BOOST_CHECK(!ReadBlockIndexSnapshot(*pblocktree, consensus, entries, best_block));
+    BOOST_CHECK(entries.empty());
+
+    // A marker from another snapshot
+    BOOST_REQUIRE(WriteBlockIndexSnapshot(*pblocktree, ::BlockIndex()));
+    BOOST_REQUIRE(pblocktree->WriteBlockIndexSnapshotMarker(uint256S("01")));
+    BOOST_CHECK(!ReadBlockIndexSnapshot(*pblocktree, consensus, entries, best_block));
+    BOOST_CHECK(entries.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
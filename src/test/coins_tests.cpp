@@ -8,6 +8,7 @@
 #include <script/standard.h>
 #include <streams.h>
 #include <test/util/setup_common.h>
+#include <txdb.h>
 #include <uint256.h>
 #include <undo.h>
 #include <util/strencodings.h>
@@ -56,7 +57,7 @@ public:
 
     uint256 GetBestBlock() const override { return hashBestBlock_; }
 
-    bool BatchWrite(CCoinsMap& mapCoins, const uint256& hashBlock) override
+    bool BatchWrite(CCoinsMap& mapCoins, const uint256& hashBlock, const CUTXOStats& statsDelta) override
     {
         for (CCoinsMap::iterator it = mapCoins.begin(); it != mapCoins.end(); ) {
             if (it->second.flags & CCoinsCacheEntry::DIRTY) {
@@ -83,7 +84,7 @@ public:
     void SelfTest() const
     {
         // Manually recompute the dynamic usage of the whole data, and compare it.
-        size_t ret = memusage::DynamicUsage(cacheCoins);
+        size_t ret = cacheCoins.DynamicMemoryUsage();
         size_t count = 0;
         for (const auto& entry : cacheCoins) {
             ret += entry.second.coin.DynamicMemoryUsage();
@@ -571,7 +572,7 @@ static size_t InsertCoinsMapEntry(CCoinsMap& map, CAmount value, char flags)
     CCoinsCacheEntry entry;
     entry.flags = flags;
     SetCoinsValue(value, entry.coin);
-    auto inserted = map.emplace(OUTPOINT, std::move(entry));
+    auto inserted = map.try_emplace(OUTPOINT, std::move(entry));
     assert(inserted.second);
     return inserted.first->second.coin.DynamicMemoryUsage();
 }
@@ -597,7 +598,7 @@ void WriteCoinsViewEntry(CCoinsView& view, CAmount value, char flags)
 {
     CCoinsMap map;
     InsertCoinsMapEntry(map, value, flags);
-    BOOST_CHECK(view.BatchWrite(map, {}));
+    BOOST_CHECK(view.BatchWrite(map, {}, {}));
 }
 
 class SingleEntryCacheTest
@@ -864,4 +865,221 @@ BOOST_AUTO_TEST_CASE(ccoins_write)
                     CheckWriteCoins(parent_value, child_value, parent_value, parent_flags, child_flags, parent_flags);
 }
 
+static bool UTXOStatsEqual(const CUTXOStats &a, const CUTXOStats &b)
+{
+    CDataStream ssa(SER_DISK, CLIENT_VERSION), ssb(SER_DISK, CLIENT_VERSION);
+    ssa << a;
+    ssb << b;
+    return ssa.str() == ssb.str();
+}
+
+BOOST_AUTO_TEST_CASE(utxo_stats_incremental)
+{
+    // Running totals kept through nested caches and flushes must match a scan of the database
+    CCoinsViewDB db(GetDataDir() / "test_utxo_stats", 1 << 20, true, false);
+    CUTXOStats stats;
+    BOOST_CHECK(!db.ReadUTXOStats(stats));
+    BOOST_CHECK(db.WriteUTXOStats(stats));
+
+    std::vector<CScript> scripts;
+    scripts.push_back(GetScriptForDestination(PKHash(uint160(g_insecure_rand_ctx.randbytes(20)))));
+    scripts.push_back(GetScriptForDestination(ScriptHash(uint160(g_insecure_rand_ctx.randbytes(20)))));
+    scripts.push_back(CScript() << OP_TRUE);
+
+    CCoinsViewCache tip(&db);
+    std::vector<COutPoint> outpoints;
+    for (int i = 0; i < 40; ++i) {
+        CCoinsViewCache cache(&tip);
+        for (int k = 0; k < 50; ++k) {
+            if (outpoints.empty() || InsecureRandRange(3) != 0) {
+                Coin coin;
+                coin.out.scriptPubKey = scripts[InsecureRandRange(scripts.size())];
+                coin.out.nValue = InsecureRandRange(100000) + 1;
+                coin.nHeight = i + 1;
+                if (fGraviocoinMode && InsecureRandRange(4) == 0) {
+                    coin.nType = OUTPUT_CT;
+                    coin.out.nValue = 0;
+                }
+                outpoints.emplace_back(InsecureRand256(), InsecureRandRange(4));
+                cache.AddCoin(outpoints.back(), std::move(coin), false);
+            } else {
+                size_t n = InsecureRandRange(outpoints.size());
+                BOOST_CHECK(cache.SpendCoin(outpoints[n]));
+                outpoints.erase(outpoints.begin() + n);
+            }
+        }
+        cache.SetBestBlock(InsecureRand256(), i + 1);
+        BOOST_CHECK(cache.Flush());
+        if (InsecureRandRange(4) == 0) {
+            BOOST_CHECK(tip.Flush());
+        }
+    }
+    tip.SetBestBlock(InsecureRand256(), 41);
+    BOOST_CHECK(tip.Flush());
+
+    CUTXOStats scanned;
+    std::unique_ptr<CCoinsViewCursor> pcursor(db.Cursor());
+    size_t count = 0;
+    for (; pcursor->Valid(); pcursor->Next()) {
+        Coin coin;
+        BOOST_CHECK(pcursor->GetValue(coin));
+        scanned.ApplyCoin(coin, false);
+        count++;
+    }
+    BOOST_CHECK_EQUAL(count, outpoints.size());
+    BOOST_CHECK(db.ReadUTXOStats(stats));
+    BOOST_CHECK(UTXOStatsEqual(stats, scanned));
+}
+
+BOOST_AUTO_TEST_CASE(utxo_stats_scan_delta)
+{
+    // Flushes made while a cursor is scanned are added to the scanned totals
+    CCoinsViewDB db(GetDataDir() / "test_utxo_stats_scan", 1 << 20, true, false);
+    CScript script = GetScriptForDestination(PKHash(uint160(g_insecure_rand_ctx.randbytes(20))));
+    CCoinsViewCache tip(&db);
+    for (int i = 0; i < 3; ++i) {
+        Coin coin;
+        coin.out.scriptPubKey = script;
+        coin.out.nValue = 1000 + i;
+        coin.nHeight = 1;
+        tip.AddCoin(COutPoint(InsecureRand256(), 0), std::move(coin), false);
+    }
+    tip.SetBestBlock(InsecureRand256(), 1);
+    BOOST_CHECK(tip.Flush());
+
+    std::unique_ptr<CCoinsViewCursor> pcursor(db.Cursor());
+    db.BeginUTXOStatsScan();
+    {
+        Coin coin;
+        coin.out.scriptPubKey = script;
+        coin.out.nValue = 5000;
+        coin.nHeight = 2;
+        tip.AddCoin(COutPoint(InsecureRand256(), 0), std::move(coin), false);
+    }
+    tip.SetBestBlock(InsecureRand256(), 2);
+    BOOST_CHECK(tip.Flush());
+
+    CUTXOStats stats;
+    size_t count = 0;
+    for (; pcursor->Valid(); pcursor->Next()) {
+        Coin coin;
+        BOOST_CHECK(pcursor->GetValue(coin));
+        stats.ApplyCoin(coin, false);
+        count++;
+    }
+    BOOST_CHECK_EQUAL(count, 3U);
+    BOOST_CHECK(db.FinishUTXOStatsScan(stats));
+
+    CUTXOStats scanned;
+    pcursor.reset(db.Cursor());
+    for (; pcursor->Valid(); pcursor->Next()) {
+        Coin coin;
+        BOOST_CHECK(pcursor->GetValue(coin));
+        scanned.ApplyCoin(coin, false);
+    }
+    BOOST_CHECK(db.ReadUTXOStats(stats));
+    BOOST_CHECK(UTXOStatsEqual(stats, scanned));
+
+    // A scan abandoned by erasing the totals can't be finished
+    BOOST_CHECK(db.EraseUTXOStats());
+    db.BeginUTXOStatsScan();
+    BOOST_CHECK(db.EraseUTXOStats());
+    BOOST_CHECK(!db.FinishUTXOStatsScan(stats));
+}
+
+BOOST_AUTO_TEST_CASE(ccoinsmap_test)
+{
+    CCoinsMap map;
+    std::map<COutPoint, CAmount> expected;
+    std::vector<const CCoinsCacheEntry*> entries;
+
+    // References to entries stay valid while the table grows
+    for (int i = 0; i < 1000; ++i) {
+        COutPoint outpoint(InsecureRand256(), InsecureRandRange(4));
+        CCoinsCacheEntry& entry = map[outpoint];
+        entry.coin.out.nValue = i + 1;
+        expected[outpoint] = i + 1;
+        entries.push_back(&entry);
+    }
+    for (int i = 0; i < 1000; ++i) {
+        BOOST_CHECK_EQUAL(entries[i]->coin.out.nValue, i + 1);
+    }
+
+    for (int i = 0; i < 20000; ++i) {
+        if (InsecureRandBool()) {
+            COutPoint outpoint(InsecureRand256(), 0);
+            auto inserted = map.try_emplace(outpoint);
+            BOOST_CHECK(inserted.second);
+            inserted.first->second.coin.out.nValue = i;
+            expected[outpoint] = i;
+        } else {
+            auto it = expected.begin();
+            std::advance(it, InsecureRandRange(expected.size()));
+            BOOST_CHECK(map.find(it->first) != map.end());
+            BOOST_CHECK(!map.try_emplace(it->first).second);
+            BOOST_CHECK_EQUAL(map.erase(it->first), 1U);
+            BOOST_CHECK(map.find(it->first) == map.end());
+            expected.erase(it);
+        }
+    }
+    BOOST_CHECK_EQUAL(map.size(), expected.size());
+
+    // Entries can be erased while iterating
+    for (CCoinsMap::iterator it = map.begin(); it != map.end(); ) {
+        auto exp = expected.find(it->first);
+        BOOST_CHECK(exp != expected.end() && exp->second == it->second.coin.out.nValue);
+        if (InsecureRandBool()) {
+            expected.erase(exp);
+            it = map.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    BOOST_CHECK_EQUAL(map.size(), expected.size());
+    for (const auto& exp : expected) {
+        BOOST_CHECK(map.find(exp.first) != map.end());
+    }
+
+    BOOST_CHECK(map.DynamicMemoryUsage() > 0);
+    map.clear();
+    BOOST_CHECK(map.empty());
+    BOOST_CHECK(map.begin() == map.end());
+    BOOST_CHECK_EQUAL(map.DynamicMemoryUsage(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(coin_commitment)
+{
+    // Only OUTPUT_CT coins allocate a commitment
+    Coin coin(CTxOut(1, CScript() << OP_TRUE), 1, false);
+    size_t standard_usage = coin.DynamicMemoryUsage();
+    BOOST_CHECK_EQUAL(standard_usage, 0U);
+
+    secp256k1_pedersen_commitment commitment = {};
+    for (size_t i = 0; i < 33; ++i) {
+        commitment.data[i] = i + 1;
+    }
+    coin.nType = OUTPUT_CT;
+    coin.out.nValue = 0;
+    coin.SetCommitment(commitment);
+    BOOST_CHECK(coin.DynamicMemoryUsage() > standard_usage);
+
+    Coin copy = coin;
+    BOOST_CHECK(memcmp(copy.GetCommitment().data, commitment.data, 33) == 0);
+    BOOST_CHECK(&copy.GetCommitment() != &coin.GetCommitment());
+
+    bool graviocoin_mode = fGraviocoinMode;
+    fGraviocoinMode = true;
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << coin;
+    Coin read;
+    ss >> read;
+    fGraviocoinMode = graviocoin_mode;
+    BOOST_CHECK_EQUAL(read.nType, OUTPUT_CT);
+    BOOST_CHECK(memcmp(read.GetCommitment().data, commitment.data, 33) == 0);
+
+    coin.Clear();
+    BOOST_CHECK(coin.IsSpent());
+    BOOST_CHECK_EQUAL(coin.DynamicMemoryUsage(), 0U);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,114 @@
+// Copyright (c) 2020 The Graviocoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <clientversion.h>
+#include <index/addressindex.h>
+#include <index/spentindex.h>
+#include <index/timestampindex.h>
+#include <script/standard.h>
+#include <streams.h>
+#include <test/util/setup_common.h>
+#include <util/time.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(insightindex_tests)
+
+static void WaitForSync(BaseIndex &index)
+{
+    constexpr int64_t timeout_ms = 10 * 1000;
+    int64_t time_start = GetTimeMillis();
+    while (!index.BlockUntilSyncedToCurrentChain()) {
+        BOOST_REQUIRE(time_start + timeout_ms > GetTimeMillis());
+        MilliSleep(100);
+    }
+}
+
+static std::vector<std::pair<uint256, unsigned int> > ReadAllTimestamps(const TimestampIndex &index)
+{
+    std::vector<std::pair<uint256, unsigned int> > hashes;
+    BOOST_CHECK(index.ReadTimestampIndex(std::numeric_limits<unsigned int>::max(), 0, false, hashes));
+    return hashes;
+}
+
+BOOST_FIXTURE_TEST_CASE(insightindex_initial_sync, TestChain100Setup)
+{
+    AddressIndex address_index(1 << 20, true);
+    SpentIndex spent_index(1 << 20, true);
+    TimestampIndex timestamp_index(1 << 20, true);
+
+    BOOST_CHECK(!timestamp_index.BlockUntilSyncedToCurrentChain());
+    BOOST_CHECK(ReadAllTimestamps(timestamp_index).empty());
+
+    address_index.Start();
+    spent_index.Start();
+    timestamp_index.Start();
+
+    WaitForSync(address_index);
+    WaitForSync(spent_index);
+    WaitForSync(timestamp_index);
+
+    const CBlockIndex *tip;
+    {
+        LOCK(cs_main);
+        tip = ::ChainActive().Tip();
+    }
+    BOOST_CHECK(address_index.IsSyncedTo(tip));
+    BOOST_CHECK(spent_index.IsSyncedTo(tip));
+    BOOST_CHECK(timestamp_index.IsSyncedTo(tip));
+
+    // Every block of the chain is indexed, logical timestamps are unique and increasing
+    std::vector<std::pair<uint256, unsigned int> > hashes = ReadAllTimestamps(timestamp_index);
+    BOOST_CHECK_EQUAL(hashes.size(), (size_t)tip->nHeight + 1);
+    unsigned int prev_ts = 0;
+    for (const CBlockIndex *pindex = tip; pindex; pindex = pindex->pprev) {
+        unsigned int ts;
+        BOOST_REQUIRE(timestamp_index.ReadTimestampBlockIndex(pindex->GetBlockHash(), ts));
+        BOOST_CHECK(ts >= pindex->nTime);
+        if (pindex != tip) {
+            BOOST_CHECK(ts < prev_ts);
+        }
+        prev_ts = ts;
+    }
+
+    // New blocks make it into the indexes
+    CScript coinbase_script_pub_key = GetScriptForDestination(PKHash(coinbaseKey.GetPubKey()));
+    for (int i = 0; i < 5; i++) {
+        std::vector<CMutableTransaction> no_txns;
+        const CBlock &block = CreateAndProcessBlock(no_txns, coinbase_script_pub_key);
+
+        BOOST_CHECK(address_index.BlockUntilSyncedToCurrentChain());
+        BOOST_CHECK(spent_index.BlockUntilSyncedToCurrentChain());
+        BOOST_CHECK(timestamp_index.BlockUntilSyncedToCurrentChain());
+
+        unsigned int ts;
+        BOOST_CHECK(timestamp_index.ReadTimestampBlockIndex(block.GetHash(), ts));
+    }
+    BOOST_CHECK_EQUAL(ReadAllTimestamps(timestamp_index).size(), (size_t)tip->nHeight + 6);
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    address_index.Stop();
+    spent_index.Stop();
+    timestamp_index.Stop();
+
+    threadGroup.interrupt_all();
+    threadGroup.join_all();
+}
+
+BOOST_AUTO_TEST_CASE(addressindex_position_key_size)
+{
+    CAddressIndexIteratorPositionKey key(ADDR_INDT_PUBKEY_ADDRESS, uint256S("01"), 100, 2);
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << key;
+    BOOST_CHECK_EQUAL(ss.size(), key.GetSerializeSize());
+
+    CAddressIndexIteratorPositionKey key_read;
+    ss >> key_read;
+    BOOST_CHECK(key_read.hashBytes == key.hashBytes);
+    BOOST_CHECK_EQUAL(key_read.blockHeight, 100);
+    BOOST_CHECK_EQUAL(key_read.txindex, 2U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
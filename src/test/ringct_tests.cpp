@@ -6,6 +6,7 @@
 
 #include <crypto/sha256.h>
 #include <key/stealth.h>
+#include <txdb.h>
 
 #include <secp256k1.h>
 #include <secp256k1_rangeproof.h>
@@ -720,5 +721,57 @@ BOOST_AUTO_TEST_CASE(ringct_test_set_have)
     BOOST_CHECK(setHaveI.insert(2).second == true);
 }
 
+BOOST_AUTO_TEST_CASE(ringct_test_migrate_rctdb)
+{
+    CBlockTreeDB block_tree_db(1 << 20, true);
+    CRCTDB rct_db(1 << 20, true);
+
+    // Records written to the block tree db by older versions
+    std::vector<CCmpPubKey> pubkeys;
+    for (int64_t i = 1; i <= 100; ++i) {
+        CKey key;
+        key.MakeNewKey(true);
+        CCmpPubKey pk(key.GetPubKey());
+        pubkeys.push_back(pk);
+
+        CAnonOutput ao;
+        ao.pubkey = pk;
+        ao.nBlockHeight = i;
+        BOOST_CHECK(block_tree_db.Write(std::make_pair(DB_RCTOUTPUT, i), ao));
+        BOOST_CHECK(block_tree_db.Write(std::make_pair(DB_RCTOUTPUT_LINK, pk), i));
+        if (i % 2 == 0) {
+            BOOST_CHECK(block_tree_db.Write(std::make_pair(DB_RCTKEYIMAGE, pk), InsecureRand256()));
+        }
+    }
+    BOOST_CHECK(block_tree_db.WriteFlag("txindex", true));
+
+    BOOST_CHECK(rct_db.MigrateData(block_tree_db));
+
+    for (int64_t i = 1; i <= 100; ++i) {
+        const CCmpPubKey &pk = pubkeys[i - 1];
+        CAnonOutput ao;
+        int64_t index;
+        uint256 txhash;
+        BOOST_CHECK(rct_db.ReadRCTOutput(i, ao));
+        BOOST_CHECK(ao.pubkey == pk);
+        BOOST_CHECK(ao.nBlockHeight == i);
+        BOOST_CHECK(rct_db.ReadRCTOutputLink(pk, index));
+        BOOST_CHECK(index == i);
+        BOOST_CHECK(rct_db.ReadRCTKeyImage(pk, txhash) == (i % 2 == 0));
+
+        BOOST_CHECK(!block_tree_db.Exists(std::make_pair(DB_RCTOUTPUT, i)));
+        BOOST_CHECK(!block_tree_db.Exists(std::make_pair(DB_RCTOUTPUT_LINK, pk)));
+        BOOST_CHECK(!block_tree_db.Exists(std::make_pair(DB_RCTKEYIMAGE, pk)));
+    }
+
+    // Other block tree records are kept
+    bool fValue = false;
+    BOOST_CHECK(block_tree_db.ReadFlag("txindex", fValue) && fValue);
+
+    // Nothing left to move
+    BOOST_CHECK(rct_db.MigrateData(block_tree_db));
+    CAnonOutput ao;
+    BOOST_CHECK(rct_db.ReadRCTOutput(1, ao));
+}
 
 BOOST_AUTO_TEST_SUITE_END()
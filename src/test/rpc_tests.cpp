@@ -20,6 +20,8 @@
 
 #include <rpc/blockchain.h>
 
+#include <thread>
+
 /*
 UniValue CallRPC(std::string args)
 {
@@ -231,6 +233,53 @@ BOOST_AUTO_TEST_CASE(json_parse_errors)
     BOOST_CHECK_THROW(ParseNonRFCJSONValue("3J98t1WpEZ73CNmQviecrnyiWrnqRhWNL"), std::runtime_error);
 }
 
+static UniValue rpc_tests_batchcall(const JSONRPCRequest& request)
+{
+    if (request.params[0].get_bool()) {
+        throw 1;
+    }
+    return request.params[0];
+}
+
+BOOST_AUTO_TEST_CASE(rpc_batch_threads)
+{
+    static const CRPCCommand command{"test", "rpc_tests_batchcall", &rpc_tests_batchcall, {"throw"}};
+    tableRPC.appendCommand("rpc_tests_batchcall", &command);
+    if (RPCIsInWarmup(nullptr)) SetRPCWarmupFinished();
+
+    UniValue calls(UniValue::VARR);
+    for (int i = 0; i < 16; ++i) {
+        // Every third call throws something that isn't a std::exception
+        UniValue params(UniValue::VARR);
+        params.push_back(UniValue(i % 3 == 0));
+        calls.push_back(JSONRPCRequestObj("rpc_tests_batchcall", params, i));
+    }
+
+    std::vector<std::thread> threads;
+    auto queue_work = [&threads](const std::function<void()>& work) {
+        threads.emplace_back(work);
+        return true;
+    };
+    std::string reply = JSONRPCExecBatch(JSONRPCRequest(), calls, 4, queue_work);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    BOOST_CHECK_EQUAL(threads.size(), 3U);
+
+    UniValue replies;
+    BOOST_REQUIRE(replies.read(reply));
+    BOOST_REQUIRE_EQUAL(replies.size(), calls.size());
+    for (size_t i = 0; i < replies.size(); ++i) {
+        BOOST_CHECK_EQUAL(find_value(replies[i], "id").get_int(), (int)i);
+        if (i % 3 == 0) {
+            BOOST_CHECK_EQUAL(find_value(find_value(replies[i], "error"), "code").get_int(), RPC_MISC_ERROR);
+        } else {
+            BOOST_CHECK(find_value(replies[i], "error").isNull());
+            BOOST_CHECK_EQUAL(find_value(replies[i], "result").get_bool(), false);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE(rpc_ban)
 {
     BOOST_CHECK_NO_THROW(CallRPC(std::string("clearbanned")));
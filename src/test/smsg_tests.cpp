@@ -3,6 +3,8 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <smsg/smessage.h>
+#include <smsg/db.h>
+#include <compat/byteswap.h>
 
 #include <test/util/setup_common.h>
 #include <net.h>
@@ -126,4 +128,93 @@ BOOST_AUTO_TEST_CASE(smsg_test)
 }
 #endif
 
+static void MakeMsgKey(const std::string &folder, int64_t timestamp, const uint160 &hash, uint8_t *chKey)
+{
+    int64_t timestamp_be = bswap_64(timestamp);
+    memcpy(&chKey[0], folder.data(), 2);
+    memcpy(&chKey[2], &timestamp_be, 8);
+    memcpy(&chKey[10], hash.begin(), 20);
+}
+
+static uint160 RandHash160()
+{
+    uint160 hash;
+    InsecureRandBytes(hash.begin(), 20);
+    return hash;
+}
+
+static std::vector<int64_t> ListIndexed(smsg::SecMsgDB &db, const std::string &prefix, const std::string &resume_after, bool reverse)
+{
+    std::vector<int64_t> times;
+    uint8_t msgId[smsg::SMSG_MSGID_LEN];
+    leveldb::Iterator *it = db.pdb->NewIterator(leveldb::ReadOptions());
+    while (db.NextIndexed(it, prefix, resume_after, reverse, msgId)) {
+        int64_t timestamp;
+        memcpy(&timestamp, msgId, 8);
+        times.push_back(bswap_64(timestamp));
+    }
+    delete it;
+    return times;
+}
+
+BOOST_AUTO_TEST_CASE(smsg_test_db_indexes)
+{
+    SeedInsecureRand();
+
+    LOCK(smsg::cs_smsgDB);
+    smsg::SecMsgDB db;
+    BOOST_REQUIRE(db.Open("cr+"));
+
+    CKeyID addrA(RandHash160());
+    CKeyID addrB(RandHash160());
+
+    const int nMessages = 5;
+    uint8_t chKeys[nMessages][30];
+    for (int i = 0; i < nMessages; ++i) {
+        MakeMsgKey(smsg::DBK_INBOX, i + 1, RandHash160(), chKeys[i]);
+        smsg::SecMsgStored stored;
+        stored.timeReceived = i + 1;
+        stored.status = (i % 2 == 0) ? SMSG_MASK_UNREAD : 0;
+        stored.folderId = 0;
+        stored.addrTo = i < 3 ? addrA : addrB;
+        BOOST_CHECK(db.WriteSmesg(chKeys[i], stored));
+    }
+
+    std::string prefix_unread = smsg::SecMsgDB::UnreadIndexPrefix(smsg::DBK_INBOX);
+    std::string prefix_a = smsg::SecMsgDB::AddressIndexPrefix(smsg::DBK_INBOX, addrA);
+    std::string prefix_b = smsg::SecMsgDB::AddressIndexPrefix(smsg::DBK_INBOX, addrB);
+
+    BOOST_CHECK(ListIndexed(db, prefix_unread, "", false) == std::vector<int64_t>({1, 3, 5}));
+    BOOST_CHECK(ListIndexed(db, prefix_a, "", true) == std::vector<int64_t>({3, 2, 1}));
+    BOOST_CHECK(ListIndexed(db, prefix_b, "", false) == std::vector<int64_t>({4, 5}));
+
+    // Resume after the second message in either direction
+    std::string resume((const char*)&chKeys[1][2], smsg::SMSG_MSGID_LEN);
+    BOOST_CHECK(ListIndexed(db, smsg::DBK_INBOX, resume, false) == std::vector<int64_t>({3, 4, 5}));
+    BOOST_CHECK(ListIndexed(db, smsg::DBK_INBOX, resume, true) == std::vector<int64_t>({1}));
+    BOOST_CHECK(ListIndexed(db, smsg::DBK_INBOX, "", true) == std::vector<int64_t>({5, 4, 3, 2, 1}));
+
+    // Read status and erase update the indexes in a batch
+    smsg::SecMsgStored stored;
+    BOOST_CHECK(db.TxnBegin());
+    BOOST_REQUIRE(db.ReadSmesg(chKeys[0], stored));
+    stored.status &= ~SMSG_MASK_UNREAD;
+    BOOST_CHECK(db.WriteSmesg(chKeys[0], stored));
+    smsg::SecMsgMeta meta;
+    meta.timeSent = 5;
+    BOOST_CHECK(db.WriteMeta(chKeys[4], meta));
+    BOOST_CHECK(db.EraseSmesg(chKeys[4]));
+    BOOST_CHECK(db.TxnCommit());
+
+    BOOST_CHECK(ListIndexed(db, prefix_unread, "", false) == std::vector<int64_t>({3}));
+    BOOST_CHECK(ListIndexed(db, prefix_b, "", false) == std::vector<int64_t>({4}));
+    BOOST_CHECK(!db.ReadMeta(chKeys[4], meta));
+
+    for (int i = 0; i < nMessages - 1; ++i) {
+        BOOST_CHECK(db.EraseSmesg(chKeys[i]));
+    }
+    BOOST_CHECK(ListIndexed(db, prefix_a, "", false).empty());
+    BOOST_CHECK(ListIndexed(db, smsg::DBK_INBOX, "", false).empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
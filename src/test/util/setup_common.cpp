@@ -114,6 +114,7 @@ TestingSetup::TestingSetup(const std::string& chainName, bool fGraviocoinModeIn)
     GetMainSignals().RegisterBackgroundSignalScheduler(scheduler);
 
     pblocktree.reset(new CBlockTreeDB(1 << 20, true));
+    prctdb.reset(new CRCTDB(1 << 20, true));
     g_chainstate = MakeUnique<CChainState>();
     ::ChainstateActive().InitCoinsDB(
         /* cache_size_bytes */ 1 << 23, /* in_memory */ true, /* should_wipe */ false);
@@ -155,6 +156,7 @@ TestingSetup::~TestingSetup()
     UnloadBlockIndex();
     g_chainstate.reset();
     pblocktree.reset();
+    prctdb.reset();
 }
 
 TestChain100Setup::TestChain100Setup()
@@ -4,6 +4,10 @@
 
 #include <chainparams.h>
 #include <net.h>
+#include <script/standard.h>
+#include <streams.h>
+#include <txdb.h>
+#include <undo.h>
 #include <validation.h>
 
 #include <test/util/setup_common.h>
@@ -74,4 +78,47 @@ BOOST_AUTO_TEST_CASE(test_combiner_all)
     Test.disconnect(&ReturnTrue);
     BOOST_CHECK(Test());
 }
+
+BOOST_FIXTURE_TEST_CASE(block_file_compression, TestChain100Setup)
+{
+    // The chain is stored uncompressed in the first block file, start a new file with compression enabled
+    GetBlockFileInfo(::ChainActive().Tip()->GetBlockPos().nFile)->nSize = MAX_BLOCKFILE_SIZE;
+    g_block_compression = true;
+    CreateAndProcessBlock({}, GetScriptForRawPubKey(coinbaseKey.GetPubKey()));
+    BOOST_CHECK_EQUAL(::ChainActive().Tip()->nFile, 1);
+
+    const fs::path first_file = GetBlockPosFilename(FlatFilePos(0, 0));
+    BOOST_CHECK(fs::exists(first_file));
+    CompressBlockFiles(Params());
+    g_block_compression = false;
+    BOOST_CHECK(!fs::exists(first_file));
+
+    int compressed_files = 0;
+    BOOST_CHECK(pblocktree->ReadCompressedBlockFiles(compressed_files));
+    BOOST_CHECK_EQUAL(compressed_files, 1);
+
+    LOCK(cs_main);
+    for (const CBlockIndex* pindex = ::ChainActive().Tip(); pindex; pindex = pindex->pprev) {
+        BOOST_CHECK(pindex->nFile >= 1);
+
+        CBlock block;
+        BOOST_CHECK(ReadBlockFromDisk(block, pindex, Params().GetConsensus()));
+
+        std::vector<uint8_t> raw_block;
+        CDataStream ss(SER_DISK, CLIENT_VERSION);
+        ss << block;
+        BOOST_CHECK(ReadRawBlockFromDisk(raw_block, pindex, Params().MessageStart()));
+        BOOST_CHECK(raw_block == std::vector<uint8_t>(ss.begin(), ss.end()));
+
+        CTransactionRef tx;
+        BOOST_CHECK(ReadTransactionFromDiskBlock(pindex, 0, tx));
+        BOOST_CHECK(tx->GetHash() == block.vtx[0]->GetHash());
+
+        if (pindex->nStatus & BLOCK_HAVE_UNDO) {
+            CBlockUndo blockundo;
+            BOOST_CHECK(UndoReadFromDisk(blockundo, pindex));
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
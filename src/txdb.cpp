@@ -28,6 +28,7 @@ static const char DB_BLOCK_FILES = 'f';
 //static const char DB_TXINDEX = 't';
 static const char DB_ADDRESSINDEX = 'a';
 static const char DB_ADDRESSUNSPENTINDEX = 'u';
+static const char DB_ADDRESSBALANCEINDEX = 'w';
 static const char DB_TIMESTAMPINDEX = 's';
 static const char DB_BLOCKHASHINDEX = 'z';
 static const char DB_SPENTINDEX = 'p';
@@ -36,9 +37,13 @@ static const char DB_BLOCK_INDEX = 'b';
 
 static const char DB_BEST_BLOCK = 'B';
 static const char DB_HEAD_BLOCKS = 'H';
+static const char DB_UTXO_STATS = 'S';
 static const char DB_FLAG = 'F';
 static const char DB_REINDEX_FLAG = 'R';
 static const char DB_LAST_BLOCK = 'l';
+static const char DB_BLOCK_INDEX_SNAPSHOT = 'I';
+static const char DB_COMPRESSED_BLOCK_FILES = 'Z';
+static const char DB_COMPRESSED_BLOCK_MOVES = 'M';
 
 /*
 static const char DB_RCTOUTPUT = 'A';
@@ -48,6 +53,22 @@ static const char DB_RCTKEYIMAGE = 'K';
 
 namespace {
 
+/** A key handled as its serialized bytes, for removing records of any type */
+struct RawKey {
+    std::vector<char> data;
+
+    template<typename Stream>
+    void Serialize(Stream &s) const {
+        s.write(data.data(), data.size());
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream &s) {
+        data.resize(s.size());
+        s.read(data.data(), data.size());
+    }
+};
+
 struct CoinEntry {
     COutPoint* outpoint;
     char key;
@@ -97,7 +118,33 @@ std::vector<uint256> CCoinsViewDB::GetHeadBlocks() const {
     return vhashHeadBlocks;
 }
 
-bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
+bool CCoinsViewDB::ReadUTXOStats(CUTXOStats &stats) const {
+    return db.Read(DB_UTXO_STATS, stats);
+}
+
+bool CCoinsViewDB::WriteUTXOStats(const CUTXOStats &stats) {
+    return db.Write(DB_UTXO_STATS, stats, true);
+}
+
+bool CCoinsViewDB::EraseUTXOStats() {
+    m_stats_scan_delta.reset();
+    return db.Erase(DB_UTXO_STATS, true);
+}
+
+void CCoinsViewDB::BeginUTXOStatsScan() {
+    m_stats_scan_delta.reset(new CUTXOStats());
+}
+
+bool CCoinsViewDB::FinishUTXOStatsScan(CUTXOStats &stats) {
+    if (!m_stats_scan_delta) {
+        return false;
+    }
+    stats += *m_stats_scan_delta;
+    m_stats_scan_delta.reset();
+    return WriteUTXOStats(stats);
+}
+
+bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, const CUTXOStats &statsDelta) {
     CDBBatch batch(db);
     size_t count = 0;
     size_t changed = 0;
@@ -148,6 +195,16 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
         }
     }
 
+    // Totals are only kept once initialised by a scan
+    CUTXOStats stats;
+    if (ReadUTXOStats(stats)) {
+        stats += statsDelta;
+        batch.Write(DB_UTXO_STATS, stats);
+    } else
+    if (m_stats_scan_delta) {
+        *m_stats_scan_delta += statsDelta;
+    }
+
     // In the last batch, mark the database as consistent with hashBlock again.
     batch.Erase(DB_HEAD_BLOCKS);
     batch.Write(DB_BEST_BLOCK, hashBlock);
@@ -158,6 +215,73 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
     return ret;
 }
 
+bool CCoinsViewDB::WriteSnapshotCoins(CHashVerifier<CAutoFile> &file, uint64_t coins_count, const uint256 &hashBlock)
+{
+    CDBBatch batch(db);
+    size_t batch_size = (size_t)gArgs.GetArg("-dbbatchsize", nDefaultDbBatchSize);
+    assert(!hashBlock.IsNull());
+
+    batch.Erase(DB_BEST_BLOCK);
+    batch.Write(DB_HEAD_BLOCKS, Vector(hashBlock, GetBestBlock()));
+    // Totals are rebuilt from the loaded set on first use
+    batch.Erase(DB_UTXO_STATS);
+    m_stats_scan_delta.reset();
+
+    COutPoint outpoint;
+    Coin coin;
+    for (uint64_t i = 0; i < coins_count; ++i) {
+        file >> outpoint;
+        file >> coin;
+        batch.Write(CoinEntry(&outpoint), coin);
+        if (batch.SizeEstimate() > batch_size) {
+            LogPrint(BCLog::COINDB, "Writing partial batch of %.2f MiB\n", batch.SizeEstimate() * (1.0 / 1048576.0));
+            if (!db.WriteBatch(batch)) {
+                return false;
+            }
+            batch.Clear();
+        }
+    }
+
+    LogPrint(BCLog::COINDB, "Writing final batch of %.2f MiB\n", batch.SizeEstimate() * (1.0 / 1048576.0));
+    return db.WriteBatch(batch);
+}
+
+bool CCoinsViewDB::CommitSnapshotCoins(const uint256 &hashBlock)
+{
+    CDBBatch batch(db);
+    batch.Erase(DB_HEAD_BLOCKS);
+    batch.Write(DB_BEST_BLOCK, hashBlock);
+    return db.WriteBatch(batch, true);
+}
+
+bool CCoinsViewDB::RollbackSnapshotCoins(const std::vector<std::pair<COutPoint, Coin> > &coins, const uint256 &hashBlock)
+{
+    CDBBatch batch(db);
+    size_t batch_size = (size_t)gArgs.GetArg("-dbbatchsize", nDefaultDbBatchSize);
+
+    std::unique_ptr<CCoinsViewCursor> pcursor(Cursor());
+    COutPoint outpoint;
+    for (; pcursor->Valid(); pcursor->Next()) {
+        if (!pcursor->GetKey(outpoint)) {
+            return false;
+        }
+        batch.Erase(CoinEntry(&outpoint));
+        if (batch.SizeEstimate() > batch_size) {
+            if (!db.WriteBatch(batch)) {
+                return false;
+            }
+            batch.Clear();
+        }
+    }
+    for (const auto &entry : coins) {
+        batch.Write(CoinEntry(&entry.first), entry.second);
+    }
+    batch.Erase(DB_UTXO_STATS);
+    batch.Erase(DB_HEAD_BLOCKS);
+    batch.Write(DB_BEST_BLOCK, hashBlock);
+    return db.WriteBatch(batch, true);
+}
+
 size_t CCoinsViewDB::EstimateSize() const
 {
     return db.EstimateSize(DB_COIN, (char)(DB_COIN+1));
@@ -251,177 +375,84 @@ bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockF
     return WriteBatch(batch, true);
 }
 
-bool CBlockTreeDB::ReadSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value) {
-    return Read(std::make_pair(DB_SPENTINDEX, key), value);
-}
-
-bool CBlockTreeDB::UpdateSpentIndex(const std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> >&vect) {
-    CDBBatch batch(*this);
-    for (std::vector<std::pair<CSpentIndexKey,CSpentIndexValue> >::const_iterator it=vect.begin(); it!=vect.end(); it++) {
-        if (it->second.IsNull()) {
-            batch.Erase(std::make_pair(DB_SPENTINDEX, it->first));
-        } else {
-            batch.Write(std::make_pair(DB_SPENTINDEX, it->first), it->second);
+bool CBlockTreeDB::EraseLegacyInsightIndexes()
+{
+    for (char prefix : {DB_ADDRESSINDEX, DB_ADDRESSUNSPENTINDEX, DB_ADDRESSBALANCEINDEX, DB_TIMESTAMPINDEX, DB_BLOCKHASHINDEX, DB_SPENTINDEX}) {
+        std::unique_ptr<CDBIterator> pcursor(NewIterator());
+        CDBBatch batch(*this);
+        RawKey key_first, key_last;
+        pcursor->Seek(prefix);
+        while (pcursor->Valid()) {
+            boost::this_thread::interruption_point();
+            RawKey key;
+            if (!pcursor->GetKey(key) || key.data.empty() || key.data[0] != prefix) {
+                break;
+            }
+            if (key_first.data.empty()) {
+                key_first = key;
+            }
+            batch.Erase(key);
+            key_last = key;
+            if (batch.SizeEstimate() > (1 << 24)) {
+                if (!WriteBatch(batch)) {
+                    return error("%s: Failed to write batch", __func__);
+                }
+                batch.Clear();
+            }
+            pcursor->Next();
         }
-    }
-    return WriteBatch(batch);
-}
-
-bool CBlockTreeDB::UpdateAddressUnspentIndex(const std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue > >&vect) {
-    CDBBatch batch(*this);
-    for (std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >::const_iterator it=vect.begin(); it!=vect.end(); it++) {
-        if (it->second.IsNull()) {
-            batch.Erase(std::make_pair(DB_ADDRESSUNSPENTINDEX, it->first));
-        } else {
-            batch.Write(std::make_pair(DB_ADDRESSUNSPENTINDEX, it->first), it->second);
+        if (!WriteBatch(batch)) {
+            return error("%s: Failed to write batch", __func__);
         }
-    }
-    return WriteBatch(batch);
-}
-
-bool CBlockTreeDB::ReadAddressUnspentIndex(uint256 addressHash, int type,
-                                           std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs) {
-    const std::unique_ptr<CDBIterator> pcursor(NewIterator());
-
-    pcursor->Seek(std::make_pair(DB_ADDRESSUNSPENTINDEX, CAddressIndexIteratorKey(type, addressHash)));
-
-    while (pcursor->Valid()) {
-        boost::this_thread::interruption_point();
-        std::pair<char,CAddressUnspentKey> key;
-        if (pcursor->GetKey(key) && key.first == DB_ADDRESSUNSPENTINDEX && key.second.hashBytes == addressHash) {
-            CAddressUnspentValue nValue;
-            if (pcursor->GetValue(nValue)) {
-                unspentOutputs.push_back(std::make_pair(key.second, nValue));
-                pcursor->Next();
-            } else {
-                return error("failed to get address unspent value");
-            }
-        } else {
-            break;
+        if (!key_first.data.empty()) {
+            CompactRange(key_first, key_last);
         }
     }
-
     return true;
 }
 
-bool CBlockTreeDB::WriteAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount > >&vect) {
-    CDBBatch batch(*this);
-    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=vect.begin(); it!=vect.end(); it++)
-        batch.Write(std::make_pair(DB_ADDRESSINDEX, it->first), it->second);
-    return WriteBatch(batch);
-}
-
-bool CBlockTreeDB::EraseAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount > >&vect) {
-    CDBBatch batch(*this);
-    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=vect.begin(); it!=vect.end(); it++)
-        batch.Erase(std::make_pair(DB_ADDRESSINDEX, it->first));
-    return WriteBatch(batch);
+bool CBlockTreeDB::WriteFlag(const std::string &name, bool fValue) {
+    return Write(std::make_pair(DB_FLAG, name), fValue ? '1' : '0');
 }
 
-bool CBlockTreeDB::ReadAddressIndex(uint256 addressHash, int type,
-                                    std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
-                                    int start, int end) {
-    const std::unique_ptr<CDBIterator> pcursor(NewIterator());
-
-    if (start > 0 && end > 0) {
-        pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorHeightKey(type, addressHash, start)));
-    } else {
-        pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorKey(type, addressHash)));
-    }
-
-    while (pcursor->Valid()) {
-        boost::this_thread::interruption_point();
-        std::pair<char,CAddressIndexKey> key;
-        if (pcursor->GetKey(key) && key.first == DB_ADDRESSINDEX && key.second.hashBytes == addressHash) {
-            if (end > 0 && key.second.blockHeight > end) {
-                break;
-            }
-            CAmount nValue;
-            if (pcursor->GetValue(nValue)) {
-                addressIndex.push_back(std::make_pair(key.second, nValue));
-                pcursor->Next();
-            } else {
-                return error("failed to get address index value");
-            }
-        } else {
-            break;
-        }
-    }
-
+bool CBlockTreeDB::ReadFlag(const std::string &name, bool &fValue) {
+    char ch;
+    if (!Read(std::make_pair(DB_FLAG, name), ch))
+        return false;
+    fValue = ch == '1';
     return true;
 }
 
-bool CBlockTreeDB::WriteTimestampIndex(const CTimestampIndexKey &timestampIndex)
-{
-    CDBBatch batch(*this);
-    batch.Write(std::make_pair(DB_TIMESTAMPINDEX, timestampIndex), 0);
-    return WriteBatch(batch);
+bool CBlockTreeDB::ReadBlockIndexSnapshotMarker(uint256 &checksum) {
+    return Read(DB_BLOCK_INDEX_SNAPSHOT, checksum);
 }
 
-bool CBlockTreeDB::ReadTimestampIndex(const unsigned int &high, const unsigned int &low, const bool fActiveOnly, std::vector<std::pair<uint256, unsigned int> > &hashes)
-{
-    const std::unique_ptr<CDBIterator> pcursor(NewIterator());
-
-    pcursor->Seek(std::make_pair(DB_TIMESTAMPINDEX, CTimestampIndexIteratorKey(low)));
-
-    if (fActiveOnly) {
-        LockAssertion lock(::cs_main); // cs_main is locked before GetTimestampIndex if fActiveOnly
-        while (pcursor->Valid()) {
-            boost::this_thread::interruption_point();
-            std::pair<char, CTimestampIndexKey> key;
-            if (pcursor->GetKey(key) && key.first == DB_TIMESTAMPINDEX && key.second.timestamp < high) {
-                if (HashOnchainActive(key.second.blockHash)) {
-                    hashes.push_back(std::make_pair(key.second.blockHash, key.second.timestamp));
-                }
-                pcursor->Next();
-            } else {
-                break;
-            }
-        }
-    } else {
-        // Otherwise get: requires holding mutex
-        while (pcursor->Valid()) {
-            boost::this_thread::interruption_point();
-            std::pair<char, CTimestampIndexKey> key;
-            if (pcursor->GetKey(key) && key.first == DB_TIMESTAMPINDEX && key.second.timestamp < high) {
-                hashes.push_back(std::make_pair(key.second.blockHash, key.second.timestamp));
-                pcursor->Next();
-            } else {
-                break;
-            }
-        }
-    }
-
-    return true;
+bool CBlockTreeDB::WriteBlockIndexSnapshotMarker(const uint256 &checksum) {
+    return Write(DB_BLOCK_INDEX_SNAPSHOT, checksum, true);
 }
 
-bool CBlockTreeDB::WriteTimestampBlockIndex(const CTimestampBlockIndexKey &blockhashIndex, const CTimestampBlockIndexValue &logicalts) {
-    CDBBatch batch(*this);
-    batch.Write(std::make_pair(DB_BLOCKHASHINDEX, blockhashIndex), logicalts);
-    return WriteBatch(batch);
+bool CBlockTreeDB::EraseBlockIndexSnapshotMarker() {
+    return Erase(DB_BLOCK_INDEX_SNAPSHOT, true);
 }
 
-bool CBlockTreeDB::ReadTimestampBlockIndex(const uint256 &hash, unsigned int &ltimestamp) {
+bool CBlockTreeDB::ReadCompressedBlockFiles(int &nFile) {
+    return Read(DB_COMPRESSED_BLOCK_FILES, nFile);
+}
 
-    CTimestampBlockIndexValue lts;
-    if (!Read(std::make_pair(DB_BLOCKHASHINDEX, hash), lts)) {
-        return false;
-    }
+bool CBlockTreeDB::WriteCompressedBlockFiles(int nFile) {
+    return Write(DB_COMPRESSED_BLOCK_FILES, nFile, true);
+}
 
-    ltimestamp = lts.ltimestamp;
-    return true;
+bool CBlockTreeDB::ReadCompressedBlockMoves(std::vector<std::pair<uint256, FlatFilePos> > &moves) {
+    return Read(DB_COMPRESSED_BLOCK_MOVES, moves);
 }
 
-bool CBlockTreeDB::WriteFlag(const std::string &name, bool fValue) {
-    return Write(std::make_pair(DB_FLAG, name), fValue ? '1' : '0');
+bool CBlockTreeDB::WriteCompressedBlockMoves(const std::vector<std::pair<uint256, FlatFilePos> > &moves) {
+    return Write(DB_COMPRESSED_BLOCK_MOVES, moves, true);
 }
 
-bool CBlockTreeDB::ReadFlag(const std::string &name, bool &fValue) {
-    char ch;
-    if (!Read(std::make_pair(DB_FLAG, name), ch))
-        return false;
-    fValue = ch == '1';
-    return true;
+bool CBlockTreeDB::EraseCompressedBlockMoves() {
+    return Erase(DB_COMPRESSED_BLOCK_MOVES, true);
 }
 
 bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex)
@@ -489,19 +520,22 @@ bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams,
     return true;
 }
 
-bool CBlockTreeDB::ReadRCTOutput(int64_t i, CAnonOutput &ao)
+CRCTDB::CRCTDB(size_t nCacheSize, bool fMemory, bool fWipe) : CDBWrapper(GetDataDir() / "blocks" / "rct", nCacheSize, fMemory, fWipe, false, false, 64, 16) {
+}
+
+bool CRCTDB::ReadRCTOutput(int64_t i, CAnonOutput &ao)
 {
     return Read(std::make_pair(DB_RCTOUTPUT, i), ao);
 };
 
-bool CBlockTreeDB::WriteRCTOutput(int64_t i, const CAnonOutput &ao)
+bool CRCTDB::WriteRCTOutput(int64_t i, const CAnonOutput &ao)
 {
     CDBBatch batch(*this);
     batch.Write(std::make_pair(DB_RCTOUTPUT, i), ao);
     return WriteBatch(batch);
 };
 
-bool CBlockTreeDB::EraseRCTOutput(int64_t i)
+bool CRCTDB::EraseRCTOutput(int64_t i)
 {
     CDBBatch batch(*this);
     batch.Erase(std::make_pair(DB_RCTOUTPUT, i));
@@ -509,44 +543,179 @@ bool CBlockTreeDB::EraseRCTOutput(int64_t i)
 };
 
 
-bool CBlockTreeDB::ReadRCTOutputLink(const CCmpPubKey &pk, int64_t &i)
+bool CRCTDB::ReadRCTOutputLink(const CCmpPubKey &pk, int64_t &i)
 {
     return Read(std::make_pair(DB_RCTOUTPUT_LINK, pk), i);
 };
 
-bool CBlockTreeDB::WriteRCTOutputLink(const CCmpPubKey &pk, int64_t i)
+bool CRCTDB::WriteRCTOutputLink(const CCmpPubKey &pk, int64_t i)
 {
     CDBBatch batch(*this);
     batch.Write(std::make_pair(DB_RCTOUTPUT_LINK, pk), i);
     return WriteBatch(batch);
 };
 
-bool CBlockTreeDB::EraseRCTOutputLink(const CCmpPubKey &pk)
+bool CRCTDB::EraseRCTOutputLink(const CCmpPubKey &pk)
 {
     CDBBatch batch(*this);
     batch.Erase(std::make_pair(DB_RCTOUTPUT_LINK, pk));
     return WriteBatch(batch);
 };
 
-bool CBlockTreeDB::ReadRCTKeyImage(const CCmpPubKey &ki, uint256 &txhash)
+bool CRCTDB::ReadRCTKeyImage(const CCmpPubKey &ki, uint256 &txhash)
 {
     return Read(std::make_pair(DB_RCTKEYIMAGE, ki), txhash);
 };
 
-bool CBlockTreeDB::WriteRCTKeyImage(const CCmpPubKey &ki, const uint256 &txhash)
+bool CRCTDB::WriteRCTKeyImage(const CCmpPubKey &ki, const uint256 &txhash)
 {
     CDBBatch batch(*this);
     batch.Write(std::make_pair(DB_RCTKEYIMAGE, ki), txhash);
     return WriteBatch(batch);
 };
 
-bool CBlockTreeDB::EraseRCTKeyImage(const CCmpPubKey &ki)
+bool CRCTDB::EraseRCTKeyImage(const CCmpPubKey &ki)
 {
     CDBBatch batch(*this);
     batch.Erase(std::make_pair(DB_RCTKEYIMAGE, ki));
     return WriteBatch(batch);
 };
 
+bool CRCTDB::WriteSnapshotRCT(CHashVerifier<CAutoFile> &file, uint64_t anon_outputs_count, uint64_t key_images_count)
+{
+    CDBBatch batch(*this);
+    size_t batch_size = (size_t)gArgs.GetArg("-dbbatchsize", nDefaultDbBatchSize);
+
+    int64_t index;
+    CAnonOutput ao;
+    for (uint64_t i = 0; i < anon_outputs_count; ++i) {
+        file >> index;
+        file >> ao;
+        batch.Write(std::make_pair(DB_RCTOUTPUT, index), ao);
+        batch.Write(std::make_pair(DB_RCTOUTPUT_LINK, ao.pubkey), index);
+        if (batch.SizeEstimate() > batch_size) {
+            if (!WriteBatch(batch)) {
+                return false;
+            }
+            batch.Clear();
+        }
+    }
+
+    CCmpPubKey ki;
+    uint256 txhash;
+    for (uint64_t i = 0; i < key_images_count; ++i) {
+        file >> ki;
+        file >> txhash;
+        batch.Write(std::make_pair(DB_RCTKEYIMAGE, ki), txhash);
+        if (batch.SizeEstimate() > batch_size) {
+            if (!WriteBatch(batch)) {
+                return false;
+            }
+            batch.Clear();
+        }
+    }
+
+    return WriteBatch(batch);
+};
+
+template <typename K>
+static bool EraseRCTRecords(CRCTDB &rct_db, char prefix, size_t batch_size)
+{
+    std::unique_ptr<CDBIterator> pcursor(rct_db.NewIterator());
+    std::pair<char, K> key;
+    CDBBatch batch(rct_db);
+    for (pcursor->Seek(prefix); pcursor->Valid(); pcursor->Next()) {
+        if (!pcursor->GetKey(key) || key.first != prefix) {
+            break;
+        }
+        batch.Erase(key);
+        if (batch.SizeEstimate() > batch_size) {
+            if (!rct_db.WriteBatch(batch)) {
+                return false;
+            }
+            batch.Clear();
+        }
+    }
+    return rct_db.WriteBatch(batch);
+}
+
+bool CRCTDB::EraseSnapshotRCT()
+{
+    size_t batch_size = (size_t)gArgs.GetArg("-dbbatchsize", nDefaultDbBatchSize);
+    return EraseRCTRecords<int64_t>(*this, DB_RCTOUTPUT, batch_size)
+        && EraseRCTRecords<CCmpPubKey>(*this, DB_RCTOUTPUT_LINK, batch_size)
+        && EraseRCTRecords<CCmpPubKey>(*this, DB_RCTKEYIMAGE, batch_size);
+}
+
+/** Move the records under one prefix from the block tree database, copies everything before erasing
+ *  so an interrupted migration restarts from the block tree records. */
+template <typename K, typename V>
+static bool MoveRCTRecords(CBlockTreeDB &block_tree_db, CRCTDB &rct_db, char prefix, size_t batch_size, bool &fFound)
+{
+    std::unique_ptr<CDBIterator> pcursor(block_tree_db.NewIterator());
+    std::pair<char, K> key, key_first;
+    V value;
+
+    pcursor->Seek(prefix);
+    if (!pcursor->Valid() || !pcursor->GetKey(key_first) || key_first.first != prefix) {
+        return true;
+    }
+    if (!fFound) {
+        LogPrintf("Moving RingCT data from the block index database to %s\n", (GetDataDir() / "blocks" / "rct").string());
+        fFound = true;
+    }
+
+    CDBBatch batch(rct_db);
+    for (; pcursor->Valid(); pcursor->Next()) {
+        boost::this_thread::interruption_point();
+        if (!pcursor->GetKey(key) || key.first != prefix) {
+            break;
+        }
+        if (!pcursor->GetValue(value)) {
+            return error("%s: Failed to read record", __func__);
+        }
+        batch.Write(key, value);
+        if (batch.SizeEstimate() > batch_size) {
+            if (!rct_db.WriteBatch(batch)) {
+                return error("%s: Failed to write batch", __func__);
+            }
+            batch.Clear();
+        }
+    }
+    if (!rct_db.WriteBatch(batch, true)) {
+        return error("%s: Failed to write batch", __func__);
+    }
+
+    CDBBatch erase_batch(block_tree_db);
+    for (pcursor->Seek(prefix); pcursor->Valid(); pcursor->Next()) {
+        if (!pcursor->GetKey(key) || key.first != prefix) {
+            break;
+        }
+        erase_batch.Erase(key);
+        if (erase_batch.SizeEstimate() > batch_size) {
+            if (!block_tree_db.WriteBatch(erase_batch)) {
+                return error("%s: Failed to write batch", __func__);
+            }
+            erase_batch.Clear();
+        }
+    }
+    if (!block_tree_db.WriteBatch(erase_batch, true)) {
+        return error("%s: Failed to write batch", __func__);
+    }
+    block_tree_db.CompactRange(key_first, key);
+    return true;
+}
+
+bool CRCTDB::MigrateData(CBlockTreeDB &block_tree_db)
+{
+    size_t batch_size = (size_t)gArgs.GetArg("-dbbatchsize", nDefaultDbBatchSize);
+    bool fFound = false;
+
+    return MoveRCTRecords<int64_t, CAnonOutput>(block_tree_db, *this, DB_RCTOUTPUT, batch_size, fFound)
+        && MoveRCTRecords<CCmpPubKey, int64_t>(block_tree_db, *this, DB_RCTOUTPUT_LINK, batch_size, fFound)
+        && MoveRCTRecords<CCmpPubKey, uint256>(block_tree_db, *this, DB_RCTKEYIMAGE, batch_size, fFound);
+}
+
 bool CCoinsViewDB::Upgrade()
 {
     // TODO
@@ -9,6 +9,7 @@
 #include <coins.h>
 #include <dbwrapper.h>
 #include <chain.h>
+#include <hash.h>
 #include <insight/addressindex.h>
 #include <insight/spentindex.h>
 #include <insight/timestampindex.h>
@@ -50,12 +51,16 @@ static const int64_t nMaxTxIndexCache = 1024;
 static const int64_t max_filter_index_cache = 1024;
 //! Max memory allocated to coin DB specific cache (MiB)
 static const int64_t nMaxCoinsDBCache = 8;
+//! Max memory allocated to the RingCT database cache (MiB)
+static const int64_t nMaxRCTDBCache = 256;
 
 /** CCoinsView backed by the coin database (chainstate/) */
 class CCoinsViewDB final : public CCoinsView
 {
 protected:
     CDBWrapper db;
+    //! Totals written while the unspent output totals are initialised, guarded by cs_main.
+    std::unique_ptr<CUTXOStats> m_stats_scan_delta;
 public:
     /**
      * @param[in] ldb_path    Location in the filesystem where leveldb data will be stored.
@@ -66,9 +71,30 @@ public:
     bool HaveCoin(const COutPoint &outpoint) const override;
     uint256 GetBestBlock() const override;
     std::vector<uint256> GetHeadBlocks() const override;
-    bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) override;
+    bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, const CUTXOStats &statsDelta) override;
     CCoinsViewCursor *Cursor() const override;
 
+    //! Read the unspent output totals at the best block, false if they are not kept yet.
+    bool ReadUTXOStats(CUTXOStats &stats) const;
+    //! Start keeping the unspent output totals from stats, which must match the best block.
+    bool WriteUTXOStats(const CUTXOStats &stats);
+    //! Stop keeping the totals, they are rebuilt with a scan on next use.
+    bool EraseUTXOStats();
+    //! Collect the totals of later writes while a cursor taken now is scanned without cs_main.
+    void BeginUTXOStatsScan();
+    //! Add the collected totals to the scanned stats and start keeping them,
+    //! false if the scan was abandoned or the coins were replaced meanwhile.
+    bool FinishUTXOStatsScan(CUTXOStats &stats);
+    void AbortUTXOStatsScan() { m_stats_scan_delta.reset(); }
+
+    //! Write the coins of a utxo snapshot, read in key order from file, in sorted batches.
+    //! The database stays marked as moving to hashBlock until CommitSnapshotCoins.
+    bool WriteSnapshotCoins(CHashVerifier<CAutoFile> &file, uint64_t coins_count, const uint256 &hashBlock);
+    //! Mark the database as consistent with the snapshot base hashBlock.
+    bool CommitSnapshotCoins(const uint256 &hashBlock);
+    //! Replace all coins by coins, the set before the snapshot was written, at hashBlock.
+    bool RollbackSnapshotCoins(const std::vector<std::pair<COutPoint, Coin> > &coins, const uint256 &hashBlock);
+
     //! Attempt to update from an older database format. Returns whether an error occurred.
     bool Upgrade();
     size_t EstimateSize() const override;
@@ -108,25 +134,36 @@ public:
     bool WriteReindexing(bool fReindexing);
     void ReadReindexing(bool &fReindexing);
 
-    bool ReadSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value);
-    bool UpdateSpentIndex(const std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> >&vect);
-    bool UpdateAddressUnspentIndex(const std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue > >&vect);
-    bool ReadAddressUnspentIndex(uint256 addressHash, int type,
-                                 std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &vect);
-    bool WriteAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect);
-    bool EraseAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect);
-    bool ReadAddressIndex(uint256 addressHash, int type,
-                          std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
-                          int start = 0, int end = 0);
-    bool WriteTimestampIndex(const CTimestampIndexKey &timestampIndex);
-    bool ReadTimestampIndex(const unsigned int &high, const unsigned int &low, const bool fActiveOnly, std::vector<std::pair<uint256, unsigned int> > &vect);
-    bool WriteTimestampBlockIndex(const CTimestampBlockIndexKey &blockhashIndex, const CTimestampBlockIndexValue &logicalts);
-    bool ReadTimestampBlockIndex(const uint256 &hash, unsigned int &logicalTS);
+    /// Erase the insight index data kept here by older versions, now stored under indexes/.
+    bool EraseLegacyInsightIndexes();
 
     bool WriteFlag(const std::string &name, bool fValue);
     bool ReadFlag(const std::string &name, bool &fValue);
+    //! The checksum of the block index snapshot, present while the snapshot matches the block index records
+    bool ReadBlockIndexSnapshotMarker(uint256 &checksum);
+    bool WriteBlockIndexSnapshotMarker(const uint256 &checksum);
+    bool EraseBlockIndexSnapshotMarker();
+    //! Block files below nFile hold only compressed records
+    bool ReadCompressedBlockFiles(int &nFile);
+    bool WriteCompressedBlockFiles(int nFile);
+    //! The blocks of the block file being compressed and their positions before they were moved
+    bool ReadCompressedBlockMoves(std::vector<std::pair<uint256, FlatFilePos> > &moves);
+    bool WriteCompressedBlockMoves(const std::vector<std::pair<uint256, FlatFilePos> > &moves);
+    bool EraseCompressedBlockMoves();
     bool LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex);
 
+};
+
+/**
+ * Access to the RingCT database (blocks/rct/), the anon outputs, their links
+ * and the spent key images. Most keys and values are random curve points, so
+ * the data is stored uncompressed, and as most key image lookups miss the
+ * bloom filters get more bits per key.
+ */
+class CRCTDB : public CDBWrapper
+{
+public:
+    explicit CRCTDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
 
     bool ReadRCTOutput(int64_t i, CAnonOutput &ao);
     bool WriteRCTOutput(int64_t i, const CAnonOutput &ao);
@@ -140,7 +177,14 @@ public:
     bool WriteRCTKeyImage(const CCmpPubKey &ki, const uint256 &txhash);
     bool EraseRCTKeyImage(const CCmpPubKey &ki);
 
-    //bool WriteRCTOutputBatch(std::vector<std::pair<int64_t, CAnonOutput> > &vao);
+    //! Write the anon outputs, with their links, and the spent key images of a utxo snapshot
+    //! read in key order from file, in sorted batches.
+    bool WriteSnapshotRCT(CHashVerifier<CAutoFile> &file, uint64_t anon_outputs_count, uint64_t key_images_count);
+    //! Erase all anon outputs, links and key images, a snapshot is only written over a chain at genesis.
+    bool EraseSnapshotRCT();
+
+    //! Move the RingCT records kept in the block tree database by older versions.
+    bool MigrateData(CBlockTreeDB &block_tree_db);
 };
 
 #endif // BITCOIN_TXDB_H
@@ -421,9 +421,22 @@ void CTxMemPool::addAddressIndex(const CTxMemPoolEntry &entry, const CCoinsViewC
     if (!tx.IsGraviocoinVersion())
         return;
 
-    std::vector<CMempoolAddressDeltaKey> inserted;
+    txiter it = mapTx.find(tx.GetHash());
+    if (it == mapTx.end()) {
+        return;
+    }
+
+    std::vector<addressDeltaMap::value_type*> inserted;
+    auto add_delta = [&](int scriptType, const std::vector<uint8_t> &hashBytes, uint32_t index, bool spending, CAmount amount) {
+        addressDeltaMap::value_type &address = *mapAddress.emplace(std::make_pair(uint256(hashBytes.data(), hashBytes.size()), scriptType), std::vector<AddressDelta>()).first;
+        cachedIndexUsage -= memusage::DynamicUsage(address.second);
+        address.second.push_back(AddressDelta{it, index, spending, amount});
+        cachedIndexUsage += memusage::DynamicUsage(address.second);
+        if (std::find(inserted.begin(), inserted.end(), &address) == inserted.end()) {
+            inserted.push_back(&address);
+        }
+    };
 
-    uint256 txhash = tx.GetHash();
     for (unsigned int j = 0; j < tx.vin.size(); j++) {
         const CTxIn input = tx.vin[j];
 
@@ -446,10 +459,7 @@ void CTxMemPool::addAddressIndex(const CTxMemPoolEntry &entry, const CCoinsViewC
             continue;
         }
 
-        CMempoolAddressDeltaKey key(scriptType, uint256(hashBytes.data(), hashBytes.size()), txhash, j, 1);
-        CMempoolAddressDelta delta(count_seconds(entry.GetTime()), nValue * -1, input.prevout.hash, input.prevout.n);
-        mapAddress.insert(std::make_pair(key, delta));
-        inserted.push_back(key);
+        add_delta(scriptType, hashBytes, j, true, nValue * -1);
     }
 
     for (unsigned int k = 0; k < tx.vpout.size(); k++) {
@@ -473,12 +483,14 @@ void CTxMemPool::addAddressIndex(const CTxMemPoolEntry &entry, const CCoinsViewC
             || scriptType == 0)
             continue;
 
-        CMempoolAddressDeltaKey key(scriptType, uint256(hashBytes.data(), hashBytes.size()), txhash, k, 0);
-        mapAddress.insert(std::make_pair(key, CMempoolAddressDelta(count_seconds(entry.GetTime()), nValue)));
-        inserted.push_back(key);
+        add_delta(scriptType, hashBytes, k, false, nValue);
     }
 
-    mapAddressInserted.insert(std::make_pair(txhash, inserted));
+    if (!inserted.empty()) {
+        inserted.shrink_to_fit();
+        cachedIndexUsage += memusage::DynamicUsage(inserted);
+        mapAddressInserted.emplace(tx.GetHash(), std::move(inserted));
+    }
 }
 
 bool CTxMemPool::getAddressIndex(std::vector<std::pair<uint256, int> > &addresses,
@@ -486,26 +498,44 @@ bool CTxMemPool::getAddressIndex(std::vector<std::pair<uint256, int> > &addresse
 {
     LOCK(cs);
     for (std::vector<std::pair<uint256, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        addressDeltaMap::iterator ait = mapAddress.lower_bound(CMempoolAddressDeltaKey((*it).second, (*it).first));
-        while (ait != mapAddress.end() && (*ait).first.addressBytes == (*it).first && (*ait).first.type == (*it).second) {
-            results.push_back(*ait);
-            ait++;
+        addressDeltaMap::const_iterator ait = mapAddress.find(*it);
+        if (ait == mapAddress.end()) {
+            continue;
+        }
+        for (const AddressDelta &delta : ait->second) {
+            const CTransaction &tx = delta.it->GetTx();
+            CMempoolAddressDeltaKey key(it->second, it->first, tx.GetHash(), delta.index, delta.spending);
+            int64_t nTime = count_seconds(delta.it->GetTime());
+            if (delta.spending) {
+                const COutPoint &prevout = tx.vin[delta.index].prevout;
+                results.push_back(std::make_pair(key, CMempoolAddressDelta(nTime, delta.amount, prevout.hash, prevout.n)));
+            } else {
+                results.push_back(std::make_pair(key, CMempoolAddressDelta(nTime, delta.amount)));
+            }
         }
     }
     return true;
 }
 
-bool CTxMemPool::removeAddressIndex(const uint256 txhash)
+bool CTxMemPool::removeAddressIndex(txiter it)
 {
-    LOCK(cs);
-    addressDeltaMapInserted::iterator it = mapAddressInserted.find(txhash);
-
-    if (it != mapAddressInserted.end()) {
-        std::vector<CMempoolAddressDeltaKey> keys = (*it).second;
-        for (std::vector<CMempoolAddressDeltaKey>::iterator mit = keys.begin(); mit != keys.end(); mit++) {
-            mapAddress.erase(*mit);
+    AssertLockHeld(cs);
+    addressDeltaMapInserted::iterator iit = mapAddressInserted.find(it->GetTx().GetHash());
+
+    if (iit != mapAddressInserted.end()) {
+        for (addressDeltaMap::value_type *address : iit->second) {
+            std::vector<AddressDelta> &deltas = address->second;
+            cachedIndexUsage -= memusage::DynamicUsage(deltas);
+            deltas.erase(std::remove_if(deltas.begin(), deltas.end(),
+                [&it](const AddressDelta &delta) { return delta.it == it; }), deltas.end());
+            if (deltas.empty()) {
+                mapAddress.erase(std::pair<uint256, int>(address->first));
+            } else {
+                cachedIndexUsage += memusage::DynamicUsage(deltas);
+            }
         }
-        mapAddressInserted.erase(it);
+        cachedIndexUsage -= memusage::DynamicUsage(iit->second);
+        mapAddressInserted.erase(iit);
     }
 
     return true;
@@ -520,9 +550,11 @@ void CTxMemPool::addSpentIndex(const CTxMemPoolEntry &entry, const CCoinsViewCac
     if (!tx.IsGraviocoinVersion())
         return;
 
-    std::vector<CSpentIndexKey> inserted;
+    txiter it = mapTx.find(tx.GetHash());
+    if (it == mapTx.end()) {
+        return;
+    }
 
-    uint256 txhash = tx.GetHash();
     for (unsigned int j = 0; j < tx.vin.size(); j++) {
         const CTxIn input = tx.vin[j];
 
@@ -547,40 +579,33 @@ void CTxMemPool::addSpentIndex(const CTxMemPoolEntry &entry, const CCoinsViewCac
             addressHash = uint256(hashBytes.data(), hashBytes.size());
         }
 
-        CSpentIndexKey key = CSpentIndexKey(input.prevout.hash, input.prevout.n);
-        CSpentIndexValue value = CSpentIndexValue(txhash, j, -1, nValue, scriptType, addressHash);
-
-        mapSpent.insert(std::make_pair(key, value));
-        inserted.push_back(key);
+        mapSpent[input.prevout] = SpentIndexEntry{it, j, scriptType, nValue, addressHash};
     }
-
-    mapSpentInserted.insert(std::make_pair(txhash, inserted));
 }
 
 bool CTxMemPool::getSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value)
 {
     LOCK(cs);
-    mapSpentIndex::iterator it;
-
-    it = mapSpent.find(key);
+    mapSpentIndex::const_iterator it = mapSpent.find(COutPoint(key.txid, key.outputIndex));
     if (it != mapSpent.end()) {
-        value = it->second;
+        const SpentIndexEntry &entry = it->second;
+        value = CSpentIndexValue(entry.it->GetTx().GetHash(), entry.inputIndex, -1, entry.satoshis, entry.addressType, entry.addressHash);
         return true;
     }
     return false;
 }
 
-bool CTxMemPool::removeSpentIndex(const uint256 txhash)
+bool CTxMemPool::removeSpentIndex(txiter it)
 {
-    LOCK(cs);
-    mapSpentIndexInserted::iterator it = mapSpentInserted.find(txhash);
-
-    if (it != mapSpentInserted.end()) {
-        std::vector<CSpentIndexKey> keys = (*it).second;
-        for (std::vector<CSpentIndexKey>::iterator mit = keys.begin(); mit != keys.end(); mit++) {
-            mapSpent.erase(*mit);
+    AssertLockHeld(cs);
+    for (const CTxIn &txin : it->GetTx().vin) {
+        if (txin.IsAnonInput()) {
+            continue;
+        }
+        mapSpentIndex::iterator sit = mapSpent.find(txin.prevout);
+        if (sit != mapSpent.end() && sit->second.it == it) {
+            mapSpent.erase(sit);
         }
-        mapSpentInserted.erase(it);
     }
 
     return true;
@@ -617,11 +642,11 @@ void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason)
     cachedInnerUsage -= it->DynamicMemoryUsage();
     cachedInnerUsage -= memusage::DynamicUsage(mapLinks[it].parents) + memusage::DynamicUsage(mapLinks[it].children);
     mapLinks.erase(it);
+    removeAddressIndex(it);
+    removeSpentIndex(it);
     mapTx.erase(it);
     nTransactionsUpdated++;
     if (minerPolicyEstimator) {minerPolicyEstimator->removeTx(hash, false);}
-    removeAddressIndex(hash);
-    removeSpentIndex(hash);
 }
 
 // Calculates descendants of entry that are not already in setDescendants, and adds to
@@ -806,8 +831,12 @@ void CTxMemPool::_clear()
     mapLinks.clear();
     mapTx.clear();
     mapNextTx.clear();
+    mapAddress.clear();
+    mapAddressInserted.clear();
+    mapSpent.clear();
     totalTxSize = 0;
     cachedInnerUsage = 0;
+    cachedIndexUsage = 0;
     lastRollingFeeUpdate = GetTime();
     blockSinceLastRollingFeeBump = false;
     rollingMinimumFeeRate = 0;
@@ -1168,7 +1197,7 @@ bool CCoinsViewMemPool::GetCoin(const COutPoint &outpoint, Coin &coin) const {
                 if (out->IsType(OUTPUT_CT))
                 {
                     coin.nType = OUTPUT_CT;
-                    coin.commitment = ((CTxOutCT*)out)->commitment;
+                    coin.SetCommitment(((CTxOutCT*)out)->commitment);
                 };
                 return true;
             };
@@ -1187,7 +1216,8 @@ bool CCoinsViewMemPool::GetCoin(const COutPoint &outpoint, Coin &coin) const {
 size_t CTxMemPool::DynamicMemoryUsage() const {
     LOCK(cs);
     // Estimate the overhead of mapTx to be 12 pointers + an allocation, as no exact formula for boost::multi_index_contained is implemented.
-    return memusage::MallocUsage(sizeof(CTxMemPoolEntry) + 12 * sizeof(void*)) * mapTx.size() + memusage::DynamicUsage(mapNextTx) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(mapLinks) + memusage::DynamicUsage(vTxHashes) + cachedInnerUsage;
+    return memusage::MallocUsage(sizeof(CTxMemPoolEntry) + 12 * sizeof(void*)) * mapTx.size() + memusage::DynamicUsage(mapNextTx) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(mapLinks) + memusage::DynamicUsage(vTxHashes) + cachedInnerUsage +
+        memusage::DynamicUsage(mapAddress) + memusage::DynamicUsage(mapAddressInserted) + memusage::DynamicUsage(mapSpent) + cachedIndexUsage;
 }
 
 void CTxMemPool::RemoveStaged(setEntries &stage, bool updateDescendants, MemPoolRemovalReason reason) {
@@ -1381,4 +1411,20 @@ void CTxMemPool::SetIsLoaded(bool loaded)
     m_is_loaded = loaded;
 }
 
+MempoolLoadProgress CTxMemPool::GetLoadProgress() const
+{
+    LOCK(cs);
+    return m_load_progress;
+}
+
+void CTxMemPool::AddLoadProgress(const MempoolLoadProgress& progress)
+{
+    LOCK(cs);
+    m_load_progress.total += progress.total;
+    m_load_progress.verified += progress.verified;
+    m_load_progress.processed += progress.processed;
+}
+
 SaltedTxidHasher::SaltedTxidHasher() : k0(GetRand(std::numeric_limits<uint64_t>::max())), k1(GetRand(std::numeric_limits<uint64_t>::max())) {}
+
+SaltedAddressHasher::SaltedAddressHasher() : k0(GetRand(std::numeric_limits<uint64_t>::max())), k1(GetRand(std::numeric_limits<uint64_t>::max())) {}
@@ -10,6 +10,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -378,6 +379,31 @@ public:
     }
 };
 
+class SaltedAddressHasher
+{
+private:
+    /** Salt */
+    const uint64_t k0, k1;
+
+public:
+    SaltedAddressHasher();
+
+    size_t operator()(const std::pair<uint256, int>& address) const {
+        return SipHashUint256Extra(k0, k1, address.first, address.second);
+    }
+};
+
+/** Counts of the transactions read from mempool.dat while loading the mempool */
+struct MempoolLoadProgress
+{
+    uint64_t total;     //!< Read from mempool.dat
+    uint64_t verified;  //!< Pre-verified, or found to have no proofs to verify
+    uint64_t processed; //!< Accepted, rejected or expired
+
+    MempoolLoadProgress(uint64_t total_in = 0, uint64_t verified_in = 0, uint64_t processed_in = 0)
+        : total(total_in), verified(verified_in), processed(processed_in) {}
+};
+
 /**
  * CTxMemPool stores valid-according-to-the-current-best-chain transactions
  * that may be included in the next block.
@@ -467,6 +493,7 @@ private:
     void trackPackageRemoved(const CFeeRate& rate) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
     bool m_is_loaded GUARDED_BY(cs){false};
+    MempoolLoadProgress m_load_progress GUARDED_BY(cs);
 
 public:
 
@@ -552,17 +579,37 @@ private:
     typedef std::map<txiter, TxLinks, CompareIteratorByHash> txlinksMap;
     txlinksMap mapLinks;
 
-    typedef std::map<CMempoolAddressDeltaKey, CMempoolAddressDelta, CMempoolAddressDeltaKeyCompare> addressDeltaMap;
-    addressDeltaMap mapAddress;
+    /** An address index delta, the txid, time and spent outpoint are read from the mempool entry */
+    struct AddressDelta {
+        txiter it;
+        uint32_t index;
+        bool spending;
+        CAmount amount;
+    };
 
-    typedef std::map<uint256, std::vector<CMempoolAddressDeltaKey> > addressDeltaMapInserted;
-    addressDeltaMapInserted mapAddressInserted;
+    /** The deltas of each (address hash, type) in the mempool */
+    typedef std::unordered_map<std::pair<uint256, int>, std::vector<AddressDelta>, SaltedAddressHasher> addressDeltaMap;
+    addressDeltaMap mapAddress GUARDED_BY(cs);
+
+    /** The addresses each transaction has deltas for, map nodes are not moved by rehashing */
+    typedef std::unordered_map<uint256, std::vector<addressDeltaMap::value_type*>, SaltedTxidHasher> addressDeltaMapInserted;
+    addressDeltaMapInserted mapAddressInserted GUARDED_BY(cs);
+
+    /** A spent index value, the spending txid is read from the mempool entry */
+    struct SpentIndexEntry {
+        txiter it;
+        uint32_t inputIndex;
+        int addressType;
+        CAmount satoshis;
+        uint256 addressHash;
+    };
 
-    typedef std::map<CSpentIndexKey, CSpentIndexValue, CSpentIndexKeyCompare> mapSpentIndex;
-    mapSpentIndex mapSpent;
+    /** Keyed by the spent outpoint, entries are removed by walking the spending transaction's inputs */
+    typedef std::unordered_map<COutPoint, SpentIndexEntry, SaltedOutpointHasher> mapSpentIndex;
+    mapSpentIndex mapSpent GUARDED_BY(cs);
 
-    typedef std::map<uint256, std::vector<CSpentIndexKey> > mapSpentIndexInserted;
-    mapSpentIndexInserted mapSpentInserted;
+    /** Heap usage of the vectors in mapAddress and mapAddressInserted */
+    uint64_t cachedIndexUsage GUARDED_BY(cs);
 
     void UpdateParent(txiter entry, txiter parent, bool add);
     void UpdateChild(txiter entry, txiter child, bool add);
@@ -603,11 +650,11 @@ public:
     void addAddressIndex(const CTxMemPoolEntry &entry, const CCoinsViewCache &view);
     bool getAddressIndex(std::vector<std::pair<uint256, int> > &addresses,
                          std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta> > &results);
-    bool removeAddressIndex(const uint256 txhash);
+    bool removeAddressIndex(txiter it) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
     void addSpentIndex(const CTxMemPoolEntry &entry, const CCoinsViewCache &view);
     bool getSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value);
-    bool removeSpentIndex(const uint256 txhash);
+    bool removeSpentIndex(txiter it) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
     void removeRecursive(const CTransaction& tx, MemPoolRemovalReason reason) EXCLUSIVE_LOCKS_REQUIRED(cs);
     void removeForReorg(const CCoinsViewCache* pcoins, unsigned int nMemPoolHeight, int flags) EXCLUSIVE_LOCKS_REQUIRED(cs, cs_main);
@@ -710,6 +757,12 @@ public:
     /** Sets the current loaded state */
     void SetIsLoaded(bool loaded);
 
+    /** Progress of loading the mempool from disk */
+    MempoolLoadProgress GetLoadProgress() const;
+
+    /** Adds progress to the counts of loading the mempool from disk */
+    void AddLoadProgress(const MempoolLoadProgress& progress);
+
     unsigned long size() const
     {
         LOCK(cs);
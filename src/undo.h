@@ -35,7 +35,7 @@ public:
         ::Serialize(s, CTxOutCompressor(REF(txout->out)));
         ::Serialize(s, txout->nType);
         if (txout->nType == OUTPUT_CT)
-            s.write((char*)&txout->commitment.data[0], 33);
+            s.write((char*)&txout->GetCommitment().data[0], 33);
     }
 
     explicit TxInUndoSerializer(const Coin* coin) : txout(coin) {}
@@ -61,8 +61,11 @@ public:
         }
         ::Unserialize(s, CTxOutCompressor(REF(txout->out)));
         ::Unserialize(s, txout->nType);
-        if (txout->nType == OUTPUT_CT)
-            s.read((char*)&txout->commitment.data[0], 33);
+        if (txout->nType == OUTPUT_CT) {
+            secp256k1_pedersen_commitment commitment = {};
+            s.read((char*)&commitment.data[0], 33);
+            txout->SetCommitment(commitment);
+        }
     }
 
     explicit TxInUndoDeserializer(Coin* coin) : txout(coin) {}
@@ -14,12 +14,21 @@
 #include <consensus/tx_check.h>
 #include <consensus/tx_verify.h>
 #include <consensus/validation.h>
+#include <crypto/common.h>
 #include <cuckoocache.h>
 #include <flatfile.h>
 #include <hash.h>
+#include <index/addressindex.h>
+#include <index/blockfilterindex.h>
+#include <index/spentindex.h>
+#include <index/timestampindex.h>
 #include <index/txindex.h>
+#include <index/voteindex.h>
 #include <logging.h>
 #include <logging/timer.h>
+#include <lz4/lz4.h>
+#include <node/blockindexsnapshot.h>
+#include <node/utxo_snapshot.h>
 #include <policy/fees.h>
 #include <policy/policy.h>
 #include <policy/settings.h>
@@ -54,7 +63,9 @@
 #include <rctindex.h>
 #include <insight/insight.h>
 
+#include <deque>
 #include <string>
+#include <thread>
 
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/thread.hpp>
@@ -124,6 +135,8 @@ Mutex g_best_block_mutex;
 std::condition_variable g_best_block_cv;
 uint256 g_best_block;
 bool g_parallel_script_checks{false};
+int g_import_check_threads{1};
+bool g_block_compression{DEFAULT_BLOCK_COMPRESSION};
 std::atomic_bool fImporting(false);
 std::atomic_bool fReindex(false);
 std::atomic_bool fSkipRangeproof(false);
@@ -206,6 +219,7 @@ CBlockIndex* FindForkInGlobalIndex(const CChain& chain, const CBlockLocator& loc
 }
 
 std::unique_ptr<CBlockTreeDB> pblocktree;
+std::unique_ptr<CRCTDB> prctdb;
 
 // See definition for documentation
 static void FindFilesToPruneManual(std::set<int>& setFilesToPrune, int nManualPruneHeight);
@@ -469,6 +483,84 @@ static bool CheckInputsFromMempoolAndCache(const CTransaction& tx, TxValidationS
     return CheckInputs(tx, state, view, flags, /* cacheSigStore = */ true, /* cacheFullSciptStore = */ true, txdata);
 }
 
+static CuckooCache::cache<uint256, SignatureCacheHasher> proofCache;
+static uint256 proofCacheNonce(GetRandHash());
+static boost::shared_mutex cs_proof_cache;
+
+CSHA256 GetProofCacheHasher()
+{
+    CSHA256 hasher;
+    hasher.Write(proofCacheNonce.begin(), 32);
+    return hasher;
+}
+
+bool ProofCacheContains(const uint256 &entry)
+{
+    boost::shared_lock<boost::shared_mutex> lock(cs_proof_cache);
+    return proofCache.contains(entry, false);
+}
+
+void ProofCacheInsert(const uint256 &entry)
+{
+    boost::unique_lock<boost::shared_mutex> lock(cs_proof_cache);
+    proofCache.insert(entry);
+}
+
+//! Proof cache entry for the range proofs of tx
+static uint256 GetRangeProofCacheEntry(const CTransaction &tx, bool bulletproofs)
+{
+    uint256 entry;
+    uint8_t type = bulletproofs ? 'B' : 'R';
+    GetProofCacheHasher().Write(&type, 1).Write(tx.GetWitnessHash().begin(), 32).Finalize(entry.begin());
+    return entry;
+}
+
+static bool HasRangeProofs(const CTransaction& tx)
+{
+    for (const auto &txout : tx.vpout) {
+        if (txout->nVersion == OUTPUT_CT || txout->nVersion == OUTPUT_RINGCT) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool HasAnonInputs(const CTransaction& tx)
+{
+    for (const auto &txin : tx.vin) {
+        if (txin.IsAnonInput()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TransactionHasProofs(const CTransaction& tx)
+{
+    return HasRangeProofs(tx) || HasAnonInputs(tx);
+}
+
+bool PreVerifyTransactionProofs(const CTransaction& tx, int64_t accept_time)
+{
+    bool has_rangeproofs = HasRangeProofs(tx), has_anon_inputs = HasAnonInputs(tx);
+    if (!has_rangeproofs && !has_anon_inputs) {
+        return false;
+    }
+
+    TxValidationState state;
+    state.SetStateInfo(accept_time, -1, Params().GetConsensus(), fGraviocoinMode, (fBusyImporting && fSkipRangeproof));
+    if (!CheckTransaction(tx, state)) {
+        return false;
+    }
+    if (has_rangeproofs && !state.m_skip_rangeproof) {
+        ProofCacheInsert(GetRangeProofCacheEntry(tx, state.fBulletproofsActive));
+    }
+    if (has_anon_inputs && !PreVerifyMLSAG(tx, state)) {
+        return false;
+    }
+    return true;
+}
+
 namespace {
 
 class MemPoolAccept
@@ -602,7 +694,14 @@ bool MemPoolAccept::PreChecks(ATMPArgs& args, Workspace& ws)
     const Consensus::Params &consensus = Params().GetConsensus();
     state.SetStateInfo(nAcceptTime, ::ChainActive().Height(), consensus, fGraviocoinMode, (fBusyImporting && fSkipRangeproof));
 
-    if (!CheckTransaction(tx, state))
+    // Range proofs verified ahead of acceptance are not verified again
+    bool skip_rangeproof = state.m_skip_rangeproof;
+    if (!skip_rangeproof && ProofCacheContains(GetRangeProofCacheEntry(tx, state.fBulletproofsActive))) {
+        state.m_skip_rangeproof = true;
+    }
+    bool tx_ok = CheckTransaction(tx, state);
+    state.m_skip_rangeproof = skip_rangeproof;
+    if (!tx_ok)
         return false; // state filled in by CheckTransaction
 
     // Coinbase is only valid in a block, not as a loose transaction
@@ -1244,7 +1343,106 @@ bool GetTransaction(const uint256 &hash, CTransactionRef &txOut, const Consensus
 // CBlock and CBlockIndex
 //
 
-static bool WriteBlockToDisk(const CBlock& block, FlatFilePos& pos, const CMessageHeader::MessageStartChars& messageStart)
+/**
+ * Block and undo file records are stored as [message start][size][data], the
+ * positions kept in the block index point past the 8 byte record header.
+ * With -blockcompression the data is written LZ4 compressed: the size has
+ * BLOCKFILE_RECORD_COMPRESSED set and the data holds the uncompressed size
+ * followed by the compressed bytes. Readers seek back to the record header to
+ * find how the record is stored, so blocks stay randomly accessible by their
+ * position and files may hold both kinds of records.
+ */
+
+static FlatFilePos GetRecordHeaderPos(const FlatFilePos& pos)
+{
+    FlatFilePos hpos = pos;
+    hpos.nPos -= 8; // Seek back 8 bytes for meta header
+    return hpos;
+}
+
+/**
+ * Compress the serialized obj into a record payload, record is left empty if compression fails.
+ * Records that don't compress are still stored compressed, so converted files are recognised.
+ */
+template <typename T>
+static void CompressBlockRecord(const T& obj, std::vector<uint8_t>& record)
+{
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << obj;
+    record.resize(4 + LZ4_compressBound(ss.size()));
+    WriteLE32(record.data(), ss.size());
+    int compressed_size = LZ4_compress_default(ss.data(), (char*)record.data() + 4, ss.size(), record.size() - 4);
+    if (compressed_size <= 0) {
+        record.clear();
+        return;
+    }
+    record.resize(4 + compressed_size);
+}
+
+bool DecompressBlockRecord(const std::vector<uint8_t>& record, std::vector<uint8_t>& data)
+{
+    if (record.size() < 4) {
+        return false;
+    }
+    uint32_t size = ReadLE32(record.data());
+    if (size > MAX_SIZE) {
+        return false;
+    }
+    data.resize(size);
+    return LZ4_decompress_safe((const char*)record.data() + 4, (char*)data.data(), record.size() - 4, size) == (int)size;
+}
+
+/**
+ * Read the header of the record at pos from filein, opened at the record header.
+ * size is set to the size of the record data on disk. A compressed record is read
+ * and decompressed into data, otherwise filein is left at the start of the data.
+ */
+static bool ReadBlockRecordHeader(CAutoFile& filein, const FlatFilePos& pos, const CMessageHeader::MessageStartChars& message_start,
+    bool& compressed, unsigned int& size, std::vector<uint8_t>& data)
+{
+    CMessageHeader::MessageStartChars record_start;
+    filein >> record_start >> size;
+
+    if (memcmp(record_start, message_start, CMessageHeader::MESSAGE_START_SIZE)) {
+        return error("%s: Record magic mismatch for %s: %s versus expected %s", __func__, pos.ToString(),
+                HexStr(record_start, record_start + CMessageHeader::MESSAGE_START_SIZE),
+                HexStr(message_start, message_start + CMessageHeader::MESSAGE_START_SIZE));
+    }
+    compressed = size & BLOCKFILE_RECORD_COMPRESSED;
+    size &= ~BLOCKFILE_RECORD_COMPRESSED;
+    if (size > MAX_SIZE) {
+        return error("%s: Record is larger than maximum deserialization size for %s: %s versus %s", __func__, pos.ToString(),
+                size, MAX_SIZE);
+    }
+    if (compressed) {
+        std::vector<uint8_t> record(size);
+        filein.read((char*)record.data(), size);
+        if (!DecompressBlockRecord(record, data)) {
+            return error("%s: Decompression failed for %s", __func__, pos.ToString());
+        }
+    }
+    return true;
+}
+
+/** Read the size on disk of the block record at pos and whether it is compressed */
+static bool ReadBlockRecordSize(const FlatFilePos& pos, unsigned int& size, bool& compressed)
+{
+    CAutoFile filein(OpenBlockFile(GetRecordHeaderPos(pos), true), SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull()) {
+        return error("%s: OpenBlockFile failed for %s", __func__, pos.ToString());
+    }
+    try {
+        CMessageHeader::MessageStartChars record_start;
+        filein >> record_start >> size;
+    } catch (const std::exception& e) {
+        return error("%s: Read from block file failed: %s for %s", __func__, e.what(), pos.ToString());
+    }
+    compressed = size & BLOCKFILE_RECORD_COMPRESSED;
+    size &= ~BLOCKFILE_RECORD_COMPRESSED;
+    return true;
+}
+
+static bool WriteBlockToDisk(const CBlock& block, const std::vector<uint8_t>& record, FlatFilePos& pos, const CMessageHeader::MessageStartChars& messageStart)
 {
     // Open history file to append
     CAutoFile fileout(OpenBlockFile(pos), SER_DISK, CLIENT_VERSION);
@@ -1252,7 +1450,7 @@ static bool WriteBlockToDisk(const CBlock& block, FlatFilePos& pos, const CMessa
         return error("WriteBlockToDisk: OpenBlockFile failed");
 
     // Write index header
-    unsigned int nSize = GetSerializeSize(block, fileout.GetVersion());
+    unsigned int nSize = record.empty() ? GetSerializeSize(block, fileout.GetVersion()) : record.size() | BLOCKFILE_RECORD_COMPRESSED;
     fileout << messageStart << nSize;
 
     // Write block
@@ -1260,7 +1458,11 @@ static bool WriteBlockToDisk(const CBlock& block, FlatFilePos& pos, const CMessa
     if (fileOutPos < 0)
         return error("WriteBlockToDisk: ftell failed");
     pos.nPos = (unsigned int)fileOutPos;
-    fileout << block;
+    if (record.empty()) {
+        fileout << block;
+    } else {
+        fileout.write((const char*)record.data(), record.size());
+    }
 
     return true;
 }
@@ -1270,13 +1472,23 @@ bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const Consensus::P
     block.SetNull();
 
     // Open history file to read
-    CAutoFile filein(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
+    CAutoFile filein(OpenBlockFile(GetRecordHeaderPos(pos), true), SER_DISK, CLIENT_VERSION);
     if (filein.IsNull())
         return error("ReadBlockFromDisk: OpenBlockFile failed for %s", pos.ToString());
 
     // Read block
     try {
-        filein >> block;
+        bool compressed;
+        unsigned int size;
+        std::vector<uint8_t> data;
+        if (!ReadBlockRecordHeader(filein, pos, Params().MessageStart(), compressed, size, data)) {
+            return false;
+        }
+        if (compressed) {
+            VectorReader(SER_DISK, CLIENT_VERSION, data, 0) >> block;
+        } else {
+            filein >> block;
+        }
     }
     catch (const std::exception& e) {
         return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
@@ -1313,6 +1525,18 @@ bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus
     return true;
 }
 
+/** Read the header and the transaction at nIndex of a serialized block, returns the number of transactions in the block */
+template <typename Stream>
+static int ReadBlockTransaction(Stream& s, int nIndex, CBlockHeader& blockHeader, CTransactionRef& txOut)
+{
+    s >> blockHeader;
+
+    int nTxns = ReadCompactSize(s);
+    for (int k = 0; k <= nIndex && k < nTxns; ++k)
+        s >> txOut;
+    return nTxns;
+}
+
 bool ReadTransactionFromDiskBlock(const CBlockIndex* pindex, int nIndex, CTransactionRef &txOut)
 {
     FlatFilePos hpos;
@@ -1322,21 +1546,28 @@ bool ReadTransactionFromDiskBlock(const CBlockIndex* pindex, int nIndex, CTransa
     }
 
     // Open history file to read
-    CAutoFile filein(OpenBlockFile(hpos, true), SER_DISK, CLIENT_VERSION);
+    CAutoFile filein(OpenBlockFile(GetRecordHeaderPos(hpos), true), SER_DISK, CLIENT_VERSION);
     if (filein.IsNull())
         return error("%s: OpenBlockFile failed for %s", __func__, hpos.ToString());
 
     CBlockHeader blockHeader;
     try {
-        filein >> blockHeader;
-
-        int nTxns = ReadCompactSize(filein);
+        bool compressed;
+        unsigned int size;
+        std::vector<uint8_t> data;
+        if (!ReadBlockRecordHeader(filein, hpos, Params().MessageStart(), compressed, size, data)) {
+            return false;
+        }
+        int nTxns;
+        if (compressed) {
+            VectorReader reader(SER_DISK, CLIENT_VERSION, data, 0);
+            nTxns = ReadBlockTransaction(reader, nIndex, blockHeader, txOut);
+        } else {
+            nTxns = ReadBlockTransaction(filein, nIndex, blockHeader, txOut);
+        }
 
         if (nTxns <= nIndex || nIndex < 0)
             return error("%s: Block %s, txn %d not in available range %d.", __func__, pindex->GetBlockPos().ToString(), nIndex, nTxns);
-
-        for (int k = 0; k <= nIndex; ++k)
-            filein >> txOut;
     } catch (const std::exception& e)
     {
         return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), hpos.ToString());
@@ -1348,34 +1579,53 @@ bool ReadTransactionFromDiskBlock(const CBlockIndex* pindex, int nIndex, CTransa
     return true;
 }
 
-bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatFilePos& pos, const CMessageHeader::MessageStartChars& message_start)
+bool ReadTransactionFromDiskBlock(const FlatFilePos& pos, unsigned int tx_offset, CBlockHeader& header, CTransactionRef& tx)
 {
-    FlatFilePos hpos = pos;
-    hpos.nPos -= 8; // Seek back 8 bytes for meta header
-    CAutoFile filein(OpenBlockFile(hpos, true), SER_DISK, CLIENT_VERSION);
+    CAutoFile filein(OpenBlockFile(GetRecordHeaderPos(pos), true), SER_DISK, CLIENT_VERSION);
     if (filein.IsNull()) {
         return error("%s: OpenBlockFile failed for %s", __func__, pos.ToString());
     }
 
     try {
-        CMessageHeader::MessageStartChars blk_start;
-        unsigned int blk_size;
+        bool compressed;
+        unsigned int size;
+        std::vector<uint8_t> data;
+        if (!ReadBlockRecordHeader(filein, pos, Params().MessageStart(), compressed, size, data)) {
+            return false;
+        }
+        if (compressed) {
+            VectorReader(SER_DISK, CLIENT_VERSION, data, 0) >> header;
+            VectorReader(SER_DISK, CLIENT_VERSION, data, ::GetSerializeSize(header, CLIENT_VERSION) + tx_offset) >> tx;
+        } else {
+            filein >> header;
+            if (fseek(filein.Get(), tx_offset, SEEK_CUR)) {
+                return error("%s: fseek(...) failed", __func__);
+            }
+            filein >> tx;
+        }
+    } catch (const std::exception& e) {
+        return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
+    }
+    return true;
+}
 
-        filein >> blk_start >> blk_size;
+bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatFilePos& pos, const CMessageHeader::MessageStartChars& message_start)
+{
+    CAutoFile filein(OpenBlockFile(GetRecordHeaderPos(pos), true), SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull()) {
+        return error("%s: OpenBlockFile failed for %s", __func__, pos.ToString());
+    }
 
-        if (memcmp(blk_start, message_start, CMessageHeader::MESSAGE_START_SIZE)) {
-            return error("%s: Block magic mismatch for %s: %s versus expected %s", __func__, pos.ToString(),
-                    HexStr(blk_start, blk_start + CMessageHeader::MESSAGE_START_SIZE),
-                    HexStr(message_start, message_start + CMessageHeader::MESSAGE_START_SIZE));
+    try {
+        bool compressed;
+        unsigned int blk_size;
+        if (!ReadBlockRecordHeader(filein, pos, message_start, compressed, blk_size, block)) {
+            return false;
         }
-
-        if (blk_size > MAX_SIZE) {
-            return error("%s: Block data is larger than maximum deserialization size for %s: %s versus %s", __func__, pos.ToString(),
-                    blk_size, MAX_SIZE);
+        if (!compressed) {
+            block.resize(blk_size); // Zeroing of memory is intentional here
+            filein.read((char*)block.data(), blk_size);
         }
-
-        block.resize(blk_size); // Zeroing of memory is intentional here
-        filein.read((char*)block.data(), blk_size);
     } catch(const std::exception& e) {
         return error("%s: Read from block file failed: %s for %s", __func__, e.what(), pos.ToString());
     }
@@ -1772,6 +2022,13 @@ void InitScriptExecutionCache() {
     size_t nElems = scriptExecutionCache.setup_bytes(nMaxCacheSize);
     LogPrintf("Using %zu MiB out of %zu/2 requested for script execution cache, able to store %zu elements\n",
             (nElems*sizeof(uint256)) >>20, (nMaxCacheSize*2)>>20, nElems);
+
+    // Proofs are only cached ahead of acceptance, a quarter of the space is plenty.
+    size_t nMaxProofCacheSize = nMaxCacheSize / 4;
+    boost::unique_lock<boost::shared_mutex> lock(cs_proof_cache);
+    nElems = proofCache.setup_bytes(nMaxProofCacheSize);
+    LogPrintf("Using %zu MiB out of %zu/8 requested for proof cache, able to store %zu elements\n",
+            (nElems*sizeof(uint256)) >>20, (nMaxCacheSize*2)>>20, nElems);
 }
 
 /**
@@ -1840,7 +2097,7 @@ bool CheckInputs(const CTransaction& tx, TxValidationState &state, const CCoinsV
         } else
         if (coin.nType == OUTPUT_CT) {
             vchAmount.resize(33);
-            memcpy(vchAmount.data(), coin.commitment.data, 33);
+            memcpy(vchAmount.data(), coin.GetCommitment().data, 33);
         }
 
         // Verify signature
@@ -1891,7 +2148,7 @@ bool CheckInputs(const CTransaction& tx, TxValidationState &state, const CCoinsV
     return true;
 }
 
-static bool UndoWriteToDisk(const CBlockUndo& blockundo, FlatFilePos& pos, const uint256& hashBlock, const CMessageHeader::MessageStartChars& messageStart)
+static bool UndoWriteToDisk(const CBlockUndo& blockundo, const std::vector<uint8_t>& record, FlatFilePos& pos, const uint256& hashBlock, const CMessageHeader::MessageStartChars& messageStart)
 {
     // Open history file to append
     CAutoFile fileout(OpenUndoFile(pos), SER_DISK, CLIENT_VERSION);
@@ -1899,7 +2156,7 @@ static bool UndoWriteToDisk(const CBlockUndo& blockundo, FlatFilePos& pos, const
         return error("%s: OpenUndoFile failed", __func__);
 
     // Write index header
-    unsigned int nSize = GetSerializeSize(blockundo, fileout.GetVersion());
+    unsigned int nSize = record.empty() ? GetSerializeSize(blockundo, fileout.GetVersion()) : record.size() | BLOCKFILE_RECORD_COMPRESSED;
     fileout << messageStart << nSize;
 
     // Write undo data
@@ -1907,7 +2164,11 @@ static bool UndoWriteToDisk(const CBlockUndo& blockundo, FlatFilePos& pos, const
     if (fileOutPos < 0)
         return error("%s: ftell failed", __func__);
     pos.nPos = (unsigned int)fileOutPos;
-    fileout << blockundo;
+    if (record.empty()) {
+        fileout << blockundo;
+    } else {
+        fileout.write((const char*)record.data(), record.size());
+    }
 
     // calculate & write checksum
     CHashWriter hasher(SER_GETHASH, PROTOCOL_VERSION);
@@ -1926,16 +2187,32 @@ bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex* pindex)
     }
 
     // Open history file to read
-    CAutoFile filein(OpenUndoFile(pos, true), SER_DISK, CLIENT_VERSION);
+    CAutoFile filein(OpenUndoFile(GetRecordHeaderPos(pos), true), SER_DISK, CLIENT_VERSION);
     if (filein.IsNull())
         return error("%s: OpenUndoFile failed", __func__);
 
     // Read block
-    uint256 hashChecksum, nullHash;
-    CHashVerifier<CAutoFile> verifier(&filein); // We need a CHashVerifier as reserializing may lose data
+    uint256 hashChecksum, hashUndo, nullHash;
+    const uint256 hashBlock = pindex->pprev ? pindex->pprev->GetBlockHash() : nullHash;
     try {
-        verifier << (pindex->pprev ? pindex->pprev->GetBlockHash() : nullHash);
-        verifier >> blockundo;
+        bool compressed;
+        unsigned int size;
+        std::vector<uint8_t> data;
+        if (!ReadBlockRecordHeader(filein, pos, Params().MessageStart(), compressed, size, data)) {
+            return false;
+        }
+        if (compressed) {
+            VectorReader reader(SER_DISK, CLIENT_VERSION, data, 0);
+            CHashVerifier<VectorReader> verifier(&reader);
+            verifier << hashBlock;
+            verifier >> blockundo;
+            hashUndo = verifier.GetHash();
+        } else {
+            CHashVerifier<CAutoFile> verifier(&filein); // We need a CHashVerifier as reserializing may lose data
+            verifier << hashBlock;
+            verifier >> blockundo;
+            hashUndo = verifier.GetHash();
+        }
         filein >> hashChecksum;
     }
     catch (const std::exception& e) {
@@ -1943,7 +2220,7 @@ bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex* pindex)
     }
 
     // Verify checksum
-    if (hashChecksum != verifier.GetHash())
+    if (hashChecksum != hashUndo)
         return error("%s: Checksum mismatch", __func__);
 
     return true;
@@ -2080,7 +2357,7 @@ DisconnectResult CChainState::DisconnectBlock(const CBlock& block, const CBlockI
                     view.nLastRCTOutput = pindex->nAnonOutputs;
                     // Verify data matches
                     CAnonOutput ao;
-                    if (!pblocktree->ReadRCTOutput(view.nLastRCTOutput, ao)) {
+                    if (!prctdb->ReadRCTOutput(view.nLastRCTOutput, ao)) {
                         error("%s: RCT output missing, txn %s, %d, index %d.", __func__, hash.ToString(), k, view.nLastRCTOutput);
                         if (!view.fForceDisconnect) {
                             return DISCONNECT_FAILED;
@@ -2119,25 +2396,6 @@ DisconnectResult CChainState::DisconnectBlock(const CBlock& block, const CBlockI
                     }
                 }
             }
-
-            if (!fAddressIndex
-                || (!out->IsType(OUTPUT_STANDARD)
-                && !out->IsType(OUTPUT_CT))) {
-                continue;
-            }
-
-            const CScript *pScript;
-            std::vector<unsigned char> hashBytes;
-            int scriptType = 0;
-            CAmount nValue;
-            if (!ExtractIndexInfo(out, scriptType, hashBytes, nValue, pScript)
-                || scriptType == 0) {
-                continue;
-            }
-            // undo receiving activity
-            view.addressIndex.push_back(std::make_pair(CAddressIndexKey(scriptType, uint256(hashBytes.data(), hashBytes.size()), pindex->nHeight, i, hash, k, false), nValue));
-            // undo unspent index
-            view.addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(scriptType, uint256(hashBytes.data(), hashBytes.size()), hash, k), CAddressUnspentValue()));
         }
 
 
@@ -2173,30 +2431,6 @@ DisconnectResult CChainState::DisconnectBlock(const CBlock& block, const CBlockI
                         return DISCONNECT_FAILED;
                     }
                     fClean = fClean && res != DISCONNECT_UNCLEAN;
-
-                    const CTxIn input = tx.vin[j];
-
-                    if (fSpentIndex) { // undo and delete the spent index
-                        view.spentIndex.push_back(std::make_pair(CSpentIndexKey(input.prevout.hash, input.prevout.n), CSpentIndexValue()));
-                    }
-
-                    if (fAddressIndex) {
-                        const Coin &coin = view.AccessCoin(tx.vin[j].prevout);
-                        const CScript *pScript = &coin.out.scriptPubKey;
-
-                        CAmount nValue = coin.nType == OUTPUT_CT ? 0 : coin.out.nValue;
-                        std::vector<uint8_t> hashBytes;
-                        int scriptType = 0;
-                        if (!ExtractIndexInfo(pScript, scriptType, hashBytes)
-                            || scriptType == 0) {
-                            continue;
-                        }
-
-                        // undo spending activity
-                        view.addressIndex.push_back(std::make_pair(CAddressIndexKey(scriptType, uint256(hashBytes.data(), hashBytes.size()), pindex->nHeight, i, hash, j, true), nValue * -1));
-                        // restore unspent index
-                        view.addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(scriptType, uint256(hashBytes.data(), hashBytes.size()), input.prevout.hash, input.prevout.n), CAddressUnspentValue(nValue, *pScript, coin.nHeight)));
-                    }
                 }
             }
         } else
@@ -2270,11 +2504,16 @@ static bool WriteUndoDataForBlock(const CBlockUndo& blockundo, BlockValidationSt
     // Write undo information to disk
     if (pindex->GetUndoPos().IsNull()) {
         FlatFilePos _pos;
-        if (!FindUndoPos(state, pindex->nFile, _pos, ::GetSerializeSize(blockundo, CLIENT_VERSION) + 40))
+        std::vector<uint8_t> record;
+        if (g_block_compression) {
+            CompressBlockRecord(blockundo, record);
+        }
+        unsigned int nUndoSize = record.empty() ? ::GetSerializeSize(blockundo, CLIENT_VERSION) : record.size();
+        if (!FindUndoPos(state, pindex->nFile, _pos, nUndoSize + 40))
             return error("ConnectBlock(): FindUndoPos failed");
 
         uint256 nullHash;
-        if (!UndoWriteToDisk(blockundo, _pos, pindex->pprev ? pindex->pprev->GetBlockHash() : nullHash, chainparams.MessageStart()))
+        if (!UndoWriteToDisk(blockundo, record, _pos, pindex->pprev ? pindex->pprev->GetBlockHash() : nullHash, chainparams.MessageStart()))
             return AbortNode(state, "Failed to write undo data");
 
         // update nUndoPos in block index
@@ -2588,7 +2827,6 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
     CAmount nFees = 0;
     int nInputs = 0;
     int64_t nSigOpsCost = 0;
-    int64_t nAnonIn = 0;
     int64_t nStakeReward = 0;
 
     blockundo.vtxundo.reserve(block.vtx.size() - (fGraviocoinMode ? 0 : 1));
@@ -2649,48 +2887,6 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
                 LogPrintf("ERROR: %s: contains a non-BIP68-final transaction\n", __func__);
                 return state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, "bad-txns-nonfinal");
             }
-
-            if (tx.IsGraviocoinVersion()
-                && (fAddressIndex || fSpentIndex)) {
-                // Update spent inputs for insight
-                for (size_t j = 0; j < tx.vin.size(); j++) {
-                    const CTxIn input = tx.vin[j];
-                    if (input.IsAnonInput()) {
-                        nAnonIn++;
-                        continue;
-                    }
-
-                    const Coin &coin = view.AccessCoin(input.prevout);
-                    const CScript *pScript = &coin.out.scriptPubKey;
-
-                    CAmount nValue = coin.nType == OUTPUT_CT ? 0 : coin.out.nValue;
-                    std::vector<uint8_t> hashBytes;
-                    int scriptType = 0;
-
-                    if (!ExtractIndexInfo(pScript, scriptType, hashBytes)
-                        || scriptType == 0) {
-                        continue;
-                    }
-
-                    uint256 hashAddress;
-                    if (scriptType > 0)
-                        hashAddress = uint256(hashBytes.data(), hashBytes.size());
-
-                    if (fAddressIndex && scriptType > 0) {
-                        // record spending activity
-                        view.addressIndex.push_back(std::make_pair(CAddressIndexKey(scriptType, hashAddress, pindex->nHeight, i, txhash, j, true), nValue * -1));
-                        // remove address from unspent index
-                        view.addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(scriptType, hashAddress, input.prevout.hash, input.prevout.n), CAddressUnspentValue()));
-                    }
-
-                    if (fSpentIndex) {
-                        CAmount nValue = coin.nType == OUTPUT_CT ? -1 : coin.out.nValue;
-                        // add the spent index to determine the txid and input that spent an output
-                        // and to find the amount and address from an input
-                        view.spentIndex.push_back(std::make_pair(CSpentIndexKey(input.prevout.hash, input.prevout.n), CSpentIndexValue(txhash, j, pindex->nHeight, nValue, scriptType, hashAddress)));
-                    }
-                }
-            }
         }
 
         // GetTransactionSigOpCost counts 3 types of sigops:
@@ -2764,7 +2960,7 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
                 CTxOutRingCT *txout = (CTxOutRingCT*)tx.vpout[k].get();
 
                 int64_t nTestExists;
-                if (!fVerifyingDB && pblocktree->ReadRCTOutputLink(txout->pk, nTestExists)) {
+                if (!fVerifyingDB && prctdb->ReadRCTOutputLink(txout->pk, nTestExists)) {
                     control.Wait();
 
                     if (nTestExists > pindex->pprev->nAnonOutputs) {
@@ -2791,32 +2987,6 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
                 view.anonOutputs.push_back(std::make_pair(view.nLastRCTOutput, ao));
             }
         }
-
-        if (fAddressIndex) {
-            // Update outputs for insight
-            for (unsigned int k = 0; k < tx.vpout.size(); k++) {
-                const CTxOutBase *out = tx.vpout[k].get();
-
-                if (!out->IsType(OUTPUT_STANDARD)
-                    && !out->IsType(OUTPUT_CT)) {
-                    continue;
-                }
-
-                const CScript *pScript;
-                std::vector<unsigned char> hashBytes;
-                int scriptType = 0;
-                CAmount nValue;
-                if (!ExtractIndexInfo(out, scriptType, hashBytes, nValue, pScript)
-                    || scriptType == 0) {
-                    continue;
-                }
-
-                // Record receiving activity
-                view.addressIndex.push_back(std::make_pair(CAddressIndexKey(scriptType, uint256(hashBytes.data(), hashBytes.size()), pindex->nHeight, i, txhash, k, false), nValue));
-                // Record unspent output
-                view.addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(scriptType, uint256(hashBytes.data(), hashBytes.size()), txhash, k), CAddressUnspentValue(nValue, *pScript, pindex->nHeight)));
-            }
-        }
     }
 
     int64_t nTime3 = GetTimeMicros(); nTimeConnect += nTime3 - nTime2;
@@ -3006,32 +3176,6 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
         setDirtyBlockIndex.insert(pindex);
     }
 
-
-    if (fTimestampIndex) {
-        unsigned int logicalTS = pindex->nTime;
-        unsigned int prevLogicalTS = 0;
-
-        // Retrieve logical timestamp of the previous block
-        if (pindex->pprev) {
-            if (!pblocktree->ReadTimestampBlockIndex(pindex->pprev->GetBlockHash(), prevLogicalTS)) {
-                LogPrintf("%s: Failed to read previous block's logical timestamp\n", __func__);
-            }
-        }
-
-        if (logicalTS <= prevLogicalTS) {
-            logicalTS = prevLogicalTS + 1;
-            LogPrintf("%s: Previous logical timestamp is newer Actual[%d] prevLogical[%d] Logical[%d]\n", __func__, pindex->nTime, prevLogicalTS, logicalTS);
-        }
-
-        if (!pblocktree->WriteTimestampIndex(CTimestampIndexKey(logicalTS, pindex->GetBlockHash()))) {
-            return AbortNode(state, "Failed to write timestamp index");
-        }
-
-        if (!pblocktree->WriteTimestampBlockIndex(CTimestampBlockIndexKey(pindex->GetBlockHash()), CTimestampBlockIndexValue(logicalTS))) {
-            return AbortNode(state, "Failed to write blockhash index");
-        }
-    }
-
     assert(pindex->phashBlock);
     // add this block to the view's block chain
     view.SetBestBlock(pindex->GetBlockHash(), pindex->nHeight);
@@ -3105,10 +3249,12 @@ bool CChainState::FlushStateToDisk(
         bool fPeriodicWrite = mode == FlushStateMode::PERIODIC && nNow > nLastWrite + (int64_t)DATABASE_WRITE_INTERVAL * 1000000;
         // It's been very long since we flushed the cache. Do this infrequently, to optimize cache usage.
         bool fPeriodicFlush = mode == FlushStateMode::PERIODIC && nNow > nLastFlush + (int64_t)DATABASE_FLUSH_INTERVAL * 1000000;
+        // Block positions were changed outside of connecting blocks, write the block index only.
+        bool fBlockIndexWrite = mode == FlushStateMode::BLOCK_INDEX;
         // Combine all conditions that result in a full cache flush.
         fDoFullFlush = (mode == FlushStateMode::ALWAYS) || fCacheLarge || fCacheCritical || fPeriodicFlush || fFlushForPrune;
         // Write blocks and block index to disk.
-        if (fDoFullFlush || fPeriodicWrite) {
+        if (fDoFullFlush || fPeriodicWrite || fBlockIndexWrite) {
             // Depend on nMinDiskSpace to ensure we can write block index
             if (!CheckDiskSpace(GetBlocksDir())) {
                 return AbortNode(state, "Disk space is too low!", _("Error: Disk space is too low!").translated, CClientUIInterface::MSG_NOPREFIX);
@@ -3213,52 +3359,26 @@ bool FlushView(CCoinsViewCache *view, BlockValidationState& state, bool fDisconn
     if (!view->Flush())
         return false;
 
-    if (fAddressIndex) {
-        if (fDisconnecting) {
-            if (!pblocktree->EraseAddressIndex(view->addressIndex)) {
-                return AbortNode(state, "Failed to delete address index");
-            }
-        } else {
-            if (!pblocktree->WriteAddressIndex(view->addressIndex)) {
-                return AbortNode(state, "Failed to write address index");
-            }
-        }
-
-        if (!pblocktree->UpdateAddressUnspentIndex(view->addressUnspentIndex)) {
-            return AbortNode(state, "Failed to write address unspent index");
-        }
-    }
-
-    if (fSpentIndex) {
-        if (!pblocktree->UpdateSpentIndex(view->spentIndex)) {
-            return AbortNode(state, "Failed to write transaction index");
-        }
-    }
-
-    view->addressIndex.clear();
-    view->addressUnspentIndex.clear();
-    view->spentIndex.clear();
-
     if (fDisconnecting) {
         for (auto &it : view->keyImages) {
-            if (!pblocktree->EraseRCTKeyImage(it.first)) {
+            if (!prctdb->EraseRCTKeyImage(it.first)) {
                 return error("%s: EraseRCTKeyImage failed, txn %s.", __func__, it.second.ToString());
             }
         }
 
         if (view->anonOutputLinks.size() > 0) {
             for (auto &it : view->anonOutputLinks) {
-                if (!pblocktree->EraseRCTOutput(it.second)) {
+                if (!prctdb->EraseRCTOutput(it.second)) {
                     return error("%s: EraseRCTOutput failed.", __func__);
                 }
 
-                if (!pblocktree->EraseRCTOutputLink(it.first)) {
+                if (!prctdb->EraseRCTOutputLink(it.first)) {
                     return error("%s: EraseRCTOutput failed.", __func__);
                 }
             }
         }
     } else {
-        CDBBatch batch(*pblocktree);
+        CDBBatch batch(*prctdb);
 
         for (auto &it : view->keyImages) {
             batch.Write(std::make_pair(DB_RCTKEYIMAGE, it.first), it.second);
@@ -3269,7 +3389,7 @@ bool FlushView(CCoinsViewCache *view, BlockValidationState& state, bool fDisconn
         for (auto &it : view->anonOutputLinks) {
             batch.Write(std::make_pair(DB_RCTOUTPUT_LINK, it.first), it.second);
         }
-        if (!pblocktree->WriteBatch(batch)) {
+        if (!prctdb->WriteBatch(batch)) {
             return error("%s: Write RCT outputs failed.", __func__);
         }
     }
@@ -4155,8 +4275,9 @@ static bool FindBlockPos(FlatFilePos &pos, unsigned int nAddSize, unsigned int n
         vinfoBlockFile.resize(nFile + 1);
     }
 
+    const unsigned int max_blockfile_size = gArgs.GetBoolArg("-fastprune", false) ? 0x10000 /* 64kb */ : MAX_BLOCKFILE_SIZE;
     if (!fKnown) {
-        while (vinfoBlockFile[nFile].nSize + nAddSize >= MAX_BLOCKFILE_SIZE) {
+        while (vinfoBlockFile[nFile].nSize + nAddSize >= max_blockfile_size) {
             nFile++;
             if (vinfoBlockFile.size() <= nFile) {
                 vinfoBlockFile.resize(nFile + 1);
@@ -5191,16 +5312,28 @@ bool ProcessNewBlockHeaders(const std::vector<CBlockHeader>& headers, BlockValid
 
 /** Store block on disk. If dbp is non-nullptr, the file is known to already reside on disk */
 static FlatFilePos SaveBlockToDisk(const CBlock& block, int nHeight, const CChainParams& chainparams, const FlatFilePos* dbp) {
-    unsigned int nBlockSize = ::GetSerializeSize(block, CLIENT_VERSION);
+    unsigned int nBlockSize;
+    std::vector<uint8_t> record;
     FlatFilePos blockPos;
-    if (dbp != nullptr)
+    if (dbp != nullptr) {
+        // The record on disk may be compressed
+        bool compressed;
+        if (!ReadBlockRecordSize(*dbp, nBlockSize, compressed)) {
+            return FlatFilePos();
+        }
         blockPos = *dbp;
+    } else {
+        if (g_block_compression) {
+            CompressBlockRecord(block, record);
+        }
+        nBlockSize = record.empty() ? ::GetSerializeSize(block, CLIENT_VERSION) : record.size();
+    }
     if (!FindBlockPos(blockPos, nBlockSize+8, nHeight, block.GetBlockTime(), dbp != nullptr)) {
         error("%s: FindBlockPos failed", __func__);
         return FlatFilePos();
     }
     if (dbp == nullptr) {
-        if (!WriteBlockToDisk(block, blockPos, chainparams.MessageStart())) {
+        if (!WriteBlockToDisk(block, record, blockPos, chainparams.MessageStart())) {
             AbortNode("Failed to write block");
             return FlatFilePos();
         }
@@ -5521,41 +5654,260 @@ void PruneBlockFilesManual(int nManualPruneHeight)
     }
 }
 
-/**
- * Prune block and undo files (blk???.dat and undo???.dat) so that the disk space used is less than a user-defined target.
- * The user sets the target (in MB) on the command line or in config file.  This will be run on startup and whenever new
- * space is allocated in a block or undo file, staying below the target. Changing back to unpruned requires a reindex
- * (which in this case means the blockchain must be re-downloaded.)
- *
- * Pruning functions are called from FlushStateToDisk when the global fCheckForPruning flag has been set.
- * Block and undo files are deleted in lock-step (when blk00003.dat is deleted, so is rev00003.dat.)
- * Pruning cannot take place until the longest chain is at least a certain length (100000 on mainnet, 1000 on testnet, 1000 on regtest).
- * Pruning will never delete a block within a defined distance (currently 288) from the active chain's tip.
- * The block index is updated by unsetting HAVE_DATA and HAVE_UNDO for any blocks that were stored in the deleted files.
- * A db flag records the fact that at least some block files have been pruned.
- *
- * @param[out]   setFilesToPrune   The set of file indices that can be unlinked will be returned
- */
-static void FindFilesToPrune(std::set<int>& setFilesToPrune, uint64_t nPruneAfterHeight)
+/** Move a block and its undo data to the current block file, compressed */
+static bool MoveBlockCompressed(CBlockIndex* pindex, const CChainParams& chainparams)
 {
-    LOCK2(cs_main, cs_LastBlockFile);
-    if (::ChainActive().Tip() == nullptr || nPruneTarget == 0) {
-        return;
+    CBlock block;
+    CBlockUndo blockundo;
+    FlatFilePos old_pos;
+    bool have_undo;
+    {
+        LOCK(cs_main);
+        old_pos = pindex->GetBlockPos();
+        have_undo = pindex->nStatus & BLOCK_HAVE_UNDO;
+        if (have_undo && !UndoReadFromDisk(blockundo, pindex)) {
+            return false;
+        }
     }
-    if ((uint64_t)::ChainActive().Tip()->nHeight <= nPruneAfterHeight) {
-        return;
+    if (!ReadBlockFromDisk(block, old_pos, chainparams.GetConsensus())) {
+        return false;
+    }
+    if (block.GetHash() != pindex->GetBlockHash()) {
+        return error("%s: GetHash() doesn't match index for %s at %s", __func__, pindex->ToString(), old_pos.ToString());
     }
 
-    unsigned int nLastBlockWeCanPrune = ::ChainActive().Tip()->nHeight - MIN_BLOCKS_TO_KEEP;
-    uint64_t nCurrentUsage = CalculateCurrentUsage();
-    // We don't check to prune until after we've allocated new space for files
-    // So we should leave a buffer under our target to account for another allocation
-    // before the next pruning.
-    uint64_t nBuffer = BLOCKFILE_CHUNK_SIZE + UNDOFILE_CHUNK_SIZE;
-    uint64_t nBytesToPrune;
-    int count=0;
+    FlatFilePos blockPos;
+    {
+        LOCK(cs_main);
+        blockPos = SaveBlockToDisk(block, pindex->nHeight, chainparams, nullptr);
+        if (blockPos.IsNull()) {
+            return false;
+        }
+        pindex->nFile = blockPos.nFile;
+        pindex->nDataPos = blockPos.nPos;
+        pindex->nUndoPos = 0;
+        pindex->nStatus &= ~BLOCK_HAVE_UNDO;
+        setDirtyBlockIndex.insert(pindex);
+        if (have_undo) {
+            BlockValidationState state;
+            if (!WriteUndoDataForBlock(blockundo, state, pindex, chainparams)) {
+                return false;
+            }
+        }
+    }
 
-    if (nCurrentUsage + nBuffer >= nPruneTarget) {
+    return true;
+}
+
+/** Point the txindex entries of moved blocks at their flushed positions, blocks that were not moved are skipped */
+static bool MoveTxIndexEntries(const std::vector<std::pair<uint256, FlatFilePos> >& moves, const CChainParams& chainparams)
+{
+    if (!g_txindex) {
+        return true;
+    }
+    for (const auto& move : moves) {
+        FlatFilePos new_pos;
+        {
+            LOCK(cs_main);
+            CBlockIndex* pindex = LookupBlockIndex(move.first);
+            if (!pindex || !(pindex->nStatus & BLOCK_HAVE_DATA)) {
+                continue;
+            }
+            new_pos = pindex->GetBlockPos();
+        }
+        if (new_pos == move.second) {
+            continue;
+        }
+        CBlock block;
+        if (!ReadBlockFromDisk(block, new_pos, chainparams.GetConsensus())) {
+            return false;
+        }
+        if (!g_txindex->MoveBlock(block, move.second, new_pos)) {
+            return error("%s: Failed to update the txindex for %s", __func__, move.first.ToString());
+        }
+    }
+    return true;
+}
+
+/** Wait until the enabled indexes are synced, they read blocks from disk without cs_main while syncing */
+static bool WaitForIndexesSynced()
+{
+    std::vector<BaseIndex*> indexes;
+    if (g_txindex) indexes.push_back(g_txindex.get());
+    if (g_address_index) indexes.push_back(g_address_index.get());
+    if (g_spent_index) indexes.push_back(g_spent_index.get());
+    if (g_timestamp_index) indexes.push_back(g_timestamp_index.get());
+    if (g_vote_index) indexes.push_back(g_vote_index.get());
+    ForEachBlockFilterIndex([&indexes](BlockFilterIndex& index) { indexes.push_back(&index); });
+
+    for (BaseIndex* index : indexes) {
+        while (!index->BlockUntilSyncedToCurrentChain()) {
+            if (ShutdownRequested()) {
+                return false;
+            }
+            MilliSleep(1000);
+        }
+    }
+    return true;
+}
+
+void CompressBlockFiles(const CChainParams& chainparams)
+{
+    int first_file = 0, last_file;
+    pblocktree->ReadCompressedBlockFiles(first_file);
+    {
+        LOCK(cs_LastBlockFile);
+        last_file = nLastBlockFile;
+    }
+    if (first_file >= last_file) {
+        return;
+    }
+    if (!g_txindex && fs::exists(GetDataDir() / "indexes" / "txindex")) {
+        // The entries of a disabled txindex can't be moved with the blocks
+        LogPrintf("Not compressing block files while the txindex is disabled\n");
+        return;
+    }
+    // Indexes must not write the old positions of blocks after they were moved
+    if (!WaitForIndexesSynced()) {
+        return;
+    }
+
+    std::vector<std::pair<uint256, FlatFilePos> > moves;
+    if (pblocktree->ReadCompressedBlockMoves(moves)) {
+        // Left over if the node stopped while a block file was compressed
+        if (!MoveTxIndexEntries(moves, chainparams)) {
+            LogPrintf("%s: Failed to update the txindex\n", __func__);
+            return;
+        }
+    }
+
+    std::map<int, std::vector<std::pair<unsigned int, CBlockIndex*> > > file_blocks;
+    {
+        LOCK(cs_main);
+        for (const auto& entry : g_blockman.m_block_index) {
+            CBlockIndex* pindex = entry.second;
+            if ((pindex->nStatus & BLOCK_HAVE_DATA) && pindex->nFile >= first_file && pindex->nFile < last_file) {
+                file_blocks[pindex->nFile].emplace_back(pindex->nDataPos, pindex);
+            }
+        }
+    }
+
+    LogPrintf("Compressing block files %05u to %05u\n", first_file, last_file - 1);
+    for (int nFile = first_file; nFile < last_file; nFile++) {
+        std::vector<std::pair<unsigned int, CBlockIndex*> >& blocks = file_blocks[nFile];
+        std::sort(blocks.begin(), blocks.end());
+
+        bool have_uncompressed = false;
+        for (const auto& entry : blocks) {
+            unsigned int size;
+            bool compressed;
+            if (!ReadBlockRecordSize(FlatFilePos(nFile, entry.first), size, compressed)) {
+                return;
+            }
+            if (!compressed) {
+                have_uncompressed = true;
+                break;
+            }
+        }
+
+        bool remove_files = false;
+        if (have_uncompressed) {
+            // Recorded before any block is moved, a periodic flush may write the new positions of some
+            moves.clear();
+            for (const auto& entry : blocks) {
+                moves.emplace_back(entry.second->GetBlockHash(), FlatFilePos(nFile, entry.first));
+            }
+            if (!pblocktree->WriteCompressedBlockMoves(moves)) {
+                return;
+            }
+            for (const auto& entry : blocks) {
+                if (ShutdownRequested()) {
+                    return;
+                }
+                if (!MoveBlockCompressed(entry.second, chainparams)) {
+                    LogPrintf("%s: Failed to move block %s\n", __func__, entry.second->GetBlockHash().ToString());
+                    return;
+                }
+            }
+            {
+                LOCK(cs_LastBlockFile);
+                vinfoBlockFile[nFile].SetNull();
+                setDirtyFileInfo.insert(nFile);
+            }
+            // Write the new block positions before the old files are removed
+            BlockValidationState state;
+            if (!::ChainstateActive().FlushStateToDisk(chainparams, state, FlushStateMode::BLOCK_INDEX)) {
+                LogPrintf("%s: Failed to flush state (%s)\n", __func__, FormatStateMessage(state));
+                return;
+            }
+            // The txindex is moved once the new positions are written, its entries must not point at unrecorded space
+            if (!MoveTxIndexEntries(moves, chainparams)) {
+                LogPrintf("%s: Failed to update the txindex\n", __func__);
+                return;
+            }
+            remove_files = true;
+        } else if (blocks.empty()) {
+            // Left over if the node stopped after the block index was written
+            LOCK(cs_LastBlockFile);
+            remove_files = (int)vinfoBlockFile.size() > nFile && vinfoBlockFile[nFile].nSize == 0;
+        }
+        if (remove_files) {
+            // Indexes syncing on their own threads may still read the old files
+            if (!WaitForIndexesSynced()) {
+                return;
+            }
+            FlatFilePos pos(nFile, 0);
+            fs::remove(BlockFileSeq().FileName(pos));
+            fs::remove(UndoFileSeq().FileName(pos));
+            LogPrintf("Compressed blocks from blk/rev (%05u)\n", nFile);
+        }
+        file_blocks.erase(nFile);
+        if (!pblocktree->WriteCompressedBlockFiles(nFile + 1)) {
+            return;
+        }
+        if (!moves.empty()) {
+            pblocktree->EraseCompressedBlockMoves();
+            moves.clear();
+        }
+    }
+    LogPrintf("Compressing block files done\n");
+}
+
+/**
+ * Prune block and undo files (blk???.dat and undo???.dat) so that the disk space used is less than a user-defined target.
+ * The user sets the target (in MB) on the command line or in config file.  This will be run on startup and whenever new
+ * space is allocated in a block or undo file, staying below the target. Changing back to unpruned requires a reindex
+ * (which in this case means the blockchain must be re-downloaded.)
+ *
+ * Pruning functions are called from FlushStateToDisk when the global fCheckForPruning flag has been set.
+ * Block and undo files are deleted in lock-step (when blk00003.dat is deleted, so is rev00003.dat.)
+ * Pruning cannot take place until the longest chain is at least a certain length (100000 on mainnet, 1000 on testnet, 1000 on regtest).
+ * Pruning will never delete a block within a defined distance (currently 288) from the active chain's tip.
+ * The block index is updated by unsetting HAVE_DATA and HAVE_UNDO for any blocks that were stored in the deleted files.
+ * A db flag records the fact that at least some block files have been pruned.
+ *
+ * @param[out]   setFilesToPrune   The set of file indices that can be unlinked will be returned
+ */
+static void FindFilesToPrune(std::set<int>& setFilesToPrune, uint64_t nPruneAfterHeight)
+{
+    LOCK2(cs_main, cs_LastBlockFile);
+    if (::ChainActive().Tip() == nullptr || nPruneTarget == 0) {
+        return;
+    }
+    if ((uint64_t)::ChainActive().Tip()->nHeight <= nPruneAfterHeight) {
+        return;
+    }
+
+    unsigned int nLastBlockWeCanPrune = ::ChainActive().Tip()->nHeight - MIN_BLOCKS_TO_KEEP;
+    uint64_t nCurrentUsage = CalculateCurrentUsage();
+    // We don't check to prune until after we've allocated new space for files
+    // So we should leave a buffer under our target to account for another allocation
+    // before the next pruning.
+    uint64_t nBuffer = BLOCKFILE_CHUNK_SIZE + UNDOFILE_CHUNK_SIZE;
+    uint64_t nBytesToPrune;
+    int count=0;
+
+    if (nCurrentUsage + nBuffer >= nPruneTarget) {
         // On a prune event, the chainstate DB is flushed.
         // To avoid excessive prune events negating the benefit of high dbcache
         // values, we should not prune too rapidly.
@@ -5641,18 +5993,37 @@ bool BlockManager::LoadBlockIndex(
     CBlockTreeDB& blocktree,
     std::set<CBlockIndex*, CBlockIndexWorkComparator>& block_index_candidates)
 {
-    if (!blocktree.LoadBlockIndexGuts(consensus_params, [this](const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main) { return this->InsertBlockIndex(hash); }))
-        return false;
-
-    // Calculate nChainWork
     std::vector<std::pair<int, CBlockIndex*> > vSortedByHeight;
-    vSortedByHeight.reserve(m_block_index.size());
-    for (const std::pair<const uint256, CBlockIndex*>& item : m_block_index)
-    {
-        CBlockIndex* pindex = item.second;
-        vSortedByHeight.push_back(std::make_pair(pindex->nHeight, pindex));
+    std::vector<std::pair<uint256, CBlockIndex*> > snapshot_entries;
+    if (m_block_index.empty() && ReadBlockIndexSnapshot(blocktree, consensus_params, snapshot_entries, m_snapshot_best_block)) {
+        // Snapshot records are ordered by height
+        m_block_index.reserve(snapshot_entries.size());
+        vSortedByHeight.reserve(snapshot_entries.size());
+        for (size_t i = 0; i < snapshot_entries.size(); ++i) {
+            auto ret = m_block_index.emplace(snapshot_entries[i].first, snapshot_entries[i].second);
+            if (!ret.second) {
+                for (; i < snapshot_entries.size(); ++i) {
+                    delete snapshot_entries[i].second;
+                }
+                return error("%s: Duplicate entry in block index snapshot", __func__);
+            }
+            snapshot_entries[i].second->phashBlock = &ret.first->first;
+            vSortedByHeight.push_back(std::make_pair(snapshot_entries[i].second->nHeight, snapshot_entries[i].second));
+        }
+    } else {
+        if (!blocktree.LoadBlockIndexGuts(consensus_params, [this](const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main) { return this->InsertBlockIndex(hash); }))
+            return false;
+
+        vSortedByHeight.reserve(m_block_index.size());
+        for (const std::pair<const uint256, CBlockIndex*>& item : m_block_index)
+        {
+            CBlockIndex* pindex = item.second;
+            vSortedByHeight.push_back(std::make_pair(pindex->nHeight, pindex));
+        }
+        sort(vSortedByHeight.begin(), vSortedByHeight.end());
     }
-    sort(vSortedByHeight.begin(), vSortedByHeight.end());
+
+    // Calculate nChainWork
     for (const std::pair<int, CBlockIndex*>& item : vSortedByHeight)
     {
         if (ShutdownRequested()) return false;
@@ -5694,6 +6065,7 @@ bool BlockManager::LoadBlockIndex(
 void BlockManager::Unload() {
     m_failed_blocks.clear();
     m_blocks_unlinked.clear();
+    m_snapshot_best_block.SetNull();
 
     for (const BlockMap::value_type& entry : m_block_index) {
         delete entry.second;
@@ -5753,17 +6125,27 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams) EXCLUSIVE_LOCKS_RE
     pblocktree->ReadReindexing(fReindexing);
     if(fReindexing) fReindex = true;
 
-    // Check whether we have an address index
-    pblocktree->ReadFlag("addressindex", fAddressIndex);
-    LogPrintf("%s: address index %s\n", __func__, fAddressIndex ? "enabled" : "disabled");
-
-    // Check whether we have a timestamp index
-    pblocktree->ReadFlag("timestampindex", fTimestampIndex);
-    LogPrintf("%s: timestamp index %s\n", __func__, fTimestampIndex ? "enabled" : "disabled");
+    // Insight indexes are kept in their own databases under indexes/, drop data left by older versions
+    bool fLegacyInsightIndex = false;
+    for (const char *name : {"addressindex", "spentindex", "timestampindex"}) {
+        bool fValue = false;
+        if (pblocktree->ReadFlag(name, fValue) && fValue) {
+            fLegacyInsightIndex = true;
+        }
+    }
+    if (fLegacyInsightIndex) {
+        LogPrintf("%s: Removing insight index data from the block index database\n", __func__);
+        if (!pblocktree->EraseLegacyInsightIndexes()) {
+            return error("%s: Failed to remove insight index data", __func__);
+        }
+        for (const char *name : {"addressindex", "spentindex", "timestampindex"}) {
+            pblocktree->WriteFlag(name, false);
+        }
+    }
 
-    // Check whether we have a spent index
-    pblocktree->ReadFlag("spentindex", fSpentIndex);
-    LogPrintf("%s: spent index %s\n", __func__, fSpentIndex ? "enabled" : "disabled");
+    if (!prctdb->MigrateData(*pblocktree)) {
+        return error("%s: Failed to move RingCT data", __func__);
+    }
 
     return true;
 }
@@ -5842,6 +6224,10 @@ bool CVerifyDB::VerifyDB(const CChainParams& chainparams, CCoinsView *coinsview,
             LogPrintf("VerifyDB(): block verification stopping at height %d (pruning, no data)\n", pindex->nHeight);
             break;
         }
+        if (pindex->nFlags & BLOCK_SNAPSHOT) {
+            LogPrintf("VerifyDB(): block verification stopping at height %d (loaded from snapshot, no data)\n", pindex->nHeight);
+            break;
+        }
         CBlock block;
         // check level 0: read from disk
         if (!ReadBlockFromDisk(block, pindex, chainparams.GetConsensus()))
@@ -5930,6 +6316,190 @@ bool CChainState::RollforwardBlock(const CBlockIndex* pindex, CCoinsViewCache& i
     return true;
 }
 
+bool CChainState::ActivateSnapshot(const fs::path& path, const CChainParams& chainparams, SnapshotMetadata& metadata, std::string& sError)
+{
+    CAutoFile file(fsbridge::fopen(path, "rb"), SER_DISK, CLIENT_VERSION);
+    if (file.IsNull()) {
+        sError = "Unable to open snapshot file";
+        return false;
+    }
+    try {
+        file >> metadata;
+    } catch (const std::exception& e) {
+        sError = strprintf("Unable to read snapshot: %s", e.what());
+        return false;
+    }
+
+    BlockValidationState state;
+    {
+        LOCK(cs_main);
+        CBlockIndex *pindexBase = LookupBlockIndex(metadata.m_base_blockhash);
+        if (!pindexBase || !pindexBase->IsValid(BLOCK_VALID_TREE)) {
+            sError = strprintf("Base block %s of the snapshot is not in the header chain", metadata.m_base_blockhash.ToString());
+            return false;
+        }
+        MapAssumeutxo::const_iterator it_hash = chainparams.Assumeutxo().find(pindexBase->nHeight);
+        if (it_hash == chainparams.Assumeutxo().end()) {
+            sError = strprintf("No snapshot is accepted at height %d", pindexBase->nHeight);
+            return false;
+        }
+        if (metadata.m_stake_modifiers_count != (uint32_t)pindexBase->nHeight + 1) {
+            sError = "Stake modifier count does not match the base block height";
+            return false;
+        }
+        if (fReindex || fImporting || m_chain.Height() != 0 || CoinsTip().GetBestBlock() != chainparams.GetConsensus().hashGenesisBlock) {
+            sError = "A snapshot can only be loaded into a chainstate at the genesis block";
+            return false;
+        }
+        if (pindexBase->nStatus & BLOCK_FAILED_MASK) {
+            sError = "Base block of the snapshot is invalid";
+            return false;
+        }
+
+        if (!FlushStateToDisk(chainparams, state, FlushStateMode::ALWAYS)) {
+            sError = FormatStateMessage(state);
+            return false;
+        }
+
+        std::vector<CBlockIndex*> vSnapshotBlocks;
+        for (CBlockIndex *pindex = pindexBase; pindex->pprev; pindex = pindex->pprev) {
+            vSnapshotBlocks.push_back(pindex);
+        }
+
+        // The coins of the genesis block, restored if the snapshot is rejected
+        std::vector<std::pair<COutPoint, Coin> > vGenesisCoins;
+        {
+            std::unique_ptr<CCoinsViewCursor> pcursor(CoinsDB().Cursor());
+            for (; pcursor->Valid(); pcursor->Next()) {
+                COutPoint outpoint;
+                Coin coin;
+                if (!pcursor->GetKey(outpoint) || !pcursor->GetValue(coin)) {
+                    sError = "Unable to read the coin database";
+                    return false;
+                }
+                vGenesisCoins.emplace_back(outpoint, std::move(coin));
+            }
+        }
+
+        // The file is read once, its hash is checked after the records are written
+        std::vector<uint256> vStakeModifiers(metadata.m_stake_modifiers_count);
+        bool fLoaded = false;
+        try {
+            CHashVerifier<CAutoFile> verifier(&file);
+            LogPrintf("%s: Loading %d coins, %d anon outputs and %d key images from snapshot at %s\n", __func__,
+                metadata.m_coins_count, metadata.m_anon_outputs_count, metadata.m_key_images_count, pindexBase->GetBlockHash().ToString());
+            if (!CoinsDB().WriteSnapshotCoins(verifier, metadata.m_coins_count, pindexBase->GetBlockHash())) {
+                sError = "Failed to write snapshot coins";
+            } else
+            if (!prctdb->WriteSnapshotRCT(verifier, metadata.m_anon_outputs_count, metadata.m_key_images_count)) {
+                sError = "Failed to write snapshot anon outputs";
+            } else {
+                for (auto &modifier : vStakeModifiers) {
+                    verifier >> modifier;
+                }
+                CHashWriter ss(SER_GETHASH, PROTOCOL_VERSION);
+                ss << metadata << verifier.GetHash();
+                if (ss.GetHash() != it_hash->second) {
+                    sError = strprintf("Snapshot hash %s does not match the expected %s", ss.GetHash().ToString(), it_hash->second.ToString());
+                } else {
+                    fLoaded = true;
+                }
+            }
+        } catch (const std::exception& e) {
+            sError = strprintf("Unable to read snapshot: %s", e.what());
+        }
+        if (!fLoaded) {
+            LogPrintf("%s: Rejected snapshot, restoring the genesis chainstate: %s\n", __func__, sError);
+            if (!CoinsDB().RollbackSnapshotCoins(vGenesisCoins, chainparams.GetConsensus().hashGenesisBlock)
+                || !prctdb->EraseSnapshotRCT()) {
+                return AbortNode("Failed to roll back a rejected snapshot");
+            }
+            return false;
+        }
+        if (!CoinsDB().CommitSnapshotCoins(pindexBase->GetBlockHash())) {
+            sError = "Failed to write snapshot coins";
+            return AbortNode(sError);
+        }
+
+        // Stake modifiers from genesis to the base, the genesis modifier is unchanged
+        size_t nModifier = 1;
+        for (auto it = vSnapshotBlocks.rbegin(); it != vSnapshotBlocks.rend(); ++it) {
+            CBlockIndex *pindex = *it;
+            pindex->bnStakeModifier = vStakeModifiers[nModifier++];
+            if (!(pindex->nStatus & BLOCK_HAVE_DATA)) {
+                pindex->nFlags |= BLOCK_SNAPSHOT;
+                // Validated by the snapshot creator, don't rewind for missing witness data
+                pindex->nStatus |= BLOCK_OPT_WITNESS;
+                // The transaction counts below the base are unknown. A block needs nTx > 0 for its
+                // descendants to become candidates for the tip (HaveTxsDownloaded), so each block
+                // counts one transaction and the base takes the rest. nChainTx of the base and of
+                // all later blocks is then exact, only getchaintxstats windows below the base are off.
+                pindex->nTx = 1;
+                if (pindex == pindexBase && metadata.m_nchaintx > pindex->pprev->nChainTx + 1) {
+                    pindex->nTx = metadata.m_nchaintx - pindex->pprev->nChainTx;
+                }
+            }
+            pindex->nChainTx = pindex->pprev->nChainTx + pindex->nTx;
+            pindex->RaiseValidity(BLOCK_VALID_SCRIPTS);
+            setDirtyBlockIndex.insert(pindex);
+        }
+        pindexBase->nMoneySupply = metadata.m_money_supply;
+        pindexBase->nAnonOutputs = metadata.m_last_anon_output;
+
+        CoinsTip().SetBestBlock(pindexBase->GetBlockHash(), pindexBase->nHeight);
+        m_chain.SetTip(pindexBase);
+        setBlockIndexCandidates.insert(pindexBase);
+
+        // Link blocks already received above the snapshot blocks, as ReceivedBlockTransactions would
+        std::deque<CBlockIndex*> queue;
+        for (CBlockIndex *pindex : vSnapshotBlocks) {
+            auto range = m_blockman.m_blocks_unlinked.equal_range(pindex);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (pindexBase->GetAncestor(it->second->nHeight) != it->second) {
+                    queue.push_back(it->second);
+                }
+            }
+            m_blockman.m_blocks_unlinked.erase(range.first, range.second);
+        }
+        while (!queue.empty()) {
+            CBlockIndex *pindex = queue.front();
+            queue.pop_front();
+            pindex->nChainTx = pindex->pprev->nChainTx + pindex->nTx;
+            {
+                LOCK(cs_nBlockSequenceId);
+                pindex->nSequenceId = nBlockSequenceId++;
+            }
+            if (!setBlockIndexCandidates.value_comp()(pindex, m_chain.Tip())) {
+                setBlockIndexCandidates.insert(pindex);
+            }
+            auto range = m_blockman.m_blocks_unlinked.equal_range(pindex);
+            for (auto it = range.first; it != range.second; ++it) {
+                queue.push_back(it->second);
+            }
+            m_blockman.m_blocks_unlinked.erase(range.first, range.second);
+        }
+        PruneBlockIndexCandidates();
+
+        // Transactions in the mempool spend coins from before the snapshot
+        mempool.clear();
+
+        if (!FlushStateToDisk(chainparams, state, FlushStateMode::ALWAYS)) {
+            sError = FormatStateMessage(state);
+            return false;
+        }
+        LogPrintf("%s: Snapshot loaded, new tip %s height %d\n", __func__, pindexBase->GetBlockHash().ToString(), pindexBase->nHeight);
+        uiInterface.NotifyBlockTip(IsInitialBlockDownload(), pindexBase);
+    }
+    CheckBlockIndex(chainparams.GetConsensus());
+
+    // Connect any blocks received above the base
+    if (!ActivateBestChain(state, chainparams, nullptr)) {
+        sError = FormatStateMessage(state);
+        return false;
+    }
+    return true;
+}
+
 bool CChainState::ReplayBlocks(const CChainParams& params)
 {
     LOCK(cs_main);
@@ -5941,6 +6511,11 @@ bool CChainState::ReplayBlocks(const CChainParams& params)
     if (hashHeads.empty()) return true; // We're already in a consistent state.
     if (hashHeads.size() != 2) return error("ReplayBlocks(): unknown inconsistent state");
 
+    // Coins of the partial flush may be written already, the unspent output totals can't be replayed.
+    if (!this->CoinsDB().EraseUTXOStats()) {
+        return error("ReplayBlocks(): failed to reset unspent output totals");
+    }
+
     uiInterface.ShowProgress(_("Replaying blocks...").translated, 0, false);
     LogPrintf("Replaying blocks\n");
 
@@ -6154,6 +6729,11 @@ void CChainState::UnloadBlockIndex() {
 // May NOT be used after any connections are up as much
 // of the peer-processing logic assumes a consistent
 // block index state
+uint256 GetBlockIndexSnapshotBestBlock()
+{
+    return g_blockman.m_snapshot_best_block;
+}
+
 void UnloadBlockIndex()
 {
     LOCK(cs_main);
@@ -6206,21 +6786,6 @@ bool LoadBlockIndex(const CChainParams& chainparams)
 
         LogPrintf("Initializing databases...\n");
         pblocktree->WriteFlag("v1", true);
-
-        // Use the provided setting for -addressindex in the new database
-        fAddressIndex = gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX);
-        pblocktree->WriteFlag("addressindex", fAddressIndex);
-        LogPrintf("%s: address index %s\n", __func__, fAddressIndex ? "enabled" : "disabled");
-
-        // Use the provided setting for -timestampindex in the new database
-        fTimestampIndex = gArgs.GetBoolArg("-timestampindex", DEFAULT_TIMESTAMPINDEX);
-        pblocktree->WriteFlag("timestampindex", fTimestampIndex);
-        LogPrintf("%s: timestamp index %s\n", __func__, fTimestampIndex ? "enabled" : "disabled");
-
-        // Use the provided setting for -spentindex in the new database
-        fSpentIndex = gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX);
-        pblocktree->WriteFlag("spentindex", fSpentIndex);
-        LogPrintf("%s: spent index %s\n", __func__, fSpentIndex ? "enabled" : "disabled");
     }
     return true;
 }
@@ -6256,65 +6821,220 @@ bool LoadGenesisBlock(const CChainParams& chainparams)
     return ::ChainstateActive().LoadGenesisBlock(chainparams);
 }
 
+namespace {
+/**
+ * Pipeline for LoadExternalBlockFile. A reader thread locates and deserialises
+ * the blocks in file order, a pool of threads runs the context free checks of
+ * CheckBlock and the caller accepts the checked blocks in file order.
+ */
+class BlockFileImporter
+{
+public:
+    struct Item {
+        std::shared_ptr<CBlock> block;
+        uint256 hash;
+        FlatFilePos pos;
+        bool checked{false};
+    };
+
+    BlockFileImporter(const CChainParams& chainparams, FILE* fileIn, const FlatFilePos* dbp, int n_threads)
+        : m_chainparams(chainparams), m_max_items(std::max(16, n_threads * 4))
+    {
+        FlatFilePos pos = dbp ? *dbp : FlatFilePos();
+        m_reader = std::thread([this, fileIn, pos]() {
+            util::ThreadRename("loadblkread");
+            ThreadRead(fileIn, pos);
+        });
+        for (int i = 0; i < n_threads; ++i) {
+            m_checkers.emplace_back([this, i]() {
+                util::ThreadRename(strprintf("loadblkchk.%i", i));
+                ThreadCheck();
+            });
+        }
+    }
+
+    ~BlockFileImporter()
+    {
+        {
+            LOCK(m_mutex);
+            m_stop = true;
+        }
+        m_cond.notify_all();
+        m_reader.join();
+        for (auto& thread : m_checkers) {
+            thread.join();
+        }
+    }
+
+    //! Get the next block in file order after its context free checks, returns false at the end of the file
+    bool Next(Item& item)
+    {
+        WAIT_LOCK(m_mutex, lock);
+        m_cond.wait(lock, [this]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return (!m_items.empty() && m_items.front().checked) || (m_read_done && m_items.empty()); });
+        if (m_items.empty()) {
+            return false;
+        }
+        item = std::move(m_items.front());
+        m_items.pop_front();
+        m_next_check--;
+        m_cond.notify_all();
+        return true;
+    }
+
+    //! Set if reading the file failed with a system error
+    std::string GetError()
+    {
+        LOCK(m_mutex);
+        return m_error;
+    }
+
+private:
+    void ThreadRead(FILE* fileIn, FlatFilePos pos)
+    {
+        try {
+            // This takes over fileIn and calls fclose() on it in the CBufferedFile destructor
+            CBufferedFile blkdat(fileIn, 2*MAX_BLOCK_SERIALIZED_SIZE, MAX_BLOCK_SERIALIZED_SIZE+8, SER_DISK, CLIENT_VERSION);
+            uint64_t nRewind = blkdat.GetPos();
+            while (!blkdat.eof()) {
+                blkdat.SetPos(nRewind);
+                nRewind++; // start one byte further next time, in case of failure
+                blkdat.SetLimit(); // remove former limit
+                unsigned int nSize = 0;
+                bool compressed = false;
+                try {
+                    // locate a header
+                    unsigned char buf[CMessageHeader::MESSAGE_START_SIZE];
+                    blkdat.FindByte(m_chainparams.MessageStart()[0]);
+                    nRewind = blkdat.GetPos()+1;
+                    blkdat >> buf;
+                    if (memcmp(buf, m_chainparams.MessageStart(), CMessageHeader::MESSAGE_START_SIZE))
+                        continue;
+                    // read size
+                    blkdat >> nSize;
+                    compressed = nSize & BLOCKFILE_RECORD_COMPRESSED;
+                    nSize &= ~BLOCKFILE_RECORD_COMPRESSED;
+                    if (nSize < (compressed ? 4 : 80) || nSize > (compressed ? LZ4_COMPRESSBOUND(MAX_BLOCK_SERIALIZED_SIZE) + 4 : MAX_BLOCK_SERIALIZED_SIZE))
+                        continue;
+                } catch (const std::exception&) {
+                    // no valid block header found; don't complain
+                    break;
+                }
+                try {
+                    // read block
+                    Item item;
+                    uint64_t nBlockPos = blkdat.GetPos();
+                    pos.nPos = nBlockPos;
+                    item.pos = pos;
+                    blkdat.SetLimit(nBlockPos + nSize);
+                    blkdat.SetPos(nBlockPos);
+                    item.block = std::make_shared<CBlock>();
+                    if (compressed) {
+                        std::vector<uint8_t> record(nSize), data;
+                        blkdat.read((char*)record.data(), nSize);
+                        if (!DecompressBlockRecord(record, data)) {
+                            throw std::ios_base::failure("decompression failed");
+                        }
+                        VectorReader(SER_DISK, CLIENT_VERSION, data, 0) >> *item.block;
+                    } else {
+                        blkdat >> *item.block;
+                    }
+                    nRewind = blkdat.GetPos();
+
+                    WAIT_LOCK(m_mutex, lock);
+                    m_cond.wait(lock, [this]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || m_items.size() < m_max_items; });
+                    if (m_stop) {
+                        break;
+                    }
+                    m_items.push_back(std::move(item));
+                    m_cond.notify_all();
+                } catch (const std::exception& e) {
+                    LogPrintf("%s: Deserialize or I/O error - %s\n", __func__, e.what());
+                }
+            }
+        } catch (const std::runtime_error& e) {
+            LOCK(m_mutex);
+            m_error = e.what();
+        }
+        {
+            LOCK(m_mutex);
+            m_read_done = true;
+        }
+        m_cond.notify_all();
+    }
+
+    void ThreadCheck()
+    {
+        while (true) {
+            Item* item;
+            {
+                WAIT_LOCK(m_mutex, lock);
+                m_cond.wait(lock, [this]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || m_read_done || m_next_check < m_items.size(); });
+                if (m_stop || m_next_check >= m_items.size()) {
+                    return;
+                }
+                // References to deque elements stay valid until the element is popped, after it was checked
+                item = &m_items[m_next_check++];
+            }
+
+            const CBlock& block = *item->block;
+            item->hash = block.GetHash();
+            BlockValidationState state;
+            if (!CheckBlock(block, state, m_chainparams.GetConsensus()) || state.nFlags != 0) {
+                // AcceptBlock checks the block again to report the failure
+                block.fChecked = false;
+            }
+
+            {
+                LOCK(m_mutex);
+                item->checked = true;
+            }
+            m_cond.notify_all();
+        }
+    }
+
+    const CChainParams& m_chainparams;
+    const size_t m_max_items;
+
+    Mutex m_mutex;
+    std::condition_variable m_cond;
+    //! Blocks in file order, blocks before m_next_check are being checked or were checked
+    std::deque<Item> m_items GUARDED_BY(m_mutex);
+    size_t m_next_check GUARDED_BY(m_mutex){0};
+    bool m_read_done GUARDED_BY(m_mutex){false};
+    bool m_stop GUARDED_BY(m_mutex){false};
+    std::string m_error GUARDED_BY(m_mutex);
+
+    std::thread m_reader;
+    std::vector<std::thread> m_checkers;
+};
+} // namespace
+
 bool LoadExternalBlockFile(const CChainParams& chainparams, FILE* fileIn, FlatFilePos *dbp)
 {
     // Map of disk positions for blocks with unknown parent (only used for reindex)
     static std::multimap<uint256, FlatFilePos> mapBlocksUnknownParent;
     int64_t nStart = GetTimeMillis();
 
-    fAddressIndex = gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX);
-    fTimestampIndex = gArgs.GetBoolArg("-timestampindex", DEFAULT_TIMESTAMPINDEX);
-    fSpentIndex = gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX);
-
     int nLoaded = 0;
     try {
-        // This takes over fileIn and calls fclose() on it in the CBufferedFile destructor
-        CBufferedFile blkdat(fileIn, 2*MAX_BLOCK_SERIALIZED_SIZE, MAX_BLOCK_SERIALIZED_SIZE+8, SER_DISK, CLIENT_VERSION);
-        uint64_t nRewind = blkdat.GetPos();
-        while (!blkdat.eof()) {
+        BlockFileImporter importer(chainparams, fileIn, dbp, g_import_check_threads);
+        BlockFileImporter::Item item;
+        while (importer.Next(item)) {
             boost::this_thread::interruption_point();
 
-            blkdat.SetPos(nRewind);
-            nRewind++; // start one byte further next time, in case of failure
-            blkdat.SetLimit(); // remove former limit
-            unsigned int nSize = 0;
-            try {
-                // locate a header
-                unsigned char buf[CMessageHeader::MESSAGE_START_SIZE];
-                blkdat.FindByte(chainparams.MessageStart()[0]);
-                nRewind = blkdat.GetPos()+1;
-                blkdat >> buf;
-                if (memcmp(buf, chainparams.MessageStart(), CMessageHeader::MESSAGE_START_SIZE))
-                    continue;
-                // read size
-                blkdat >> nSize;
-                if (nSize < 80 || nSize > MAX_BLOCK_SERIALIZED_SIZE)
-                    continue;
-            } catch (const std::exception&) {
-                // no valid block header found; don't complain
-                break;
-            }
             try {
-                // read block
-                uint64_t nBlockPos = blkdat.GetPos();
                 if (dbp)
-                    dbp->nPos = nBlockPos;
-                blkdat.SetLimit(nBlockPos + nSize);
-                blkdat.SetPos(nBlockPos);
-                std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
-                CBlock& block = *pblock;
-                blkdat >> block;
-                nRewind = blkdat.GetPos();
-
-                uint256 hash = block.GetHash();
+                    dbp->nPos = item.pos.nPos;
+                std::shared_ptr<CBlock> pblock = item.block;
+                const uint256& hash = item.hash;
                 {
                     LOCK(cs_main);
                     // detect out of order blocks, and store them for later
-                    if (hash != chainparams.GetConsensus().hashGenesisBlock && !LookupBlockIndex(block.hashPrevBlock)) {
+                    if (hash != chainparams.GetConsensus().hashGenesisBlock && !LookupBlockIndex(pblock->hashPrevBlock)) {
                         LogPrint(BCLog::REINDEX, "%s: Out of order block %s, parent %s not known\n", __func__, hash.ToString(),
-                                block.hashPrevBlock.ToString());
+                                pblock->hashPrevBlock.ToString());
                         if (dbp)
-                            mapBlocksUnknownParent.insert(std::make_pair(block.hashPrevBlock, *dbp));
+                            mapBlocksUnknownParent.insert(std::make_pair(pblock->hashPrevBlock, *dbp));
                         continue;
                     }
 
@@ -6374,6 +7094,10 @@ bool LoadExternalBlockFile(const CChainParams& chainparams, FILE* fileIn, FlatFi
                 LogPrintf("%s: Deserialize or I/O error - %s\n", __func__, e.what());
             }
         }
+        std::string strError = importer.GetError();
+        if (!strError.empty()) {
+            AbortNode("System error: " + strError);
+        }
     } catch (const std::runtime_error& e) {
         AbortNode(std::string("System error: ") + e.what());
     }
@@ -6426,7 +7150,8 @@ void CChainState::CheckBlockIndex(const Consensus::Params& consensusParams)
     while (pindex != nullptr) {
         nNodes++;
         if (pindexFirstInvalid == nullptr && pindex->nStatus & BLOCK_FAILED_VALID) pindexFirstInvalid = pindex;
-        if (pindexFirstMissing == nullptr && !(pindex->nStatus & BLOCK_HAVE_DATA)) pindexFirstMissing = pindex;
+        // Blocks loaded from a snapshot are handled as if their data was present
+        if (pindexFirstMissing == nullptr && !(pindex->nStatus & BLOCK_HAVE_DATA) && !(pindex->nFlags & BLOCK_SNAPSHOT)) pindexFirstMissing = pindex;
         if (pindexFirstNeverProcessed == nullptr && pindex->nTx == 0) pindexFirstNeverProcessed = pindex;
         if (pindex->pprev != nullptr && pindexFirstNotTreeValid == nullptr && (pindex->nStatus & BLOCK_VALID_MASK) < BLOCK_VALID_TREE) pindexFirstNotTreeValid = pindex;
         if (pindex->pprev != nullptr && pindexFirstNotTransactionsValid == nullptr && (pindex->nStatus & BLOCK_VALID_MASK) < BLOCK_VALID_TRANSACTIONS) pindexFirstNotTransactionsValid = pindex;
@@ -6444,7 +7169,7 @@ void CChainState::CheckBlockIndex(const Consensus::Params& consensusParams)
         // HAVE_DATA is only equivalent to nTx > 0 (or VALID_TRANSACTIONS) if no pruning has occurred.
         if (!fHavePruned) {
             // If we've never pruned, then HAVE_DATA should be equivalent to nTx > 0
-            assert(!(pindex->nStatus & BLOCK_HAVE_DATA) == (pindex->nTx == 0));
+            assert(!(pindex->nStatus & BLOCK_HAVE_DATA) == (pindex->nTx == 0) || (pindex->nFlags & BLOCK_SNAPSHOT));
             assert(pindexFirstMissing == pindexFirstNeverProcessed);
         } else {
             // If we have pruned, then we can only say that HAVE_DATA implies nTx > 0
@@ -6598,6 +7323,105 @@ int VersionBitsTipStateSinceHeight(const Consensus::Params& params, Consensus::D
 
 static const uint64_t MEMPOOL_DUMP_VERSION = 1;
 
+namespace {
+/**
+ * Verifies the range proofs and MLSAG signatures of the transactions read from
+ * mempool.dat on a pool of threads, outside cs_main, while LoadMempool accepts
+ * the transactions in file order.
+ */
+class MempoolProofVerifier
+{
+public:
+    struct Entry {
+        CTransactionRef tx;
+        int64_t time;
+        int64_t fee_delta;
+        bool verified{false};
+    };
+
+    MempoolProofVerifier(CTxMemPool& pool, std::vector<Entry>& entries, int64_t expiry_time, int n_threads)
+        : m_pool(pool), m_entries(entries), m_expiry_time(expiry_time)
+    {
+        for (int i = 0; i < n_threads; ++i) {
+            m_threads.emplace_back([this, i]() {
+                util::ThreadRename(strprintf("loadmempool.%i", i));
+                ThreadVerify();
+            });
+        }
+    }
+
+    ~MempoolProofVerifier()
+    {
+        {
+            LOCK(m_mutex);
+            m_stop = true;
+        }
+        m_cond.notify_all();
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    //! Wait until the entry at index was verified, the verifiers only run a limited distance ahead of the last index waited for
+    void Wait(size_t index)
+    {
+        WAIT_LOCK(m_mutex, lock);
+        m_next_accept = index;
+        m_cond.notify_all();
+        m_cond.wait(lock, [this, index]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_entries[index].verified; });
+    }
+
+private:
+    //! Keeps the proofs verified ahead from being evicted from the proof cache before they are used
+    static const size_t MAX_VERIFY_AHEAD = 1024;
+
+    void ThreadVerify()
+    {
+        while (true) {
+            size_t index;
+            {
+                WAIT_LOCK(m_mutex, lock);
+                m_cond.wait(lock, [this]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || m_next_verify < m_next_accept + MAX_VERIFY_AHEAD; });
+                if (m_stop || m_next_verify >= m_entries.size()) {
+                    return;
+                }
+                index = m_next_verify++;
+            }
+
+            // Entries are not changed until they were verified
+            const Entry& entry = m_entries[index];
+            if (entry.time > m_expiry_time) {
+                try {
+                    PreVerifyTransactionProofs(*entry.tx, entry.time);
+                } catch (const std::exception& e) {
+                    // The transaction is verified again when it is accepted
+                    LogPrintf("%s: %s\n", __func__, e.what());
+                }
+            }
+            m_pool.AddLoadProgress(MempoolLoadProgress(0, 1, 0));
+
+            {
+                LOCK(m_mutex);
+                m_entries[index].verified = true;
+            }
+            m_cond.notify_all();
+        }
+    }
+
+    CTxMemPool& m_pool;
+    std::vector<Entry>& m_entries;
+    const int64_t m_expiry_time;
+
+    Mutex m_mutex;
+    std::condition_variable m_cond;
+    size_t m_next_verify GUARDED_BY(m_mutex){0};
+    size_t m_next_accept GUARDED_BY(m_mutex){0};
+    bool m_stop GUARDED_BY(m_mutex){false};
+
+    std::vector<std::thread> m_threads;
+};
+} // namespace
+
 bool LoadMempool(CTxMemPool& pool)
 {
     const CChainParams& chainparams = Params();
@@ -6623,15 +7447,27 @@ bool LoadMempool(CTxMemPool& pool)
         }
         uint64_t num;
         file >> num;
+        // Transactions are written in dependency order, they are read first so
+        // their proofs can be verified ahead of accepting them in that order.
+        std::vector<MempoolProofVerifier::Entry> entries;
         while (num--) {
-            CTransactionRef tx;
-            int64_t nTime;
-            int64_t nFeeDelta;
-            file >> tx;
-            file >> nTime;
-            file >> nFeeDelta;
-
-            CAmount amountdelta = nFeeDelta;
+            MempoolProofVerifier::Entry entry;
+            file >> entry.tx;
+            file >> entry.time;
+            file >> entry.fee_delta;
+            entries.push_back(std::move(entry));
+        }
+        std::map<uint256, CAmount> mapDeltas;
+        file >> mapDeltas;
+        pool.AddLoadProgress(MempoolLoadProgress(entries.size()));
+
+        MempoolProofVerifier verifier(pool, entries, nNow - nExpiryTimeout, g_import_check_threads);
+        for (size_t i = 0; i < entries.size(); ++i) {
+            verifier.Wait(i);
+            CTransactionRef tx = std::move(entries[i].tx);
+            int64_t nTime = entries[i].time;
+
+            CAmount amountdelta = entries[i].fee_delta;
             if (amountdelta) {
                 pool.PrioritiseTransaction(tx->GetHash(), amountdelta);
             }
@@ -6661,11 +7497,10 @@ bool LoadMempool(CTxMemPool& pool)
             } else {
                 ++expired;
             }
+            pool.AddLoadProgress(MempoolLoadProgress(0, 0, 1));
             if (ShutdownRequested())
                 return false;
         }
-        std::map<uint256, CAmount> mapDeltas;
-        file >> mapDeltas;
 
         for (const auto& i : mapDeltas) {
             pool.PrioritiseTransaction(i.first, i.second);
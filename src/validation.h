@@ -32,9 +32,11 @@
 #include <vector>
 
 class CChainState;
+class CSHA256;
 class BlockValidationState;
 class CBlockIndex;
 class CBlockTreeDB;
+class CRCTDB;
 class CBlockUndo;
 class CChainParams;
 class CInv;
@@ -42,6 +44,7 @@ class CConnman;
 class CScriptCheck;
 class CBlockPolicyEstimator;
 class CTxMemPool;
+class SnapshotMetadata;
 class TxValidationState;
 struct ChainTxData;
 
@@ -125,6 +128,10 @@ static const unsigned int DEFAULT_BANSCORE_THRESHOLD = 100;
 static const bool DEFAULT_PERSIST_MEMPOOL = true;
 /** Default for using fee filter */
 static const bool DEFAULT_FEEFILTER = true;
+/** Default for -blockcompression */
+static const bool DEFAULT_BLOCK_COMPRESSION = false;
+/** Set in the size field of a block or undo file record stored LZ4 compressed */
+static const uint32_t BLOCKFILE_RECORD_COMPRESSED = 0x80000000;
 
 /** Maximum number of headers to announce when relaying blocks with headers message.*/
 static const unsigned int MAX_BLOCKS_TO_ANNOUNCE = 8;
@@ -173,6 +180,10 @@ extern std::atomic_bool fBusyImporting;
  * False indicates all script checking is done on the main threadMessageHandler thread.
  */
 extern bool g_parallel_script_checks;
+/** Number of threads running the context free block checks while importing blocks from files, and verifying the proofs of transactions loaded from mempool.dat. */
+extern int g_import_check_threads;
+/** Whether new blocks and undo data are written LZ4 compressed. */
+extern bool g_block_compression;
 extern bool fRequireStandard;
 extern bool fCheckBlockIndex;
 extern bool fCheckpointsEnabled;
@@ -264,6 +275,8 @@ bool TryAutoReindex();
 /** Load the block tree and coins database from disk,
  * initializing state if we're running with -reindex. */
 bool LoadBlockIndex(const CChainParams& chainparams) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+/** The best block recorded in the block index snapshot the block index was loaded from, null if it was read from the block tree db. */
+uint256 GetBlockIndexSnapshotBestBlock() EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 /** Unload database information */
 void UnloadBlockIndex();
 /** Run an instance of the script checking thread */
@@ -306,6 +319,13 @@ void UnlinkPrunedFiles(const std::set<int>& setFilesToPrune);
 /** Prune block files up to a given height */
 void PruneBlockFilesManual(int nManualPruneHeight);
 
+/**
+ *  Rewrite the blocks and undo data stored uncompressed in files below the current block file
+ *  compressed into new files, and delete the old files. Progress is kept in the block tree db,
+ *  returns early if shutdown is requested.
+ */
+void CompressBlockFiles(const CChainParams& chainparams);
+
 /** (try to) add transaction to memory pool
  * plTxnReplaced will be appended to with all transactions replaced from mempool **/
 bool AcceptToMemoryPool(CTxMemPool& pool, TxValidationState &state, const CTransactionRef &tx,
@@ -407,14 +427,38 @@ public:
     ScriptError GetScriptError() const { return error; }
 };
 
-/** Initializes the script-execution cache */
+/** Initializes the script-execution and proof caches */
 void InitScriptExecutionCache();
 
+/**
+ * The proof cache holds range proofs and MLSAG signatures verified ahead of
+ * acceptance, outside cs_main, so acceptance can skip verifying them again.
+ * Entries are SHA256(nonce || type || data verified), GetProofCacheHasher
+ * returns a hasher with the nonce written.
+ */
+CSHA256 GetProofCacheHasher();
+bool ProofCacheContains(const uint256 &entry);
+void ProofCacheInsert(const uint256 &entry);
+
+/** Whether tx has range proofs or MLSAG signatures to verify */
+bool TransactionHasProofs(const CTransaction& tx);
+
+/**
+ * Verify the range proofs and MLSAG signatures of tx without cs_main, adding
+ * them to the proof cache. Returns false if tx has none or they failed,
+ * failures are reported again when tx is accepted.
+ */
+bool PreVerifyTransactionProofs(const CTransaction& tx, int64_t accept_time);
+
 
 /** Functions for disk access for blocks */
 bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const Consensus::Params& consensusParams);
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams);
 bool ReadTransactionFromDiskBlock(const CBlockIndex *pindex, int nIndex, CTransactionRef &txOut);
+/** Read the header of the block at pos and the transaction at tx_offset bytes after the header */
+bool ReadTransactionFromDiskBlock(const FlatFilePos& pos, unsigned int tx_offset, CBlockHeader& header, CTransactionRef& tx);
+/** Decompress the payload of a compressed block or undo file record */
+bool DecompressBlockRecord(const std::vector<uint8_t>& record, std::vector<uint8_t>& data);
 
 bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatFilePos& pos, const CMessageHeader::MessageStartChars& message_start);
 bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const CBlockIndex* pindex, const CMessageHeader::MessageStartChars& message_start);
@@ -481,6 +525,7 @@ enum class FlushStateMode {
     NONE,
     IF_NEEDED,
     PERIODIC,
+    BLOCK_INDEX, //!< Write the block index and block file info without flushing the coins cache
     ALWAYS
 };
 
@@ -526,6 +571,9 @@ public:
      */
     std::multimap<CBlockIndex*, CBlockIndex*> m_blocks_unlinked;
 
+    //! Best block recorded in the block index snapshot m_block_index was loaded from, if any.
+    uint256 m_snapshot_best_block;
+
     /**
      * Load the blocktree off disk and into memory. Populate certain metadata
      * per index entry (nStatus, nChainWork, nTimeMax, etc.) as well as peripheral
@@ -763,6 +811,13 @@ public:
     bool InvalidateBlock(BlockValidationState& state, const CChainParams& chainparams, CBlockIndex* pindex) LOCKS_EXCLUDED(cs_main);
     void ResetBlockFailureFlags(CBlockIndex* pindex) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+    /**
+     * Load a utxo snapshot written by dumptxoutset into a chainstate at genesis and make its
+     * base block the tip. The snapshot hash must be listed in CChainParams::Assumeutxo().
+     * Blocks up to the base are marked BLOCK_SNAPSHOT, they are neither validated nor stored.
+     */
+    bool ActivateSnapshot(const fs::path& path, const CChainParams& chainparams, SnapshotMetadata& metadata, std::string& sError) LOCKS_EXCLUDED(cs_main);
+
     /** Replay blocks that aren't fully applied to the database. */
     bool ReplayBlocks(const CChainParams& params);
     bool RewindBlockIndex(const CChainParams& params) LOCKS_EXCLUDED(cs_main);
@@ -829,6 +884,9 @@ extern std::unique_ptr<CChainState> g_chainstate;
 /** Global variable that points to the active block tree (protected by cs_main) */
 extern std::unique_ptr<CBlockTreeDB> pblocktree;
 
+/** Global variable that points to the RingCT database (protected by cs_main) */
+extern std::unique_ptr<CRCTDB> prctdb;
+
 /**
  * Return the spend height, which is one more than the inputs.GetBestBlock().
  * While checking, GetBestBlock() refers to the parent block. (protected by cs_main)
@@ -531,7 +531,7 @@ void BerkeleyEnvironment::CheckpointLSN(const std::string& strFile)
 }
 
 
-BerkeleyBatch::BerkeleyBatch(BerkeleyDatabase& database, const char* pszMode, bool fFlushOnCloseIn) : pdb(nullptr), activeTxn(nullptr)
+BerkeleyBatch::BerkeleyBatch(BerkeleyDatabase& database, const char* pszMode, bool fFlushOnCloseIn) : pdb(nullptr), activeTxn(nullptr), m_database(&database)
 {
     fReadOnly = (!strchr(pszMode, '+') && !strchr(pszMode, 'w'));
     fFlushOnClose = fFlushOnCloseIn;
@@ -612,7 +612,7 @@ BerkeleyBatch::BerkeleyBatch(BerkeleyDatabase& database, const char* pszMode, bo
 
 void BerkeleyBatch::Flush()
 {
-    if (activeTxn)
+    if (activeTxn || GroupTxnActive())
         return;
 
     // Flush database activity from memory pool to disk log
@@ -635,7 +635,7 @@ void BerkeleyBatch::Close()
     if (!pdb)
         return;
     if (activeTxn)
-        activeTxn->abort();
+        TxnAbort();
     activeTxn = nullptr;
     pdb = nullptr;
 
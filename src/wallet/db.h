@@ -16,6 +16,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -86,10 +87,10 @@ public:
     void CloseDb(const std::string& strFile);
     void ReloadDbEnv();
 
-    DbTxn* TxnBegin(int flags = DB_TXN_WRITE_NOSYNC)
+    DbTxn* TxnBegin(DbTxn* parent = nullptr, int flags = DB_TXN_WRITE_NOSYNC)
     {
         DbTxn* ptxn = nullptr;
-        int ret = dbenv->txn_begin(nullptr, &ptxn, flags);
+        int ret = dbenv->txn_begin(parent, &ptxn, flags);
         if (!ptxn || ret != 0)
             return nullptr;
         return ptxn;
@@ -189,6 +190,10 @@ public:
 private:
     std::string strFile;
 
+    /** Transaction begun by BerkeleyBatch::TxnBeginGroup, only used by batches on m_group_thread */
+    DbTxn* m_group_txn{nullptr};
+    std::atomic<std::thread::id> m_group_thread{std::thread::id()};
+
     /** Return whether this database handle is a dummy for testing.
      * Only to be used at a low level, application should ideally not care
      * about this.
@@ -228,6 +233,7 @@ public:
     DbTxn* activeTxn;
     bool fReadOnly;
     bool fFlushOnClose;
+    BerkeleyDatabase* m_database;
     BerkeleyEnvironment *env;
 
 public:
@@ -263,7 +269,7 @@ public:
 
         // Read
         SafeDbt datValue;
-        int ret = pdb->get(activeTxn, datKey, datValue, nFlags);
+        int ret = pdb->get(Txn(), datKey, datValue, nFlags);
         bool success = false;
         if (datValue.get_data() != nullptr) {
             // Unserialize value
@@ -299,7 +305,7 @@ public:
         SafeDbt datValue(ssValue.data(), ssValue.size());
 
         // Write
-        int ret = pdb->put(activeTxn, datKey, datValue, (fOverwrite ? 0 : DB_NOOVERWRITE));
+        int ret = pdb->put(Txn(), datKey, datValue, (fOverwrite ? 0 : DB_NOOVERWRITE));
         return (ret == 0);
     }
 
@@ -318,7 +324,7 @@ public:
         SafeDbt datKey(ssKey.data(), ssKey.size());
 
         // Erase
-        int ret = pdb->del(activeTxn, datKey, 0);
+        int ret = pdb->del(Txn(), datKey, 0);
         return (ret == 0 || ret == DB_NOTFOUND);
     }
 
@@ -335,7 +341,7 @@ public:
         SafeDbt datKey(ssKey.data(), ssKey.size());
 
         // Exists
-        int ret = pdb->exists(activeTxn, datKey, 0);
+        int ret = pdb->exists(Txn(), datKey, 0);
         return (ret == 0);
     }
 
@@ -344,7 +350,7 @@ public:
         if (!pdb)
             return nullptr;
         Dbc* pcursor = nullptr;
-        int ret = pdb->cursor(nullptr, &pcursor, 0);
+        int ret = pdb->cursor(Txn(), &pcursor, 0);
         if (ret != 0)
             return nullptr;
         return pcursor;
@@ -380,11 +386,36 @@ public:
         return 0;
     }
 
+    /** Return the transaction reads and writes go through, the batch's own or the group transaction
+     * of the database if this thread has one open.
+     */
+    DbTxn* Txn() const
+    {
+        if (activeTxn)
+            return activeTxn;
+        if (m_database->m_group_thread.load() != std::this_thread::get_id())
+            return nullptr;
+        return m_database->m_group_txn;
+    }
+
+    //! Return whether this thread has a group transaction open on the database
+    bool GroupTxnActive() const
+    {
+        return m_database->m_group_thread.load() == std::this_thread::get_id();
+    }
+
+    //! Return whether activeTxn is the group transaction of the database
+    bool IsGroupTxn() const
+    {
+        return activeTxn && GroupTxnActive() && activeTxn == m_database->m_group_txn;
+    }
+
+    /** Begin a transaction as a child of the group transaction if this thread has one open */
     bool TxnBegin()
     {
         if (!pdb || activeTxn)
             return false;
-        DbTxn* ptxn = env->TxnBegin();
+        DbTxn* ptxn = env->TxnBegin(Txn());
         if (!ptxn)
             return false;
         activeTxn = ptxn;
@@ -395,6 +426,7 @@ public:
     {
         if (!pdb || !activeTxn)
             return false;
+        EndGroupTxn();
         int ret = activeTxn->commit(0);
         activeTxn = nullptr;
         return (ret == 0);
@@ -404,12 +436,45 @@ public:
     {
         if (!pdb || !activeTxn)
             return false;
+        EndGroupTxn();
         int ret = activeTxn->abort();
         activeTxn = nullptr;
         return (ret == 0);
     }
 
+    /** Begin a group transaction, until it's committed every batch on the database
+     * used by this thread reads and writes through it and TxnBegin starts a child transaction.
+     * Batches on other threads wait on its locks, so it must only be held while
+     * the caller holds the locks guarding the database's users.
+     */
+    bool TxnBeginGroup()
+    {
+        if (!pdb || activeTxn || m_database->m_group_thread.load() != std::thread::id())
+            return false;
+        if (!TxnBegin())
+            return false;
+        m_database->m_group_txn = activeTxn;
+        m_database->m_group_thread = std::this_thread::get_id();
+        return true;
+    }
+
+    bool TxnCommitGroup()
+    {
+        if (!pdb || !IsGroupTxn())
+            return false;
+        return TxnCommit();
+    }
+
     bool static Rewrite(BerkeleyDatabase& database, const char* pszSkip = nullptr);
+
+private:
+    void EndGroupTxn()
+    {
+        if (IsGroupTxn()) {
+            m_database->m_group_txn = nullptr;
+            m_database->m_group_thread = std::thread::id();
+        }
+    }
 };
 
 #endif // BITCOIN_WALLET_DB_H
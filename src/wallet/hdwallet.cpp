@@ -161,6 +161,7 @@ void CHDWallet::AddOptions()
     gArgs.AddArg("-defaultlookaheadsize=<n>", strprintf("Number of keys to load into the lookahead pool per chain. (default: %u)", DEFAULT_LOOKAHEAD_SIZE), ArgsManager::ALLOW_ANY, OptionsCategory::GIO_WALLET);
     gArgs.AddArg("-stealthv1lookaheadsize=<n>", strprintf("Number of V1 stealth keys to look ahead during a rescan. (default: %u)", DEFAULT_STEALTH_LOOKAHEAD_SIZE), ArgsManager::ALLOW_ANY, OptionsCategory::GIO_WALLET);
     gArgs.AddArg("-stealthv2lookaheadsize=<n>", strprintf("Number of V2 stealth keys to look ahead during a rescan. (default: %u)", DEFAULT_STEALTH_LOOKAHEAD_SIZE), ArgsManager::ALLOW_ANY, OptionsCategory::GIO_WALLET);
+    gArgs.AddArg("-rescanblockfilter", strprintf("Only read blocks matching the wallet's keys in the basic block filter index during a rescan, requires -blockfilterindex. Ignored for wallets with stealth addresses, stealth, anon and cold staking outputs paying to new keys are not found. (default: %u)", DEFAULT_RESCAN_BLOCK_FILTER), ArgsManager::ALLOW_ANY, OptionsCategory::GIO_WALLET);
     gArgs.AddArg("-extkeysaveancestors", strprintf("On saving a key from the lookahead pool, save all unsaved keys leading up to it too. (default: %s)", "true"), ArgsManager::ALLOW_ANY, OptionsCategory::GIO_WALLET);
     gArgs.AddArg("-createdefaultmasterkey", strprintf("Generate a random master key and main account if no master key exists. (default: %s)", "false"), ArgsManager::ALLOW_ANY, OptionsCategory::GIO_WALLET);
 
@@ -1493,6 +1494,7 @@ DBErrors CHDWallet::LoadWallet(bool& fFirstRunRet)
 
     m_rescan_stealth_v1_lookahead = gArgs.GetArg("-stealthv1lookaheadsize", DEFAULT_STEALTH_LOOKAHEAD_SIZE);
     m_rescan_stealth_v2_lookahead = gArgs.GetArg("-stealthv2lookaheadsize", DEFAULT_STEALTH_LOOKAHEAD_SIZE);
+    m_rescan_block_filter = gArgs.GetBoolArg("-rescanblockfilter", DEFAULT_RESCAN_BLOCK_FILTER);
 
     std::string sError;
     ProcessStakingSettings(sError);
@@ -4781,7 +4783,7 @@ int CHDWallet::PlaceRealOutputs(std::vector<std::vector<int64_t> > &vMI, size_t
                 }
 
                 int64_t index;
-                if (!pblocktree->ReadRCTOutputLink(pk, index)) {
+                if (!prctdb->ReadRCTOutputLink(pk, index)) {
                     return wserrorN(1, sError, __func__, _("Anon pubkey not found in db, %s").translated, HexStr(pk.begin(), pk.end()));
                 }
 
@@ -4815,7 +4817,7 @@ int CHDWallet::PickHidingOutputs(interfaces::Chain::Lock& locked_chain, std::vec
     // Remove outputs without required depth
     while (nLastRCTOutIndex > 1){
         CAnonOutput ao;
-        if (!pblocktree->ReadRCTOutput(nLastRCTOutIndex, ao)) {
+        if (!prctdb->ReadRCTOutput(nLastRCTOutIndex, ao)) {
             return wserrorN(1, sError, __func__, _("Anon output not found in db, %d").translated, nLastRCTOutIndex);
         }
         if (nBestHeight - ao.nBlockHeight + 1 < consensusParams.nMinRCTOutputDepth) {
@@ -4853,7 +4855,7 @@ int CHDWallet::PickHidingOutputs(interfaces::Chain::Lock& locked_chain, std::vec
 
             int64_t output_id = nLastRCTOutIndex - std::min(nLastRCTOutIndex-1, std::max(int64_t(1), ranges[j]));
             CAnonOutput ao;
-            if (!pblocktree->ReadRCTOutput(output_id, ao)) {
+            if (!prctdb->ReadRCTOutput(output_id, ao)) {
                 return wserrorN(1, sError, __func__, _("Anon output not found in db, %d").translated, output_id);
             }
 
@@ -4920,10 +4922,10 @@ int CHDWallet::PickHidingOutputs(interfaces::Chain::Lock& locked_chain, std::vec
 
                     int64_t num_blocks, num_aos = select_max - select_min;
                     CAnonOutput ao_min, ao_max;
-                    if (!pblocktree->ReadRCTOutput(select_min, ao_min)) {
+                    if (!prctdb->ReadRCTOutput(select_min, ao_min)) {
                         return wserrorN(1, sError, __func__, _("Anon output not found in db, %d").translated, select_min);
                     }
-                    if (!pblocktree->ReadRCTOutput(select_max, ao_max)) {
+                    if (!prctdb->ReadRCTOutput(select_max, ao_max)) {
                         return wserrorN(1, sError, __func__, _("Anon output not found in db, %d").translated, select_max);
                     }
                     num_blocks = ao_max.nBlockHeight - ao_min.nBlockHeight;
@@ -5328,7 +5330,7 @@ int CHDWallet::AddAnonInputs(interfaces::Chain::Lock& locked_chain, CWalletTx &w
                     int64_t nIndex = vMI[l][k][i];
 
                     CAnonOutput ao;
-                    if (!pblocktree->ReadRCTOutput(nIndex, ao)) {
+                    if (!prctdb->ReadRCTOutput(nIndex, ao)) {
                         return wserrorN(1, sError, __func__, _("Anon output not found in db, %d").translated, nIndex);
                     }
 
@@ -5370,7 +5372,7 @@ int CHDWallet::AddAnonInputs(interfaces::Chain::Lock& locked_chain, CWalletTx &w
                     int64_t nIndex = vMI[l][k][i];
 
                     CAnonOutput ao;
-                    if (!pblocktree->ReadRCTOutput(nIndex, ao)) {
+                    if (!prctdb->ReadRCTOutput(nIndex, ao)) {
                         return wserrorN(1, sError, __func__, _("Anon output not found in db, %d").translated, nIndex);
                     }
 
@@ -5599,6 +5601,7 @@ void CHDWallet::LoadToWallet(const uint256 &hash, CTransactionRecord &rtx)
 
     MapRecords_t::iterator mri = ret.first;
     rtxOrdered.insert(std::make_pair(rtx.GetTxTime(), mri));
+    UpdateOwnedOutputs(hash, mri->second);
 
     // TODO: Spend only owned inputs?
 
@@ -5616,6 +5619,7 @@ void CHDWallet::RemoveFromTxSpends(const uint256 &hash, const CTransactionRef pt
             }
             ++it;
         }
+        UpdateOwnedOutput(txin.prevout);
     }
     return;
 };
@@ -5655,6 +5659,7 @@ int CHDWallet::UnloadTransaction(const uint256 &hash)
             ++it;
         }
 
+        UpdateOwnedOutputs(hash, itr->second, true);
         mapRecords.erase(itr);
     } else {
         WalletLogPrintf("Warning: %s - tx not found in wallet! %s.\n", __func__, hash.ToString());
@@ -8979,6 +8984,7 @@ bool CHDWallet::ProcessLockedBlindedOutputs()
             }
 
             setChanged.insert(op.hash);
+            UpdateOwnedOutputs(op.hash, rtx);
         }
 
         nExpanded++;
@@ -9674,6 +9680,70 @@ void CHDWallet::PostProcessUnloadSpent()
     }
 };
 
+void CHDWallet::AddToSpends(const COutPoint& outpoint, const uint256& wtxid)
+{
+    CWallet::AddToSpends(outpoint, wtxid);
+    UpdateOwnedOutput(outpoint);
+}
+
+COwnedOutputIndex *CHDWallet::GetOwnedOutputIndex(uint8_t nType)
+{
+    switch (nType) {
+        case OUTPUT_STANDARD: return &m_owned_standard;
+        case OUTPUT_CT: return &m_owned_blind;
+        case OUTPUT_RINGCT: return &m_owned_anon;
+        default:
+            break;
+    }
+    return nullptr;
+};
+
+void CHDWallet::UpdateOwnedOutput(const COutPoint &op)
+{
+    AssertLockHeld(cs_wallet);
+
+    MapRecords_t::const_iterator mri = mapRecords.find(op.hash);
+    if (mri == mapRecords.end()) {
+        return;
+    }
+    const COutputRecord *pout = mri->second.GetOutput(op.n);
+    if (pout) {
+        UpdateOwnedOutput(op.hash, *pout);
+    }
+};
+
+void CHDWallet::UpdateOwnedOutput(const uint256 &txhash, const COutputRecord &r, bool fRemove)
+{
+    AssertLockHeld(cs_wallet);
+
+    COwnedOutputIndex *pindex = GetOwnedOutputIndex(r.nType);
+    if (!pindex) {
+        return;
+    }
+
+    // Anon outputs must be owned, standard and blinded outputs may be watch-only
+    bool fOwned = r.nType == OUTPUT_RINGCT ? (r.nFlags & ORF_OWNED) : (r.nFlags & ORF_OWN_ANY);
+    if (fRemove || !fOwned
+        || (r.nType == OUTPUT_RINGCT && IsAnonSpendDisabled())
+        || IsSpent(txhash, r.n)) {
+        pindex->Remove(COutPoint(txhash, r.n));
+        return;
+    }
+    pindex->Add(COutPoint(txhash, r.n), r.nValue);
+};
+
+void CHDWallet::UpdateOwnedOutputs(const uint256 &txhash, const CTransactionRecord &rtx, bool fRemove)
+{
+    for (const auto &r : rtx.vout) {
+        UpdateOwnedOutput(txhash, r, fRemove);
+    }
+};
+
+bool CHDWallet::IsAnonSpendDisabled() const
+{
+    return GetAdjustedTime() >= EXPLOIT_FIX_HF1_TIME;
+};
+
 void CHDWallet::AddToSpends(const uint256& wtxid)
 {
     auto it = mapWallet.find(wtxid);
@@ -9816,6 +9886,10 @@ bool CHDWallet::AddToWalletIfInvolvingMe(const CTransactionRef& ptx, CWalletTx::
             wtx.m_confirm = confirm;
 
             bool rv = AddToWallet(wtx, false);
+            // The status of a spend of record outputs may have changed
+            for (const auto &txin : tx.vin) {
+                UpdateOwnedOutput(txin.prevout);
+            }
             WakeThreadStakeMiner(this); // wallet balance may have changed
             return rv;
         }
@@ -10532,6 +10606,13 @@ bool CHDWallet::AddToRecord(CTransactionRecord &rtxIn, const CTransaction &tx, C
         }
     }
 
+    UpdateOwnedOutputs(txhash, rtx);
+    if (!(rtx.nFlags & ORF_ANON_IN)) {
+        for (const auto &prevout : rtx.vin) {
+            UpdateOwnedOutput(prevout);
+        }
+    }
+
     // Notify UI of new or updated transaction
     NotifyTransactionChanged(this, txhash, fInsertedNew ? CT_NEW : CT_UPDATED);
 
@@ -10564,6 +10645,24 @@ CWallet::ScanResult CHDWallet::ScanForWalletTransactions(const uint256& first_bl
         }
     }
 
+    // Outputs to stealth addresses can't be matched against block filters
+    m_rescan_filter_active = false;
+    if (m_rescan_block_filter) {
+        LOCK(cs_wallet);
+        m_rescan_filter_active = stealthAddresses.empty();
+        for (const auto &mi : mapExtAccounts) {
+            if (!mi.second->mapStealthKeys.empty()) {
+                m_rescan_filter_active = false;
+            }
+        }
+        if (!m_rescan_filter_active) {
+            WalletLogPrintf("%s: Wallet has stealth addresses, not using block filters.\n", __func__);
+        }
+    }
+
+    if (m_rescan_filter_active) {
+        WalletLogPrintf("%s: Matching block filters, not adding stealth lookahead keys.\n", __func__);
+    } else
     if (sea && sea->nFlags & EAF_HAVE_SECRET) {
         LOCK(cs_wallet);
         CEKAStealthKey akStealth;
@@ -10616,6 +10715,7 @@ CWallet::ScanResult CHDWallet::ScanForWalletTransactions(const uint256& first_bl
     }
 
     ScanResult rv = CWallet::ScanForWalletTransactions(first_block, last_block, reserver, fUpdate);
+    m_rescan_filter_active = false;
 
     // Remove lookahead keys
     if (sea) {
@@ -10632,6 +10732,59 @@ CWallet::ScanResult CHDWallet::ScanForWalletTransactions(const uint256& first_bl
     return rv;
 };
 
+bool CHDWallet::GetRescanFilterElements(GCSFilter::ElementSet &elements)
+{
+    if (!m_rescan_filter_active) {
+        return false;
+    }
+
+    LOCK(cs_wallet);
+    auto add_script = [&elements](const CScript &script) {
+        elements.emplace(script.begin(), script.end());
+    };
+    // Keys can receive to P2PKH and P2PKH256 outputs
+    auto add_key = [&add_script](const CPubKey &pk) {
+        add_script(GetScriptForDestination(PKHash(pk.GetID())));
+        add_script(GetScriptForDestination(pk.GetID256()));
+    };
+
+    for (const auto &mi : mapExtAccounts) {
+        const CExtKeyAccount *sea = mi.second;
+        CPubKey pk;
+        for (const auto &ki : sea->mapKeys) {
+            if (!sea->GetPubKey(ki.second, pk)) {
+                return false;
+            }
+            add_key(pk);
+        }
+        for (const auto &ki : sea->mapLookAhead) {
+            if (!sea->GetPubKey(ki.second, pk)) {
+                return false;
+            }
+            add_key(pk);
+        }
+    }
+
+    LOCK(cs_KeyStore);
+    for (const auto &ki : mapKeys) {
+        add_key(ki.second.GetPubKey());
+    }
+    for (const auto &ki : mapCryptedKeys) {
+        add_key(ki.second.first);
+    }
+    for (const auto &ki : mapWatchKeys) {
+        add_key(ki.second);
+    }
+    for (const auto &si : mapScripts) {
+        add_script(GetScriptForDestination(ScriptHash(si.second)));
+    }
+    for (const auto &script : setWatchOnly) {
+        add_script(script);
+    }
+
+    return true;
+};
+
 std::vector<uint256> CHDWallet::ResendRecordTransactionsBefore(int64_t nTime)
 {
     std::vector<uint256> result;
@@ -10847,9 +11000,16 @@ void CHDWallet::AvailableCoins(interfaces::Chain::Lock& locked_chain, std::vecto
         }
     }
 
-    for (MapRecords_t::const_iterator it = mapRecords.begin(); it != mapRecords.end(); ++it) {
+    for (auto oi = m_owned_standard.LowerBound(nMinimumAmount); oi != m_owned_standard.End() && oi->first <= nMaximumAmount; ++oi) {
+        MapRecords_t::const_iterator it = mapRecords.find(oi->second.hash);
+        const COutputRecord *pout;
+        if (it == mapRecords.end()
+            || !(pout = it->second.GetOutput(oi->second.n))) {
+            continue;
+        }
         const uint256 &txid = it->first;
         const CTransactionRecord &rtx = it->second;
+        const COutputRecord &r = *pout;
 
         // TODO: implement when moving coinbase and coinstake txns to mapRecords
         //if (pcoin->GetBlocksToMaturity() > 0)
@@ -10883,63 +11043,48 @@ void CHDWallet::AvailableCoins(interfaces::Chain::Lock& locked_chain, std::vecto
             continue;
         }
 
-        MapWallet_t::const_iterator twi = mapTempWallet.find(txid);
-        for (const auto &r : rtx.vout) {
-            if (r.nType != OUTPUT_STANDARD) {
-                continue;
-            }
-
-            if (!(r.nFlags & ORF_OWN_ANY)) {
-                continue;
-            }
-
-            if (IsSpent(txid, r.n)) {
-                continue;
-            }
-
-            if (r.nValue < nMinimumAmount || r.nValue > nMaximumAmount) {
-                continue;
-            }
+        if (IsSpent(txid, r.n)) {
+            continue;
+        }
 
-            if (coinControl && coinControl->HasSelected() && !coinControl->fAllowOtherInputs && !coinControl->IsSelected(COutPoint(txid, r.n))) {
-                continue;
-            }
+        if (coinControl && coinControl->HasSelected() && !coinControl->fAllowOtherInputs && !coinControl->IsSelected(COutPoint(txid, r.n))) {
+            continue;
+        }
 
-            if (IsLockedCoin(txid, r.n)) {
-                continue;
-            }
+        if (IsLockedCoin(txid, r.n)) {
+            continue;
+        }
 
-            if (!allow_used_addresses && IsUsedDestination(&r.scriptPubKey)) {
-                continue;
-            }
+        if (!allow_used_addresses && IsUsedDestination(&r.scriptPubKey)) {
+            continue;
+        }
 
-            if (twi == mapTempWallet.end()
-                && (twi = mapTempWallet.find(txid)) == mapTempWallet.end()) {
-                if (0 != InsertTempTxn(txid, &rtx)
-                    || (twi = mapTempWallet.find(txid)) == mapTempWallet.end()) {
-                    WalletLogPrintf("ERROR: %s - InsertTempTxn failed %s.\n", __func__, txid.ToString());
-                    return;
-                }
+        MapWallet_t::const_iterator twi = mapTempWallet.find(txid);
+        if (twi == mapTempWallet.end()) {
+            if (0 != InsertTempTxn(txid, &rtx)
+                || (twi = mapTempWallet.find(txid)) == mapTempWallet.end()) {
+                WalletLogPrintf("ERROR: %s - InsertTempTxn failed %s.\n", __func__, txid.ToString());
+                return;
             }
+        }
 
-            bool fSpendableIn = (r.nFlags & ORF_OWNED) || (coinControl && coinControl->fAllowWatchOnly);
-            bool fNeedHardwareKey = (r.nFlags & ORF_HARDWARE_DEVICE);
-
-            vCoins.emplace_back(&twi->second, r.n, nDepth, fSpendableIn, true, safeTx, (coinControl && coinControl->fAllowWatchOnly), true, fNeedHardwareKey);
+        bool fSpendableIn = (r.nFlags & ORF_OWNED) || (coinControl && coinControl->fAllowWatchOnly);
+        bool fNeedHardwareKey = (r.nFlags & ORF_HARDWARE_DEVICE);
 
-            if (nMinimumSumAmount != MAX_MONEY) {
-                nTotal += r.nValue;
+        vCoins.emplace_back(&twi->second, r.n, nDepth, fSpendableIn, true, safeTx, (coinControl && coinControl->fAllowWatchOnly), true, fNeedHardwareKey);
 
-                if (nTotal >= nMinimumSumAmount) {
-                    return;
-                }
-            }
+        if (nMinimumSumAmount != MAX_MONEY) {
+            nTotal += r.nValue;
 
-            // Checks the maximum number of UTXO's.
-            if (nMaximumCount > 0 && vCoins.size() >= nMaximumCount) {
+            if (nTotal >= nMinimumSumAmount) {
                 return;
             }
         }
+
+        // Checks the maximum number of UTXO's.
+        if (nMaximumCount > 0 && vCoins.size() >= nMaximumCount) {
+            return;
+        }
     }
     return;
 };
@@ -11075,9 +11220,16 @@ void CHDWallet::AvailableBlindedCoins(interfaces::Chain::Lock& locked_chain, std
     // a coin control object is provided, and has the avoid address reuse flag set to false, do we allow already used addresses
     bool allow_used_addresses = !IsWalletFlagSet(WALLET_FLAG_AVOID_REUSE) || (coinControl && !coinControl->m_avoid_address_reuse);
 
-    for (MapRecords_t::const_iterator it = mapRecords.begin(); it != mapRecords.end(); ++it) {
+    for (auto oi = m_owned_blind.LowerBound(nMinimumAmount); oi != m_owned_blind.End() && oi->first <= nMaximumAmount; ++oi) {
+        MapRecords_t::const_iterator it = mapRecords.find(oi->second.hash);
+        const COutputRecord *pout;
+        if (it == mapRecords.end()
+            || !(pout = it->second.GetOutput(oi->second.n))) {
+            continue;
+        }
         const uint256 &txid = it->first;
         const CTransactionRecord &rtx = it->second;
+        const COutputRecord &r = *pout;
 
         // TODO: implement when moving coinbase and coinstake txns to mapRecords
         //if (pcoin->GetBlocksToMaturity() > 0)
@@ -11108,56 +11260,42 @@ void CHDWallet::AvailableBlindedCoins(interfaces::Chain::Lock& locked_chain, std
             continue;
         }
 
-        for (const auto &r : rtx.vout) {
-            if (r.nType != OUTPUT_CT) {
-                continue;
-            }
-
-            if (!(r.nFlags & ORF_OWN_ANY)) {
-                continue;
-            }
-
-            if (IsSpent(txid, r.n)) {
-                continue;
-            }
-
-            if (r.nValue < nMinimumAmount || r.nValue > nMaximumAmount) {
-                continue;
-            }
+        if (IsSpent(txid, r.n)) {
+            continue;
+        }
 
-            if (coinControl && coinControl->HasSelected() && !coinControl->fAllowOtherInputs && !coinControl->IsSelected(COutPoint(txid, r.n))) {
-                continue;
-            }
+        if (coinControl && coinControl->HasSelected() && !coinControl->fAllowOtherInputs && !coinControl->IsSelected(COutPoint(txid, r.n))) {
+            continue;
+        }
 
-            if ((!coinControl || !coinControl->fAllowLocked)
-                && IsLockedCoin(txid, r.n)) {
-                continue;
-            }
+        if ((!coinControl || !coinControl->fAllowLocked)
+            && IsLockedCoin(txid, r.n)) {
+            continue;
+        }
 
-            if (!allow_used_addresses && IsUsedDestination(&r.scriptPubKey)) {
-                continue;
-            }
+        if (!allow_used_addresses && IsUsedDestination(&r.scriptPubKey)) {
+            continue;
+        }
 
-            bool fMature = true;
-            bool fSpendable = (coinControl && !coinControl->fAllowWatchOnly && !(r.nFlags & ORF_OWNED)) ? false : true;
-            bool fSolvable = true;
-            bool fNeedHardwareKey = (r.nFlags & ORF_HARDWARE_DEVICE);
+        bool fMature = true;
+        bool fSpendable = (coinControl && !coinControl->fAllowWatchOnly && !(r.nFlags & ORF_OWNED)) ? false : true;
+        bool fSolvable = true;
+        bool fNeedHardwareKey = (r.nFlags & ORF_HARDWARE_DEVICE);
 
-            vCoins.emplace_back(txid, it, r.n, nDepth, fSpendable, fSolvable, safeTx, fMature, fNeedHardwareKey);
+        vCoins.emplace_back(txid, it, r.n, nDepth, fSpendable, fSolvable, safeTx, fMature, fNeedHardwareKey);
 
-            if (nMinimumSumAmount != MAX_MONEY) {
-                nTotal += r.nValue;
+        if (nMinimumSumAmount != MAX_MONEY) {
+            nTotal += r.nValue;
 
-                if (nTotal >= nMinimumSumAmount) {
-                    return;
-                }
-            }
-
-            // Checks the maximum number of UTXO's.
-            if (nMaximumCount > 0 && vCoins.size() >= nMaximumCount) {
+            if (nTotal >= nMinimumSumAmount) {
                 return;
             }
         }
+
+        // Checks the maximum number of UTXO's.
+        if (nMaximumCount > 0 && vCoins.size() >= nMaximumCount) {
+            return;
+        }
     }
 
     return;
@@ -11300,6 +11438,9 @@ void CHDWallet::AvailableAnonCoins(interfaces::Chain::Lock& locked_chain, std::v
     AssertLockHeld(cs_wallet);
 
     vCoins.clear();
+    if (IsAnonSpendDisabled()) {
+        return;
+    }
     CAmount nTotal = 0;
 
     const int min_depth = {coinControl ? coinControl->m_min_depth : DEFAULT_MIN_DEPTH};
@@ -11307,9 +11448,16 @@ void CHDWallet::AvailableAnonCoins(interfaces::Chain::Lock& locked_chain, std::v
     const bool fIncludeImmature = {coinControl ? coinControl->m_include_immature : false};
 
     const Consensus::Params& consensusParams = Params().GetConsensus();
-    for (MapRecords_t::const_iterator it = mapRecords.begin(); it != mapRecords.end(); ++it) {
+    for (auto oi = m_owned_anon.LowerBound(nMinimumAmount); oi != m_owned_anon.End() && oi->first <= nMaximumAmount; ++oi) {
+        MapRecords_t::const_iterator it = mapRecords.find(oi->second.hash);
+        const COutputRecord *pout;
+        if (it == mapRecords.end()
+            || !(pout = it->second.GetOutput(oi->second.n))) {
+            continue;
+        }
         const uint256 &txid = it->first;
         const CTransactionRecord &rtx = it->second;
+        const COutputRecord &r = *pout;
 
         // TODO: implement when moving coinbase and coinstake txns to mapRecords
         //if (pcoin->GetBlocksToMaturity() > 0)
@@ -11334,52 +11482,38 @@ void CHDWallet::AvailableAnonCoins(interfaces::Chain::Lock& locked_chain, std::v
             continue;
         }
 
-        for (const auto &r : rtx.vout) {
-            if (r.nType != OUTPUT_RINGCT) {
-                continue;
-            }
-
-            if (!(r.nFlags & ORF_OWNED)) {
-                continue;
-            }
-
-            if (IsSpent(txid, r.n)) {
-                continue;
-            }
-
-            if (r.nValue < nMinimumAmount || r.nValue > nMaximumAmount) {
-                continue;
-            }
-
-            if (coinControl && coinControl->HasSelected() && !coinControl->fAllowOtherInputs && !coinControl->IsSelected(COutPoint(txid, r.n))) {
-                continue;
-            }
+        if (IsSpent(txid, r.n)) {
+            continue;
+        }
 
-            if ((!coinControl || !coinControl->fAllowLocked)
-                && IsLockedCoin(txid, r.n)) {
-                continue;
-            }
+        if (coinControl && coinControl->HasSelected() && !coinControl->fAllowOtherInputs && !coinControl->IsSelected(COutPoint(txid, r.n))) {
+            continue;
+        }
 
-            bool fSpendable = (coinControl && !coinControl->fAllowWatchOnly && !(r.nFlags & ORF_OWNED)) ? false : true;
-            bool fSolvable = true;
-            bool fNeedHardwareKey = (r.nFlags & ORF_HARDWARE_DEVICE);
+        if ((!coinControl || !coinControl->fAllowLocked)
+            && IsLockedCoin(txid, r.n)) {
+            continue;
+        }
 
-            vCoins.emplace_back(txid, it, r.n, nDepth, fSpendable, fSolvable, safeTx, fMature, fNeedHardwareKey);
+        bool fSpendable = (coinControl && !coinControl->fAllowWatchOnly && !(r.nFlags & ORF_OWNED)) ? false : true;
+        bool fSolvable = true;
+        bool fNeedHardwareKey = (r.nFlags & ORF_HARDWARE_DEVICE);
 
-            if (nMinimumSumAmount != MAX_MONEY) {
-                nTotal += r.nValue;
+        vCoins.emplace_back(txid, it, r.n, nDepth, fSpendable, fSolvable, safeTx, fMature, fNeedHardwareKey);
 
-                if (nTotal >= nMinimumSumAmount) {
-                    return;
-                }
-            }
+        if (nMinimumSumAmount != MAX_MONEY) {
+            nTotal += r.nValue;
 
-            // Checks the maximum number of UTXO's.
-            if (nMaximumCount > 0 && vCoins.size() >= nMaximumCount) {
+            if (nTotal >= nMinimumSumAmount) {
                 return;
             }
-        };
-    };
+        }
+
+        // Checks the maximum number of UTXO's.
+        if (nMaximumCount > 0 && vCoins.size() >= nMaximumCount) {
+            return;
+        }
+    }
 
     random_shuffle(vCoins.begin(), vCoins.end(), GetRandInt);
     return;
@@ -11884,6 +12018,11 @@ bool CHDWallet::AbandonTransaction(const uint256 &hashTx)
                 rtx.SetAbandoned();
                 walletdb.WriteTxRecord(now, rtx);
                 NotifyTransactionChanged(this, now, CT_UPDATED);
+                if (!(rtx.nFlags & ORF_ANON_IN)) {
+                    for (const auto &prevout : rtx.vin) {
+                        UpdateOwnedOutput(prevout);
+                    }
+                }
             }
 
         } else
@@ -11915,6 +12054,7 @@ bool CHDWallet::AbandonTransaction(const uint256 &hashTx)
                     if (it != mapWallet.end()) {
                         it->second.MarkDirty();
                     }
+                    UpdateOwnedOutput(txin.prevout);
                 };
             };
         } else
@@ -11975,6 +12115,11 @@ void CHDWallet::MarkConflicted(const uint256 &hashBlock, int conflicting_height,
                 rtx.blockHash = hashBlock;
                 rtx.block_height = conflicting_height;
                 walletdb.WriteTxRecord(now, rtx);
+                if (!(rtx.nFlags & ORF_ANON_IN)) {
+                    for (const auto &prevout : rtx.vin) {
+                        UpdateOwnedOutput(prevout);
+                    }
+                }
 
                 // Iterate over all its outputs, and mark transactions in the wallet that spend them conflicted too
                 TxSpends::const_iterator iter = mapTxSpends.lower_bound(COutPoint(now, 0));
@@ -12019,6 +12164,7 @@ void CHDWallet::MarkConflicted(const uint256 &hashBlock, int conflicting_height,
                     if (it != mapWallet.end()) {
                         it->second.MarkDirty();
                     }
+                    UpdateOwnedOutput(txin.prevout);
                 }
             }
 
@@ -14,6 +14,7 @@
 #include <key/stealth.h>
 
 static const size_t DEFAULT_STEALTH_LOOKAHEAD_SIZE = 5;
+static const bool DEFAULT_RESCAN_BLOCK_FILTER = false;
 
 //! -fallbackfee default
 static const CAmount DEFAULT_FALLBACK_FEE_GIO = 20000;
@@ -380,7 +381,7 @@ public:
     int UnloadSpent(const uint256 &wtxid, int depth, const uint256 &wtxid_from);
     void PostProcessUnloadSpent();
 
-    using CWallet::AddToSpends;
+    void AddToSpends(const COutPoint& outpoint, const uint256& wtxid) override EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
     void AddToSpends(const uint256& wtxid) override EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
     bool AddToWalletIfInvolvingMe(const CTransactionRef& ptx, CWalletTx::Confirmation confirm, bool fUpdate) override EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
@@ -401,10 +402,20 @@ public:
 
     bool AddTxinToSpends(const CTxIn &txin, const uint256 &txhash);
 
+    //! Return the index of unspent owned record outputs of nType, nullptr if the type isn't indexed
+    COwnedOutputIndex *GetOwnedOutputIndex(uint8_t nType);
+    //! Add or remove record outputs from the owned output indices after their record or spends changed
+    void UpdateOwnedOutput(const COutPoint &op) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    void UpdateOwnedOutput(const uint256 &txhash, const COutputRecord &r, bool fRemove=false) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    void UpdateOwnedOutputs(const uint256 &txhash, const CTransactionRecord &rtx, bool fRemove=false) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    //! Anon outputs can't be spent once the exploit fix is active
+    bool IsAnonSpendDisabled() const;
+
     bool ProcessPlaceholder(CHDWalletDB *pwdb, const CTransaction &tx, CTransactionRecord &rtx);
     bool AddToRecord(CTransactionRecord &rtxIn, const CTransaction &tx, CWalletTx::Confirmation confirm, bool fFlushOnClose=true);
 
     ScanResult ScanForWalletTransactions(const uint256& first_block, const uint256& last_block, const WalletRescanReserver& reserver, bool fUpdate) override;
+    bool GetRescanFilterElements(GCSFilter::ElementSet& elements) override;
     std::vector<uint256> ResendRecordTransactionsBefore(int64_t nTime);
     void ResendWalletTransactions() override;
 
@@ -507,6 +518,11 @@ public:
     RtxOrdered_t rtxOrdered;
     mutable MapRecords_t mapTempRecords; // Hack for sending unmined inputs through fundrawtransactionfrom
 
+    // Unspent owned outputs of mapRecords by type, coin selection starts from these
+    COwnedOutputIndex m_owned_standard;
+    COwnedOutputIndex m_owned_blind;
+    COwnedOutputIndex m_owned_anon;
+
     std::vector<CVoteToken> vVoteTokens;
 
     // Staking Settings
@@ -541,6 +557,8 @@ public:
 
     size_t m_rescan_stealth_v1_lookahead = DEFAULT_STEALTH_LOOKAHEAD_SIZE;
     size_t m_rescan_stealth_v2_lookahead = DEFAULT_STEALTH_LOOKAHEAD_SIZE;
+    bool m_rescan_block_filter = DEFAULT_RESCAN_BLOCK_FILTER;
+    bool m_rescan_filter_active = false; // Set while a rescan matches block filters
 
     bool m_smsg_enabled = true;
 
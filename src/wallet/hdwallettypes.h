@@ -13,6 +13,7 @@
 
 #include <stdint.h>
 #include <map>
+#include <set>
 #include <vector>
 #include <string>
 
@@ -275,6 +276,49 @@ public:
     bool fNeedHardwareKey;
 };
 
+/** Unspent owned outputs of one type, ordered by amount */
+class COwnedOutputIndex
+{
+public:
+    typedef std::set<std::pair<CAmount, COutPoint> > ByValue_t;
+
+    void Add(const COutPoint &op, CAmount nValue)
+    {
+        Remove(op);
+        mapValues[op] = nValue;
+        setByValue.insert(std::make_pair(nValue, op));
+    };
+
+    void Remove(const COutPoint &op)
+    {
+        std::map<COutPoint, CAmount>::iterator it = mapValues.find(op);
+        if (it == mapValues.end()) {
+            return;
+        }
+        setByValue.erase(std::make_pair(it->second, op));
+        mapValues.erase(it);
+    };
+
+    void Clear()
+    {
+        setByValue.clear();
+        mapValues.clear();
+    };
+
+    size_t Size() const { return setByValue.size(); };
+
+    //! First output with an amount of at least nMinimumAmount
+    ByValue_t::const_iterator LowerBound(CAmount nMinimumAmount) const
+    {
+        return setByValue.lower_bound(std::make_pair(nMinimumAmount, COutPoint(uint256(), 0)));
+    };
+    ByValue_t::const_iterator End() const { return setByValue.end(); };
+
+private:
+    ByValue_t setByValue;
+    std::map<COutPoint, CAmount> mapValues;
+};
+
 class CHDWalletBalances
 {
 public:
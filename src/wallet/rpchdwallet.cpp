@@ -20,6 +20,7 @@
 #include <timedata.h>
 #include <util/string.h>
 #include <txdb.h>
+#include <index/voteindex.h>
 #include <blind.h>
 #include <anon.h>
 #include <util/moneystr.h>
@@ -35,6 +36,7 @@
 #include <key/mnemonic.h>
 #include <pos/miner.h>
 #include <crypto/sha256.h>
+#include <lz4/lz4.h>
 #include <warnings.h>
 #include <shutdown.h>
 #include <txmempool.h>
@@ -6428,43 +6430,49 @@ static UniValue tallyvotes(const JSONRPCRequest &request)
     std::pair<std::map<int, int>::iterator, bool> ri;
 
     int nBlocks = 0;
-    CBlockIndex *pindex = ::ChainActive().Tip();
-    if (pindex)
-    do {
-        if (pindex->nHeight < nStartHeight) {
-            break;
-        }
-        if (pindex->nHeight <= nEndHeight) {
-            if (!ReadBlockFromDisk(block, pindex, consensusParams)) {
-                continue;
+    if (!g_vote_index || !g_vote_index->BlockUntilSyncedToCurrentChain()
+        || !g_vote_index->TallyVotes(issue, nStartHeight, nEndHeight, mapVotes, nBlocks)) {
+        // Read the coinstakes from disk
+        mapVotes.clear();
+        nBlocks = 0;
+        CBlockIndex *pindex = ::ChainActive().Tip();
+        if (pindex)
+        do {
+            if (pindex->nHeight < nStartHeight) {
+                break;
             }
+            if (pindex->nHeight <= nEndHeight) {
+                if (!ReadBlockFromDisk(block, pindex, consensusParams)) {
+                    continue;
+                }
 
-            if (block.vtx.size() < 1
-                || !block.vtx[0]->IsCoinStake()) {
-                continue;
-            }
+                if (block.vtx.size() < 1
+                    || !block.vtx[0]->IsCoinStake()) {
+                    continue;
+                }
 
-            std::vector<uint8_t> &vData = ((CTxOutData*)block.vtx[0]->vpout[0].get())->vData;
-            if (vData.size() < 9 || vData[4] != DO_VOTE) {
-                ri = mapVotes.insert(std::pair<int, int>(0, 1));
-                if (!ri.second) ri.first->second++;
-            } else {
-                uint32_t voteToken;
-                memcpy(&voteToken, &vData[5], 4);
-                int option = 0; // default to abstain
+                std::vector<uint8_t> &vData = ((CTxOutData*)block.vtx[0]->vpout[0].get())->vData;
+                if (vData.size() < 9 || vData[4] != DO_VOTE) {
+                    ri = mapVotes.insert(std::pair<int, int>(0, 1));
+                    if (!ri.second) ri.first->second++;
+                } else {
+                    uint32_t voteToken;
+                    memcpy(&voteToken, &vData[5], 4);
+                    int option = 0; // default to abstain
+
+                    // count only if related to current issue:
+                    if ((int) (voteToken & 0xFFFF) == issue) {
+                        option = (voteToken >> 16) & 0xFFFF;
+                    }
 
-                // count only if related to current issue:
-                if ((int) (voteToken & 0xFFFF) == issue) {
-                    option = (voteToken >> 16) & 0xFFFF;
+                    ri = mapVotes.insert(std::pair<int, int>(option, 1));
+                    if (!ri.second) ri.first->second++;
                 }
 
-                ri = mapVotes.insert(std::pair<int, int>(option, 1));
-                if (!ri.second) ri.first->second++;
+                nBlocks++;
             }
-
-            nBlocks++;
-        }
-    } while ((pindex = pindex->pprev));
+        } while ((pindex = pindex->pprev));
+    }
 
     UniValue result(UniValue::VOBJ);
     result.pushKV("proposal", issue);
@@ -7895,7 +7903,9 @@ static UniValue verifyrawtransaction(const JSONRPCRequest &request)
                 }
                 std::vector<uint8_t> vchCommitment = ParseHex(s);
                 CHECK_NONFATAL(vchCommitment.size() == 33);
-                memcpy(newcoin.commitment.data, vchCommitment.data(), 33);
+                secp256k1_pedersen_commitment commitment = {};
+                memcpy(commitment.data, vchCommitment.data(), 33);
+                newcoin.SetCommitment(commitment);
                 newcoin.nType = OUTPUT_CT;
             } else {
                 throw JSONRPCError(RPC_INVALID_PARAMETER, "\"amount\" or \"amount_commitment\" is required");
@@ -7954,7 +7964,7 @@ static UniValue verifyrawtransaction(const JSONRPCRequest &request)
         } else
         if (coin.nType == OUTPUT_CT) {
             vchAmount.resize(33);
-            memcpy(vchAmount.data(), coin.commitment.data, 33);
+            memcpy(vchAmount.data(), coin.GetCommitment().data, 33);
         } else {
             throw JSONRPCError(RPC_MISC_ERROR, strprintf("Bad input type: %d", coin.nType));
         }
@@ -8004,6 +8014,7 @@ static bool PruneBlockFile(FILE *fp, bool test_only, size_t &num_blocks_in_file,
         nRewind++; // start one byte further next time, in case of failure
         blkdat.SetLimit(); // remove former limit
         unsigned int nSize = 0;
+        bool compressed = false;
         try {
             // locate a header
             unsigned char buf[CMessageHeader::MESSAGE_START_SIZE];
@@ -8014,7 +8025,9 @@ static bool PruneBlockFile(FILE *fp, bool test_only, size_t &num_blocks_in_file,
                 continue;
             // read size
             blkdat >> nSize;
-            if (nSize < 80 || nSize > MAX_BLOCK_SERIALIZED_SIZE)
+            compressed = nSize & BLOCKFILE_RECORD_COMPRESSED;
+            nSize &= ~BLOCKFILE_RECORD_COMPRESSED;
+            if (nSize < (compressed ? 4 : 80) || nSize > (compressed ? LZ4_COMPRESSBOUND(MAX_BLOCK_SERIALIZED_SIZE) + 4 : MAX_BLOCK_SERIALIZED_SIZE))
                 continue;
         } catch (const std::exception&) {
             // no valid block header found; don't complain
@@ -8027,7 +8040,18 @@ static bool PruneBlockFile(FILE *fp, bool test_only, size_t &num_blocks_in_file,
             blkdat.SetPos(nBlockPos);
             std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
             CBlock& block = *pblock;
-            blkdat >> block;
+            std::vector<uint8_t> record;
+            if (compressed) {
+                std::vector<uint8_t> data;
+                record.resize(nSize);
+                blkdat.read((char*)record.data(), nSize);
+                if (!DecompressBlockRecord(record, data)) {
+                    throw std::ios_base::failure("decompression failed");
+                }
+                VectorReader(SER_DISK, CLIENT_VERSION, data, 0) >> block;
+            } else {
+                blkdat >> block;
+            }
             uint256 blockhash = block.GetHash();
             nRewind = blkdat.GetPos();
 
@@ -8038,8 +8062,13 @@ static bool PruneBlockFile(FILE *fp, bool test_only, size_t &num_blocks_in_file,
                 num_blocks_removed++;
             } else
             if (!test_only) {
-                fileout << chainparams.MessageStart() << nSize;
-                fileout << block;
+                if (compressed) {
+                    fileout << chainparams.MessageStart() << (nSize | BLOCKFILE_RECORD_COMPRESSED);
+                    fileout.write((const char*)record.data(), record.size());
+                } else {
+                    fileout << chainparams.MessageStart() << nSize;
+                    fileout << block;
+                }
             }
         } catch (const std::exception& e) {
             return error("%s: Deserialize or I/O error - %s\n", __func__, e.what());
@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <memory>
+#include <thread>
 
 #include <boost/test/unit_test.hpp>
 
@@ -69,4 +70,55 @@ BOOST_AUTO_TEST_CASE(getwalletenv_g_dbenvs_free_instance)
     BOOST_CHECK(env_2_a == env_2_b);
 }
 
+BOOST_AUTO_TEST_CASE(group_txn)
+{
+    std::unique_ptr<BerkeleyDatabase> database = BerkeleyDatabase::CreateMock();
+    int value;
+
+    BerkeleyBatch group(*database, "cr+", false);
+    BOOST_CHECK(group.TxnBeginGroup());
+    BOOST_CHECK(!group.TxnBeginGroup());
+    {
+        // Batches opened on the same thread join the group transaction
+        BerkeleyBatch batch(*database, "r+", false);
+        BOOST_CHECK(batch.Txn() == group.Txn());
+        BOOST_CHECK(!batch.TxnCommitGroup());
+        BOOST_CHECK(batch.Write(std::string("a"), 1));
+
+        // Transactions begun inside the group are children of it
+        BOOST_CHECK(batch.TxnBegin());
+        BOOST_CHECK(batch.Txn() != group.Txn());
+        BOOST_CHECK(batch.Write(std::string("b"), 2));
+        BOOST_CHECK(batch.TxnCommit());
+        BOOST_CHECK(batch.TxnBegin());
+        BOOST_CHECK(batch.Write(std::string("c"), 3));
+        BOOST_CHECK(batch.TxnAbort());
+
+        BOOST_CHECK(batch.Read(std::string("b"), value) && value == 2);
+        BOOST_CHECK(!batch.Exists(std::string("c")));
+    }
+
+    // Batches on other threads don't
+    bool other_in_group = true;
+    std::thread([&database, &other_in_group] {
+        BerkeleyBatch other(*database, "r", false);
+        other_in_group = other.Txn() != nullptr;
+    }).join();
+    BOOST_CHECK(!other_in_group);
+
+    BOOST_CHECK(group.TxnCommitGroup());
+    BerkeleyBatch batch(*database, "r", false);
+    BOOST_CHECK(batch.Txn() == nullptr);
+    BOOST_CHECK(batch.Read(std::string("a"), value) && value == 1);
+    BOOST_CHECK(batch.Read(std::string("b"), value) && value == 2);
+
+    // Aborting the group discards its writes
+    BOOST_CHECK(group.TxnBeginGroup());
+    BOOST_CHECK(group.Write(std::string("d"), 4));
+    BOOST_CHECK(group.TxnAbort());
+    BOOST_CHECK(!batch.Exists(std::string("d")));
+    BOOST_CHECK(group.TxnBeginGroup());
+    BOOST_CHECK(group.TxnCommitGroup());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
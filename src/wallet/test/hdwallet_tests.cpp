@@ -596,4 +596,40 @@ BOOST_AUTO_TEST_CASE(opiscoinstake_test)
 }
 
 
+BOOST_AUTO_TEST_CASE(owned_output_index)
+{
+    COwnedOutputIndex index;
+    COutPoint op1(uint256S("01"), 0), op2(uint256S("02"), 1), op3(uint256S("03"), 0);
+
+    index.Add(op1, 5 * COIN);
+    index.Add(op2, 1 * COIN);
+    index.Add(op3, 3 * COIN);
+    BOOST_CHECK(index.Size() == 3);
+
+    // Ordered by amount, starting from the minimum
+    auto it = index.LowerBound(2 * COIN);
+    BOOST_CHECK(it != index.End() && it->second == op3);
+    ++it;
+    BOOST_CHECK(it != index.End() && it->second == op1);
+    ++it;
+    BOOST_CHECK(it == index.End());
+    BOOST_CHECK(index.LowerBound(6 * COIN) == index.End());
+
+    // Re-adding an output replaces its amount
+    index.Add(op1, 1 * COIN);
+    BOOST_CHECK(index.Size() == 3);
+    BOOST_CHECK(index.LowerBound(1 * COIN)->first == 1 * COIN);
+    BOOST_CHECK(index.LowerBound(2 * COIN)->second == op3);
+
+    index.Remove(op3);
+    index.Remove(op3);
+    BOOST_CHECK(index.Size() == 2);
+    BOOST_CHECK(index.LowerBound(2 * COIN) == index.End());
+
+    index.Clear();
+    BOOST_CHECK(index.Size() == 0);
+    BOOST_CHECK(index.LowerBound(0) == index.End());
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -1104,11 +1104,18 @@ void CWallet::BlockConnected(const CBlock& block, const std::vector<CTransaction
 
     m_last_block_processed_height = height;
     m_last_block_processed = block_hash;
+
+    // Records, transactions and keys written for the block are committed together
+    WalletBatch batch(*database, "r+", false);
+    bool group_txn = batch.TxnBeginGroup();
     for (size_t index = 0; index < block.vtx.size(); index++) {
         CWalletTx::Confirmation confirm(CWalletTx::Status::CONFIRMED, height, block_hash, index);
         SyncTransaction(block.vtx[index], confirm);
         TransactionRemovedFromMempool(block.vtx[index]);
     }
+    if (group_txn && !batch.TxnCommitGroup()) {
+        WalletLogPrintf("%s: TxnCommitGroup failed for block %s.\n", __func__, block_hash.ToString());
+    }
     for (const CTransactionRef& ptx : vtxConflicted) {
         TransactionRemovedFromMempool(ptx);
     }
@@ -1770,6 +1777,15 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
         progress_end = chain().guessVerificationProgress(stop_block.IsNull() ? tip_hash : stop_block);
     }
     double progress_current = progress_begin;
+
+    // Blocks whose filter matches none of the wallet's scripts are not read
+    GCSFilter::ElementSet filter_elements;
+    bool use_filter = chain().hasBlockFilterIndex(BlockFilterType::BASIC) && GetRescanFilterElements(filter_elements);
+    size_t blocks_skipped = 0;
+    size_t blocks_since_flush = 0;
+    if (use_filter) {
+        WalletLogPrintf("Rescan using the basic block filter index, %u scripts\n", filter_elements.size());
+    }
     while (block_height && !fAbortRescan && !chain().shutdownRequested()) {
         m_scanning_progress = (progress_current - progress_begin) / (progress_end - progress_begin);
         if (*block_height % 100 == 0 && progress_end - progress_begin > 0.0) {
@@ -1780,7 +1796,18 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
             WalletLogPrintf("Still rescanning. At block %d. Progress=%f\n", *block_height, progress_current);
         }
 
+        Optional<bool> filter_match;
+        if (use_filter) {
+            filter_match = chain().blockFilterMatchesAny(BlockFilterType::BASIC, block_hash, filter_elements);
+        }
+
         CBlock block;
+        if (filter_match && !*filter_match) {
+            // Nothing in the block pays to or spends from the wallet
+            result.last_scanned_block = block_hash;
+            result.last_scanned_height = *block_height;
+            blocks_skipped++;
+        } else
         if (chain().findBlock(block_hash, &block) && !block.IsNull()) {
             auto locked_chain = chain().lock();
             LOCK(cs_wallet);
@@ -1793,13 +1820,24 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
                 result.status = ScanResult::FAILURE;
                 break;
             }
+            // Writes for the block are committed together, the log is checkpointed every RESCAN_FLUSH_BLOCKS
+            WalletBatch batch(*database, "r+", ++blocks_since_flush % RESCAN_FLUSH_BLOCKS == 0);
+            bool group_txn = batch.TxnBeginGroup();
             for (size_t posInBlock = 0; posInBlock < block.vtx.size(); ++posInBlock) {
                 CWalletTx::Confirmation confirm(CWalletTx::Status::CONFIRMED, *block_height, block_hash, posInBlock);
                 SyncTransaction(block.vtx[posInBlock], confirm, fUpdate);
             }
+            if (group_txn && !batch.TxnCommitGroup()) {
+                WalletLogPrintf("%s: TxnCommitGroup failed for block %s.\n", __func__, block_hash.ToString());
+            }
             // scan succeeded, record block as most recent successfully scanned
             result.last_scanned_block = block_hash;
             result.last_scanned_height = *block_height;
+            if (filter_match) {
+                // The block may have moved the wallet's lookahead
+                filter_elements.clear();
+                use_filter = GetRescanFilterElements(filter_elements);
+            }
         } else {
             // could not scan block, keep scanning but record this block as the most recent failure
             result.last_failed_block = block_hash;
@@ -1840,6 +1878,9 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
     } else {
         WalletLogPrintf("Rescan completed in %15dms\n", GetTimeMillis() - start_time);
     }
+    if (blocks_skipped > 0) {
+        WalletLogPrintf("Rescan skipped %u blocks not matching the block filter\n", blocks_skipped);
+    }
     return result;
 }
 
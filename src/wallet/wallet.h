@@ -89,6 +89,8 @@ constexpr CAmount DEFAULT_TRANSACTION_MAXFEE_BTC{COIN / 10};
 constexpr CAmount HIGH_TX_FEE_PER_KB{COIN / 100};
 //! -maxtxfee will warn if called with a higher fee than this amount (in satoshis)
 constexpr CAmount HIGH_MAX_TX_FEE{100 * HIGH_TX_FEE_PER_KB};
+//! Blocks scanned between wallet database log checkpoints during a rescan
+static constexpr size_t RESCAN_FLUSH_BLOCKS = 100;
 
 //! Pre-calculated constants for input size estimation in *virtual size*
 static constexpr size_t DUMMY_NESTED_P2WPKH_INPUT_SIZE = 91;
@@ -671,7 +673,7 @@ private:
      */
     typedef std::multimap<COutPoint, uint256> TxSpends;
     TxSpends mapTxSpends GUARDED_BY(cs_wallet);
-    void AddToSpends(const COutPoint& outpoint, const uint256& wtxid) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    virtual void AddToSpends(const COutPoint& outpoint, const uint256& wtxid) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
     virtual void AddToSpends(const uint256& wtxid) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
     /**
@@ -930,6 +932,9 @@ public:
         uint256 last_failed_block;
     };
     virtual ScanResult ScanForWalletTransactions(const uint256& first_block, const uint256& last_block, const WalletRescanReserver& reserver, bool fUpdate);
+    //! Fill elements with every script a transaction relevant to the wallet must
+    //! pay to or spend from, returns false if blocks can't be skipped by their filter.
+    virtual bool GetRescanFilterElements(GCSFilter::ElementSet& elements) { return false; }
     void TransactionRemovedFromMempool(const CTransactionRef &ptx) override;
     void ReacceptWalletTransactions() EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
     std::vector<uint256> ResendWalletTransactionsBefore(int64_t nTime);
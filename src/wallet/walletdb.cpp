@@ -832,6 +832,16 @@ bool WalletBatch::TxnAbort()
     return m_batch.TxnAbort();
 }
 
+bool WalletBatch::TxnBeginGroup()
+{
+    return m_batch.TxnBeginGroup();
+}
+
+bool WalletBatch::TxnCommitGroup()
+{
+    return m_batch.TxnCommitGroup();
+}
+
 bool WalletBatch::WriteLockedUnspentOutput(const COutPoint &o)
 {
     bool tmp = true;
@@ -280,6 +280,10 @@ public:
     bool TxnCommit();
     //! Abort current transaction
     bool TxnAbort();
+    //! Begin a transaction every batch used by this thread writes through, see BerkeleyBatch::TxnBeginGroup
+    bool TxnBeginGroup();
+    //! Commit the group transaction
+    bool TxnCommitGroup();
 
     bool WriteLockedUnspentOutput(const COutPoint &o);
     bool EraseLockedUnspentOutput(const COutPoint &o);
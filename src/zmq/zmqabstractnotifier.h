@@ -7,6 +7,9 @@
 
 #include <zmq/zmqconfig.h>
 
+#include <memory>
+
+class CBlock;
 class CBlockIndex;
 namespace smsg {
 class SecureMessage;
@@ -43,9 +46,15 @@ public:
     virtual bool Initialize(void *pcontext) = 0;
     virtual void Shutdown() = 0;
 
-    virtual bool NotifyBlock(const CBlockIndex *pindex);
+    //! pblock is the block at pindex if it is still in memory, or null
+    virtual bool NotifyBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock> &pblock);
     virtual bool NotifyTransaction(const CTransaction &transaction);
 
+    virtual bool NotifyBlockConnect(const CBlockIndex *pindex);
+    virtual bool NotifyBlockDisconnect(const CBlockIndex *pindex);
+    virtual bool NotifyTransactionAcceptance(const CTransaction &transaction);
+    virtual bool NotifyTransactionRemoval(const CTransaction &transaction);
+
     virtual bool NotifyTransaction(const std::string &sWalletName, const CTransaction &transaction);
     virtual bool NotifySecureMessage(const smsg::SecureMessage *psmsg, const uint160 &hash);
 
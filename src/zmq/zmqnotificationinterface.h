@@ -32,6 +32,7 @@ protected:
 
     // CValidationInterface
     void TransactionAddedToMempool(const CTransactionRef& tx) override;
+    void TransactionRemovedFromMempool(const CTransactionRef& tx) override;
     void BlockConnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindexConnected, const std::vector<CTransactionRef>& vtxConflicted) override;
     void BlockDisconnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindexDisconnected) override;
     void UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlockIndex *pindexFork, bool fInitialDownload) override;
@@ -42,9 +43,15 @@ protected:
 private:
     CZMQNotificationInterface();
 
+    void NotifyTransaction(const CTransaction& tx);
+
     void *pcontext;
     std::list<CZMQAbstractNotifier*> notifiers;
 
+    //! Last block connected, passed to the notifiers by UpdatedBlockTip if it's the new tip
+    std::shared_ptr<const CBlock> m_last_connected_block;
+    const CBlockIndex *m_last_connected_index = nullptr;
+
     bool IsWhitelistedRange(const CNetAddr &addr);
     void ThreadZAP();
     std::thread threadZAP;
@@ -12,15 +12,20 @@
 #include <util/strencodings.h>
 #include <smsg/smessage.h>
 #include <compat/byteswap.h>
+#include <sync.h>
 
 static std::multimap<std::string, CZMQAbstractPublishNotifier*> mapPublishNotifiers;
 
+//! Serialises sends, wallet and smsg notifications arrive on other threads than validation notifications
+static Mutex g_send_mutex;
+
 static const char *MSG_HASHBLOCK = "hashblock";
 static const char *MSG_HASHTX    = "hashtx";
 static const char *MSG_RAWBLOCK  = "rawblock";
 static const char *MSG_RAWTX     = "rawtx";
 static const char *MSG_HASHWTX   = "hashwtx";
 static const char *MSG_SMSG      = "smsg";
+static const char *MSG_SEQUENCE  = "sequence";
 
 // Internal function to send multipart message
 static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
@@ -173,6 +178,7 @@ void CZMQAbstractPublishNotifier::Shutdown()
 bool CZMQAbstractPublishNotifier::SendMessage(const char *command, const void* data, size_t size)
 {
     assert(psocket);
+    LOCK(g_send_mutex);
 
     /* send three parts, command & data & a LE 4byte sequence number */
     unsigned char msgseq[sizeof(uint32_t)];
@@ -187,7 +193,55 @@ bool CZMQAbstractPublishNotifier::SendMessage(const char *command, const void* d
     return true;
 }
 
-bool CZMQPublishHashBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
+static void zmq_free_stream(void * /*data*/, void *hint)
+{
+    delete static_cast<CDataStream*>(hint);
+}
+
+bool CZMQAbstractPublishNotifier::SendMessage(const char *command, std::unique_ptr<CDataStream> data)
+{
+    assert(psocket);
+    LOCK(g_send_mutex);
+
+    // Set up the data part before sending the command part, a failure after that would leave a partial multipart message
+    zmq_msg_t msg;
+    CDataStream *pdata = data.get();
+    if (zmq_msg_init_data(&msg, pdata->data(), pdata->size(), zmq_free_stream, pdata) != 0)
+    {
+        zmqError("Unable to initialize ZMQ msg");
+        return false;
+    }
+    data.release(); // msg owns the stream now
+
+    if (zmq_send(psocket, command, strlen(command), ZMQ_SNDMORE) == -1)
+    {
+        zmqError("Unable to send ZMQ msg");
+        zmq_msg_close(&msg);
+        return false;
+    }
+
+    int rc = zmq_msg_send(&msg, psocket, ZMQ_SNDMORE);
+    zmq_msg_close(&msg);
+    if (rc == -1)
+    {
+        zmqError("Unable to send ZMQ msg");
+        return false;
+    }
+
+    unsigned char msgseq[sizeof(uint32_t)];
+    WriteLE32(&msgseq[0], nSequence);
+    if (zmq_send(psocket, msgseq, sizeof(msgseq), 0) == -1)
+    {
+        zmqError("Unable to send ZMQ msg");
+        return false;
+    }
+
+    nSequence++;
+
+    return true;
+}
+
+bool CZMQPublishHashBlockNotifier::NotifyBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock> &/*pblock*/)
 {
     uint256 hash = pindex->GetBlockHash();
     LogPrint(BCLog::ZMQ, "zmq: Publish hashblock %s\n", hash.GetHex());
@@ -207,13 +261,15 @@ bool CZMQPublishHashTransactionNotifier::NotifyTransaction(const CTransaction &t
     return SendMessage(MSG_HASHTX, data, 32);
 }
 
-bool CZMQPublishRawBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
+bool CZMQPublishRawBlockNotifier::NotifyBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock> &pblock)
 {
     LogPrint(BCLog::ZMQ, "zmq: Publish rawblock %s\n", pindex->GetBlockHash().GetHex());
 
-    const Consensus::Params& consensusParams = Params().GetConsensus();
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
-    {
+    std::unique_ptr<CDataStream> ss = MakeUnique<CDataStream>(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
+    if (pblock) {
+        *ss << *pblock;
+    } else {
+        const Consensus::Params& consensusParams = Params().GetConsensus();
         LOCK(cs_main);
         CBlock block;
         if(!ReadBlockFromDisk(block, pindex, consensusParams))
@@ -222,19 +278,19 @@ bool CZMQPublishRawBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
             return false;
         }
 
-        ss << block;
+        *ss << block;
     }
 
-    return SendMessage(MSG_RAWBLOCK, &(*ss.begin()), ss.size());
+    return SendMessage(MSG_RAWBLOCK, std::move(ss));
 }
 
 bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &transaction)
 {
     uint256 hash = transaction.GetHash();
     LogPrint(BCLog::ZMQ, "zmq: Publish rawtx %s\n", hash.GetHex());
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
-    ss << transaction;
-    return SendMessage(MSG_RAWTX, &(*ss.begin()), ss.size());
+    std::unique_ptr<CDataStream> ss = MakeUnique<CDataStream>(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
+    *ss << transaction;
+    return SendMessage(MSG_RAWTX, std::move(ss));
 }
 
 bool CZMQPublishHashWalletTransactionNotifier::NotifyTransaction(const std::string &sWalletName, const CTransaction &transaction)
@@ -263,3 +319,52 @@ bool CZMQPublishSMSGNotifier::NotifySecureMessage(const smsg::SecureMessage *psm
     ss << hash;
     return SendMessage(MSG_SMSG, &(*ss.begin()), ss.size());
 }
+
+bool CZMQPublishSequenceNotifier::SendSequenceMsg(char label, const uint256 &hash, const std::string &suffix)
+{
+    std::vector<uint8_t> data(1 + 32 + suffix.size());
+    data[0] = label;
+    for (unsigned int i = 0; i < 32; i++)
+        data[32 - i] = hash.begin()[i];
+    memcpy(data.data() + 33, suffix.data(), suffix.size());
+    return SendMessage(MSG_SEQUENCE, data.data(), data.size());
+}
+
+bool CZMQPublishSequenceNotifier::NotifyBlockConnect(const CBlockIndex *pindex)
+{
+    LogPrint(BCLog::ZMQ, "zmq: Publish sequence block connect %s\n", pindex->GetBlockHash().GetHex());
+    return SendSequenceMsg('C', pindex->GetBlockHash());
+}
+
+bool CZMQPublishSequenceNotifier::NotifyBlockDisconnect(const CBlockIndex *pindex)
+{
+    LogPrint(BCLog::ZMQ, "zmq: Publish sequence block disconnect %s\n", pindex->GetBlockHash().GetHex());
+    return SendSequenceMsg('D', pindex->GetBlockHash());
+}
+
+bool CZMQPublishSequenceNotifier::NotifyTransactionAcceptance(const CTransaction &transaction)
+{
+    LogPrint(BCLog::ZMQ, "zmq: Publish sequence mempool acceptance %s\n", transaction.GetHash().GetHex());
+    return SendSequenceMsg('A', transaction.GetHash());
+}
+
+bool CZMQPublishSequenceNotifier::NotifyTransactionRemoval(const CTransaction &transaction)
+{
+    LogPrint(BCLog::ZMQ, "zmq: Publish sequence mempool removal %s\n", transaction.GetHash().GetHex());
+    return SendSequenceMsg('R', transaction.GetHash());
+}
+
+bool CZMQPublishSequenceNotifier::NotifyTransaction(const std::string &sWalletName, const CTransaction &transaction)
+{
+    LogPrint(BCLog::ZMQ, "zmq: Publish sequence wallet transaction %s, %s\n", sWalletName, transaction.GetHash().GetHex());
+    return SendSequenceMsg('W', transaction.GetHash(), sWalletName.size() > 96 ? "" : sWalletName);
+}
+
+bool CZMQPublishSequenceNotifier::NotifySecureMessage(const smsg::SecureMessage *psmsg, const uint160 &hash)
+{
+    LogPrint(BCLog::ZMQ, "zmq: Publish sequence smsg %s\n", hash.GetHex());
+    uint8_t data[1 + 20];
+    data[0] = 'S';
+    memcpy(&data[1], hash.begin(), 20);
+    return SendMessage(MSG_SEQUENCE, data, sizeof(data));
+}
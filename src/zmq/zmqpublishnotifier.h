@@ -7,7 +7,10 @@
 
 #include <zmq/zmqabstractnotifier.h>
 
+#include <memory>
+
 class CBlockIndex;
+class CDataStream;
 
 class CZMQAbstractPublishNotifier : public CZMQAbstractNotifier
 {
@@ -24,6 +27,11 @@ public:
     */
     bool SendMessage(const char *command, const void* data, size_t size);
 
+    /* send zmq multipart message as above,
+       the data part is passed to zmq without copying and freed once sent
+    */
+    bool SendMessage(const char *command, std::unique_ptr<CDataStream> data);
+
     bool Initialize(void *pcontext) override;
     void Shutdown() override;
 };
@@ -31,7 +39,7 @@ public:
 class CZMQPublishHashBlockNotifier : public CZMQAbstractPublishNotifier
 {
 public:
-    bool NotifyBlock(const CBlockIndex *pindex) override;
+    bool NotifyBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock> &pblock) override;
 };
 
 class CZMQPublishHashTransactionNotifier : public CZMQAbstractPublishNotifier
@@ -43,7 +51,7 @@ public:
 class CZMQPublishRawBlockNotifier : public CZMQAbstractPublishNotifier
 {
 public:
-    bool NotifyBlock(const CBlockIndex *pindex) override;
+    bool NotifyBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock> &pblock) override;
 };
 
 class CZMQPublishRawTransactionNotifier : public CZMQAbstractPublishNotifier
@@ -64,5 +72,27 @@ public:
     bool NotifySecureMessage(const smsg::SecureMessage *psmsg, const uint160 &hash) override;
 };
 
+/* Publishes chain, mempool, wallet and secure message events in a single
+   sequence, the message sequence number lets subscribers detect missed events.
+   The body is a one byte label followed by a hash:
+     C / D: block hash, block connected / disconnected
+     A / R: txid, transaction added to / removed from the mempool
+     W: txid followed by the wallet name, transaction added to a wallet
+     S: 20 byte secure message hash, new secure message
+*/
+class CZMQPublishSequenceNotifier : public CZMQAbstractPublishNotifier
+{
+private:
+    bool SendSequenceMsg(char label, const uint256 &hash, const std::string &suffix = "");
+
+public:
+    bool NotifyBlockConnect(const CBlockIndex *pindex) override;
+    bool NotifyBlockDisconnect(const CBlockIndex *pindex) override;
+    bool NotifyTransactionAcceptance(const CTransaction &transaction) override;
+    bool NotifyTransactionRemoval(const CTransaction &transaction) override;
+    bool NotifyTransaction(const std::string &sWalletName, const CTransaction &transaction) override;
+    bool NotifySecureMessage(const smsg::SecureMessage *psmsg, const uint160 &hash) override;
+};
+
 
 #endif // BITCOIN_ZMQ_ZMQPUBLISHNOTIFIER_H
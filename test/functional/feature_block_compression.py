@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+# Copyright (c) 2020 The Graviocoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test -blockcompression.
+
+- Blocks and undo data are written compressed after the option is enabled, files hold both kinds of records.
+- Compressed blocks and undo data are read when serving, disconnecting and reindexing blocks.
+- Compressed blocks are still read when the node is started without the option.
+- Old block files are converted and the txindex still finds the transactions of the moved blocks.
+"""
+import os
+import struct
+
+from test_framework.authproxy import JSONRPCException
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal, wait_until
+
+BLOCKFILE_RECORD_COMPRESSED = 0x80000000
+
+
+def read_record_flags(path, checksum_size=0):
+    """Return whether each record in a block or undo file is compressed"""
+    with open(path, 'rb') as f:
+        data = f.read()
+    magic = data[:4]
+    flags = []
+    pos = 0
+    while True:
+        # Skip space left between records, -reindex can leave gaps
+        pos = data.find(magic, pos)
+        if pos < 0 or pos + 8 > len(data):
+            break
+        size, = struct.unpack('<I', data[pos + 4:pos + 8])
+        flags.append(bool(size & BLOCKFILE_RECORD_COMPRESSED))
+        pos += 8 + (size & ~BLOCKFILE_RECORD_COMPRESSED) + checksum_size
+    return flags
+
+
+class BlockCompressionTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 1
+
+    def block_txs(self, heights):
+        node = self.nodes[0]
+        txs = {}
+        for h in heights:
+            for txid in node.getblock(node.getblockhash(h))['tx']:
+                txs[txid] = node.getrawtransaction(txid)
+        return txs
+
+    def txindex_synced(self):
+        node = self.nodes[0]
+        try:
+            node.getrawtransaction(node.getblock(node.getbestblockhash())['tx'][0])
+            return True
+        except JSONRPCException:
+            return False
+
+    def chain_state(self):
+        node = self.nodes[0]
+        return [node.getblock(node.getblockhash(h), 0) for h in range(node.getblockcount() + 1)]
+
+    def run_test(self):
+        node = self.nodes[0]
+        address = node.get_deterministic_priv_key().address
+        blocks_dir = os.path.join(node.datadir, 'regtest', 'blocks')
+        blk_path = os.path.join(blocks_dir, 'blk00000.dat')
+        rev_path = os.path.join(blocks_dir, 'rev00000.dat')
+
+        node.generatetoaddress(10, address)
+        self.stop_node(0)
+        assert_equal(read_record_flags(blk_path), [False] * 11)
+
+        self.log.info("New blocks and undo data are written compressed")
+        self.start_node(0, extra_args=['-blockcompression'])
+        node.generatetoaddress(5, address)
+        expected = self.chain_state()
+        self.stop_node(0)
+        assert_equal(read_record_flags(blk_path), [False] * 11 + [True] * 5)
+        assert_equal(read_record_flags(rev_path, 32), [False] * 10 + [True] * 5)
+
+        self.log.info("Compressed undo data is read when disconnecting blocks")
+        self.start_node(0, extra_args=['-blockcompression'])
+        assert_equal(self.chain_state(), expected)
+        tip = node.getbestblockhash()
+        block_hash = node.getblockhash(8)
+        node.invalidateblock(block_hash)
+        assert_equal(node.getblockcount(), 7)
+        node.reconsiderblock(block_hash)
+        assert_equal(node.getbestblockhash(), tip)
+
+        self.log.info("Reindex reads compressed blocks")
+        self.restart_node(0, extra_args=['-blockcompression', '-reindex'])
+        wait_until(lambda: node.getblockcount() == 15)
+        assert_equal(self.chain_state(), expected)
+
+        self.log.info("Compressed blocks are read without -blockcompression")
+        self.restart_node(0)
+        assert_equal(self.chain_state(), expected)
+        node.generatetoaddress(1, address)
+        self.stop_node(0)
+        assert_equal(read_record_flags(blk_path), [False] * 11 + [True] * 5 + [False])
+
+        self.log.info("Old block files are converted")
+        self.start_node(0, extra_args=['-fastprune', '-txindex'])
+        wait_until(lambda: self.txindex_synced())
+        while not os.path.exists(os.path.join(blocks_dir, 'blk00002.dat')):
+            node.generatetoaddress(50, address)
+        expected = self.chain_state()
+        old_heights = range(1, node.getblockcount() - 50)
+        expected_txs = self.block_txs(old_heights)
+        with node.assert_debug_log(['Not compressing block files while the txindex is disabled']):
+            self.restart_node(0, extra_args=['-fastprune', '-blockcompression'])
+        assert os.path.exists(blk_path)
+        with node.assert_debug_log(['Compressing block files done'], timeout=30):
+            self.restart_node(0, extra_args=['-fastprune', '-blockcompression', '-txindex', '-blockfilterindex'])
+        assert not os.path.exists(blk_path)
+        assert not os.path.exists(rev_path)
+        assert_equal(self.chain_state(), expected)
+        assert_equal(self.block_txs(old_heights), expected_txs)
+        # The files are removed once the block filter index synced from them
+        for height in old_heights:
+            node.getblockfilter(node.getblockhash(height))
+
+        self.log.info("The txindex still finds the moved transactions after a restart")
+        self.restart_node(0, extra_args=['-fastprune', '-txindex'])
+        assert_equal(self.block_txs(old_heights), expected_txs)
+
+if __name__ == '__main__':
+    BlockCompressionTest().main()
@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+# Copyright (c) 2020 The Graviocoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test the block index snapshot written at shutdown.
+
+- A clean shutdown writes the snapshot and the next start reads the block index from it.
+- An unclean shutdown, a corrupt snapshot or -noblockindexsnapshot fall back to the block tree db.
+- A snapshot written for another chainstate than the one on disk falls back to the block tree db.
+"""
+import os
+import shutil
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal, wait_until
+
+
+class BlockIndexSnapshotTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 1
+
+    def block_index_state(self):
+        node = self.nodes[0]
+        return [node.getblockheader(node.getblockhash(h)) for h in range(node.getblockcount() + 1)]
+
+    def run_test(self):
+        node = self.nodes[0]
+        snapshot_path = os.path.join(node.datadir, 'regtest', 'blocks', 'index.snapshot')
+        node.generatetoaddress(20, node.get_deterministic_priv_key().address)
+        expected = self.block_index_state()
+
+        self.log.info("Clean shutdown writes the snapshot, the next start loads it")
+        with node.assert_debug_log(['Wrote 21 block index entries to snapshot']):
+            self.stop_node(0)
+        assert os.path.isfile(snapshot_path)
+        with node.assert_debug_log(['Loaded 21 block index entries from snapshot']):
+            self.start_node(0)
+        assert_equal(self.block_index_state(), expected)
+
+        self.log.info("Snapshot is stale after an unclean shutdown")
+        node.generatetoaddress(5, node.get_deterministic_priv_key().address)
+        expected = self.block_index_state()
+        node.gettxoutsetinfo()  # Flush the new blocks
+        node.process.kill()
+        self.wait_for_node_exit(0, timeout=10)
+        with node.assert_debug_log(['Loaded best chain: hashBestChain={}'.format(expected[-1]['hash'])]):
+            self.start_node(0)
+        assert_equal(self.block_index_state(), expected)
+
+        self.log.info("Corrupt snapshot is rejected")
+        self.stop_node(0)
+        with open(snapshot_path, 'r+b') as f:
+            f.seek(200)
+            b = f.read(1)
+            f.seek(200)
+            f.write(bytes([b[0] ^ 0xff]))
+        with node.assert_debug_log(['Invalid block index snapshot']):
+            self.start_node(0)
+        assert_equal(self.block_index_state(), expected)
+
+        self.log.info("No snapshot is written with -noblockindexsnapshot")
+        self.restart_node(0, extra_args=['-noblockindexsnapshot'])
+        os.remove(snapshot_path)
+        self.stop_node(0)
+        assert not os.path.exists(snapshot_path)
+        self.start_node(0)
+        assert_equal(self.block_index_state(), expected)
+
+        self.log.info("Snapshot not matching the coin database is rejected")
+        chainstate_path = os.path.join(node.datadir, 'regtest', 'chainstate')
+        backup_path = os.path.join(node.datadir, 'chainstate.bak')
+        self.stop_node(0)
+        shutil.copytree(chainstate_path, backup_path)
+        self.start_node(0)
+        node.generatetoaddress(3, node.get_deterministic_priv_key().address)
+        expected = self.block_index_state()
+        self.stop_node(0)
+        shutil.rmtree(chainstate_path)
+        shutil.move(backup_path, chainstate_path)
+        with node.assert_debug_log(['does not match the coin database']):
+            self.start_node(0)
+        wait_until(lambda: node.getblockcount() == len(expected) - 1, timeout=10)
+        assert_equal(self.block_index_state(), expected)
+
+
+if __name__ == '__main__':
+    BlockIndexSnapshotTest().main()
@@ -8,10 +8,13 @@
 # Test addressindex generation and fetching
 #
 
+import http.client
+import json
 import time
+import urllib.parse
 
 from test_framework.test_graviocoin import GraviocoinTestFramework, connect_nodes_bi
-from test_framework.util import assert_equal
+from test_framework.util import assert_equal, assert_raises_rpc_error
 
 
 
@@ -23,7 +26,7 @@ class AddressIndexTest(GraviocoinTestFramework):
         self.extra_args = [
             # Nodes 0/1 are "wallet" nodes
             ['-debug',],
-            ['-debug','-addressindex'],
+            ['-debug','-addressindex','-rest'],
             # Nodes 2/3 are used for testing
             ['-debug','-addressindex',],
             ['-debug','-addressindex'],]
@@ -134,6 +137,9 @@ class AddressIndexTest(GraviocoinTestFramework):
         # Check that balances are correct
         balance0 = self.nodes[1].getaddressbalance("r8L81gLiWg46j5EGfZSp2JHmA9hBgLbHuf")
         assert_equal(balance0["balance"], 45 * 100000000)
+        assert_equal(balance0["received"], 45 * 100000000)
+        assert_equal(balance0["sent"], 0)
+        assert_equal(balance0["txcount"], 3)
 
 
         # Check that outputs with the same address will only return one txid
@@ -208,12 +214,71 @@ class AddressIndexTest(GraviocoinTestFramework):
         deltas = self.nodes[1].getaddressdeltas({"addresses": [address2], "start": 3, "end": 3})
         assert_equal(len(deltas), 1)
 
+        # Check that deltas and txids can be paged through
+        self.log.info("Testing pagination...")
+        paged_deltas = []
+        options = {"addresses": [address2], "limit": 1}
+        while True:
+            page = self.nodes[1].getaddressdeltas(options)
+            paged_deltas += page['deltas']
+            if 'cursor' not in page:
+                break
+            options['cursor'] = page['cursor']
+        assert_equal(paged_deltas, deltasAll)
+        page = self.nodes[1].getaddressdeltas({"addresses": [address2], "limit": 0})
+        assert_equal(page['deltas'], deltasAll)
+        assert 'cursor' not in page
+        assert_raises_rpc_error(-8, 'limit must be zero or positive', self.nodes[1].getaddressdeltas, {"addresses": [address2], "limit": -1})
+
+        url = urllib.parse.urlparse(self.nodes[1].url)
+        paged_deltas = []
+        uri = '/rest/address/deltas/1/' + address2
+        while True:
+            conn = http.client.HTTPConnection(url.hostname, url.port)
+            conn.request('GET', uri + '.json')
+            resp = conn.getresponse()
+            assert_equal(resp.status, 200)
+            page = json.loads(resp.read().decode('utf-8'))
+            paged_deltas += page['deltas']
+            if 'cursor' not in page:
+                break
+            uri = '/rest/address/deltas/1/' + address2 + '/' + page['cursor']
+        assert_equal(paged_deltas, deltasAll)
+
+        paged_txids = []
+        options = {"addresses": ['pqavEUgLCZeGh8o9sTcCfYVAsrTgnQTUsK', address2], "limit": 2}
+        while True:
+            page = self.nodes[1].getaddresstxids(options)
+            assert(len(page['txids']) <= 2)
+            paged_txids += page['txids']
+            if 'cursor' not in page:
+                break
+            options['cursor'] = page['cursor']
+        assert_equal(sorted(paged_txids), sorted(self.nodes[1].getaddresstxids({"addresses": ['pqavEUgLCZeGh8o9sTcCfYVAsrTgnQTUsK', address2]})))
+        assert_raises_rpc_error(-8, 'cursor must be', self.nodes[1].getaddresstxids, {"addresses": [address2], "cursor": "x"})
+        assert_equal(self.nodes[1].getaddresstxids({"addresses": [address2], "limit": 0})['txids'], self.nodes[1].getaddresstxids({"addresses": [address2]}))
+
         # Check that unspent outputs can be queried
         self.log.info("Testing utxos...")
         utxos = self.nodes[1].getaddressutxos({"addresses": [address2]})
         assert_equal(len(utxos), 2)
         assert_equal(utxos[0]["satoshis"], 1500000000)
 
+        paged_utxos = []
+        uri = '/rest/address/utxos/1/' + address2
+        while True:
+            conn = http.client.HTTPConnection(url.hostname, url.port)
+            conn.request('GET', uri + '.json')
+            resp = conn.getresponse()
+            assert_equal(resp.status, 200)
+            page = json.loads(resp.read().decode('utf-8'))
+            assert(len(page['utxos']) <= 1)
+            paged_utxos += page['utxos']
+            if 'cursor' not in page:
+                break
+            uri = '/rest/address/utxos/1/' + address2 + '/' + page['cursor']
+        assert_equal(sorted(u['txid'] + str(u['outputIndex']) for u in paged_utxos), sorted(u['txid'] + str(u['outputIndex']) for u in utxos))
+
         # Check that indexes will be updated with a reorg
         self.log.info("Testing reorg...")
         height_before = self.nodes[1].getblockcount()
@@ -272,6 +337,12 @@ class AddressIndexTest(GraviocoinTestFramework):
         assert(mempool[2]['txid'] == txidsort3)
         assert_equal(mempool[2]['address'], address3)
 
+        balance3 = self.nodes[2].getaddressbalance({"addresses": [address3], "mempool": True})
+        assert_equal(balance3["balance"], 3 * 100000000)
+        assert_equal(balance3["txcount"], 3)
+        balance3 = self.nodes[2].getaddressbalance({"addresses": [address3]})
+        assert_equal(balance3["balance"], 0)
+
         self.sync_all()
         self.stakeBlocks(1)
         mempool = self.nodes[2].getaddressmempool({"addresses": [address3]})
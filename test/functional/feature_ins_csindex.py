@@ -105,6 +105,13 @@ class TxIndexTest(GraviocoinTestFramework):
         ro = nodes[2].listcoldstakeunspent(addrStake, 2, {'mature_only': True, 'all_staked': True})
         assert(len(ro) == 0)
 
+        ro = nodes[2].getcoldstakesummary(addrStake)
+        assert(len(ro) == 1)
+        assert(ro[0]['addrspend'] == addrSpend)
+        assert(ro[0]['value'] == 2400000000000)
+        assert(ro[0]['num_unspent'] == 2)
+        assert(ro[0]['staked'] == 0)
+
         ro = nodes[2].listcoldstakeunspent(addrStake2)
         assert(len(ro) == 1)
         assert(ro[0]['value'] == 1200000000)
@@ -123,6 +130,13 @@ class TxIndexTest(GraviocoinTestFramework):
         ro = nodes[2].listcoldstakeunspent(addrStake)
         assert(len(ro) == 3)
 
+        rs = nodes[2].getcoldstakesummary(addrStake)
+        assert(rs[0]['num_unspent'] == 3)
+        assert(rs[0]['value'] == sum(o['value'] for o in ro))
+        assert(rs[0]['staked'] > 0)
+        assert(rs[0]['value'] == 2400000000000 + rs[0]['staked'])
+        assert(nodes[1].getcoldstakesummary(addrStake) == rs)
+
         ro = nodes[2].listcoldstakeunspent(addrStake, 4, {'mature_only': True})
         assert(len(ro) == 1)
         ro = nodes[2].listcoldstakeunspent(addrStake, 4, {'mature_only': True, 'all_staked': True})
@@ -138,13 +152,20 @@ class TxIndexTest(GraviocoinTestFramework):
         assert(ro[1]['height'] == 2)
         assert(len(ro) == 2)
 
+        rs = nodes[2].getcoldstakesummary(addrStake)
+        assert(rs[0]['num_unspent'] == 2)
+        assert(rs[0]['value'] == 2400000000000)
+        assert(rs[0]['staked'] == 0)
+
         ro = nodes[1].listcoldstakeunspent(addrStake)
         assert(len(ro) == 3)
+        rs = nodes[1].getcoldstakesummary(addrStake)
 
         self.restart_node(1)
 
         ro = nodes[1].listcoldstakeunspent(addrStake)
         assert(len(ro) == 3)
+        assert(nodes[1].getcoldstakesummary(addrStake) == rs)
 
         ro = nodes[1].getblockreward(2)
         assert(ro['stakereward'] < ro['blockreward'])
@@ -7,6 +7,10 @@
 # Test addressindex generation and fetching
 #
 
+import http.client
+import json
+import urllib.parse
+
 from test_framework.test_graviocoin import GraviocoinTestFramework
 from test_framework.util import connect_nodes, assert_equal
 
@@ -21,7 +25,7 @@ class SpentIndexTest(GraviocoinTestFramework):
             ['-debug','-spentindex'],
             # Nodes 2/3 are used for testing
             ['-debug','-spentindex'],
-            ['-debug','-spentindex', '-txindex'],]
+            ['-debug','-spentindex', '-txindex', '-rest'],]
 
     def skip_test_if_missing_module(self):
         self.skip_if_no_wallet()
@@ -146,6 +150,13 @@ class SpentIndexTest(GraviocoinTestFramework):
                 break
         assert(fFound)
 
+        url = urllib.parse.urlparse(nodes[3].url)
+        conn = http.client.HTTPConnection(url.hostname, url.port)
+        conn.request('GET', '/rest/block/deltas/' + block1_hash + '.json')
+        resp = conn.getresponse()
+        assert_equal(resp.status, 200)
+        assert_equal(json.loads(resp.read().decode('utf-8'))['deltas'], block['deltas'])
+
         print("Passed\n")
 
 
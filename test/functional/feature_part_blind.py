@@ -57,6 +57,9 @@ class BlindTest(GraviocoinTestFramework):
         assert(self.wait_for_mempool(nodes[1], txnHash))
 
         sync_mempools([nodes[0], nodes[1]])
+        ro = nodes[1].getnetworkinfo()['txprevalidation']
+        assert(ro['threads'] == 2)
+        assert(ro['verified'] >= 1)
         ro = nodes[1].getwalletinfo()
         assert(isclose(ro['unconfirmed_blind'], 3.4))
 
@@ -140,7 +140,10 @@ class SmsgTest(GraviocoinTestFramework):
         nodes[0].smsgdebug('clearbanned')
 
         self.log.info('Test smsgpeers')
-        assert(len(nodes[0].smsgpeers()) == 2)
+        peers = nodes[0].smsgpeers()
+        assert(len(peers) == 2)
+        for peer in peers:
+            assert(peer['processingtime'] > 0)
 
 
 if __name__ == '__main__':
@@ -11,6 +11,7 @@ class VoteTest(GraviocoinTestFramework):
         self.setup_clean_chain = True
         self.num_nodes = 3
         self.extra_args = [ ['-debug','-noacceptnonstdtxn','-reservebalance=10000000'] for i in range(self.num_nodes)]
+        self.extra_args[1].append('-voteindex')
 
     def skip_test_if_missing_module(self):
         self.skip_if_no_wallet()
@@ -61,5 +62,11 @@ class VoteTest(GraviocoinTestFramework):
         assert(ro['blocks_counted'] == 2)
         assert(ro['Option 3'] == '1, 50.00%')
 
+        # Node 1 tallies from the vote index
+        self.sync_all()
+        assert(nodes[1].getindexinfo()['voteindex'] is True)
+        assert(nodes[1].tallyvotes(1, 0, 10) == ro)
+        assert(nodes[1].tallyvotes(1, 2, 2) == nodes[0].tallyvotes(1, 2, 2))
+
 if __name__ == '__main__':
     VoteTest().main()
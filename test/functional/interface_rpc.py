@@ -61,6 +61,31 @@ class RPCInterfaceTest(BitcoinTestFramework):
         assert_equal(result_by_id[3]['error'], None)
         assert result_by_id[3]['result'] is not None
 
+    def test_parallel_batch_request(self):
+        self.log.info("Testing JSON-RPC batch request executed on several threads...")
+
+        self.restart_node(0, extra_args=['-rpcbatchthreads=4'])
+        blockhash = self.nodes[0].getblockhash(0)
+        requests = []
+        for i in range(200):
+            if i % 3 == 0:
+                requests.append({"method": "getblockhash", "params": [0], "id": i})
+            elif i % 3 == 1:
+                requests.append({"method": "getblockheader", "params": [blockhash], "id": i})
+            else:
+                requests.append({"method": "getblockhash", "params": [i], "id": i})
+        results = self.nodes[0].batch(requests)
+
+        # Replies keep the order of the requests
+        assert_equal([res['id'] for res in results], list(range(200)))
+        for i, res in enumerate(results):
+            if i % 3 == 0:
+                assert_equal(res['result'], blockhash)
+            elif i % 3 == 1:
+                assert_equal(res['result']['hash'], blockhash)
+            else:
+                assert_equal(res['error']['code'], -8)
+
     def test_http_status_codes(self):
         self.log.info("Testing HTTP status codes for JSON-RPC requests...")
 
@@ -71,6 +96,7 @@ class RPCInterfaceTest(BitcoinTestFramework):
         self.test_getrpcinfo()
         self.test_batch_request()
         self.test_http_status_codes()
+        self.test_parallel_batch_request()
 
 
 if __name__ == '__main__':
@@ -48,6 +48,7 @@ class ZMQTest (BitcoinTestFramework):
         try:
             self.test_basic()
             self.test_reorg()
+            self.test_sequence()
         finally:
             # Destroy the ZMQ context.
             self.log.debug("Destroying ZMQ context")
@@ -152,5 +153,30 @@ class ZMQTest (BitcoinTestFramework):
         # Should receive nodes[1] tip
         assert_equal(self.nodes[1].getbestblockhash(), hashblock.receive().hex())
 
+    def test_sequence(self):
+        import zmq
+        address = 'tcp://127.0.0.1:28334'
+        socket = self.ctx.socket(zmq.SUB)
+        socket.set(zmq.RCVTIMEO, 60000)
+        sequence = ZMQSubscriber(socket, b'sequence')
+
+        self.restart_node(0, ['-zmqpub%s=%s' % (sequence.topic.decode(), address)])
+        socket.connect(address)
+        # Relax so that the subscriber is ready before publishing zmq messages
+        sleep(0.2)
+
+        self.log.info("Blocks connected and disconnected are published in sequence")
+        blockhashes = self.nodes[0].generatetoaddress(2, ADDRESS_BCRT1_UNSPENDABLE)
+        for blockhash in blockhashes:
+            assert_equal(sequence.receive(), b'C' + bytes.fromhex(blockhash))
+
+        self.nodes[0].invalidateblock(blockhashes[0])
+        for blockhash in reversed(blockhashes):
+            assert_equal(sequence.receive(), b'D' + bytes.fromhex(blockhash))
+
+        self.nodes[0].reconsiderblock(blockhashes[0])
+        for blockhash in blockhashes:
+            assert_equal(sequence.receive(), b'C' + bytes.fromhex(blockhash))
+
 if __name__ == '__main__':
     ZMQTest().main()
@@ -94,6 +94,12 @@ class MempoolPersistTest(BitcoinTestFramework):
         # The others have loaded their mempool. If node_1 loaded anything, we'd probably notice by now:
         assert_equal(len(self.nodes[1].getrawmempool()), 0)
 
+        self.log.debug('Verify load progress is reported')
+        for node in self.nodes:
+            mempool_info = node.getmempoolinfo()
+            assert_equal(mempool_info['loadverified'], 1)
+            assert_equal(mempool_info['loadprogress'], 1)
+
         self.log.debug('Verify prioritization is loaded correctly')
         fees = self.nodes[0].getmempoolentry(txid=last_txid)['fees']
         assert_equal(fees['base'] + Decimal('0.00001000'), fees['modified'])
@@ -219,6 +219,14 @@ class BlockchainTest(BitcoinTestFramework):
         assert_equal(len(res['bestblock']), 64)
         assert_equal(len(res['hash_serialized_2']), 64)
 
+        self.log.info("Test that gettxoutsetinfo() returns the kept totals with hash_type none")
+        res_none = node.gettxoutsetinfo('none')
+        for key in ['total_amount', 'height', 'txouts', 'bogosize', 'bestblock']:
+            assert_equal(res_none[key], res[key])
+        assert 'hash_serialized_2' not in res_none
+        assert 'transactions' not in res_none
+        assert_raises_rpc_error(-8, "muhash is not a valid hash_type", node.gettxoutsetinfo, 'muhash')
+
         self.log.info("Test that gettxoutsetinfo() works for blockchain with just the genesis block")
         b1hash = node.getblockhash(1)
         node.invalidateblock(b1hash)
@@ -231,6 +239,9 @@ class BlockchainTest(BitcoinTestFramework):
         assert_equal(res2['bogosize'], 0),
         assert_equal(res2['bestblock'], node.getblockhash(0))
         assert_equal(len(res2['hash_serialized_2']), 64)
+        res2_none = node.gettxoutsetinfo('none')
+        for key in ['total_amount', 'height', 'txouts', 'bogosize', 'bestblock']:
+            assert_equal(res2_none[key], res2[key])
 
         self.log.info("Test that gettxoutsetinfo() returns the same result after invalidate/reconsider block")
         node.reconsiderblock(b1hash)
@@ -2,10 +2,11 @@
 # Copyright (c) 2019 The Bitcoin Core developers
 # Distributed under the MIT software license, see the accompanying
 # file COPYING or http://www.opensource.org/licenses/mit-license.php.
-"""Test the generation of UTXO snapshots using `dumptxoutset`.
+"""Test the generation of UTXO snapshots using `dumptxoutset` and loading them with `loadtxoutset`.
 """
 from test_framework.test_framework import BitcoinTestFramework
-from test_framework.util import assert_equal, assert_raises_rpc_error
+from test_framework.test_node import ErrorMatch
+from test_framework.util import assert_equal, assert_raises_rpc_error, connect_nodes
 
 import hashlib
 from pathlib import Path
@@ -14,7 +15,11 @@ from pathlib import Path
 class DumptxoutsetTest(BitcoinTestFramework):
     def set_test_params(self):
         self.setup_clean_chain = True
-        self.num_nodes = 1
+        self.num_nodes = 2
+
+    def setup_network(self):
+        # Node 1 loads the snapshot and must not sync the blocks first
+        self.setup_nodes()
 
     def run_test(self):
         """Test a trivial usage of the dumptxoutset RPC command."""
@@ -41,11 +46,55 @@ class DumptxoutsetTest(BitcoinTestFramework):
             digest = hashlib.sha256(f.read()).hexdigest()
             # UTXO snapshot hash should be deterministic based on mocked time.
             assert_equal(
-                digest, 'be032e5f248264ba08e11099ac09dbd001f6f87ffc68bf0f87043d8146d50664')
+                digest, '7588fc2ac446d64e71cebb8d9871447870799ec409e95e9ec2177357748c8912')
 
         # Specifying a path to an existing file will fail.
         assert_raises_rpc_error(
             -8, '{} already exists'.format(FILENAME),  node.dumptxoutset, FILENAME)
 
+        self.log.info("Load the snapshot into a node with the headers only")
+        loader = self.nodes[1]
+        assert_raises_rpc_error(-1, 'not in the header chain', loader.loadtxoutset, str(expected_path))
+        for i in range(1, 101):
+            loader.submitheader(node.getblockheader(node.getblockhash(i), False))
+        assert_raises_rpc_error(-1, 'No snapshot is accepted at height 100', loader.loadtxoutset, str(expected_path))
+
+        genesis_utxos = loader.gettxoutsetinfo()
+        self.restart_node(1, extra_args=['-assumeutxo=100:' + '00' * 32])
+        assert_raises_rpc_error(-1, 'does not match', loader.loadtxoutset, str(expected_path))
+        assert_equal(loader.getblockcount(), 0)
+        assert_equal(loader.gettxoutsetinfo()['hash_serialized_2'], genesis_utxos['hash_serialized_2'])
+
+        self.log.info("A truncated snapshot is rolled back")
+        self.restart_node(1, extra_args=['-assumeutxo=100:' + out['snapshot_hash']])
+        truncated_path = Path(loader.datadir) / 'regtest' / 'truncated.dat'
+        with open(str(expected_path), 'rb') as f:
+            data = f.read()
+        with open(str(truncated_path), 'wb') as f:
+            f.write(data[:len(data) // 2])
+        assert_raises_rpc_error(-1, 'Unable to read snapshot', loader.loadtxoutset, str(truncated_path))
+        assert_equal(loader.getblockcount(), 0)
+        assert_equal(loader.gettxoutsetinfo()['hash_serialized_2'], genesis_utxos['hash_serialized_2'])
+
+        loaded = loader.loadtxoutset(str(expected_path))
+        assert_equal(loaded['coins_loaded'], 100)
+        assert_equal(loaded['tip_hash'], out['base_hash'])
+        assert_equal(loader.getbestblockhash(), out['base_hash'])
+        assert_equal(loader.gettxoutsetinfo()['hash_serialized_2'], node.gettxoutsetinfo()['hash_serialized_2'])
+        assert_raises_rpc_error(-1, 'genesis block', loader.loadtxoutset, str(expected_path))
+
+        self.log.info("Sync blocks above the snapshot")
+        node.generate(10)
+        connect_nodes(loader, 0)
+        self.sync_blocks()
+        assert_equal(loader.gettxoutsetinfo()['hash_serialized_2'], node.gettxoutsetinfo()['hash_serialized_2'])
+
+        self.restart_node(1, extra_args=['-assumeutxo=100:' + out['snapshot_hash']])
+        assert_equal(loader.getblockcount(), 110)
+
+        self.log.info("Indexes that read old blocks can't be started on a chain loaded from a snapshot")
+        self.stop_node(1)
+        loader.assert_start_raises_init_error(['-txindex'], 'The chain was loaded from a UTXO snapshot', match=ErrorMatch.PARTIAL_REGEX)
+
 if __name__ == '__main__':
     DumptxoutsetTest().main()